@@ -254,6 +254,16 @@ void MEM_use_lockfree_allocator(void);
  * NOTE: The switch between allocator types can only happen before any allocation did happen. */
 void MEM_use_guarded_allocator(void);
 
+/* Switch allocator to pooled mode.
+ *
+ * Same tracking as the lock-free allocator, but small blocks are served from thread-local pools
+ * of fixed size classes. This avoids most of the system allocator and atomic counter overhead
+ * when many threads allocate small blocks at the same time. Memory of freed small blocks is kept
+ * for later allocations instead of being given back to the system.
+ *
+ * NOTE: The switch between allocator types can only happen before any allocation did happen. */
+void MEM_use_pool_allocator(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
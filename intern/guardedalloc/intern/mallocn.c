@@ -175,3 +175,34 @@ void MEM_use_guarded_allocator(void)
   MEM_name_ptr = MEM_guarded_name_ptr;
 #endif
 }
+
+void MEM_use_pool_allocator(void)
+{
+  assert_for_allocator_change();
+
+  MEM_allocN_len = MEM_pool_allocN_len;
+  MEM_freeN = MEM_pool_freeN;
+  MEM_dupallocN = MEM_pool_dupallocN;
+  MEM_reallocN_id = MEM_pool_reallocN_id;
+  MEM_recallocN_id = MEM_pool_recallocN_id;
+  MEM_callocN = MEM_pool_callocN;
+  MEM_calloc_arrayN = MEM_pool_calloc_arrayN;
+  MEM_mallocN = MEM_pool_mallocN;
+  MEM_malloc_arrayN = MEM_pool_malloc_arrayN;
+  MEM_mallocN_aligned = MEM_pool_mallocN_aligned;
+  MEM_printmemlist_pydict = MEM_pool_printmemlist_pydict;
+  MEM_printmemlist = MEM_pool_printmemlist;
+  MEM_callbackmemlist = MEM_pool_callbackmemlist;
+  MEM_printmemlist_stats = MEM_pool_printmemlist_stats;
+  MEM_set_error_callback = MEM_pool_set_error_callback;
+  MEM_consistency_check = MEM_pool_consistency_check;
+  MEM_set_memory_debug = MEM_pool_set_memory_debug;
+  MEM_get_memory_in_use = MEM_pool_get_memory_in_use;
+  MEM_get_memory_blocks_in_use = MEM_pool_get_memory_blocks_in_use;
+  MEM_reset_peak_memory = MEM_pool_reset_peak_memory;
+  MEM_get_peak_memory = MEM_pool_get_peak_memory;
+
+#ifndef NDEBUG
+  MEM_name_ptr = MEM_pool_name_ptr;
+#endif
+}
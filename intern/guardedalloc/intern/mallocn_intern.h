@@ -149,6 +149,49 @@ size_t MEM_lockfree_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
 const char *MEM_lockfree_name_ptr(void *vmemh);
 #endif
 
+/* Prototypes for pooled allocator functions */
+size_t MEM_pool_allocN_len(const void *vmemh) ATTR_WARN_UNUSED_RESULT;
+void MEM_pool_freeN(void *vmemh);
+void *MEM_pool_dupallocN(const void *vmemh) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+void *MEM_pool_reallocN_id(void *vmemh,
+                           size_t len,
+                           const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(2);
+void *MEM_pool_recallocN_id(void *vmemh,
+                            size_t len,
+                            const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(2);
+void *MEM_pool_callocN(size_t len, const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1) ATTR_NONNULL(2);
+void *MEM_pool_calloc_arrayN(size_t len,
+                             size_t size,
+                             const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1, 2) ATTR_NONNULL(3);
+void *MEM_pool_mallocN(size_t len, const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1) ATTR_NONNULL(2);
+void *MEM_pool_malloc_arrayN(size_t len,
+                             size_t size,
+                             const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1, 2) ATTR_NONNULL(3);
+void *MEM_pool_mallocN_aligned(size_t len,
+                               size_t alignment,
+                               const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1) ATTR_NONNULL(3);
+void MEM_pool_printmemlist_pydict(void);
+void MEM_pool_printmemlist(void);
+void MEM_pool_callbackmemlist(void (*func)(void *));
+void MEM_pool_printmemlist_stats(void);
+void MEM_pool_set_error_callback(void (*func)(const char *));
+bool MEM_pool_consistency_check(void);
+void MEM_pool_set_memory_debug(void);
+size_t MEM_pool_get_memory_in_use(void);
+unsigned int MEM_pool_get_memory_blocks_in_use(void);
+void MEM_pool_reset_peak_memory(void);
+size_t MEM_pool_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
+#ifndef NDEBUG
+const char *MEM_pool_name_ptr(void *vmemh);
+#endif
+
 /* Prototypes for fully guarded allocator functions */
 size_t MEM_guarded_allocN_len(const void *vmemh) ATTR_WARN_UNUSED_RESULT;
 void MEM_guarded_freeN(void *vmemh);
@@ -0,0 +1,682 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup intern_mem
+ *
+ * Memory allocation which serves small blocks from thread-local pools.
+ *
+ * Blocks up to #POOL_MAX_LEN bytes are rounded up to a size class. Every thread keeps a free
+ * list per size class, so allocating and freeing is done without any lock or atomic operation
+ * in the common case. Elements move between threads in batches through a global depot (which is
+ * protected by a mutex), new elements are carved from chunks allocated with malloc, similar to
+ * #BLI_mempool. Chunks are never given back to the system.
+ *
+ * Larger and aligned blocks are forwarded to the lock-free allocator.
+ *
+ * Memory statistics are counted per thread and added to global counters from time to time, so
+ * the peak memory can be slightly off (by up to #POOL_STATS_FLUSH_LEN per thread). The number of
+ * blocks and the memory in use are exact when no other thread is allocating at the same time,
+ * which is what leak detection relies on.
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h> /* printf */
+#include <stdlib.h>
+#include <string.h> /* memcpy */
+#include <sys/types.h>
+
+#include "MEM_guardedalloc.h"
+
+/* to ensure strict conversions */
+#include "../../source/blender/blenlib/BLI_strict_flags.h"
+
+#include "atomic_ops.h"
+#include "mallocn_intern.h"
+
+typedef struct MemHead {
+  /* Length of allocated memory block. */
+  size_t len;
+} MemHead;
+
+/* Same as the lock-free allocator, which uses bit 0 for aligned blocks. */
+enum {
+  MEMHEAD_ALIGN_FLAG = 1,
+  MEMHEAD_POOL_FLAG = 2,
+};
+
+#define MEMHEAD_FROM_PTR(ptr) (((MemHead *)ptr) - 1)
+#define PTR_FROM_MEMHEAD(memhead) (memhead + 1)
+#define MEMHEAD_IS_POOLED(memhead) ((memhead)->len & (size_t)MEMHEAD_POOL_FLAG)
+
+/* Largest block served from the pools. */
+#define POOL_MAX_LEN 1024
+#define POOL_SIZE_CLASSES_NUM 20
+/* Size of the chunks that elements are carved from. */
+#define POOL_CHUNK_SIZE (1 << 16)
+/* Number of bytes moved between a thread and the depot at once. */
+#define POOL_BATCH_SIZE (1 << 13)
+/* Thread-local statistics are added to the global ones when they exceed this. */
+#define POOL_STATS_FLUSH_LEN (1 << 20)
+
+/* Usable length of the elements of each size class. */
+static const size_t pool_size_classes[POOL_SIZE_CLASSES_NUM] = {
+    16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, 1024};
+
+/**
+ * A freed element. While in a free list, its #MemHead is reused to store the number of elements
+ * of the batch it starts (only meaningful for the first element of a batch in the depot).
+ */
+typedef struct PoolElem {
+  MemHead head;
+  struct PoolElem *next;
+  /* Next batch in the depot. */
+  struct PoolElem *next_batch;
+} PoolElem;
+
+typedef struct PoolFreeList {
+  PoolElem *first;
+  unsigned int len;
+} PoolFreeList;
+
+typedef struct ThreadCache {
+  struct ThreadCache *next, *prev;
+  PoolFreeList free_lists[POOL_SIZE_CLASSES_NUM];
+  /* Changes to the statistics made by this thread that are not added to the globals yet.
+   * Those can be negative, when the thread freed blocks allocated by others. */
+  ptrdiff_t mem_in_use;
+  ptrdiff_t totblock;
+} ThreadCache;
+
+typedef struct PoolChunk {
+  struct PoolChunk *next;
+} PoolChunk;
+
+static struct {
+  pthread_mutex_t mutex;
+  pthread_key_t thread_cache_key;
+  pthread_once_t init_once;
+
+  /* Linked lists of batches of free elements per size class. */
+  PoolElem *depot[POOL_SIZE_CLASSES_NUM];
+  /* All chunks allocated with malloc. */
+  PoolChunk *chunks;
+  size_t chunks_len;
+  /* Registered thread caches, to sum up statistics. */
+  ThreadCache *thread_caches;
+
+  /* Statistics of pooled blocks (large blocks are counted by the lock-free allocator). */
+  size_t mem_in_use;
+  unsigned int totblock;
+  size_t peak_mem;
+} pool = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .init_once = PTHREAD_ONCE_INIT,
+};
+
+static bool malloc_debug_memset = false;
+
+static void (*error_callback)(const char *) = NULL;
+
+/* The key is only used to free the cache when the thread exits, access goes through the faster
+ * thread-local variable. */
+#ifdef _MSC_VER
+static __declspec(thread) ThreadCache *thread_cache = NULL;
+#else
+static __thread ThreadCache *thread_cache = NULL;
+#endif
+
+#ifdef __GNUC__
+__attribute__((format(printf, 1, 2)))
+#endif
+static void
+print_error(const char *str, ...)
+{
+  char buf[512];
+  va_list ap;
+
+  va_start(ap, str);
+  vsnprintf(buf, sizeof(buf), str, ap);
+  va_end(ap);
+  buf[sizeof(buf) - 1] = '\0';
+
+  if (error_callback) {
+    error_callback(buf);
+  }
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Size Classes & Depot
+ * \{ */
+
+MEM_INLINE int pool_size_class(size_t len)
+{
+  if (len <= 128) {
+    return len == 0 ? 0 : (int)((len - 1) >> 4);
+  }
+  /* Bounding the index lets the compiler know the table is never read out of bounds,
+   * lengths are at most #POOL_MAX_LEN here. */
+  int size_class = 8;
+  while (size_class < POOL_SIZE_CLASSES_NUM - 1 && pool_size_classes[size_class] < len) {
+    size_class++;
+  }
+  return size_class;
+}
+
+MEM_INLINE size_t pool_elem_size(int size_class)
+{
+  return sizeof(MemHead) + pool_size_classes[size_class];
+}
+
+MEM_INLINE unsigned int pool_batch_len(int size_class)
+{
+  return (unsigned int)(POOL_BATCH_SIZE / pool_elem_size(size_class));
+}
+
+/** Get a batch of free elements from the depot or from a new chunk. Needs the mutex. */
+static PoolElem *pool_depot_pop_batch(int size_class, unsigned int *r_len)
+{
+  PoolElem *batch = pool.depot[size_class];
+  if (batch != NULL) {
+    pool.depot[size_class] = batch->next_batch;
+    *r_len = (unsigned int)batch->head.len;
+    return batch;
+  }
+
+  PoolChunk *chunk = malloc(POOL_CHUNK_SIZE);
+  if (UNLIKELY(chunk == NULL)) {
+    *r_len = 0;
+    return NULL;
+  }
+  chunk->next = pool.chunks;
+  pool.chunks = chunk;
+  pool.chunks_len++;
+
+  /* The chunk header keeps the elements aligned the same way as blocks from malloc. */
+  const size_t elem_size = pool_elem_size(size_class);
+  char *first = (char *)chunk + sizeof(MemHead) * 2;
+  const unsigned int len = (unsigned int)((POOL_CHUNK_SIZE - sizeof(MemHead) * 2) / elem_size);
+  for (unsigned int i = 0; i < len; i++) {
+    PoolElem *elem = (PoolElem *)(first + elem_size * i);
+    elem->next = (i + 1 < len) ? (PoolElem *)(first + elem_size * (i + 1)) : NULL;
+  }
+  *r_len = len;
+  return (PoolElem *)first;
+}
+
+/** Give a batch of free elements to the depot. Needs the mutex. */
+static void pool_depot_push_batch(int size_class, PoolElem *batch, unsigned int len)
+{
+  batch->head.len = len;
+  batch->next_batch = pool.depot[size_class];
+  pool.depot[size_class] = batch;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Thread Caches
+ * \{ */
+
+MEM_INLINE size_t pool_global_mem_in_use(void)
+{
+  return MEM_lockfree_get_memory_in_use() + pool.mem_in_use;
+}
+
+/** Add the statistics of the thread cache to the global ones. */
+static void thread_cache_flush_stats(ThreadCache *cache)
+{
+  if (cache->mem_in_use >= 0) {
+    atomic_add_and_fetch_z(&pool.mem_in_use, (size_t)cache->mem_in_use);
+  }
+  else {
+    atomic_sub_and_fetch_z(&pool.mem_in_use, (size_t)-cache->mem_in_use);
+  }
+  if (cache->totblock >= 0) {
+    atomic_add_and_fetch_u(&pool.totblock, (unsigned int)cache->totblock);
+  }
+  else {
+    atomic_sub_and_fetch_u(&pool.totblock, (unsigned int)-cache->totblock);
+  }
+  cache->mem_in_use = 0;
+  cache->totblock = 0;
+  atomic_fetch_and_update_max_z(&pool.peak_mem, pool_global_mem_in_use());
+}
+
+/** Called when a thread exits, gives all its elements and statistics back. */
+static void thread_cache_free(void *cache_v)
+{
+  ThreadCache *cache = cache_v;
+
+  pthread_mutex_lock(&pool.mutex);
+  for (int size_class = 0; size_class < POOL_SIZE_CLASSES_NUM; size_class++) {
+    PoolFreeList *free_list = &cache->free_lists[size_class];
+    if (free_list->first) {
+      pool_depot_push_batch(size_class, free_list->first, free_list->len);
+    }
+  }
+  if (cache->prev) {
+    cache->prev->next = cache->next;
+  }
+  else {
+    pool.thread_caches = cache->next;
+  }
+  if (cache->next) {
+    cache->next->prev = cache->prev;
+  }
+  thread_cache_flush_stats(cache);
+  pthread_mutex_unlock(&pool.mutex);
+
+  thread_cache = NULL;
+  free(cache);
+}
+
+static void pool_init_once(void)
+{
+  pthread_key_create(&pool.thread_cache_key, thread_cache_free);
+}
+
+static ThreadCache *thread_cache_ensure(void)
+{
+  ThreadCache *cache = thread_cache;
+  if (LIKELY(cache)) {
+    return cache;
+  }
+
+  pthread_once(&pool.init_once, pool_init_once);
+
+  cache = calloc(1, sizeof(ThreadCache));
+  if (UNLIKELY(cache == NULL)) {
+    return NULL;
+  }
+  pthread_mutex_lock(&pool.mutex);
+  cache->next = pool.thread_caches;
+  if (pool.thread_caches) {
+    pool.thread_caches->prev = cache;
+  }
+  pool.thread_caches = cache;
+  pthread_mutex_unlock(&pool.mutex);
+
+  pthread_setspecific(pool.thread_cache_key, cache);
+  thread_cache = cache;
+  return cache;
+}
+
+static PoolElem *thread_cache_alloc(ThreadCache *cache, int size_class)
+{
+  PoolFreeList *free_list = &cache->free_lists[size_class];
+  if (UNLIKELY(free_list->first == NULL)) {
+    pthread_mutex_lock(&pool.mutex);
+    free_list->first = pool_depot_pop_batch(size_class, &free_list->len);
+    pthread_mutex_unlock(&pool.mutex);
+    if (UNLIKELY(free_list->first == NULL)) {
+      return NULL;
+    }
+  }
+
+  PoolElem *elem = free_list->first;
+  free_list->first = elem->next;
+  free_list->len--;
+  return elem;
+}
+
+static void thread_cache_free_elem(ThreadCache *cache, int size_class, PoolElem *elem)
+{
+  PoolFreeList *free_list = &cache->free_lists[size_class];
+  elem->next = free_list->first;
+  free_list->first = elem;
+  free_list->len++;
+
+  /* Give a batch back when this thread frees much more than it allocates. */
+  const unsigned int batch_len = pool_batch_len(size_class);
+  if (UNLIKELY(free_list->len >= batch_len * 2)) {
+    PoolElem *last = free_list->first;
+    for (unsigned int i = 1; i < batch_len; i++) {
+      last = last->next;
+    }
+    PoolElem *batch = free_list->first;
+    free_list->first = last->next;
+    free_list->len -= batch_len;
+    last->next = NULL;
+
+    pthread_mutex_lock(&pool.mutex);
+    pool_depot_push_batch(size_class, batch, batch_len);
+    pthread_mutex_unlock(&pool.mutex);
+  }
+}
+
+MEM_INLINE void thread_cache_count(ThreadCache *cache, ptrdiff_t len, ptrdiff_t blocks)
+{
+  cache->mem_in_use += len;
+  cache->totblock += blocks;
+  if (UNLIKELY(cache->mem_in_use > POOL_STATS_FLUSH_LEN ||
+               cache->mem_in_use < -POOL_STATS_FLUSH_LEN)) {
+    thread_cache_flush_stats(cache);
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Allocator API
+ * \{ */
+
+size_t MEM_pool_allocN_len(const void *vmemh)
+{
+  if (vmemh) {
+    return MEMHEAD_FROM_PTR(vmemh)->len & ~((size_t)(MEMHEAD_ALIGN_FLAG | MEMHEAD_POOL_FLAG));
+  }
+
+  return 0;
+}
+
+void MEM_pool_freeN(void *vmemh)
+{
+  if (vmemh == NULL || !MEMHEAD_IS_POOLED(MEMHEAD_FROM_PTR(vmemh))) {
+    MEM_lockfree_freeN(vmemh);
+    return;
+  }
+
+  if (leak_detector_has_run) {
+    print_error("%s\n", free_after_leak_detection_message);
+  }
+
+  MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+  const size_t len = MEM_pool_allocN_len(vmemh);
+
+  if (UNLIKELY(malloc_debug_memset && len)) {
+    memset(memh + 1, 255, len);
+  }
+
+  ThreadCache *cache = thread_cache_ensure();
+  if (UNLIKELY(cache == NULL)) {
+    /* Out of memory for the thread cache, the element is lost but statistics stay valid. */
+    atomic_sub_and_fetch_z(&pool.mem_in_use, len);
+    atomic_sub_and_fetch_u(&pool.totblock, 1);
+    return;
+  }
+  thread_cache_count(cache, -(ptrdiff_t)len, -1);
+  thread_cache_free_elem(cache, pool_size_class(len), (PoolElem *)memh);
+}
+
+void *MEM_pool_mallocN(size_t len, const char *str)
+{
+  len = SIZET_ALIGN_4(len);
+
+  if (len > POOL_MAX_LEN) {
+    void *ptr = MEM_lockfree_mallocN(len, str);
+    atomic_fetch_and_update_max_z(&pool.peak_mem, pool_global_mem_in_use());
+    return ptr;
+  }
+
+  ThreadCache *cache = thread_cache_ensure();
+  PoolElem *elem = cache ? thread_cache_alloc(cache, pool_size_class(len)) : NULL;
+
+  if (LIKELY(elem)) {
+    MemHead *memh = &elem->head;
+    if (UNLIKELY(malloc_debug_memset && len)) {
+      memset(memh + 1, 255, len);
+    }
+
+    memh->len = len | (size_t)MEMHEAD_POOL_FLAG;
+    thread_cache_count(cache, (ptrdiff_t)len, 1);
+
+    return PTR_FROM_MEMHEAD(memh);
+  }
+  print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+              SIZET_ARG(len),
+              str,
+              (unsigned int)MEM_pool_get_memory_in_use());
+  return NULL;
+}
+
+void *MEM_pool_callocN(size_t len, const char *str)
+{
+  /* Large blocks can use calloc, which often gets zeroed pages from the system for free. */
+  if (SIZET_ALIGN_4(len) > POOL_MAX_LEN) {
+    void *ptr = MEM_lockfree_callocN(len, str);
+    atomic_fetch_and_update_max_z(&pool.peak_mem, pool_global_mem_in_use());
+    return ptr;
+  }
+
+  /* Clear the rounded up length without reading the header back, which the compiler sees as
+   * an access before the start of the allocation. */
+  void *ptr = MEM_pool_mallocN(len, str);
+  if (LIKELY(ptr)) {
+    memset(ptr, 0, SIZET_ALIGN_4(len));
+  }
+  return ptr;
+}
+
+void *MEM_pool_malloc_arrayN(size_t len, size_t size, const char *str)
+{
+  size_t total_size;
+  if (UNLIKELY(!MEM_size_safe_multiply(len, size, &total_size))) {
+    print_error(
+        "Malloc array aborted due to integer overflow: "
+        "len=" SIZET_FORMAT "x" SIZET_FORMAT " in %s, total %u\n",
+        SIZET_ARG(len),
+        SIZET_ARG(size),
+        str,
+        (unsigned int)MEM_pool_get_memory_in_use());
+    abort();
+    return NULL;
+  }
+
+  return MEM_pool_mallocN(total_size, str);
+}
+
+void *MEM_pool_calloc_arrayN(size_t len, size_t size, const char *str)
+{
+  size_t total_size;
+  if (UNLIKELY(!MEM_size_safe_multiply(len, size, &total_size))) {
+    print_error(
+        "Calloc array aborted due to integer overflow: "
+        "len=" SIZET_FORMAT "x" SIZET_FORMAT " in %s, total %u\n",
+        SIZET_ARG(len),
+        SIZET_ARG(size),
+        str,
+        (unsigned int)MEM_pool_get_memory_in_use());
+    abort();
+    return NULL;
+  }
+
+  return MEM_pool_callocN(total_size, str);
+}
+
+void *MEM_pool_mallocN_aligned(size_t len, size_t alignment, const char *str)
+{
+  void *ptr = MEM_lockfree_mallocN_aligned(len, alignment, str);
+  atomic_fetch_and_update_max_z(&pool.peak_mem, pool_global_mem_in_use());
+  return ptr;
+}
+
+void *MEM_pool_dupallocN(const void *vmemh)
+{
+  void *newp = NULL;
+  if (vmemh) {
+    if (!MEMHEAD_IS_POOLED(MEMHEAD_FROM_PTR(vmemh))) {
+      return MEM_lockfree_dupallocN(vmemh);
+    }
+    const size_t prev_size = MEM_pool_allocN_len(vmemh);
+    newp = MEM_pool_mallocN(prev_size, "dupli_malloc");
+    if (newp) {
+      memcpy(newp, vmemh, prev_size);
+    }
+  }
+  return newp;
+}
+
+static void *pool_realloc(void *vmemh, size_t len, const char *str, const bool clear)
+{
+  if (vmemh == NULL) {
+    return clear ? MEM_pool_callocN(len, str) : MEM_pool_mallocN(len, str);
+  }
+
+  MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+  if (UNLIKELY(memh->len & (size_t)MEMHEAD_ALIGN_FLAG)) {
+    return clear ? MEM_lockfree_recallocN_id(vmemh, len, str) :
+                   MEM_lockfree_reallocN_id(vmemh, len, str);
+  }
+
+  const size_t old_len = MEM_pool_allocN_len(vmemh);
+
+  /* Resize in place when the new length still fits the element of the same size class. */
+  const size_t new_len = SIZET_ALIGN_4(len);
+  if (MEMHEAD_IS_POOLED(memh) && new_len <= POOL_MAX_LEN &&
+      pool_size_class(new_len) == pool_size_class(old_len)) {
+    if (clear && new_len > old_len) {
+      memset(((char *)vmemh) + old_len, 0, new_len - old_len);
+    }
+    memh->len = new_len | (size_t)MEMHEAD_POOL_FLAG;
+    ThreadCache *cache = thread_cache_ensure();
+    if (LIKELY(cache)) {
+      thread_cache_count(cache, (ptrdiff_t)new_len - (ptrdiff_t)old_len, 0);
+    }
+    else if (new_len >= old_len) {
+      atomic_add_and_fetch_z(&pool.mem_in_use, new_len - old_len);
+    }
+    else {
+      atomic_sub_and_fetch_z(&pool.mem_in_use, old_len - new_len);
+    }
+    return vmemh;
+  }
+
+  void *newp = MEM_pool_mallocN(len, clear ? "recalloc" : "realloc");
+  if (newp) {
+    if (len < old_len) {
+      /* shrink */
+      memcpy(newp, vmemh, len);
+    }
+    else {
+      memcpy(newp, vmemh, old_len);
+
+      if (clear && len > old_len) {
+        /* grow */
+        /* zero new bytes */
+        memset(((char *)newp) + old_len, 0, len - old_len);
+      }
+    }
+  }
+
+  MEM_pool_freeN(vmemh);
+  return newp;
+}
+
+void *MEM_pool_reallocN_id(void *vmemh, size_t len, const char *str)
+{
+  return pool_realloc(vmemh, len, str, false);
+}
+
+void *MEM_pool_recallocN_id(void *vmemh, size_t len, const char *str)
+{
+  return pool_realloc(vmemh, len, str, true);
+}
+
+void MEM_pool_printmemlist_pydict(void)
+{
+}
+
+void MEM_pool_printmemlist(void)
+{
+}
+
+/* unused */
+void MEM_pool_callbackmemlist(void (*func)(void *))
+{
+  (void)func; /* Ignored. */
+}
+
+void MEM_pool_printmemlist_stats(void)
+{
+  printf("\ntotal memory len: %.3f MB\n",
+         (double)MEM_pool_get_memory_in_use() / (double)(1024 * 1024));
+  printf("peak memory len: %.3f MB\n", (double)MEM_pool_get_peak_memory() / (double)(1024 * 1024));
+  printf("pooled memory reserved: %.3f MB\n",
+         (double)(pool.chunks_len * POOL_CHUNK_SIZE) / (double)(1024 * 1024));
+  printf(
+      "\nFor more detailed per-block statistics run Blender with memory debugging command line "
+      "argument.\n");
+
+#ifdef HAVE_MALLOC_STATS
+  printf("System Statistics:\n");
+  malloc_stats();
+#endif
+}
+
+void MEM_pool_set_error_callback(void (*func)(const char *))
+{
+  error_callback = func;
+  MEM_lockfree_set_error_callback(func);
+}
+
+bool MEM_pool_consistency_check(void)
+{
+  return true;
+}
+
+void MEM_pool_set_memory_debug(void)
+{
+  malloc_debug_memset = true;
+  MEM_lockfree_set_memory_debug();
+}
+
+size_t MEM_pool_get_memory_in_use(void)
+{
+  pthread_mutex_lock(&pool.mutex);
+  ptrdiff_t mem_in_use = (ptrdiff_t)pool.mem_in_use;
+  for (ThreadCache *cache = pool.thread_caches; cache; cache = cache->next) {
+    mem_in_use += cache->mem_in_use;
+  }
+  pthread_mutex_unlock(&pool.mutex);
+  return MEM_lockfree_get_memory_in_use() + (size_t)mem_in_use;
+}
+
+unsigned int MEM_pool_get_memory_blocks_in_use(void)
+{
+  pthread_mutex_lock(&pool.mutex);
+  ptrdiff_t totblock = (ptrdiff_t)pool.totblock;
+  for (ThreadCache *cache = pool.thread_caches; cache; cache = cache->next) {
+    totblock += cache->totblock;
+  }
+  pthread_mutex_unlock(&pool.mutex);
+  return MEM_lockfree_get_memory_blocks_in_use() + (unsigned int)totblock;
+}
+
+void MEM_pool_reset_peak_memory(void)
+{
+  pool.peak_mem = MEM_pool_get_memory_in_use();
+}
+
+size_t MEM_pool_get_peak_memory(void)
+{
+  const size_t mem_in_use = MEM_pool_get_memory_in_use();
+  return pool.peak_mem > mem_in_use ? pool.peak_mem : mem_in_use;
+}
+
+#ifndef NDEBUG
+const char *MEM_pool_name_ptr(void *vmemh)
+{
+  if (vmemh) {
+    return "unknown block name ptr";
+  }
+
+  return "MEM_pool_name_ptr(NULL)";
+}
+#endif /* NDEBUG */
+
+/** \} */
@@ -0,0 +1,137 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+#include "guardedalloc_test_base.h"
+
+TEST_F(PoolAllocatorTest, SizeClasses)
+{
+  std::vector<void *> blocks;
+  size_t total_len = 0;
+  for (size_t len = 0; len <= 2100; len += 7) {
+    char *block = (char *)MEM_mallocN(len, __func__);
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(MEM_allocN_len(block), (len + 3) & ~size_t(3));
+    memset(block, (int)(len & 0xff), len);
+    blocks.push_back(block);
+    total_len += MEM_allocN_len(block);
+  }
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks.size());
+  EXPECT_EQ(MEM_get_memory_in_use(), total_len);
+
+  /* Check that blocks don't overlap. */
+  for (size_t i = 0; i < blocks.size(); i++) {
+    const size_t len = i * 7;
+    for (size_t j = 0; j < len; j++) {
+      EXPECT_EQ(((unsigned char *)blocks[i])[j], (i * 7) & 0xff);
+    }
+  }
+
+  for (void *block : blocks) {
+    MEM_freeN(block);
+  }
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0);
+  EXPECT_EQ(MEM_get_memory_in_use(), 0);
+}
+
+TEST_F(PoolAllocatorTest, ReallocAndDup)
+{
+  int *data = (int *)MEM_callocN(sizeof(int) * 4, __func__);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(data[i], 0);
+    data[i] = i;
+  }
+  /* Grow from a pooled block to a large one and back. */
+  data = (int *)MEM_recallocN(data, sizeof(int) * 1000);
+  EXPECT_EQ(data[3], 3);
+  EXPECT_EQ(data[999], 0);
+  data = (int *)MEM_reallocN(data, sizeof(int) * 8);
+  EXPECT_EQ(data[3], 3);
+
+  int *dup = (int *)MEM_dupallocN(data);
+  EXPECT_EQ(MEM_allocN_len(dup), sizeof(int) * 8);
+  EXPECT_EQ(memcmp(dup, data, sizeof(int) * 8), 0);
+
+  MEM_freeN(dup);
+  MEM_freeN(data);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0);
+}
+
+TEST_F(PoolAllocatorTest, ReallocSameSizeClass)
+{
+  char *data = (char *)MEM_mallocN(130, __func__);
+  memset(data, 1, 130);
+  /* 130 and 160 bytes share a size class, the block is resized in place. */
+  char *grown = (char *)MEM_recallocN(data, 160);
+  EXPECT_EQ(grown, data);
+  EXPECT_EQ(MEM_allocN_len(grown), 160);
+  EXPECT_EQ(grown[129], 1);
+  for (int i = 132; i < 160; i++) {
+    EXPECT_EQ(grown[i], 0);
+  }
+  EXPECT_EQ(MEM_get_memory_in_use(), 160);
+
+  char *moved = (char *)MEM_reallocN(grown, 200);
+  EXPECT_EQ(MEM_allocN_len(moved), 200);
+  EXPECT_EQ(moved[129], 1);
+  EXPECT_EQ(MEM_get_memory_in_use(), 200);
+
+  MEM_freeN(moved);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0);
+  EXPECT_EQ(MEM_get_memory_in_use(), 0);
+}
+
+TEST_F(PoolAllocatorTest, CallocLarge)
+{
+  int *data = (int *)MEM_callocN(sizeof(int) * 4096, __func__);
+  for (int i = 0; i < 4096; i++) {
+    EXPECT_EQ(data[i], 0);
+  }
+  EXPECT_EQ(MEM_allocN_len(data), sizeof(int) * 4096);
+  EXPECT_EQ(MEM_get_memory_in_use(), sizeof(int) * 4096);
+  MEM_freeN(data);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0);
+}
+
+TEST_F(PoolAllocatorTest, Threads)
+{
+  const int threads_num = 8;
+  const int blocks_num = 20000;
+
+  /* Every thread allocates blocks that are freed by the next thread. */
+  std::vector<std::vector<void *>> blocks(threads_num);
+  std::vector<std::thread> threads;
+  for (int thread_index = 0; thread_index < threads_num; thread_index++) {
+    threads.emplace_back([&, thread_index]() {
+      for (int i = 0; i < blocks_num; i++) {
+        const size_t len = (size_t)((i * 37 + thread_index) % 600);
+        void *block = MEM_mallocN(len, __func__);
+        memset(block, thread_index, len);
+        blocks[thread_index].push_back(block);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), threads_num * blocks_num);
+
+  threads.clear();
+  for (int thread_index = 0; thread_index < threads_num; thread_index++) {
+    threads.emplace_back([&, thread_index]() {
+      for (void *block : blocks[(thread_index + 1) % threads_num]) {
+        MEM_freeN(block);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0);
+  EXPECT_EQ(MEM_get_memory_in_use(), 0);
+}
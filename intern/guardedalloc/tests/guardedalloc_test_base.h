@@ -23,4 +23,12 @@ class GuardedAllocatorTest : public ::testing::Test {
   }
 };
 
+class PoolAllocatorTest : public ::testing::Test {
+ protected:
+  virtual void SetUp()
+  {
+    MEM_use_pool_allocator();
+  }
+};
+
 #endif  // __GUARDEDALLOC_TEST_UTIL_H__
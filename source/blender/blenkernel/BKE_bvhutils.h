@@ -324,6 +324,20 @@ struct BVHCache *bvhcache_init(void);
  * Frees a BVH-cache.
  */
 void bvhcache_free(struct BVHCache *bvh_cache);
+/**
+ * Take the trees out of the cache of a mesh that is about to be freed, so that they can be given
+ * to the next mesh evaluated for the same object with #bvhcache_unstash. Trees that can't be
+ * refitted are freed. The cache pointer is cleared.
+ * \return The stashed trees or null when there are none, freed with #bvhcache_free.
+ */
+struct BVHCache *bvhcache_stash(struct BVHCache **bvh_cache_p);
+/**
+ * Give stashed trees to a new mesh. Each tree is refitted to the positions of the mesh the first
+ * time it is requested, instead of building a new tree. That only happens when the number of
+ * elements did not change and the tree did not degrade too much from refitting; otherwise a new
+ * tree is built as usual. The stash is freed.
+ */
+void bvhcache_unstash(struct BVHCache **bvh_cache_p, struct BVHCache *stash);
 
 #ifdef __cplusplus
 }
@@ -75,6 +75,11 @@ typedef enum eCDAllocType {
   CD_REFERENCE = 3,
   /** Do a full copy of all layers, only allowed if source has same number of elements. */
   CD_DUPLICATE = 4,
+  /**
+   * Share the data of all layers with the source, it is only copied when it is modified.
+   * Only allowed if source has same number of elements.
+   */
+  CD_SHARE = 5,
 } eCDAllocType;
 
 #define CD_TYPE_AS_MASK(_type) (CustomDataMask)((CustomDataMask)1 << (CustomDataMask)(_type))
@@ -115,7 +120,8 @@ bool CustomData_has_interp(const struct CustomData *data);
 bool CustomData_bmesh_has_free(const struct CustomData *data);
 
 /**
- * Checks if any of the custom-data layers is referenced.
+ * Checks if any of the custom-data layers is referenced, or shares its data with other
+ * custom-data (see #CD_SHARE), so that the data can't be assigned to a new owner.
  */
 bool CustomData_has_referenced(const struct CustomData *data);
 
@@ -266,6 +272,7 @@ int CustomData_number_of_layers_typemask(const struct CustomData *data, CustomDa
 
 /**
  * Duplicate data of a layer with flag NOFREE, and remove that flag.
+ * Data which is shared with other layers is copied as well, so that the layer can be modified.
  * \return the layer data.
  */
 void *CustomData_duplicate_referenced_layer(struct CustomData *data, int type, int totelem);
@@ -280,9 +287,19 @@ void *CustomData_duplicate_referenced_layer_named(struct CustomData *data,
 void *CustomData_duplicate_referenced_layer_anonymous(
     CustomData *data, int type, const struct AnonymousAttributeID *anonymous_id, int totelem);
 bool CustomData_is_referenced_layer(struct CustomData *data, int type);
+/**
+ * Check whether every layer in \a data still uses the same array as the layer with the same type
+ * and name in \a source, which means it has not been modified since it was copied with
+ * #CD_SHARE or #CD_REFERENCE (modifying requires #CustomData_duplicate_referenced_layer).
+ * Layers with a type in \a mask_ignore are skipped.
+ */
+bool CustomData_layers_share_data(const struct CustomData *data,
+                                  const struct CustomData *source,
+                                  CustomDataMask mask_ignore);
 
 /**
  * Duplicate all the layers with flag NOFREE, and remove the flag from duplicated layers.
+ * Data which is shared with other layers is copied as well.
  */
 void CustomData_duplicate_referenced_layers(CustomData *data, int totelem);
 
@@ -359,6 +376,25 @@ void CustomData_interp(const struct CustomData *source,
                        const float *sub_weights,
                        int count,
                        int dest_index);
+/**
+ * Interpolate many destination items at once, each from the same number of source items.
+ * This gives the same result as calling #CustomData_interp for every item, but layers are only
+ * matched once, and common float types use loops specialized for their type.
+ *
+ * \param src_indices: The indices of the \a count source items of every destination item.
+ * \param weights: The \a count weights of every destination item. If NULL, the source items
+ * are averaged.
+ * \param count: The number of source items to interpolate for every destination item.
+ * \param dest_indices: The index of every destination item.
+ * \param dest_num: The number of destination items.
+ */
+void CustomData_interp_batch(const struct CustomData *source,
+                             struct CustomData *dest,
+                             const int *src_indices,
+                             const float *weights,
+                             int count,
+                             const int *dest_indices,
+                             int dest_num);
 /**
  * \note src_blocks_ofs & dst_block_ofs
  * must be pointers to the data, offset by layer->offset already.
@@ -376,6 +412,19 @@ void CustomData_bmesh_interp(struct CustomData *data,
                              const float *sub_weights,
                              int count,
                              void *dst_block);
+/**
+ * Interpolate the same source blocks into many destination blocks, with different weights for
+ * every destination. Equivalent to calling #CustomData_bmesh_interp for every destination block.
+ *
+ * \param weights: The \a count weights of every destination block. If NULL, the source blocks
+ * are averaged.
+ */
+void CustomData_bmesh_interp_batch(struct CustomData *data,
+                                   const void **src_blocks,
+                                   const float *weights,
+                                   int count,
+                                   void **dst_blocks,
+                                   int dst_num);
 
 /**
  * Swap data inside each item, for all layers.
@@ -463,6 +512,7 @@ void CustomData_bmesh_set_layer_n(struct CustomData *data, void *block, int n, c
 
 /**
  * Set the pointer of to the first layer of type. the old data is not freed.
+ * When the old data was shared with other layers, only this layer's user is removed.
  * returns the value of `ptr` if the layer is found, NULL otherwise.
  */
 void *CustomData_set_layer(const struct CustomData *data, int type, void *ptr);
@@ -163,7 +163,11 @@ enum {
   LIB_ID_COPY_CACHES = 1 << 18,
   /** Don't copy id->adt, used by ID datablock localization routines. */
   LIB_ID_COPY_NO_ANIMDATA = 1 << 19,
-  /** Mesh: Reference CD data layers instead of doing real copy - USE WITH CAUTION! */
+  /**
+   * Mesh, hair, point-cloud: Share CD data layers instead of doing real copy, they are copied
+   * when modified. Only valid when the source isn't modified in place afterwards, which is why
+   * copy-on-write copies of original data don't use it.
+   */
   LIB_ID_COPY_CD_REFERENCE = 1 << 20,
   /** Do not copy id->override_library, used by ID datablock override routines. */
   LIB_ID_COPY_NO_LIB_OVERRIDE = 1 << 21,
@@ -1038,9 +1038,23 @@ void BKE_mesh_eval_geometry(struct Depsgraph *depsgraph, struct Mesh *mesh);
 /* Draw Cache */
 void BKE_mesh_batch_cache_dirty_tag(struct Mesh *me, eMeshBatchDirtyMode mode);
 void BKE_mesh_batch_cache_free(struct Mesh *me);
+/**
+ * Take the batch cache out of an evaluated mesh that is about to be freed, so that it can be given
+ * to the next evaluated mesh of the same object with #BKE_mesh_batch_cache_unstash.
+ * \return The batch cache or null, freed with #BKE_mesh_batch_cache_stash_free.
+ */
+void *BKE_mesh_batch_cache_stash(struct Mesh *me);
+/**
+ * Give a stashed batch cache to a mesh which only has different positions than the mesh the cache
+ * was created for (see #BKE_mesh_runtime_only_positions_changed). Only the buffers depending on
+ * positions are extracted again.
+ */
+void BKE_mesh_batch_cache_unstash(struct Mesh *me, void *batch_cache);
+void BKE_mesh_batch_cache_stash_free(void *batch_cache);
 
 extern void (*BKE_mesh_batch_cache_dirty_tag_cb)(struct Mesh *me, eMeshBatchDirtyMode mode);
 extern void (*BKE_mesh_batch_cache_free_cb)(struct Mesh *me);
+extern void (*BKE_mesh_batch_cache_stash_free_cb)(void *batch_cache);
 
 /* mesh_debug.c */
 #ifndef NDEBUG
@@ -115,6 +115,14 @@ void BKE_mesh_runtime_eval_to_meshkey(struct Mesh *me_deformed,
                                       struct Mesh *me,
                                       struct KeyBlock *kb);
 
+/**
+ * Check whether an evaluated mesh only has different vertex positions (and data derived from
+ * them, like normals) than its input mesh, which is the case when only deform modifiers changed
+ * it. All other layers have to still share their data with the input mesh.
+ */
+bool BKE_mesh_runtime_only_positions_changed(const struct Mesh *me_eval,
+                                             const struct Mesh *me_input);
+
 #ifndef NDEBUG
 bool BKE_mesh_runtime_is_valid(struct Mesh *me_eval);
 #endif /* NDEBUG */
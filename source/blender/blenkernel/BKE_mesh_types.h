@@ -29,4 +29,9 @@ typedef enum eMeshBatchDirtyMode {
   BKE_MESH_BATCH_DIRTY_SHADING,
   BKE_MESH_BATCH_DIRTY_UVEDIT_ALL,
   BKE_MESH_BATCH_DIRTY_UVEDIT_SELECT,
+  /**
+   * Only vertex positions changed, so topology and attribute buffers stay valid. Triangle index
+   * buffers are only kept for meshes that consist of triangles.
+   */
+  BKE_MESH_BATCH_DIRTY_POSITIONS,
 } eMeshBatchDirtyMode;
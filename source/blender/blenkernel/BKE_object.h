@@ -453,6 +453,12 @@ void BKE_object_eval_uber_data(struct Depsgraph *depsgraph,
  * Assign #Object.data after modifier stack evaluation.
  */
 void BKE_object_eval_assign_data(struct Object *object, struct ID *data, bool is_owned);
+/**
+ * Check whether the evaluated mesh only has different positions than its input, and give the
+ * draw batch cache of the previously evaluated mesh to it in that case, otherwise free the cache.
+ * See #BKE_mesh_batch_cache_unstash.
+ */
+void BKE_object_eval_batch_cache_unstash(struct Object *object_eval);
 
 void BKE_object_sync_to_original(struct Depsgraph *depsgraph, struct Object *object);
 
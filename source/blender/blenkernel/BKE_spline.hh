@@ -97,6 +97,12 @@ class Spline {
   mutable std::mutex length_cache_mutex_;
   mutable bool length_cache_dirty_ = true;
 
+  /**
+   * Identifies the state of the evaluated data. A new value is generated whenever the caches are
+   * invalidated, so values are never shared by splines with different evaluated data.
+   */
+  uint64_t cache_version_ = new_cache_version();
+
  public:
   virtual ~Spline() = default;
   Spline(const Type type) : type_(type)
@@ -150,6 +156,12 @@ class Spline {
    * change the generated positions, tangents, normals, mapping, etc. of the evaluated points.
    */
   virtual void mark_cache_invalid() = 0;
+  /**
+   * Return a value that changes every time #mark_cache_invalid is called, which can be used to
+   * detect whether evaluated data stored outside of the spline is still valid. Copies of a spline
+   * made with #copy keep the version, since their evaluated data is the same.
+   */
+  uint64_t cache_version() const;
   virtual int evaluated_points_size() const = 0;
   int evaluated_edges_size() const;
 
@@ -254,6 +266,9 @@ class Spline {
   }
 
  protected:
+  static uint64_t new_cache_version();
+  void update_cache_version();
+
   virtual void correct_end_tangents() const = 0;
   virtual void copy_settings(Spline &dst) const = 0;
   virtual void copy_data(Spline &dst) const = 0;
@@ -650,9 +665,51 @@ class PolySpline final : public Spline {
  * DNA.
  */
 struct CurveEval {
+  /**
+   * Evaluated data for all splines, stored in flat arrays so that it can be accessed without
+   * going through each spline's caches separately. The data for a spline is found in the
+   * range defined by #offsets, like #evaluated_point_offsets. Only the fields passed to
+   * #evaluated_data are up to date, the others may be empty or outdated.
+   */
+  struct EvaluatedData {
+    /** The start index of every spline's evaluated points, with the total size at the end. */
+    blender::Array<int> offsets;
+    blender::Array<blender::float3> positions;
+    blender::Array<blender::float3> tangents;
+    blender::Array<blender::float3> normals;
+    /**
+     * Accumulated lengths, as in #Spline::evaluated_lengths. Since a spline has one fewer
+     * evaluated edge than points when it isn't cyclic, the last value of the spline's point
+     * range is unused in that case.
+     */
+    blender::Array<float> lengths;
+
+    blender::IndexRange range(const int spline_index) const
+    {
+      return {offsets[spline_index], offsets[spline_index + 1] - offsets[spline_index]};
+    }
+  };
+
+  /** The arrays of #EvaluatedData that are evaluated, since most users only need some. */
+  enum class EvaluatedFields {
+    Positions = 1 << 0,
+    Tangents = 1 << 1,
+    Normals = 1 << 2,
+    Lengths = 1 << 3,
+    All = Positions | Tangents | Normals | Lengths,
+  };
+
  private:
   blender::Vector<SplinePtr> splines_;
 
+  mutable EvaluatedData evaluated_data_;
+  /**
+   * The #Spline::cache_version of every spline when each field of #evaluated_data_ was last
+   * updated, in the order of the bits of #EvaluatedFields.
+   */
+  mutable blender::Array<uint64_t> evaluated_data_versions_[4];
+  mutable std::mutex evaluated_data_mutex_;
+
  public:
   blender::bke::CustomDataAttributes attributes;
 
@@ -662,6 +719,8 @@ struct CurveEval {
     for (const SplinePtr &spline : other.splines()) {
       this->add_spline(spline->copy());
     }
+    /* The evaluated data isn't copied, most copies are changed right away. It is built again from
+     * the caches of the copied splines when it is needed. */
   }
 
   blender::Span<SplinePtr> splines() const;
@@ -709,6 +768,16 @@ struct CurveEval {
 
   void mark_cache_invalid();
 
+  /**
+   * Return the evaluated positions, tangents, normals and lengths of all splines in flat arrays.
+   * Only the requested fields are evaluated, and only for the splines whose
+   * #Spline::cache_version changed since the field was last requested, in parallel. As with the caches on splines, #Spline::mark_cache_invalid must be
+   * called after changing any data that affects evaluation.
+   *
+   * \warning The returned reference is invalidated by the next call after a spline changed.
+   */
+  const EvaluatedData &evaluated_data(EvaluatedFields fields = EvaluatedFields::All) const;
+
   /**
    * Check the invariants that curve control point attributes should always uphold, necessary
    * because attributes are stored on splines rather than in a flat array on the curve:
@@ -719,6 +788,8 @@ struct CurveEval {
   void assert_valid_point_attributes() const;
 };
 
+ENUM_OPERATORS(CurveEval::EvaluatedFields, CurveEval::EvaluatedFields::Lengths);
+
 std::unique_ptr<CurveEval> curve_eval_from_dna_curve(const Curve &curve,
                                                      const ListBase &nurbs_list);
 std::unique_ptr<CurveEval> curve_eval_from_dna_curve(const Curve &dna_curve);
@@ -32,6 +32,7 @@
 #include "BLI_linklist.h"
 #include "BLI_math.h"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -48,7 +49,14 @@
 
 struct BVHCacheItem {
   bool is_filled;
+  /**
+   * The tree was built for a previous mesh and moved here with #bvhcache_unstash. Its bounds have
+   * to be refitted to the positions of the current mesh before it can be used.
+   */
+  bool is_stale;
   BVHTree *tree;
+  /** Result of #BLI_bvhtree_get_branch_area_ratio when the tree was built, zero if unknown. */
+  float build_area_ratio;
 };
 
 struct BVHCache {
@@ -118,7 +126,7 @@ bool bvhcache_has_tree(const BVHCache *bvh_cache, const BVHTree *tree)
   }
 
   for (int i = 0; i < BVHTREE_MAX_ITEM; i++) {
-    if (bvh_cache->items[i].tree == tree) {
+    if (bvh_cache->items[i].is_filled && bvh_cache->items[i].tree == tree) {
       return true;
     }
   }
@@ -143,8 +151,14 @@ static void bvhcache_insert(BVHCache *bvh_cache, BVHTree *tree, BVHCacheType typ
 {
   BVHCacheItem *item = &bvh_cache->items[type];
   BLI_assert(!item->is_filled);
+  if (item->is_stale) {
+    /* The stale tree could not be refitted. */
+    BLI_bvhtree_free(item->tree);
+    item->is_stale = false;
+  }
   item->tree = tree;
   item->is_filled = true;
+  item->build_area_ratio = 0.0f;
 }
 
 void bvhcache_free(BVHCache *bvh_cache)
@@ -158,6 +172,185 @@ void bvhcache_free(BVHCache *bvh_cache)
   MEM_freeN(bvh_cache);
 }
 
+/**
+ * Refitting is only possible for trees that contain every element of the mesh, because then the
+ * leaf with a certain index always corresponds to the element with that index.
+ */
+static bool bvhcache_type_supports_refit(const BVHCacheType type)
+{
+  return ELEM(type, BVHTREE_FROM_VERTS, BVHTREE_FROM_EDGES, BVHTREE_FROM_LOOPTRI);
+}
+
+/**
+ * Refitted trees are rebuilt when their branches became this much larger relative to the root
+ * than they were directly after building, because queries have to visit too many branches then.
+ */
+static constexpr float bvhcache_refit_max_area_ratio_growth = 1.5f;
+
+BVHCache *bvhcache_stash(BVHCache **bvh_cache_p)
+{
+  BVHCache *bvh_cache = *bvh_cache_p;
+  if (bvh_cache == nullptr) {
+    return nullptr;
+  }
+  *bvh_cache_p = nullptr;
+
+  bool has_trees = false;
+  for (int index = 0; index < BVHTREE_MAX_ITEM; index++) {
+    BVHCacheItem *item = &bvh_cache->items[index];
+    if (item->tree == nullptr) {
+      item->is_filled = false;
+      continue;
+    }
+    if (!bvhcache_type_supports_refit(BVHCacheType(index))) {
+      BLI_bvhtree_free(item->tree);
+      item->tree = nullptr;
+      item->is_filled = false;
+      continue;
+    }
+    if (item->is_filled && item->build_area_ratio == 0.0f) {
+      /* The tree has not been refitted yet. */
+      item->build_area_ratio = BLI_bvhtree_get_branch_area_ratio(item->tree);
+    }
+    item->is_filled = false;
+    item->is_stale = true;
+    has_trees = true;
+  }
+
+  if (!has_trees) {
+    bvhcache_free(bvh_cache);
+    return nullptr;
+  }
+  return bvh_cache;
+}
+
+void bvhcache_unstash(BVHCache **bvh_cache_p, BVHCache *stash)
+{
+  if (*bvh_cache_p == nullptr) {
+    *bvh_cache_p = stash;
+    return;
+  }
+  BVHCache *bvh_cache = *bvh_cache_p;
+  for (int index = 0; index < BVHTREE_MAX_ITEM; index++) {
+    BVHCacheItem *item = &bvh_cache->items[index];
+    BVHCacheItem *stash_item = &stash->items[index];
+    if (stash_item->tree == nullptr || item->is_filled || item->is_stale) {
+      continue;
+    }
+    *item = *stash_item;
+    stash_item->tree = nullptr;
+  }
+  bvhcache_free(stash);
+}
+
+/**
+ * Update the bounds of a tree that was built for a mesh with the same number of elements.
+ *
+ * \return False when the tree does not match the mesh.
+ */
+static bool bvhtree_refit_from_mesh(BVHTree *tree,
+                                    const Mesh *mesh,
+                                    const MLoopTri *looptri,
+                                    const BVHCacheType type)
+{
+  using namespace blender;
+  const MVert *vert = mesh->mvert;
+  const int leafs_num = BLI_bvhtree_get_len(tree);
+  switch (type) {
+    case BVHTREE_FROM_VERTS:
+      if (leafs_num != mesh->totvert) {
+        return false;
+      }
+      threading::parallel_for(IndexRange(leafs_num), 4096, [&](IndexRange range) {
+        for (const int i : range) {
+          BLI_bvhtree_update_node(tree, i, vert[i].co, nullptr, 1);
+        }
+      });
+      break;
+    case BVHTREE_FROM_EDGES:
+      if (leafs_num != mesh->totedge) {
+        return false;
+      }
+      threading::parallel_for(IndexRange(leafs_num), 4096, [&](IndexRange range) {
+        for (const int i : range) {
+          float co[2][3];
+          copy_v3_v3(co[0], vert[mesh->medge[i].v1].co);
+          copy_v3_v3(co[1], vert[mesh->medge[i].v2].co);
+          BLI_bvhtree_update_node(tree, i, co[0], nullptr, 2);
+        }
+      });
+      break;
+    case BVHTREE_FROM_LOOPTRI:
+      if (leafs_num != BKE_mesh_runtime_looptri_len(mesh)) {
+        return false;
+      }
+      threading::parallel_for(IndexRange(leafs_num), 4096, [&](IndexRange range) {
+        for (const int i : range) {
+          float co[3][3];
+          copy_v3_v3(co[0], vert[mesh->mloop[looptri[i].tri[0]].v].co);
+          copy_v3_v3(co[1], vert[mesh->mloop[looptri[i].tri[1]].v].co);
+          copy_v3_v3(co[2], vert[mesh->mloop[looptri[i].tri[2]].v].co);
+          BLI_bvhtree_update_node(tree, i, co[0], nullptr, 3);
+        }
+      });
+      break;
+    default:
+      BLI_assert_unreachable();
+      return false;
+  }
+  BLI_bvhtree_update_tree(tree);
+  return true;
+}
+
+/**
+ * Try to make a stale tree usable for the mesh by refitting it. Trees that don't match the mesh
+ * or that became too slow to query are freed, so that a new tree is built instead.
+ *
+ * \return True when the tree is in the cache now.
+ */
+static bool bvhcache_refit_stale(BVHCache **bvh_cache_p,
+                                 const BVHCacheType type,
+                                 const Mesh *mesh,
+                                 ThreadMutex *mesh_eval_mutex,
+                                 BVHTree **r_tree)
+{
+  if (*bvh_cache_p == nullptr || !(*bvh_cache_p)->items[type].is_stale) {
+    return false;
+  }
+  /* Ensure the triangulation before locking, it uses the mutex of the mesh. */
+  const MLoopTri *looptri = (type == BVHTREE_FROM_LOOPTRI) ?
+                                BKE_mesh_runtime_looptri_ensure(mesh) :
+                                nullptr;
+
+  bool lock_started = false;
+  if (bvhcache_find(bvh_cache_p, type, r_tree, &lock_started, mesh_eval_mutex)) {
+    /* Another thread was faster. */
+    return true;
+  }
+  BVHCache *bvh_cache = *bvh_cache_p;
+  BVHCacheItem *item = &bvh_cache->items[type];
+  bool is_refitted = false;
+  if (item->is_stale) {
+    /* Refitting is multi-threaded, see #bvhtree_balance_isolated. */
+    blender::threading::isolate_task([&]() {
+      is_refitted = bvhtree_refit_from_mesh(item->tree, mesh, looptri, type) &&
+                    BLI_bvhtree_get_branch_area_ratio(item->tree) <=
+                        item->build_area_ratio * bvhcache_refit_max_area_ratio_growth;
+    });
+    item->is_stale = false;
+    if (is_refitted) {
+      item->is_filled = true;
+      *r_tree = item->tree;
+    }
+    else {
+      BLI_bvhtree_free(item->tree);
+      item->tree = nullptr;
+    }
+  }
+  bvhcache_unlock(bvh_cache, lock_started);
+  return is_refitted;
+}
+
 /**
  * BVH-tree balancing inside a mutex lock must be run in isolation. Balancing
  * is multithreaded, and we do not want the current thread to start another task
@@ -180,6 +373,31 @@ static void bvhtree_balance(BVHTree *tree, const bool isolate)
   }
 }
 
+/**
+ * Flags passed to #BLI_bvhtree_new_ex for the trees of every cache type. Triangle trees are mostly
+ * used for ray casts (snapping, shrinkwrap projection, the ray-cast node), where a tree built with
+ * the surface area heuristic is noticeably faster for unevenly tessellated meshes.
+ */
+static int bvhtree_build_flag(const BVHCacheType bvh_cache_type)
+{
+  switch (bvh_cache_type) {
+    case BVHTREE_FROM_LOOPTRI:
+    case BVHTREE_FROM_LOOPTRI_NO_HIDDEN:
+    case BVHTREE_FROM_EM_LOOPTRI:
+      return BVH_BUILD_SAH;
+    case BVHTREE_FROM_VERTS:
+    case BVHTREE_FROM_EDGES:
+    case BVHTREE_FROM_FACES:
+    case BVHTREE_FROM_LOOSEVERTS:
+    case BVHTREE_FROM_LOOSEEDGES:
+    case BVHTREE_FROM_EM_VERTS:
+    case BVHTREE_FROM_EM_EDGES:
+    case BVHTREE_MAX_ITEM:
+      break;
+  }
+  return 0;
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -1108,6 +1326,7 @@ BVHTree *bvhtree_from_mesh_faces_ex(BVHTreeFromMesh *data,
 static BVHTree *bvhtree_from_editmesh_looptri_create_tree(float epsilon,
                                                           int tree_type,
                                                           int axis,
+                                                          int build_flag,
                                                           BMEditMesh *em,
                                                           const BLI_bitmap *looptri_mask,
                                                           int looptri_num_active)
@@ -1125,7 +1344,7 @@ static BVHTree *bvhtree_from_editmesh_looptri_create_tree(float epsilon,
 
     /* Create a BVH-tree of the given target */
     // printf("%s: building BVH, total=%d\n", __func__, numFaces);
-    tree = BLI_bvhtree_new(looptri_num_active, epsilon, tree_type, axis);
+    tree = BLI_bvhtree_new_ex(looptri_num_active, epsilon, tree_type, axis, build_flag);
     if (tree) {
       const BMLoop *(*looptris)[3] = (const BMLoop *(*)[3])em->looptris;
 
@@ -1157,6 +1376,7 @@ static BVHTree *bvhtree_from_editmesh_looptri_create_tree(float epsilon,
 static BVHTree *bvhtree_from_mesh_looptri_create_tree(float epsilon,
                                                       int tree_type,
                                                       int axis,
+                                                      int build_flag,
                                                       const MVert *vert,
                                                       const MLoop *mloop,
                                                       const MLoopTri *looptri,
@@ -1176,7 +1396,7 @@ static BVHTree *bvhtree_from_mesh_looptri_create_tree(float epsilon,
   if (looptri_num_active) {
     /* Create a BVH-tree of the given target */
     // printf("%s: building BVH, total=%d\n", __func__, numFaces);
-    tree = BLI_bvhtree_new(looptri_num_active, epsilon, tree_type, axis);
+    tree = BLI_bvhtree_new_ex(looptri_num_active, epsilon, tree_type, axis, build_flag);
     if (tree) {
       if (vert && looptri) {
         for (int i = 0; i < looptri_num; i++) {
@@ -1246,8 +1466,13 @@ BVHTree *bvhtree_from_editmesh_looptri_ex(BVHTreeFromEditMesh *data,
         bvh_cache_p, bvh_cache_type, &tree, &lock_started, mesh_eval_mutex);
     BVHCache *bvh_cache = *bvh_cache_p;
     if (in_cache == false) {
-      tree = bvhtree_from_editmesh_looptri_create_tree(
-          epsilon, tree_type, axis, em, looptri_mask, looptri_num_active);
+      tree = bvhtree_from_editmesh_looptri_create_tree(epsilon,
+                                                       tree_type,
+                                                       axis,
+                                                       bvhtree_build_flag(bvh_cache_type),
+                                                       em,
+                                                       looptri_mask,
+                                                       looptri_num_active);
       bvhtree_balance(tree, true);
 
       /* Save on cache for later use */
@@ -1257,8 +1482,13 @@ BVHTree *bvhtree_from_editmesh_looptri_ex(BVHTreeFromEditMesh *data,
     bvhcache_unlock(bvh_cache, lock_started);
   }
   else {
-    tree = bvhtree_from_editmesh_looptri_create_tree(
-        epsilon, tree_type, axis, em, looptri_mask, looptri_num_active);
+    tree = bvhtree_from_editmesh_looptri_create_tree(epsilon,
+                                                     tree_type,
+                                                     axis,
+                                                     bvhtree_build_flag(bvh_cache_type),
+                                                     em,
+                                                     looptri_mask,
+                                                     looptri_num_active);
     bvhtree_balance(tree, false);
   }
 
@@ -1276,7 +1506,7 @@ BVHTree *bvhtree_from_editmesh_looptri(
     BVHTreeFromEditMesh *data, BMEditMesh *em, float epsilon, int tree_type, int axis)
 {
   return bvhtree_from_editmesh_looptri_ex(
-      data, em, nullptr, -1, epsilon, tree_type, axis, BVHTREE_FROM_VERTS, nullptr, nullptr);
+      data, em, nullptr, -1, epsilon, tree_type, axis, BVHTREE_FROM_EM_LOOPTRI, nullptr, nullptr);
 }
 
 BVHTree *bvhtree_from_mesh_looptri_ex(BVHTreeFromMesh *data,
@@ -1308,6 +1538,7 @@ BVHTree *bvhtree_from_mesh_looptri_ex(BVHTreeFromMesh *data,
     tree = bvhtree_from_mesh_looptri_create_tree(epsilon,
                                                  tree_type,
                                                  axis,
+                                                 bvhtree_build_flag(bvh_cache_type),
                                                  vert,
                                                  mloop,
                                                  looptri,
@@ -1430,7 +1661,10 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
   BVHCache **bvh_cache_p = (BVHCache **)&mesh->runtime.bvh_cache;
   ThreadMutex *mesh_eval_mutex = (ThreadMutex *)mesh->runtime.eval_mutex;
 
-  const bool is_cached = bvhcache_find(bvh_cache_p, bvh_cache_type, &tree, nullptr, nullptr);
+  bool is_cached = bvhcache_find(bvh_cache_p, bvh_cache_type, &tree, nullptr, nullptr);
+  if (!is_cached && bvhcache_type_supports_refit(bvh_cache_type)) {
+    is_cached = bvhcache_refit_stale(bvh_cache_p, bvh_cache_type, mesh, mesh_eval_mutex, &tree);
+  }
 
   if (is_cached && tree == nullptr) {
     memset(data, 0, sizeof(*data));
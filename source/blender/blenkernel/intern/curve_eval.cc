@@ -174,6 +174,135 @@ void CurveEval::mark_cache_invalid()
   }
 }
 
+static void copy_spline_evaluated_lengths(const Spline &spline, MutableSpan<float> dst)
+{
+  /* There is one length less than points for splines that aren't cyclic. */
+  Span<float> lengths = spline.evaluated_lengths();
+  dst.take_front(lengths.size()).copy_from(lengths);
+  dst.drop_front(lengths.size()).fill(lengths.is_empty() ? 0.0f : lengths.last());
+}
+
+/**
+ * Update one array of the flat evaluated data from the splines. Changed splines are copied from
+ * their caches, the data of other splines is kept, or moved when the layout changed.
+ *
+ * \param old_offsets: The layout of \a data, from the last time any field was updated.
+ * \param versions: The #Spline::cache_version of every spline when \a data was last updated,
+ * or empty when it was never updated for the layout of \a old_offsets.
+ */
+template<typename T, typename CopyFn>
+static void update_evaluated_field(Span<SplinePtr> splines,
+                                   Span<uint64_t> new_versions,
+                                   Span<int> old_offsets,
+                                   Span<int> new_offsets,
+                                   Array<uint64_t> &versions,
+                                   Array<T> &data,
+                                   const CopyFn &copy_from_spline)
+{
+  const auto range = [](Span<int> offsets, const int index) {
+    return IndexRange(offsets[index], offsets[index + 1] - offsets[index]);
+  };
+  const bool has_old_data = !versions.is_empty();
+
+  if (has_old_data && old_offsets == new_offsets) {
+    /* The layout is unchanged, so only the changed splines have to be written. */
+    blender::threading::parallel_for(splines.index_range(), 64, [&](IndexRange splines_range) {
+      for (const int i : splines_range) {
+        if (new_versions[i] != versions[i]) {
+          copy_from_spline(*splines[i], data.as_mutable_span().slice(range(new_offsets, i)));
+        }
+      }
+    });
+  }
+  else {
+    /* Splines may have been added, removed or reordered, so find unchanged data by version. */
+    Map<uint64_t, int> old_indices;
+    if (has_old_data) {
+      for (const int i : versions.index_range()) {
+        old_indices.add(versions[i], i);
+      }
+    }
+
+    Array<T> new_data(new_offsets.last());
+    blender::threading::parallel_for(splines.index_range(), 64, [&](IndexRange splines_range) {
+      for (const int i : splines_range) {
+        MutableSpan<T> dst = new_data.as_mutable_span().slice(range(new_offsets, i));
+        const int old_index = old_indices.lookup_default(new_versions[i], -1);
+        if (old_index == -1) {
+          copy_from_spline(*splines[i], dst);
+        }
+        else {
+          dst.copy_from(data.as_span().slice(range(old_offsets, old_index)));
+        }
+      }
+    });
+    data = std::move(new_data);
+  }
+
+  versions = Array<uint64_t>(new_versions);
+}
+
+const CurveEval::EvaluatedData &CurveEval::evaluated_data(const EvaluatedFields fields) const
+{
+  std::lock_guard lock{evaluated_data_mutex_};
+
+  Array<uint64_t> versions(splines_.size());
+  for (const int i : splines_.index_range()) {
+    versions[i] = splines_[i]->cache_version();
+  }
+
+  /* The index of a field in #evaluated_data_versions_ is the index of its bit. */
+  const auto is_requested = [&](const int field_index) {
+    return (fields & EvaluatedFields(1 << field_index)) != EvaluatedFields(0);
+  };
+  bool is_up_to_date = !evaluated_data_.offsets.is_empty();
+  for (const int field_index : IndexRange(4)) {
+    if (is_requested(field_index) &&
+        versions.as_span() != evaluated_data_versions_[field_index].as_span()) {
+      is_up_to_date = false;
+    }
+  }
+  if (is_up_to_date) {
+    return evaluated_data_;
+  }
+
+  Array<int> offsets = this->evaluated_point_offsets();
+  const bool layout_changed = offsets.as_span() != evaluated_data_.offsets.as_span();
+
+  const auto update_field = [&](const int field_index, auto &data, const auto &copy_from_spline) {
+    Array<uint64_t> &field_versions = evaluated_data_versions_[field_index];
+    if (!is_requested(field_index)) {
+      if (layout_changed) {
+        /* Fields that aren't needed now are built again when they are requested. */
+        field_versions = {};
+      }
+      return;
+    }
+    if (layout_changed || versions.as_span() != field_versions.as_span()) {
+      update_evaluated_field(splines_,
+                             versions,
+                             evaluated_data_.offsets,
+                             offsets,
+                             field_versions,
+                             data,
+                             copy_from_spline);
+    }
+  };
+  update_field(0, evaluated_data_.positions, [](const Spline &spline, MutableSpan<float3> dst) {
+    dst.copy_from(spline.evaluated_positions());
+  });
+  update_field(1, evaluated_data_.tangents, [](const Spline &spline, MutableSpan<float3> dst) {
+    dst.copy_from(spline.evaluated_tangents());
+  });
+  update_field(2, evaluated_data_.normals, [](const Spline &spline, MutableSpan<float3> dst) {
+    dst.copy_from(spline.evaluated_normals());
+  });
+  update_field(3, evaluated_data_.lengths, copy_spline_evaluated_lengths);
+
+  evaluated_data_.offsets = std::move(offsets);
+  return evaluated_data_;
+}
+
 static BezierSpline::HandleType handle_type_from_dna_bezt(const eBezTriple_Handle dna_handle_type)
 {
   switch (dna_handle_type) {
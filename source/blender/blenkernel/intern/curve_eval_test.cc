@@ -0,0 +1,195 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "BKE_spline.hh"
+
+namespace blender::bke::tests {
+
+static std::unique_ptr<PolySpline> create_poly_spline(const int size, const float offset)
+{
+  std::unique_ptr<PolySpline> spline = std::make_unique<PolySpline>();
+  spline->resize(size);
+  for (const int i : IndexRange(size)) {
+    spline->positions()[i] = float3(i, offset, i % 2);
+  }
+  spline->radii().fill(1.0f);
+  spline->tilts().fill(0.0f);
+  return spline;
+}
+
+static std::unique_ptr<BezierSpline> create_bezier_spline(const int size, const float offset)
+{
+  std::unique_ptr<BezierSpline> spline = std::make_unique<BezierSpline>();
+  spline->resize(size);
+  spline->set_resolution(6);
+  spline->handle_types_left().fill(BezierSpline::HandleType::Free);
+  spline->handle_types_right().fill(BezierSpline::HandleType::Free);
+  for (const int i : IndexRange(size)) {
+    spline->positions()[i] = float3(i, offset, 0.0f);
+    spline->handle_positions_left(true)[i] = float3(i - 0.3f, offset, 0.5f);
+    spline->handle_positions_right(true)[i] = float3(i + 0.3f, offset, -0.5f);
+  }
+  spline->radii().fill(1.0f);
+  spline->tilts().fill(0.0f);
+  return spline;
+}
+
+static std::unique_ptr<NURBSpline> create_nurbs_spline(const int size, const float offset)
+{
+  std::unique_ptr<NURBSpline> spline = std::make_unique<NURBSpline>();
+  spline->knots_mode = NURBSpline::KnotsMode::EndPoint;
+  spline->resize(size);
+  spline->set_order(4);
+  spline->set_resolution(8);
+  for (const int i : IndexRange(size)) {
+    spline->positions()[i] = float3(i, offset, (i % 3) * 0.5f);
+  }
+  spline->weights().fill(1.0f);
+  spline->weights()[size / 2] = 3.0f;
+  spline->radii().fill(1.0f);
+  spline->tilts().fill(0.0f);
+  return spline;
+}
+
+static CurveEval create_test_curve()
+{
+  CurveEval curve;
+  curve.add_spline(create_poly_spline(5, 0.0f));
+  curve.add_spline(create_bezier_spline(4, 1.0f));
+  curve.add_spline(create_nurbs_spline(7, 2.0f));
+  curve.add_spline(create_poly_spline(3, 3.0f));
+  curve.splines()[3]->set_cyclic(true);
+  curve.attributes.reallocate(curve.splines().size());
+  curve.mark_cache_invalid();
+  return curve;
+}
+
+static void expect_evaluated_data_matches_splines(const CurveEval &curve)
+{
+  const CurveEval::EvaluatedData &data = curve.evaluated_data();
+  Span<SplinePtr> splines = curve.splines();
+  ASSERT_EQ(data.offsets.size(), splines.size() + 1);
+  for (const int i : splines.index_range()) {
+    const Spline &spline = *splines[i];
+    const IndexRange range = data.range(i);
+    ASSERT_EQ(range.size(), spline.evaluated_points_size());
+
+    Span<float3> positions = spline.evaluated_positions();
+    Span<float3> tangents = spline.evaluated_tangents();
+    Span<float3> normals = spline.evaluated_normals();
+    for (const int j : IndexRange(range.size())) {
+      EXPECT_V3_NEAR(data.positions[range[j]], positions[j], 1e-6f);
+      EXPECT_V3_NEAR(data.tangents[range[j]], tangents[j], 1e-6f);
+      EXPECT_V3_NEAR(data.normals[range[j]], normals[j], 1e-6f);
+    }
+    Span<float> lengths = spline.evaluated_lengths();
+    for (const int j : lengths.index_range()) {
+      EXPECT_FLOAT_EQ(data.lengths[range[j]], lengths[j]);
+    }
+  }
+}
+
+TEST(curve_eval, EvaluatedDataMatchesSplines)
+{
+  CurveEval curve = create_test_curve();
+  expect_evaluated_data_matches_splines(curve);
+}
+
+TEST(curve_eval, EvaluatedDataUpdatesChangedSplines)
+{
+  CurveEval curve = create_test_curve();
+  expect_evaluated_data_matches_splines(curve);
+
+  /* Change the positions of a single spline, which keeps the layout the same. */
+  curve.splines()[1]->translate(float3(0.0f, 0.0f, 2.0f));
+  expect_evaluated_data_matches_splines(curve);
+
+  /* Change the number of evaluated points of a spline. */
+  static_cast<BezierSpline &>(*curve.splines()[1]).set_resolution(3);
+  expect_evaluated_data_matches_splines(curve);
+
+  /* Remove a spline, which moves the data of the following splines. */
+  Vector<int64_t> indices = {1};
+  curve.remove_splines(indices.as_span());
+  expect_evaluated_data_matches_splines(curve);
+
+  /* Add a spline at the end. */
+  curve.add_spline(create_nurbs_spline(5, 4.0f));
+  expect_evaluated_data_matches_splines(curve);
+}
+
+TEST(curve_eval, EvaluatedDataFields)
+{
+  CurveEval curve = create_test_curve();
+  const CurveEval::EvaluatedData &data = curve.evaluated_data(
+      CurveEval::EvaluatedFields::Positions);
+  EXPECT_EQ(data.positions.size(), data.offsets.last());
+  EXPECT_TRUE(data.tangents.is_empty());
+  EXPECT_TRUE(data.normals.is_empty());
+  EXPECT_TRUE(data.lengths.is_empty());
+
+  /* Change the layout while only positions are evaluated, the other fields are built later. */
+  static_cast<BezierSpline &>(*curve.splines()[1]).set_resolution(3);
+  const CurveEval::EvaluatedData &positions_data = curve.evaluated_data(
+      CurveEval::EvaluatedFields::Positions);
+  for (const int i : curve.splines().index_range()) {
+    EXPECT_EQ(positions_data.positions.as_span().slice(positions_data.range(i)),
+              curve.splines()[i]->evaluated_positions());
+  }
+  expect_evaluated_data_matches_splines(curve);
+
+  /* Fields that weren't requested are updated when they are requested again. */
+  curve.splines()[2]->translate(float3(0.0f, 0.0f, 2.0f));
+  curve.evaluated_data(CurveEval::EvaluatedFields::Positions);
+  expect_evaluated_data_matches_splines(curve);
+}
+
+TEST(curve_eval, EvaluatedDataCopy)
+{
+  const CurveEval curve = create_test_curve();
+  const CurveEval::EvaluatedData &data = curve.evaluated_data();
+
+  CurveEval copy(curve);
+  for (const int i : curve.splines().index_range()) {
+    EXPECT_EQ(copy.splines()[i]->cache_version(), curve.splines()[i]->cache_version());
+  }
+  const CurveEval::EvaluatedData &copy_data = copy.evaluated_data();
+  EXPECT_EQ(copy_data.positions.as_span(), data.positions.as_span());
+
+  copy.splines()[0]->translate(float3(1.0f, 0.0f, 0.0f));
+  EXPECT_NE(copy.splines()[0]->cache_version(), curve.splines()[0]->cache_version());
+  expect_evaluated_data_matches_splines(copy);
+}
+
+TEST(curve_eval, NURBSEndPointInterpolation)
+{
+  std::unique_ptr<NURBSpline> spline = create_nurbs_spline(9, 0.0f);
+  Span<float3> positions = spline->evaluated_positions();
+  EXPECT_V3_NEAR(positions.first(), spline->positions().first(), 1e-5f);
+  EXPECT_V3_NEAR(positions.last(), spline->positions().last(), 1e-5f);
+
+  /* A weight of one everywhere gives a partition of unity, so a constant is preserved. */
+  spline->weights().fill(1.0f);
+  spline->mark_cache_invalid();
+  const Spline &const_spline = *spline;
+  VArray<float> radii = const_spline.interpolate_to_evaluated(const_spline.radii());
+  for (const int i : IndexRange(radii.size())) {
+    EXPECT_NEAR(radii[i], 1.0f, 1e-5f);
+  }
+}
+
+}  // namespace blender::bke::tests
@@ -47,15 +47,21 @@ struct ResultInfo {
   int spline_edge_len;
   int profile_vert_len;
   int profile_edge_len;
+  /** Slices of the flat evaluated data from #CurveEval::evaluated_data. */
+  Span<float3> spline_positions;
+  Span<float3> spline_tangents;
+  Span<float3> spline_normals;
+  Span<float3> profile_positions;
 };
 
-static void vert_extrude_to_mesh_data(const Spline &spline,
+static void vert_extrude_to_mesh_data(const ResultInfo &info,
                                       const float3 profile_vert,
                                       MutableSpan<MVert> r_verts,
-                                      MutableSpan<MEdge> r_edges,
-                                      const int vert_offset,
-                                      const int edge_offset)
+                                      MutableSpan<MEdge> r_edges)
 {
+  const Spline &spline = info.spline;
+  const int vert_offset = info.vert_offset;
+  const int edge_offset = info.edge_offset;
   const int eval_size = spline.evaluated_points_size();
   for (const int i : IndexRange(eval_size - 1)) {
     MEdge &edge = r_edges[edge_offset + i];
@@ -71,9 +77,9 @@ static void vert_extrude_to_mesh_data(const Spline &spline,
     edge.flag = ME_LOOSEEDGE;
   }
 
-  Span<float3> positions = spline.evaluated_positions();
-  Span<float3> tangents = spline.evaluated_tangents();
-  Span<float3> normals = spline.evaluated_normals();
+  Span<float3> positions = info.spline_positions;
+  Span<float3> tangents = info.spline_tangents;
+  Span<float3> normals = info.spline_normals;
   VArray<float> radii = spline.interpolate_to_evaluated(spline.radii());
   for (const int i : IndexRange(eval_size)) {
     float4x4 point_matrix = float4x4::from_normalized_axis_data(
@@ -102,12 +108,7 @@ static void spline_extrude_to_mesh_data(const ResultInfo &info,
   const Spline &spline = info.spline;
   const Spline &profile = info.profile;
   if (info.profile_vert_len == 1) {
-    vert_extrude_to_mesh_data(spline,
-                              profile.evaluated_positions()[0],
-                              r_verts,
-                              r_edges,
-                              info.vert_offset,
-                              info.edge_offset);
+    vert_extrude_to_mesh_data(info, info.profile_positions[0], r_verts, r_edges);
     return;
   }
 
@@ -220,10 +221,10 @@ static void spline_extrude_to_mesh_data(const ResultInfo &info,
   }
 
   /* Calculate the positions of each profile ring profile along the spline. */
-  Span<float3> positions = spline.evaluated_positions();
-  Span<float3> tangents = spline.evaluated_tangents();
-  Span<float3> normals = spline.evaluated_normals();
-  Span<float3> profile_positions = profile.evaluated_positions();
+  Span<float3> positions = info.spline_positions;
+  Span<float3> tangents = info.spline_tangents;
+  Span<float3> normals = info.spline_normals;
+  Span<float3> profile_positions = info.profile_positions;
 
   VArray<float> radii = spline.interpolate_to_evaluated(spline.radii());
   for (const int i_ring : IndexRange(info.spline_vert_len)) {
@@ -712,6 +713,13 @@ Mesh *curve_to_mesh_sweep(const CurveEval &curve, const CurveEval &profile, cons
   mesh_component.replace(mesh, GeometryOwnershipType::Editable);
   ResultAttributes attributes = create_result_attributes(curve, profile, mesh_component);
 
+  /* Evaluate all splines up front, in parallel, instead of lazily from each combination. */
+  const CurveEval::EvaluatedData &curve_data = curve.evaluated_data(
+      CurveEval::EvaluatedFields::Positions | CurveEval::EvaluatedFields::Tangents |
+      CurveEval::EvaluatedFields::Normals);
+  const CurveEval::EvaluatedData &profile_data = profile.evaluated_data(
+      CurveEval::EvaluatedFields::Positions);
+
   threading::parallel_for(curves.index_range(), 128, [&](IndexRange curves_range) {
     for (const int i_spline : curves_range) {
       const Spline &spline = *curves[i_spline];
@@ -734,6 +742,10 @@ Mesh *curve_to_mesh_sweep(const CurveEval &curve, const CurveEval &profile, cons
               spline.evaluated_edges_size(),
               profile.evaluated_points_size(),
               profile.evaluated_edges_size(),
+              curve_data.positions.as_span().slice(curve_data.range(i_spline)),
+              curve_data.tangents.as_span().slice(curve_data.range(i_spline)),
+              curve_data.normals.as_span().slice(curve_data.range(i_spline)),
+              profile_data.positions.as_span().slice(profile_data.range(i_profile)),
           };
 
           spline_extrude_to_mesh_data(info,
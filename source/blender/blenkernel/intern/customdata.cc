@@ -36,6 +36,7 @@
 
 #include "BLI_bitmap.h"
 #include "BLI_endian_switch.h"
+#include "BLI_implicit_sharing.hh"
 #include "BLI_math.h"
 #include "BLI_math_color_blend.h"
 #include "BLI_mempool.h"
@@ -66,6 +67,8 @@
 
 #include "CLG_log.h"
 
+#include "atomic_ops.h"
+
 /* only for customdata_data_transfer_interp_normal_normals */
 #include "data_transfer_intern.h"
 
@@ -2114,6 +2117,98 @@ static bool customdata_typemap_is_valid(const CustomData *data)
 }
 #endif
 
+static void customData_free_layer_data(const int type, const void *data, const int totelem)
+{
+  const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+  if (typeInfo->free) {
+    typeInfo->free(const_cast<void *>(data), totelem, typeInfo->size);
+  }
+  MEM_freeN(const_cast<void *>(data));
+}
+
+namespace {
+
+/** Owns the data of layers which share it, see #CustomDataLayer.sharing_info. */
+class CustomDataLayerImplicitSharing : public blender::ImplicitSharingInfo {
+ private:
+  const void *data_;
+  int totelem_;
+  int type_;
+
+ public:
+  CustomDataLayerImplicitSharing(const void *data, const int totelem, const int type)
+      : ImplicitSharingInfo(1), data_(data), totelem_(totelem), type_(type)
+  {
+  }
+
+ private:
+  void delete_self_with_data() override
+  {
+    customData_free_layer_data(type_, data_, totelem_);
+    MEM_delete(this);
+  }
+};
+
+}  // namespace
+
+static const blender::ImplicitSharingInfo *layer_sharing_info(const CustomDataLayer *layer)
+{
+  return reinterpret_cast<const blender::ImplicitSharingInfo *>(layer->sharing_info);
+}
+
+/**
+ * Get the sharing info of a layer whose data is to be shared with another layer, creating it
+ * when the data was not shared before. The new layer has to add its user afterwards.
+ */
+static const blender::ImplicitSharingInfo *customData_layer_ensure_sharing_info(
+    const CustomDataLayer *layer, const int totelem)
+{
+  if (layer->sharing_info != nullptr) {
+    return layer_sharing_info(layer);
+  }
+  blender::ImplicitSharingInfo *sharing_info = MEM_new<CustomDataLayerImplicitSharing>(
+      __func__, layer->data, totelem, layer->type);
+  /* The source is not modified otherwise, so it may be shared from multiple threads at the same
+   * time, e.g. when multiple dependency graphs copy the same original data. */
+  void *existing = atomic_cas_ptr((void **)&const_cast<CustomDataLayer *>(layer)->sharing_info,
+                                  nullptr,
+                                  static_cast<void *>(sharing_info));
+  if (existing != nullptr) {
+    MEM_delete(sharing_info);
+    return reinterpret_cast<const blender::ImplicitSharingInfo *>(existing);
+  }
+  return sharing_info;
+}
+
+/**
+ * Remove the sharing info from a layer which is the only user of its data, so that the layer
+ * owns the data directly. Data which is still shared is copied first.
+ */
+static void customData_layer_unshare(CustomDataLayer *layer, const int totelem)
+{
+  const blender::ImplicitSharingInfo *sharing_info = layer_sharing_info(layer);
+  if (sharing_info == nullptr) {
+    return;
+  }
+  if (sharing_info->is_shared()) {
+    const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
+    void *dst_data = MEM_malloc_arrayN((size_t)totelem, typeInfo->size, "CD unshare layer");
+    if (typeInfo->copy) {
+      typeInfo->copy(layer->data, dst_data, totelem);
+    }
+    else {
+      memcpy(dst_data, layer->data, (size_t)totelem * typeInfo->size);
+    }
+    layer->data = dst_data;
+    sharing_info->remove_user_and_delete_if_last();
+  }
+  else {
+    /* Only free the sharing info, the data is owned by the layer now. */
+    MEM_delete(sharing_info);
+  }
+  layer->sharing_info = nullptr;
+}
+
 bool CustomData_merge(const struct CustomData *source,
                       struct CustomData *dest,
                       CustomDataMask mask,
@@ -2164,6 +2259,7 @@ bool CustomData_merge(const struct CustomData *source,
       case CD_ASSIGN:
       case CD_REFERENCE:
       case CD_DUPLICATE:
+      case CD_SHARE:
         data = layer->data;
         break;
       default:
@@ -2171,14 +2267,40 @@ bool CustomData_merge(const struct CustomData *source,
         break;
     }
 
+    const blender::ImplicitSharingInfo *sharing_info = nullptr;
     if ((alloctype == CD_ASSIGN) && (flag & CD_FLAG_NOFREE)) {
       newlayer = customData_add_layer__internal(
           dest, type, CD_REFERENCE, data, totelem, layer->name);
     }
+    else if (alloctype == CD_SHARE) {
+      if (flag & CD_FLAG_NOFREE) {
+        /* The lifetime of referenced data is managed elsewhere, so it can't be shared. */
+        newlayer = customData_add_layer__internal(
+            dest, type, CD_REFERENCE, data, totelem, layer->name);
+      }
+      else if (data == nullptr) {
+        newlayer = customData_add_layer__internal(
+            dest, type, CD_CALLOC, nullptr, totelem, layer->name);
+      }
+      else {
+        sharing_info = customData_layer_ensure_sharing_info(layer, totelem);
+        newlayer = customData_add_layer__internal(
+            dest, type, CD_ASSIGN, data, totelem, layer->name);
+      }
+    }
     else {
       newlayer = customData_add_layer__internal(dest, type, alloctype, data, totelem, layer->name);
     }
 
+    if (newlayer && sharing_info != nullptr && newlayer->data == data) {
+      sharing_info->add_user();
+      newlayer->sharing_info = reinterpret_cast<const ImplicitSharingInfoHandle *>(sharing_info);
+    }
+    else if (newlayer && alloctype == CD_ASSIGN && newlayer->data == data) {
+      /* The new layer takes over the source layer's user of the shared data. */
+      newlayer->sharing_info = layer->sharing_info;
+    }
+
     if (newlayer) {
       newlayer->uid = layer->uid;
 
@@ -2209,6 +2331,10 @@ void CustomData_realloc(CustomData *data, int totelem)
       continue;
     }
     typeInfo = layerType_getInfo(layer->type);
+    if (layer->sharing_info != nullptr) {
+      /* Shared data can't be reallocated in place. */
+      customData_layer_unshare(layer, int(MEM_allocN_len(layer->data) / typeInfo->size));
+    }
     /* Use calloc to avoid the need to manually initialize new data in layers.
      * Useful for types like #MDeformVert which contain a pointer. */
     layer->data = MEM_recallocN(layer->data, (size_t)totelem * typeInfo->size);
@@ -2232,22 +2358,16 @@ void CustomData_copy(const struct CustomData *source,
 
 static void customData_free_layer__internal(CustomDataLayer *layer, int totelem)
 {
-  const LayerTypeInfo *typeInfo;
-
   if (layer->anonymous_id != nullptr) {
     BKE_anonymous_attribute_id_decrement_weak(layer->anonymous_id);
     layer->anonymous_id = nullptr;
   }
-  if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
-    typeInfo = layerType_getInfo(layer->type);
-
-    if (typeInfo->free) {
-      typeInfo->free(layer->data, totelem, typeInfo->size);
-    }
-
-    if (layer->data) {
-      MEM_freeN(layer->data);
-    }
+  if (layer->sharing_info != nullptr) {
+    layer_sharing_info(layer)->remove_user_and_delete_if_last();
+    layer->sharing_info = nullptr;
+  }
+  else if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
+    customData_free_layer_data(layer->type, layer->data, totelem);
   }
 }
 
@@ -2840,6 +2960,9 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
 
     layer->flag &= ~CD_FLAG_NOFREE;
   }
+  else if (layer->sharing_info != nullptr && layer_sharing_info(layer)->is_shared()) {
+    customData_layer_unshare(layer, totelem);
+  }
 
   return layer->data;
 }
@@ -2906,7 +3029,25 @@ bool CustomData_is_referenced_layer(struct CustomData *data, int type)
 
   CustomDataLayer *layer = &data->layers[layer_index];
 
-  return (layer->flag & CD_FLAG_NOFREE) != 0;
+  return (layer->flag & CD_FLAG_NOFREE) != 0 ||
+         (layer->sharing_info != nullptr && layer_sharing_info(layer)->is_shared());
+}
+
+bool CustomData_layers_share_data(const CustomData *data,
+                                  const CustomData *source,
+                                  const CustomDataMask mask_ignore)
+{
+  for (int i = 0; i < data->totlayer; i++) {
+    const CustomDataLayer *layer = &data->layers[i];
+    if (CD_TYPE_AS_MASK(layer->type) & mask_ignore) {
+      continue;
+    }
+    const int source_index = CustomData_get_named_layer_index(source, layer->type, layer->name);
+    if (source_index == -1 || source->layers[source_index].data != layer->data) {
+      return false;
+    }
+  }
+  return true;
 }
 
 void CustomData_free_temporary(CustomData *data, int totelem)
@@ -3174,6 +3315,191 @@ void CustomData_interp(const CustomData *source,
   }
 }
 
+/**
+ * Interpolate float vector layers for many destination items at once. Matches the result of the
+ * corresponding #LayerTypeInfo.interp callbacks, but without the per-item indirection, so that
+ * the compiler can vectorize the inner loops.
+ */
+template<int N, typename SourceFn, typename DestFn>
+static void layer_interp_float_batch(const SourceFn &get_source,
+                                     const DestFn &get_dest,
+                                     const float *weights,
+                                     const int weights_stride,
+                                     const int count,
+                                     const int dest_num)
+{
+  for (int i = 0; i < dest_num; i++) {
+    const float *item_weights = &weights[(size_t)i * weights_stride];
+    float result[N] = {0.0f};
+    for (int j = 0; j < count; j++) {
+      const float *src = static_cast<const float *>(get_source(i, j));
+      for (int c = 0; c < N; c++) {
+        result[c] += src[c] * item_weights[j];
+      }
+    }
+    /* Delay writing to the destination in case dest is in sources. */
+    float *dst = static_cast<float *>(get_dest(i));
+    for (int c = 0; c < N; c++) {
+      dst[c] = result[c];
+    }
+  }
+}
+
+template<typename SourceFn, typename DestFn>
+static void layer_interp_mloopuv_batch(const SourceFn &get_source,
+                                       const DestFn &get_dest,
+                                       const float *weights,
+                                       const int weights_stride,
+                                       const int count,
+                                       const int dest_num)
+{
+  for (int i = 0; i < dest_num; i++) {
+    const float *item_weights = &weights[(size_t)i * weights_stride];
+    float uv[2] = {0.0f, 0.0f};
+    int flag = 0;
+    for (int j = 0; j < count; j++) {
+      const MLoopUV *src = static_cast<const MLoopUV *>(get_source(i, j));
+      madd_v2_v2fl(uv, src->uv, item_weights[j]);
+      if (item_weights[j] > 0.0f) {
+        flag |= src->flag;
+      }
+    }
+    MLoopUV *dst = static_cast<MLoopUV *>(get_dest(i));
+    copy_v2_v2(dst->uv, uv);
+    dst->flag = flag;
+  }
+}
+
+/**
+ * Interpolate a single layer for many destination items, using specialized loops for common
+ * types and the layer type's interpolation callback otherwise.
+ */
+template<typename SourceFn, typename DestFn>
+static void layer_interp_batch(const int type,
+                               const SourceFn &get_source,
+                               const DestFn &get_dest,
+                               const float *weights,
+                               const int weights_stride,
+                               const int count,
+                               const int dest_num)
+{
+  switch (type) {
+    case CD_PROP_FLOAT:
+      layer_interp_float_batch<1>(get_source, get_dest, weights, weights_stride, count, dest_num);
+      return;
+    case CD_PROP_FLOAT2:
+      layer_interp_float_batch<2>(get_source, get_dest, weights, weights_stride, count, dest_num);
+      return;
+    case CD_PROP_FLOAT3:
+      layer_interp_float_batch<3>(get_source, get_dest, weights, weights_stride, count, dest_num);
+      return;
+    case CD_PROP_COLOR:
+      layer_interp_float_batch<4>(get_source, get_dest, weights, weights_stride, count, dest_num);
+      return;
+    case CD_MLOOPUV:
+      layer_interp_mloopuv_batch(get_source, get_dest, weights, weights_stride, count, dest_num);
+      return;
+  }
+
+  const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+  const void *source_buf[SOURCE_BUF_SIZE];
+  const void **sources = source_buf;
+  if (count > SOURCE_BUF_SIZE) {
+    sources = static_cast<const void **>(MEM_malloc_arrayN(count, sizeof(*sources), __func__));
+  }
+  for (int i = 0; i < dest_num; i++) {
+    for (int j = 0; j < count; j++) {
+      sources[j] = get_source(i, j);
+    }
+    typeInfo->interp(sources, &weights[(size_t)i * weights_stride], nullptr, count, get_dest(i));
+  }
+  if (count > SOURCE_BUF_SIZE) {
+    MEM_freeN((void *)sources);
+  }
+}
+
+/**
+ * Weights to use when the caller doesn't pass any: the same average for every item,
+ * so the stride is zero.
+ */
+static const float *interp_batch_weights_ensure(const float *weights,
+                                                const int count,
+                                                float default_weights_buf[SOURCE_BUF_SIZE],
+                                                float **r_default_weights,
+                                                int *r_weights_stride)
+{
+  *r_default_weights = nullptr;
+  if (weights != nullptr) {
+    *r_weights_stride = count;
+    return weights;
+  }
+  float *default_weights = (count > SOURCE_BUF_SIZE) ?
+                               static_cast<float *>(
+                                   MEM_mallocN(sizeof(*weights) * (size_t)count, __func__)) :
+                               default_weights_buf;
+  copy_vn_fl(default_weights, count, 1.0f / count);
+  if (default_weights != default_weights_buf) {
+    *r_default_weights = default_weights;
+  }
+  *r_weights_stride = 0;
+  return default_weights;
+}
+
+void CustomData_interp_batch(const CustomData *source,
+                             CustomData *dest,
+                             const int *src_indices,
+                             const float *weights,
+                             const int count,
+                             const int *dest_indices,
+                             const int dest_num)
+{
+  if (count <= 0 || dest_num <= 0) {
+    return;
+  }
+
+  float default_weights_buf[SOURCE_BUF_SIZE];
+  float *default_weights;
+  int weights_stride;
+  weights = interp_batch_weights_ensure(
+      weights, count, default_weights_buf, &default_weights, &weights_stride);
+
+  /* Interpolates a layer at a time, matching layers the same way as #CustomData_interp. */
+  int dest_i = 0;
+  for (int src_i = 0; src_i < source->totlayer; src_i++) {
+    const int type = source->layers[src_i].type;
+    const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+    if (!typeInfo->interp) {
+      continue;
+    }
+    while (dest_i < dest->totlayer && dest->layers[dest_i].type < type) {
+      dest_i++;
+    }
+    if (dest_i >= dest->totlayer) {
+      break;
+    }
+    if (dest->layers[dest_i].type == type) {
+      const void *src_data = source->layers[src_i].data;
+      void *dst_data = dest->layers[dest_i].data;
+      const size_t size = (size_t)typeInfo->size;
+      layer_interp_batch(
+          type,
+          [&](const int i, const int j) {
+            return POINTER_OFFSET(src_data, (size_t)src_indices[(size_t)i * count + j] * size);
+          },
+          [&](const int i) { return POINTER_OFFSET(dst_data, (size_t)dest_indices[i] * size); },
+          weights,
+          weights_stride,
+          count,
+          dest_num);
+      dest_i++;
+    }
+  }
+
+  if (default_weights != nullptr) {
+    MEM_freeN(default_weights);
+  }
+}
+
 void CustomData_swap_corners(struct CustomData *data, int index, const int *corner_indices)
 {
   for (int i = 0; i < data->totlayer; i++) {
@@ -3319,6 +3645,25 @@ const char *CustomData_get_layer_name(const CustomData *data, int type, int n)
   return (layer_index == -1) ? nullptr : data->layers[layer_index].name;
 }
 
+/**
+ * The data of the layer is about to be replaced. When it is shared, only the layer's user is
+ * removed, otherwise the caller becomes responsible for the old data, like for other layers.
+ */
+static void customData_layer_release_sharing(CustomDataLayer *layer)
+{
+  const blender::ImplicitSharingInfo *sharing_info = layer_sharing_info(layer);
+  if (sharing_info == nullptr) {
+    return;
+  }
+  if (sharing_info->is_shared()) {
+    sharing_info->remove_user_and_delete_if_last();
+  }
+  else {
+    MEM_delete(sharing_info);
+  }
+  layer->sharing_info = nullptr;
+}
+
 void *CustomData_set_layer(const CustomData *data, int type, void *ptr)
 {
   /* get the layer index of the first layer of type */
@@ -3328,6 +3673,7 @@ void *CustomData_set_layer(const CustomData *data, int type, void *ptr)
     return nullptr;
   }
 
+  customData_layer_release_sharing(&data->layers[layer_index]);
   data->layers[layer_index].data = ptr;
 
   return ptr;
@@ -3341,6 +3687,7 @@ void *CustomData_set_layer_n(const struct CustomData *data, int type, int n, voi
     return nullptr;
   }
 
+  customData_layer_release_sharing(&data->layers[layer_index]);
   data->layers[layer_index].data = ptr;
 
   return ptr;
@@ -3913,7 +4260,12 @@ bool CustomData_has_interp(const struct CustomData *data)
 bool CustomData_has_referenced(const struct CustomData *data)
 {
   for (int i = 0; i < data->totlayer; i++) {
-    if (data->layers[i].flag & CD_FLAG_NOFREE) {
+    const CustomDataLayer *layer = &data->layers[i];
+    if (layer->flag & CD_FLAG_NOFREE) {
+      return true;
+    }
+    /* Data that is shared with other owners can't be handed to a new owner either. */
+    if (layer->sharing_info != nullptr && layer_sharing_info(layer)->is_shared()) {
       return true;
     }
   }
@@ -4120,6 +4472,47 @@ void CustomData_bmesh_interp(CustomData *data,
   }
 }
 
+void CustomData_bmesh_interp_batch(CustomData *data,
+                                   const void **src_blocks,
+                                   const float *weights,
+                                   const int count,
+                                   void **dst_blocks,
+                                   const int dst_num)
+{
+  if (count <= 0 || dst_num <= 0) {
+    return;
+  }
+
+  float default_weights_buf[SOURCE_BUF_SIZE];
+  float *default_weights;
+  int weights_stride;
+  weights = interp_batch_weights_ensure(
+      weights, count, default_weights_buf, &default_weights, &weights_stride);
+
+  for (int i = 0; i < data->totlayer; i++) {
+    const CustomDataLayer *layer = &data->layers[i];
+    const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
+    if (!typeInfo->interp) {
+      continue;
+    }
+    const int offset = layer->offset;
+    layer_interp_batch(
+        layer->type,
+        [&](const int UNUSED(dst_index), const int j) {
+          return POINTER_OFFSET(src_blocks[j], offset);
+        },
+        [&](const int dst_index) { return POINTER_OFFSET(dst_blocks[dst_index], offset); },
+        weights,
+        weights_stride,
+        count,
+        dst_num);
+  }
+
+  if (default_weights != nullptr) {
+    MEM_freeN(default_weights);
+  }
+}
+
 void CustomData_to_bmesh_block(const CustomData *source,
                                CustomData *dest,
                                int src_index,
@@ -5186,6 +5579,7 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, int count)
     }
 
     layer->flag &= ~CD_FLAG_NOFREE;
+    layer->sharing_info = nullptr;
 
     if (CustomData_verify_versions(data, i)) {
       BLO_read_data_address(reader, &layer->data);
@@ -0,0 +1,238 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array.hh"
+#include "BLI_rand.hh"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+namespace blender::bke::tests {
+
+static const int interp_test_types[] = {
+    CD_MLOOPUV, CD_PROP_FLOAT, CD_PROP_INT32, CD_PROP_COLOR, CD_PROP_FLOAT3, CD_PROP_FLOAT2};
+
+static void fill_random_layers(CustomData *data, const int totelem, RandomNumberGenerator &rng)
+{
+  for (const int type : interp_test_types) {
+    CustomData_add_layer(data, type, CD_CALLOC, nullptr, totelem);
+  }
+  for (int i = 0; i < data->totlayer; i++) {
+    CustomDataLayer &layer = data->layers[i];
+    const int size = CustomData_sizeof(layer.type);
+    if (layer.type == CD_MLOOPUV) {
+      MLoopUV *uvs = static_cast<MLoopUV *>(layer.data);
+      for (const int j : IndexRange(totelem)) {
+        uvs[j].uv[0] = rng.get_float();
+        uvs[j].uv[1] = rng.get_float();
+        uvs[j].flag = 1 << (j % 4);
+      }
+    }
+    else if (layer.type == CD_PROP_INT32) {
+      int *values = static_cast<int *>(layer.data);
+      for (const int j : IndexRange(totelem)) {
+        values[j] = rng.get_int32(1000);
+      }
+    }
+    else {
+      float *values = static_cast<float *>(layer.data);
+      for (const int j : IndexRange(totelem * size / int(sizeof(float)))) {
+        values[j] = rng.get_float();
+      }
+    }
+  }
+}
+
+static void expect_layers_equal(const CustomData *a, const CustomData *b, const int totelem)
+{
+  ASSERT_EQ(a->totlayer, b->totlayer);
+  for (int i = 0; i < a->totlayer; i++) {
+    ASSERT_EQ(a->layers[i].type, b->layers[i].type);
+    const size_t size = size_t(CustomData_sizeof(a->layers[i].type)) * size_t(totelem);
+    EXPECT_EQ(memcmp(a->layers[i].data, b->layers[i].data, size), 0)
+        << "Layer type " << a->layers[i].type;
+  }
+}
+
+TEST(customdata, InterpBatchMatchesInterp)
+{
+  const int src_num = 50;
+  const int dst_num = 300;
+  const int count = 4;
+  RandomNumberGenerator rng(0);
+
+  CustomData src;
+  CustomData dst_single;
+  CustomData dst_batch;
+  CustomData_reset(&src);
+  CustomData_reset(&dst_single);
+  fill_random_layers(&src, src_num, rng);
+  fill_random_layers(&dst_single, dst_num, rng);
+  /* Layers without interpolation are not changed, so both destinations start out the same. */
+  CustomData_copy(&dst_single, &dst_batch, CD_MASK_ALL, CD_DUPLICATE, dst_num);
+
+  Array<int> src_indices(dst_num * count);
+  Array<float> weights(dst_num * count);
+  Array<int> dst_indices(dst_num);
+  for (const int i : IndexRange(dst_num)) {
+    float total = 0.0f;
+    for (const int j : IndexRange(count)) {
+      src_indices[i * count + j] = rng.get_int32(src_num);
+      /* Include zero weights, which affect the #MLoopUV flags. */
+      weights[i * count + j] = (j == 1) ? 0.0f : rng.get_float();
+      total += weights[i * count + j];
+    }
+    for (const int j : IndexRange(count)) {
+      weights[i * count + j] /= total;
+    }
+    /* Write the destination items in a different order than they are stored. */
+    dst_indices[i] = (i * 7) % dst_num;
+  }
+
+  for (const int i : IndexRange(dst_num)) {
+    CustomData_interp(&src,
+                      &dst_single,
+                      &src_indices[i * count],
+                      &weights[i * count],
+                      nullptr,
+                      count,
+                      dst_indices[i]);
+  }
+  CustomData_interp_batch(&src,
+                          &dst_batch,
+                          src_indices.data(),
+                          weights.data(),
+                          count,
+                          dst_indices.data(),
+                          dst_num);
+  expect_layers_equal(&dst_single, &dst_batch, dst_num);
+
+  /* Without weights, the source items are averaged. */
+  for (const int i : IndexRange(dst_num)) {
+    CustomData_interp(
+        &src, &dst_single, &src_indices[i * count], nullptr, nullptr, count, dst_indices[i]);
+  }
+  CustomData_interp_batch(
+      &src, &dst_batch, src_indices.data(), nullptr, count, dst_indices.data(), dst_num);
+  expect_layers_equal(&dst_single, &dst_batch, dst_num);
+
+  CustomData_free(&src, src_num);
+  CustomData_free(&dst_single, dst_num);
+  CustomData_free(&dst_batch, dst_num);
+}
+
+TEST(customdata, ShareLayers)
+{
+  const int totelem = 20;
+  RandomNumberGenerator rng(1);
+  CustomData src;
+  CustomData_reset(&src);
+  fill_random_layers(&src, totelem, rng);
+
+  CustomData copy_a;
+  CustomData copy_b;
+  CustomData_copy(&src, &copy_a, CD_MASK_ALL, CD_SHARE, totelem);
+  CustomData_copy(&copy_a, &copy_b, CD_MASK_ALL, CD_SHARE, totelem);
+  expect_layers_equal(&src, &copy_b, totelem);
+  for (int i = 0; i < src.totlayer; i++) {
+    EXPECT_EQ(copy_a.layers[i].data, src.layers[i].data);
+    EXPECT_EQ(copy_b.layers[i].data, src.layers[i].data);
+    EXPECT_TRUE(CustomData_is_referenced_layer(&copy_b, copy_b.layers[i].type));
+  }
+
+  /* Shared data is copied when it is about to be modified. */
+  const void *shared_data = src.layers[0].data;
+  float *values = static_cast<float *>(
+      CustomData_duplicate_referenced_layer(&copy_b, src.layers[0].type, totelem));
+  EXPECT_NE(values, shared_data);
+  const size_t size = size_t(CustomData_sizeof(src.layers[0].type)) * size_t(totelem);
+  EXPECT_EQ(memcmp(values, shared_data, size), 0);
+  values[0] += 1.0f;
+  EXPECT_EQ(copy_a.layers[0].data, shared_data);
+
+  /* The data stays alive when the source is freed. */
+  CustomData_free(&src, totelem);
+  CustomData_free(&copy_b, totelem);
+  EXPECT_EQ(copy_a.layers[0].data, shared_data);
+
+  /* The last user can modify the data without copying it. */
+  EXPECT_FALSE(CustomData_is_referenced_layer(&copy_a, copy_a.layers[0].type));
+  EXPECT_EQ(CustomData_duplicate_referenced_layer(&copy_a, copy_a.layers[0].type, totelem),
+            shared_data);
+  CustomData_free(&copy_a, totelem);
+}
+
+TEST(customdata, ShareLayersWithFreeCallback)
+{
+  const int totelem = 4;
+  CustomData src;
+  CustomData_reset(&src);
+  MDeformVert *dverts = static_cast<MDeformVert *>(
+      CustomData_add_layer(&src, CD_MDEFORMVERT, CD_CALLOC, nullptr, totelem));
+  for (const int i : IndexRange(totelem)) {
+    dverts[i].dw = static_cast<MDeformWeight *>(MEM_callocN(sizeof(MDeformWeight), __func__));
+    dverts[i].dw->def_nr = i;
+    dverts[i].totweight = 1;
+  }
+
+  CustomData copy;
+  CustomData_copy(&src, &copy, CD_MASK_ALL, CD_SHARE, totelem);
+  MDeformVert *copied_dverts = static_cast<MDeformVert *>(
+      CustomData_duplicate_referenced_layer(&copy, CD_MDEFORMVERT, totelem));
+  EXPECT_NE(copied_dverts, dverts);
+  EXPECT_NE(copied_dverts[0].dw, dverts[0].dw);
+  EXPECT_EQ(copied_dverts[3].dw->def_nr, 3);
+
+  /* Freeing both must not leak or free the weights twice. */
+  CustomData_free(&src, totelem);
+  CustomData_free(&copy, totelem);
+}
+
+TEST(customdata, ShareLayersMeshNomainToMesh)
+{
+  BKE_idtype_init();
+  Mesh *source = BKE_mesh_new_nomain(4, 0, 0, 0, 0);
+  for (const int i : IndexRange(source->totvert)) {
+    source->mvert[i].co[0] = float(i);
+  }
+  Mesh *evaluated = BKE_mesh_copy_for_eval(source, true);
+  EXPECT_EQ(evaluated->mvert, source->mvert);
+
+  /* The original mesh doesn't take over data that is still shared with the source, since
+   * original data is modified in place. */
+  Mesh *original = BKE_mesh_new_nomain(0, 0, 0, 0, 0);
+  BKE_mesh_nomain_to_mesh(evaluated, original, nullptr, &CD_MASK_MESH, true);
+  ASSERT_EQ(original->totvert, 4);
+  EXPECT_NE(original->mvert, source->mvert);
+  original->mvert[1].co[0] = 10.0f;
+  EXPECT_EQ(source->mvert[1].co[0], 1.0f);
+
+  BKE_id_free(nullptr, original);
+  BKE_id_free(nullptr, source);
+}
+
+}  // namespace blender::bke::tests
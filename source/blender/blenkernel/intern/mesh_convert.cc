@@ -1567,7 +1567,11 @@ void BKE_mesh_nomain_to_mesh(Mesh *mesh_src,
   /* NOTE(nazgul): maybe some other layers should be copied? */
   if (CustomData_has_layer(&mesh_dst->ldata, CD_MDISPS)) {
     if (totloop == mesh_dst->totloop) {
-      MDisps *mdisps = (MDisps *)CustomData_get_layer(&mesh_dst->ldata, CD_MDISPS);
+      /* Data which is moved to the new layer can't be shared anymore. */
+      MDisps *mdisps = (MDisps *)((alloctype == CD_ASSIGN) ?
+                                      CustomData_duplicate_referenced_layer(
+                                          &mesh_dst->ldata, CD_MDISPS, totloop) :
+                                      CustomData_get_layer(&mesh_dst->ldata, CD_MDISPS));
       CustomData_add_layer(&tmp.ldata, CD_MDISPS, alloctype, mdisps, totloop);
       if (alloctype == CD_ASSIGN) {
         /* Assign nullptr to prevent double-free. */
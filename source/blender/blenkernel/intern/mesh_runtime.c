@@ -34,6 +34,7 @@
 #include "BLI_threads.h"
 
 #include "BKE_bvhutils.h"
+#include "BKE_customdata.h"
 #include "BKE_lib_id.h"
 #include "BKE_mesh.h"
 #include "BKE_mesh_runtime.h"
@@ -281,6 +282,7 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
 /* Draw Engine */
 void (*BKE_mesh_batch_cache_dirty_tag_cb)(Mesh *me, eMeshBatchDirtyMode mode) = NULL;
 void (*BKE_mesh_batch_cache_free_cb)(Mesh *me) = NULL;
+void (*BKE_mesh_batch_cache_stash_free_cb)(void *batch_cache) = NULL;
 
 void BKE_mesh_batch_cache_dirty_tag(Mesh *me, eMeshBatchDirtyMode mode)
 {
@@ -295,6 +297,57 @@ void BKE_mesh_batch_cache_free(Mesh *me)
   }
 }
 
+void *BKE_mesh_batch_cache_stash(Mesh *me)
+{
+  void *batch_cache = me->runtime.batch_cache;
+  me->runtime.batch_cache = NULL;
+  return batch_cache;
+}
+
+void BKE_mesh_batch_cache_unstash(Mesh *me, void *batch_cache)
+{
+  if (me->runtime.batch_cache != NULL) {
+    BKE_mesh_batch_cache_stash_free(batch_cache);
+    return;
+  }
+  me->runtime.batch_cache = batch_cache;
+  BKE_mesh_batch_cache_dirty_tag(me, BKE_MESH_BATCH_DIRTY_POSITIONS);
+}
+
+void BKE_mesh_batch_cache_stash_free(void *batch_cache)
+{
+  if (batch_cache) {
+    BKE_mesh_batch_cache_stash_free_cb(batch_cache);
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Mesh Runtime Evaluation Changes
+ * \{ */
+
+bool BKE_mesh_runtime_only_positions_changed(const Mesh *me_eval, const Mesh *me_input)
+{
+  if (me_eval == me_input) {
+    return false;
+  }
+  if (me_eval->edit_mesh != NULL || me_eval->runtime.wrapper_type != ME_WRAPPER_TYPE_MDATA) {
+    return false;
+  }
+  if (me_eval->totvert != me_input->totvert || me_eval->totedge != me_input->totedge ||
+      me_eval->totloop != me_input->totloop || me_eval->totpoly != me_input->totpoly) {
+    return false;
+  }
+  /* Positions are stored in the vertex layer. Normals and original coordinates are only added to
+   * the evaluated mesh, the latter don't depend on the deformation. */
+  const CustomDataMask mask_ignore = CD_MASK_MVERT | CD_MASK_NORMAL | CD_MASK_ORCO;
+  return CustomData_layers_share_data(&me_eval->vdata, &me_input->vdata, mask_ignore) &&
+         CustomData_layers_share_data(&me_eval->edata, &me_input->edata, mask_ignore) &&
+         CustomData_layers_share_data(&me_eval->ldata, &me_input->ldata, mask_ignore) &&
+         CustomData_layers_share_data(&me_eval->pdata, &me_input->pdata, mask_ignore);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -84,6 +84,7 @@
 #include "BKE_armature.h"
 #include "BKE_asset.h"
 #include "BKE_bpath.h"
+#include "BKE_bvhutils.h"
 #include "BKE_camera.h"
 #include "BKE_collection.h"
 #include "BKE_constraint.h"
@@ -121,6 +122,7 @@
 #include "BKE_material.h"
 #include "BKE_mball.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
 #include "BKE_mesh_wrapper.h"
 #include "BKE_modifier.h"
 #include "BKE_multires.h"
@@ -275,6 +277,22 @@ static void object_copy_data(Main *bmain, ID *id_dst, const ID *id_src, const in
   }
 }
 
+static void object_free_bvh_cache_stash(Object *ob)
+{
+  if (ob->runtime.bvh_cache_stash != nullptr) {
+    bvhcache_free(ob->runtime.bvh_cache_stash);
+    ob->runtime.bvh_cache_stash = nullptr;
+  }
+}
+
+static void object_free_batch_cache_stash(Object *ob)
+{
+  if (ob->runtime.batch_cache_stash != nullptr) {
+    BKE_mesh_batch_cache_stash_free(ob->runtime.batch_cache_stash);
+    ob->runtime.batch_cache_stash = nullptr;
+  }
+}
+
 static void object_free_data(ID *id)
 {
   Object *ob = (Object *)id;
@@ -322,6 +340,10 @@ static void object_free_data(ID *id)
     ob->runtime.curve_cache = nullptr;
   }
 
+  /* Stashed when the derived caches were freed together with the modifiers. */
+  object_free_bvh_cache_stash(ob);
+  object_free_batch_cache_stash(ob);
+
   BKE_previewimg_free(&ob->preview);
 }
 
@@ -1820,6 +1842,19 @@ void BKE_object_eval_assign_data(Object *object_eval, ID *data_eval, bool is_own
     data_eval->tag |= LIB_TAG_COPIED_ON_WRITE_EVAL_RESULT;
   }
 
+  /* Let the new mesh refit the BVH trees of the previous one, see #BKE_object_free_derived_caches.
+   * Meshes that are not owned by the object might be used by other objects as well. */
+  if (object_eval->runtime.bvh_cache_stash != nullptr) {
+    if (is_owned && GS(data_eval->name) == ID_ME) {
+      bvhcache_unstash(&((Mesh *)data_eval)->runtime.bvh_cache,
+                       object_eval->runtime.bvh_cache_stash);
+      object_eval->runtime.bvh_cache_stash = nullptr;
+    }
+    else {
+      object_free_bvh_cache_stash(object_eval);
+    }
+  }
+
   /* Assigned evaluated data. */
   object_eval->runtime.data_eval = data_eval;
   object_eval->runtime.is_data_eval_owned = is_owned;
@@ -1838,6 +1873,30 @@ void BKE_object_eval_assign_data(Object *object_eval, ID *data_eval, bool is_own
   object_eval->runtime.geometry_set_eval = nullptr;
 }
 
+void BKE_object_eval_batch_cache_unstash(Object *object_eval)
+{
+  /* Checked here since the input mesh might already be freed when the evaluated one is. */
+  ID *data_eval = object_eval->runtime.data_eval;
+  const ID *data_input = object_eval->runtime.data_orig;
+  object_eval->runtime.is_data_eval_deform_only =
+      data_eval != nullptr && data_input != nullptr && object_eval->runtime.is_data_eval_owned &&
+      GS(data_eval->name) == ID_ME && GS(data_input->name) == ID_ME &&
+      BKE_mesh_runtime_only_positions_changed((const Mesh *)data_eval, (const Mesh *)data_input);
+
+  if (object_eval->runtime.batch_cache_stash == nullptr) {
+    return;
+  }
+  /* The input mesh must not have been updated, since its data might have been modified in place
+   * while keeping the same arrays. */
+  if (object_eval->runtime.is_data_eval_deform_only && (data_input->recalc & ID_RECALC_ALL) == 0) {
+    BKE_mesh_batch_cache_unstash((Mesh *)data_eval, object_eval->runtime.batch_cache_stash);
+    object_eval->runtime.batch_cache_stash = nullptr;
+  }
+  else {
+    object_free_batch_cache_stash(object_eval);
+  }
+}
+
 void BKE_object_free_derived_caches(Object *ob)
 {
   MEM_SAFE_FREE(ob->runtime.bb);
@@ -1854,7 +1913,19 @@ void BKE_object_free_derived_caches(Object *ob)
     if (ob->runtime.is_data_eval_owned) {
       ID *data_eval = ob->runtime.data_eval;
       if (GS(data_eval->name) == ID_ME) {
-        BKE_mesh_eval_delete((Mesh *)data_eval);
+        Mesh *mesh_eval = (Mesh *)data_eval;
+        /* The next evaluated mesh often only has different positions (e.g. because of an
+         * armature or another deforming modifier), so keep its BVH trees to refit them. */
+        object_free_bvh_cache_stash(ob);
+        ob->runtime.bvh_cache_stash = bvhcache_stash(&mesh_eval->runtime.bvh_cache);
+        /* Most GPU buffers don't depend on positions either. They can only be reused when the
+         * mesh was created by deforming the input mesh, the next one is checked when it is
+         * assigned in #BKE_object_eval_batch_cache_unstash. */
+        object_free_batch_cache_stash(ob);
+        if (ob->runtime.is_data_eval_deform_only) {
+          ob->runtime.batch_cache_stash = BKE_mesh_batch_cache_stash(mesh_eval);
+        }
+        BKE_mesh_eval_delete(mesh_eval);
       }
       else {
         BKE_libblock_free_datablock(data_eval, 0);
@@ -1862,6 +1933,7 @@ void BKE_object_free_derived_caches(Object *ob)
       }
     }
     ob->runtime.data_eval = nullptr;
+    ob->runtime.is_data_eval_deform_only = false;
   }
   if (ob->runtime.mesh_deform_eval != nullptr) {
     Mesh *mesh_deform_eval = ob->runtime.mesh_deform_eval;
@@ -1930,6 +2002,8 @@ void BKE_object_free_caches(Object *object)
    */
   if ((object->base_flag & BASE_FROM_DUPLI) == 0) {
     BKE_object_free_derived_caches(object);
+    object_free_bvh_cache_stash(object);
+    object_free_batch_cache_stash(object);
     update_flag |= ID_RECALC_GEOMETRY;
   }
 
@@ -5219,6 +5293,8 @@ void BKE_object_runtime_reset_on_copy(Object *object, const int UNUSED(flag))
   runtime->object_as_temp_mesh = nullptr;
   runtime->object_as_temp_curve = nullptr;
   runtime->geometry_set_eval = nullptr;
+  runtime->bvh_cache_stash = nullptr;
+  runtime->batch_cache_stash = nullptr;
 
   runtime->crazyspace_deform_imats = nullptr;
   runtime->crazyspace_deform_cos = nullptr;
@@ -5226,8 +5302,9 @@ void BKE_object_runtime_reset_on_copy(Object *object, const int UNUSED(flag))
 
 void BKE_object_runtime_free_data(Object *object)
 {
-  /* Currently this is all that's needed. */
   BKE_object_free_derived_caches(object);
+  object_free_bvh_cache_stash(object);
+  object_free_batch_cache_stash(object);
 
   BKE_object_runtime_reset(object);
 }
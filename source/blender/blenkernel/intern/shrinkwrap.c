@@ -347,89 +347,103 @@ void BKE_shrinkwrap_compute_boundary_data(struct Mesh *mesh)
  * Shrink-wrap to the nearest vertex
  *
  * it builds a #BVHTree of vertices we can attach to and then
- * for each vertex performs a nearest vertex search on the tree
+ * for each block of vertices performs a batched nearest vertex search on the tree
  */
+#define SHRINKWRAP_NEAREST_VERTEX_BLOCK_SIZE 256
+
 static void shrinkwrap_calc_nearest_vertex_cb_ex(void *__restrict userdata,
-                                                 const int i,
-                                                 const TaskParallelTLS *__restrict tls)
+                                                 const int block,
+                                                 const TaskParallelTLS *__restrict UNUSED(tls))
 {
   ShrinkwrapCalcCBData *data = userdata;
 
   ShrinkwrapCalcData *calc = data->calc;
   BVHTreeFromMesh *treeData = &data->tree->treeData;
-  BVHTreeNearest *nearest = tls->userdata_chunk;
 
-  float *co = calc->vertexCos[i];
-  float tmp_co[3];
-  float weight = BKE_defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
+  const int start = block * SHRINKWRAP_NEAREST_VERTEX_BLOCK_SIZE;
+  const int end = min_ii(start + SHRINKWRAP_NEAREST_VERTEX_BLOCK_SIZE, calc->numVerts);
 
-  if (calc->invert_vgroup) {
-    weight = 1.0f - weight;
-  }
+  int indices[SHRINKWRAP_NEAREST_VERTEX_BLOCK_SIZE];
+  float weights[SHRINKWRAP_NEAREST_VERTEX_BLOCK_SIZE];
+  float tmp_co[SHRINKWRAP_NEAREST_VERTEX_BLOCK_SIZE][3];
+  BVHTreeNearest nearest[SHRINKWRAP_NEAREST_VERTEX_BLOCK_SIZE];
+  int tot = 0;
 
-  if (weight == 0.0f) {
-    return;
-  }
+  for (int i = start; i < end; i++) {
+    float weight = BKE_defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
 
-  /* Convert the vertex to tree coordinates */
-  if (calc->vert) {
-    copy_v3_v3(tmp_co, calc->vert[i].co);
-  }
-  else {
-    copy_v3_v3(tmp_co, co);
-  }
-  BLI_space_transform_apply(&calc->local2target, tmp_co);
+    if (calc->invert_vgroup) {
+      weight = 1.0f - weight;
+    }
 
-  /* Use local proximity heuristics (to reduce the nearest search)
-   *
-   * If we already had an hit before.. we assume this vertex is going to have a close hit to that
-   * other vertex so we can initiate the "nearest.dist" with the expected value to that last hit.
-   * This will lead in pruning of the search tree. */
-  if (nearest->index != -1) {
-    nearest->dist_sq = len_squared_v3v3(tmp_co, nearest->co);
-  }
-  else {
-    nearest->dist_sq = FLT_MAX;
-  }
+    if (weight == 0.0f) {
+      continue;
+    }
 
-  BLI_bvhtree_find_nearest(treeData->tree, tmp_co, nearest, treeData->nearest_callback, treeData);
+    /* Convert the vertex to tree coordinates */
+    if (calc->vert) {
+      copy_v3_v3(tmp_co[tot], calc->vert[i].co);
+    }
+    else {
+      copy_v3_v3(tmp_co[tot], calc->vertexCos[i]);
+    }
+    BLI_space_transform_apply(&calc->local2target, tmp_co[tot]);
+
+    indices[tot] = i;
+    weights[tot] = weight;
+    nearest[tot].index = -1;
+    nearest[tot].dist_sq = FLT_MAX;
+    nearest[tot].flags = 0;
+    tot++;
+  }
+
+  /* The batched search uses the result of nearby vertices to reduce the nearest search. */
+  BLI_bvhtree_find_nearest_batch(treeData->tree,
+                                 (const float(*)[3])tmp_co,
+                                 tot,
+                                 nearest,
+                                 treeData->nearest_callback,
+                                 treeData,
+                                 0);
+
+  for (int j = 0; j < tot; j++) {
+    /* Found the nearest vertex */
+    if (nearest[j].index == -1) {
+      continue;
+    }
+
+    float *co = calc->vertexCos[indices[j]];
+    float weight = weights[j];
 
-  /* Found the nearest vertex */
-  if (nearest->index != -1) {
     /* Adjusting the vertex weight,
      * so that after interpolating it keeps a certain distance from the nearest position */
-    if (nearest->dist_sq > FLT_EPSILON) {
-      const float dist = sqrtf(nearest->dist_sq);
+    if (nearest[j].dist_sq > FLT_EPSILON) {
+      const float dist = sqrtf(nearest[j].dist_sq);
       weight *= (dist - calc->keepDist) / dist;
     }
 
     /* Convert the coordinates back to mesh coordinates */
-    copy_v3_v3(tmp_co, nearest->co);
-    BLI_space_transform_invert(&calc->local2target, tmp_co);
+    float co_target[3];
+    copy_v3_v3(co_target, nearest[j].co);
+    BLI_space_transform_invert(&calc->local2target, co_target);
 
-    interp_v3_v3v3(co, co, tmp_co, weight); /* linear interpolation */
+    interp_v3_v3v3(co, co, co_target, weight); /* linear interpolation */
   }
 }
 
 static void shrinkwrap_calc_nearest_vertex(ShrinkwrapCalcData *calc)
 {
-  BVHTreeNearest nearest = NULL_BVHTreeNearest;
-
-  /* Setup nearest */
-  nearest.index = -1;
-  nearest.dist_sq = FLT_MAX;
-
   ShrinkwrapCalcCBData data = {
       .calc = calc,
       .tree = calc->tree,
   };
+  const int blocks_num = (calc->numVerts + SHRINKWRAP_NEAREST_VERTEX_BLOCK_SIZE - 1) /
+                         SHRINKWRAP_NEAREST_VERTEX_BLOCK_SIZE;
+
   TaskParallelSettings settings;
   BLI_parallel_range_settings_defaults(&settings);
   settings.use_threading = (calc->numVerts > BKE_MESH_OMP_LIMIT);
-  settings.userdata_chunk = &nearest;
-  settings.userdata_chunk_size = sizeof(nearest);
-  BLI_task_parallel_range(
-      0, calc->numVerts, &data, shrinkwrap_calc_nearest_vertex_cb_ex, &settings);
+  BLI_task_parallel_range(0, blocks_num, &data, shrinkwrap_calc_nearest_vertex_cb_ex, &settings);
 }
 
 bool BKE_shrinkwrap_project_normal(char options,
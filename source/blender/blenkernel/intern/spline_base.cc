@@ -14,6 +14,8 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <atomic>
+
 #include "BLI_array.hh"
 #include "BLI_span.hh"
 #include "BLI_task.hh"
@@ -42,6 +44,22 @@ Spline::Type Spline::type() const
   return type_;
 }
 
+uint64_t Spline::new_cache_version()
+{
+  static std::atomic<uint64_t> version_counter = 0;
+  return ++version_counter;
+}
+
+void Spline::update_cache_version()
+{
+  cache_version_ = new_cache_version();
+}
+
+uint64_t Spline::cache_version() const
+{
+  return cache_version_;
+}
+
 void Spline::copy_base_settings(const Spline &src, Spline &dst)
 {
   dst.normal_mode = src.normal_mode;
@@ -81,6 +99,8 @@ SplinePtr Spline::copy_without_attributes() const
 {
   SplinePtr dst = this->copy_only_settings();
   this->copy_data(*dst);
+  /* All of the data used for evaluation is the same, so caches outside the spline can be shared. */
+  dst->cache_version_ = cache_version_;
 
   /* Though the attributes storage is empty, it still needs to know the correct size. */
   dst->attributes.reallocate(dst->size());
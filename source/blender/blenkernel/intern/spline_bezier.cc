@@ -347,6 +347,7 @@ void BezierSpline::mark_cache_invalid()
   normal_cache_dirty_ = true;
   length_cache_dirty_ = true;
   auto_handles_dirty_ = true;
+  this->update_cache_version();
 }
 
 int BezierSpline::evaluated_points_size() const
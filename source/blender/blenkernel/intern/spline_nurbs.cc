@@ -136,6 +136,7 @@ void NURBSpline::mark_cache_invalid()
   tangent_cache_dirty_ = true;
   normal_cache_dirty_ = true;
   length_cache_dirty_ = true;
+  this->update_cache_version();
 }
 
 int NURBSpline::evaluated_points_size() const
@@ -231,11 +232,18 @@ Span<float> NURBSpline::knots() const
   return knots_;
 }
 
+/**
+ * \param span_hint: The knot span found for the previous parameter. Since the parameters are
+ * always evaluated in increasing order, the search for the span containing the next parameter can
+ * start there, and only the values around that span have to be cleared in the buffer. That keeps
+ * the cost of each evaluated point proportional to the order rather than the number of points.
+ */
 static void calculate_basis_for_point(const float parameter,
                                       const int size,
                                       const int order,
                                       Span<float> knots,
                                       MutableSpan<float> basis_buffer,
+                                      int &span_hint,
                                       NURBSpline::BasisCache &basis_cache)
 {
   /* Clamp parameter due to floating point inaccuracy. */
@@ -243,20 +251,25 @@ static void calculate_basis_for_point(const float parameter,
 
   int start = 0;
   int end = 0;
-  for (const int i : IndexRange(size + order - 1)) {
+  bool span_found = false;
+  for (const int i : IndexRange(span_hint, size + order - 1 - span_hint)) {
     const bool knots_equal = knots[i] == knots[i + 1];
     if (knots_equal || t < knots[i] || t > knots[i + 1]) {
-      basis_buffer[i] = 0.0f;
       continue;
     }
 
-    basis_buffer[i] = 1.0f;
     start = std::max(i - order - 1, 0);
     end = i;
-    basis_buffer.slice(i + 1, size + order - 1 - i).fill(0.0f);
+    span_hint = i;
+    span_found = true;
     break;
   }
-  basis_buffer[size + order - 1] = 0.0f;
+
+  /* The recursion below only reads values up to one past the span. */
+  basis_buffer.slice(start, end - start + 2).fill(0.0f);
+  if (span_found) {
+    basis_buffer[end] = 1.0f;
+  }
 
   for (const int i_order : IndexRange(2, order - 1)) {
     if (end + i_order >= size + order) {
@@ -323,10 +336,16 @@ Span<NURBSpline::BasisCache> NURBSpline::calculate_basis_cache() const
   const float end = is_cyclic_ ? knots[size + order - 1] : knots[size];
   const float step = (end - start) / this->evaluated_edges_size();
   float parameter = start;
+  int span_hint = 0;
   for (const int i : IndexRange(eval_size)) {
     BasisCache &basis = basis_cache[i];
-    calculate_basis_for_point(
-        parameter, size + (is_cyclic_ ? order - 1 : 0), order, knots, basis_buffer, basis);
+    calculate_basis_for_point(parameter,
+                              size + (is_cyclic_ ? order - 1 : 0),
+                              order,
+                              knots,
+                              basis_buffer,
+                              span_hint,
+                              basis);
     BLI_assert(basis.weights.size() <= order);
 
     for (const int j : basis.weights.index_range()) {
@@ -88,6 +88,7 @@ void PolySpline::mark_cache_invalid()
   tangent_cache_dirty_ = true;
   normal_cache_dirty_ = true;
   length_cache_dirty_ = true;
+  this->update_cache_version();
 }
 
 int PolySpline::evaluated_points_size() const
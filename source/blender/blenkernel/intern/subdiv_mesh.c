@@ -403,7 +403,31 @@ static void loop_interpolation_end(LoopsForInterpolation *loop_interpolation)
 /** \name TLS
  * \{ */
 
+/* Number of subdivided vertices or loops which are interpolated at once. */
+#define INTERPOLATION_BATCH_SIZE 128
+
+/* Subdivided elements which are interpolated from the four corners of a ptex face.
+ * The interpolation is deferred until the batch is full or its source data is about to change,
+ * so that all custom data layers are interpolated with a single #CustomData_interp_batch call
+ * instead of one call per element. */
+typedef struct InterpolationBatch {
+  const CustomData *source;
+  int num;
+  int src_indices[INTERPOLATION_BATCH_SIZE][4];
+  float weights[INTERPOLATION_BATCH_SIZE][4];
+  int dest_indices[INTERPOLATION_BATCH_SIZE];
+  /* Ptex coordinates of every element, used to evaluate face-varying data after the
+   * interpolation, which would overwrite it otherwise. */
+  int ptex_face_indices[INTERPOLATION_BATCH_SIZE];
+  float ptex_uvs[INTERPOLATION_BATCH_SIZE][2];
+} InterpolationBatch;
+
 typedef struct SubdivMeshTLS {
+  /* Context the batches belong to, needed to flush them when the TLS is freed. */
+  SubdivMeshContext *ctx;
+  InterpolationBatch vertex_batch;
+  InterpolationBatch loop_batch;
+
   bool vertex_interpolation_initialized;
   VerticesForInterpolation vertex_interpolation;
   const MPoly *vertex_interpolation_coarse_poly;
@@ -415,15 +439,39 @@ typedef struct SubdivMeshTLS {
   int loop_interpolation_coarse_corner;
 } SubdivMeshTLS;
 
-static void subdiv_mesh_tls_free(void *tls_v)
+/* Add an element to the batch, the caller is responsible for flushing it when full. */
+static void interpolation_batch_add(InterpolationBatch *batch,
+                                    const CustomData *source,
+                                    const int src_indices[4],
+                                    const float u,
+                                    const float v,
+                                    const int ptex_face_index,
+                                    const int dest_index)
 {
-  SubdivMeshTLS *tls = tls_v;
-  if (tls->vertex_interpolation_initialized) {
-    vertex_interpolation_end(&tls->vertex_interpolation);
-  }
-  if (tls->loop_interpolation_initialized) {
-    loop_interpolation_end(&tls->loop_interpolation);
-  }
+  BLI_assert(batch->num == 0 || batch->source == source);
+  BLI_assert(batch->num < INTERPOLATION_BATCH_SIZE);
+  const int i = batch->num++;
+  batch->source = source;
+  copy_v4_v4_int(batch->src_indices[i], src_indices);
+  batch->weights[i][0] = (1.0f - u) * (1.0f - v);
+  batch->weights[i][1] = u * (1.0f - v);
+  batch->weights[i][2] = u * v;
+  batch->weights[i][3] = (1.0f - u) * v;
+  batch->dest_indices[i] = dest_index;
+  batch->ptex_face_indices[i] = ptex_face_index;
+  batch->ptex_uvs[i][0] = u;
+  batch->ptex_uvs[i][1] = v;
+}
+
+static void interpolation_batch_interp(InterpolationBatch *batch, CustomData *dest)
+{
+  CustomData_interp_batch(batch->source,
+                          dest,
+                          &batch->src_indices[0][0],
+                          &batch->weights[0][0],
+                          4,
+                          batch->dest_indices,
+                          batch->num);
 }
 
 /** \} */
@@ -501,21 +549,36 @@ static void subdiv_vertex_data_copy(const SubdivMeshContext *ctx,
       &coarse_mesh->vdata, &ctx->subdiv_mesh->vdata, coarse_vertex_index, subdiv_vertex_index, 1);
 }
 
-static void subdiv_vertex_data_interpolate(const SubdivMeshContext *ctx,
+static void subdiv_vertex_batch_flush(SubdivMeshTLS *tls)
+{
+  InterpolationBatch *batch = &tls->vertex_batch;
+  if (batch->num == 0) {
+    return;
+  }
+  interpolation_batch_interp(batch, &tls->ctx->subdiv_mesh->vdata);
+  batch->num = 0;
+}
+
+static void subdiv_vertex_data_interpolate(SubdivMeshContext *ctx,
+                                           SubdivMeshTLS *tls,
                                            MVert *subdiv_vertex,
                                            const VerticesForInterpolation *vertex_interpolation,
+                                           const int ptex_face_index,
                                            const float u,
                                            const float v)
 {
   const int subdiv_vertex_index = subdiv_vertex - ctx->subdiv_mesh->mvert;
-  const float weights[4] = {(1.0f - u) * (1.0f - v), u * (1.0f - v), u * v, (1.0f - u) * v};
-  CustomData_interp(vertex_interpolation->vertex_data,
-                    &ctx->subdiv_mesh->vdata,
-                    vertex_interpolation->vertex_indices,
-                    weights,
-                    NULL,
-                    4,
-                    subdiv_vertex_index);
+  tls->ctx = ctx;
+  interpolation_batch_add(&tls->vertex_batch,
+                          vertex_interpolation->vertex_data,
+                          vertex_interpolation->vertex_indices,
+                          u,
+                          v,
+                          ptex_face_index,
+                          subdiv_vertex_index);
+  if (tls->vertex_batch.num == INTERPOLATION_BATCH_SIZE) {
+    subdiv_vertex_batch_flush(tls);
+  }
   if (ctx->vert_origindex != NULL) {
     ctx->vert_origindex[subdiv_vertex_index] = ORIGINDEX_NONE;
   }
@@ -547,7 +610,8 @@ static void evaluate_vertex_and_apply_displacement_copy(const SubdivMeshContext
 }
 
 static void evaluate_vertex_and_apply_displacement_interpolate(
-    const SubdivMeshContext *ctx,
+    SubdivMeshContext *ctx,
+    SubdivMeshTLS *tls,
     const int ptex_face_index,
     const float u,
     const float v,
@@ -564,7 +628,8 @@ static void evaluate_vertex_and_apply_displacement_interpolate(
     mul_v3_fl(D, inv_num_accumulated);
   }
   /* Interpolate custom data and evaluate position. */
-  subdiv_vertex_data_interpolate(ctx, subdiv_vert, vertex_interpolation, u, v);
+  subdiv_vertex_data_interpolate(
+      ctx, tls, subdiv_vert, vertex_interpolation, ptex_face_index, u, v);
   BKE_subdiv_eval_limit_point(ctx->subdiv, ptex_face_index, u, v, subdiv_vert->co);
   /* Apply displacement. */
   add_v3_v3(subdiv_vert->co, D);
@@ -643,6 +708,8 @@ static void subdiv_mesh_ensure_vertex_interpolation(SubdivMeshContext *ctx,
   if (tls->vertex_interpolation_initialized) {
     if (tls->vertex_interpolation_coarse_poly != coarse_poly ||
         tls->vertex_interpolation_coarse_corner != coarse_corner) {
+      /* Pending interpolation might use the data which is about to change. */
+      subdiv_vertex_batch_flush(tls);
       vertex_interpolation_end(&tls->vertex_interpolation);
       tls->vertex_interpolation_initialized = false;
     }
@@ -682,7 +749,7 @@ static void subdiv_mesh_vertex_edge(const SubdivForeachContext *foreach_context,
   MVert *subdiv_vert = &subdiv_mvert[subdiv_vertex_index];
   subdiv_mesh_ensure_vertex_interpolation(ctx, tls, coarse_poly, coarse_corner);
   evaluate_vertex_and_apply_displacement_interpolate(
-      ctx, ptex_face_index, u, v, &tls->vertex_interpolation, subdiv_vert);
+      ctx, tls, ptex_face_index, u, v, &tls->vertex_interpolation, subdiv_vert);
 }
 
 static bool subdiv_mesh_is_center_vertex(const MPoly *coarse_poly, const float u, const float v)
@@ -729,7 +796,8 @@ static void subdiv_mesh_vertex_inner(const SubdivForeachContext *foreach_context
   MVert *subdiv_mvert = subdiv_mesh->mvert;
   MVert *subdiv_vert = &subdiv_mvert[subdiv_vertex_index];
   subdiv_mesh_ensure_vertex_interpolation(ctx, tls, coarse_poly, coarse_corner);
-  subdiv_vertex_data_interpolate(ctx, subdiv_vert, &tls->vertex_interpolation, u, v);
+  subdiv_vertex_data_interpolate(
+      ctx, tls, subdiv_vert, &tls->vertex_interpolation, ptex_face_index, u, v);
   BKE_subdiv_eval_final_point(subdiv, ptex_face_index, u, v, subdiv_vert->co);
   subdiv_mesh_tag_center_vertex(coarse_poly, subdiv_vert, u, v);
 }
@@ -791,24 +859,6 @@ static void subdiv_mesh_edge(const SubdivForeachContext *foreach_context,
 /** \name Loops creation/interpolation
  * \{ */
 
-static void subdiv_interpolate_loop_data(const SubdivMeshContext *ctx,
-                                         MLoop *subdiv_loop,
-                                         const LoopsForInterpolation *loop_interpolation,
-                                         const float u,
-                                         const float v)
-{
-  const int subdiv_loop_index = subdiv_loop - ctx->subdiv_mesh->mloop;
-  const float weights[4] = {(1.0f - u) * (1.0f - v), u * (1.0f - v), u * v, (1.0f - u) * v};
-  CustomData_interp(loop_interpolation->loop_data,
-                    &ctx->subdiv_mesh->ldata,
-                    loop_interpolation->loop_indices,
-                    weights,
-                    NULL,
-                    4,
-                    subdiv_loop_index);
-  /* TODO(sergey): Set ORIGINDEX. */
-}
-
 static void subdiv_eval_uv_layer(SubdivMeshContext *ctx,
                                  MLoop *subdiv_loop,
                                  const int ptex_face_index,
@@ -826,6 +876,48 @@ static void subdiv_eval_uv_layer(SubdivMeshContext *ctx,
   }
 }
 
+static void subdiv_loop_batch_flush(SubdivMeshTLS *tls)
+{
+  InterpolationBatch *batch = &tls->loop_batch;
+  if (batch->num == 0) {
+    return;
+  }
+  SubdivMeshContext *ctx = tls->ctx;
+  interpolation_batch_interp(batch, &ctx->subdiv_mesh->ldata);
+  /* Evaluate UVs after the interpolation, which would overwrite them otherwise. */
+  for (int i = 0; i < batch->num; i++) {
+    subdiv_eval_uv_layer(ctx,
+                         &ctx->subdiv_mesh->mloop[batch->dest_indices[i]],
+                         batch->ptex_face_indices[i],
+                         batch->ptex_uvs[i][0],
+                         batch->ptex_uvs[i][1]);
+  }
+  batch->num = 0;
+}
+
+static void subdiv_interpolate_loop_data(SubdivMeshContext *ctx,
+                                         SubdivMeshTLS *tls,
+                                         MLoop *subdiv_loop,
+                                         const LoopsForInterpolation *loop_interpolation,
+                                         const int ptex_face_index,
+                                         const float u,
+                                         const float v)
+{
+  const int subdiv_loop_index = subdiv_loop - ctx->subdiv_mesh->mloop;
+  tls->ctx = ctx;
+  interpolation_batch_add(&tls->loop_batch,
+                          loop_interpolation->loop_data,
+                          loop_interpolation->loop_indices,
+                          u,
+                          v,
+                          ptex_face_index,
+                          subdiv_loop_index);
+  if (tls->loop_batch.num == INTERPOLATION_BATCH_SIZE) {
+    subdiv_loop_batch_flush(tls);
+  }
+  /* TODO(sergey): Set ORIGINDEX. */
+}
+
 static void subdiv_mesh_ensure_loop_interpolation(SubdivMeshContext *ctx,
                                                   SubdivMeshTLS *tls,
                                                   const MPoly *coarse_poly,
@@ -835,6 +927,8 @@ static void subdiv_mesh_ensure_loop_interpolation(SubdivMeshContext *ctx,
   if (tls->loop_interpolation_initialized) {
     if (tls->loop_interpolation_coarse_poly != coarse_poly ||
         tls->loop_interpolation_coarse_corner != coarse_corner) {
+      /* Pending interpolation might use the data which is about to change. */
+      subdiv_loop_batch_flush(tls);
       loop_interpolation_end(&tls->loop_interpolation);
       tls->loop_interpolation_initialized = false;
     }
@@ -875,8 +969,9 @@ static void subdiv_mesh_loop(const SubdivForeachContext *foreach_context,
   MLoop *subdiv_mloop = subdiv_mesh->mloop;
   MLoop *subdiv_loop = &subdiv_mloop[subdiv_loop_index];
   subdiv_mesh_ensure_loop_interpolation(ctx, tls, coarse_poly, coarse_corner);
-  subdiv_interpolate_loop_data(ctx, subdiv_loop, &tls->loop_interpolation, u, v);
-  subdiv_eval_uv_layer(ctx, subdiv_loop, ptex_face_index, u, v);
+  /* UVs are evaluated when the interpolation batch is flushed. */
+  subdiv_interpolate_loop_data(
+      ctx, tls, subdiv_loop, &tls->loop_interpolation, ptex_face_index, u, v);
   subdiv_loop->v = subdiv_vertex_index;
   subdiv_loop->e = subdiv_edge_index;
 }
@@ -1081,6 +1176,25 @@ static void subdiv_mesh_vertex_of_loose_edge(const struct SubdivForeachContext *
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name TLS free
+ * \{ */
+
+static void subdiv_mesh_tls_free(void *tls_v)
+{
+  SubdivMeshTLS *tls = tls_v;
+  subdiv_vertex_batch_flush(tls);
+  subdiv_loop_batch_flush(tls);
+  if (tls->vertex_interpolation_initialized) {
+    vertex_interpolation_end(&tls->vertex_interpolation);
+  }
+  if (tls->loop_interpolation_initialized) {
+    loop_interpolation_end(&tls->loop_interpolation);
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Initialization
  * \{ */
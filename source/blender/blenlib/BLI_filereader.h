@@ -71,6 +71,18 @@ FileReader *BLI_filereader_new_mmap(int filedes) ATTR_WARN_UNUSED_RESULT;
 /** Create #FileReader from a region of memory. */
 FileReader *BLI_filereader_new_memory(const void *data, size_t len) ATTR_WARN_UNUSED_RESULT
     ATTR_NONNULL();
+/**
+ * Get a pointer to `size` bytes at `offset` of the memory backing a #FileReader that was
+ * created by #BLI_filereader_new_memory or #BLI_filereader_new_mmap, without copying them.
+ * Returns NULL for any other kind of reader or if the range is outside of the data.
+ *
+ * \note For memory-mapped files IO errors only show up once the memory is accessed,
+ * so #BLI_filereader_memory_check must be called after reading through the pointer.
+ */
+const void *BLI_filereader_memory_pointer(FileReader *reader, off64_t offset, size_t size)
+    ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+/** Returns false if an IO error happened while accessing the memory of the #FileReader. */
+bool BLI_filereader_memory_check(FileReader *reader) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
 /** Create #FileReader from applying `Zstd` decompression on an underlying file. */
 FileReader *BLI_filereader_new_zstd(FileReader *base) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
 /** Create #FileReader from applying `Gzip` decompression on an underlying file. */
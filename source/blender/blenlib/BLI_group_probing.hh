@@ -0,0 +1,195 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Control bytes and probing cursors used by hash tables that support #GroupProbingStrategy.
+ * Those are kept out of BLI_probing_strategies.hh, because they need more headers.
+ */
+
+#include <algorithm>
+
+#include "BLI_array.hh"
+#include "BLI_math_bits.h"
+#include "BLI_probing_strategies.hh"
+
+namespace blender {
+
+/**
+ * Control bytes of a hash table using GroupProbingStrategy. There is always at least one group,
+ * so that a default constructed table with a single slot does not have to allocate.
+ */
+template<typename Allocator> class GroupProbingControls {
+ private:
+  static constexpr int64_t group_size = GroupProbingStrategy::group_size;
+
+  Array<uint8_t, group_size, Allocator> controls_;
+  uint64_t group_mask_ = 0;
+
+ public:
+  GroupProbingControls(Allocator allocator = {}) noexcept
+      : controls_(group_size, GroupProbingStrategy::control_sentinel, allocator)
+  {
+    controls_[0] = GroupProbingStrategy::control_empty;
+  }
+
+  /** Mark all slots as empty. The number of slots must be a power of two. */
+  void reinitialize(const int64_t total_slots)
+  {
+    const int64_t total_groups = std::max<int64_t>(total_slots / group_size, 1);
+    controls_.reinitialize(total_groups * group_size);
+    std::fill_n(controls_.data(), total_slots, GroupProbingStrategy::control_empty);
+    std::fill(controls_.data() + total_slots,
+              controls_.data() + controls_.size(),
+              GroupProbingStrategy::control_sentinel);
+    group_mask_ = static_cast<uint64_t>(total_groups - 1);
+  }
+
+  void occupy(const int64_t slot_index, const uint64_t hash)
+  {
+    controls_[slot_index] = GroupProbingStrategy::hash_tag(GroupProbingStrategy::mix_hash(hash));
+  }
+
+  void remove(const int64_t slot_index)
+  {
+    controls_[slot_index] = GroupProbingStrategy::control_removed;
+  }
+
+  const uint8_t *data() const
+  {
+    return controls_.data();
+  }
+
+  uint64_t group_mask() const
+  {
+    return group_mask_;
+  }
+
+  int64_t size_in_bytes() const
+  {
+    return controls_.size();
+  }
+};
+
+/**
+ * Stand-in for GroupProbingControls in hash tables that don't use GroupProbingStrategy.
+ */
+template<typename Allocator> class NoProbingControls {
+ public:
+  NoProbingControls(Allocator UNUSED(allocator) = {}) noexcept
+  {
+  }
+
+  void reinitialize(const int64_t UNUSED(total_slots))
+  {
+  }
+
+  void occupy(const int64_t UNUSED(slot_index), const uint64_t UNUSED(hash))
+  {
+  }
+
+  void remove(const int64_t UNUSED(slot_index))
+  {
+  }
+
+  int64_t size_in_bytes() const
+  {
+    return 0;
+  }
+};
+
+/**
+ * Iterates over the slots of a table using GroupProbingStrategy that have the tag of the hash or
+ * are empty. The groups are visited in triangular order, which reaches every group because their
+ * number is a power of two. Slots whose tag does not match can't contain the key, and slots that
+ * were removed are never reused, so skipping both does not change the result of any lookup.
+ */
+class GroupProbingCursor {
+ private:
+  static constexpr int64_t group_size = GroupProbingStrategy::group_size;
+
+  const uint8_t *controls_;
+  uint64_t group_mask_;
+  uint64_t group_;
+  uint64_t step_ = 0;
+  uint32_t candidates_;
+  uint8_t tag_;
+
+ public:
+  template<typename Allocator>
+  GroupProbingCursor(const uint64_t hash,
+                     const uint64_t UNUSED(slot_mask),
+                     const GroupProbingControls<Allocator> &controls)
+      : controls_(controls.data()), group_mask_(controls.group_mask())
+  {
+    const uint64_t mixed_hash = GroupProbingStrategy::mix_hash(hash);
+    tag_ = GroupProbingStrategy::hash_tag(mixed_hash);
+    group_ = mixed_hash & group_mask_;
+    this->find_candidates();
+  }
+
+  int64_t slot_index() const
+  {
+    return static_cast<int64_t>(group_) * group_size + bitscan_forward_uint(candidates_);
+  }
+
+  void next()
+  {
+    candidates_ &= candidates_ - 1;
+    if (candidates_ == 0) {
+      this->next_group();
+      this->find_candidates();
+    }
+  }
+
+ private:
+  void next_group()
+  {
+    step_++;
+    group_ = (group_ + step_) & group_mask_;
+  }
+
+  void find_candidates()
+  {
+    /* There is always at least one empty slot, so this terminates. */
+    while (true) {
+      candidates_ = GroupProbingStrategy::match_tag_or_empty(controls_ + group_ * group_size,
+                                                             tag_);
+      if (candidates_ != 0) {
+        return;
+      }
+      this->next_group();
+    }
+  }
+};
+
+/**
+ * Types used by a hash table to support any probing strategy. Only GroupProbingStrategy
+ * actually needs controls.
+ */
+template<typename ProbingStrategy, typename Allocator>
+using ProbingControls = std::conditional_t<is_group_probing_strategy_v<ProbingStrategy>,
+                                           GroupProbingControls<Allocator>,
+                                           NoProbingControls<Allocator>>;
+template<typename ProbingStrategy>
+using ProbingCursor = std::conditional_t<is_group_probing_strategy_v<ProbingStrategy>,
+                                         GroupProbingCursor,
+                                         SlotProbingCursor<ProbingStrategy>>;
+
+}  // namespace blender
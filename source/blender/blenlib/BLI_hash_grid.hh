@@ -0,0 +1,54 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Spatial queries using a uniform grid of cells, whose size is chosen for the query distance.
+ * Only the non-empty cells are stored, in a hash table, so the memory usage is proportional to
+ * the number of points. This is faster than a #KDTree when all points are queried with the same
+ * distance, because building the grid and searching it can be done in parallel.
+ */
+
+#include "BLI_index_mask.hh"
+#include "BLI_math_vec_types.hh"
+#include "BLI_span.hh"
+
+namespace blender::hash_grid {
+
+/**
+ * Find duplicate points in \a range, considering only the points in \a selection.
+ * The result is the same as #BLI_kdtree_3d_calc_duplicates_fast with `use_index_order` enabled,
+ * for a tree containing the selected points inserted with their index:
+ * points are looped over in index order and every point that is not merged yet becomes the
+ * target of all the points within \a range that are not merged yet. Only points whose distance
+ * along an axis is within rounding errors of \a range may be handled differently, because the
+ * tree's result for those depends on its layout.
+ *
+ * \param r_duplicates: An array the size of \a positions. Values of selected points initialized
+ * to -1 are candidates to be merged. Setting the index to its own position in the array prevents
+ * it from being touched, although it can still be used as a target.
+ * Afterwards, merged points contain the index of their target and targets contain their own index.
+ * \returns The number of merges found.
+ */
+int calc_duplicates(Span<float3> positions,
+                    IndexMask selection,
+                    float range,
+                    MutableSpan<int> r_duplicates);
+
+}  // namespace blender::hash_grid
@@ -0,0 +1,78 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Implicit sharing allows multiple owners to use the same data, without copying it. The data is
+ * freed when the last user is removed. Users that want to modify the data have to make sure
+ * that they are the only user first, otherwise they have to make a copy and remove their user
+ * from the shared data ("copy-on-write").
+ */
+
+#include <atomic>
+
+#include "BLI_assert.h"
+#include "BLI_utility_mixins.hh"
+
+namespace blender {
+
+/**
+ * The user count of shared data, which is usually allocated together with the data it owns.
+ * Subclasses define how the data and the sharing info itself are freed.
+ */
+class ImplicitSharingInfo : NonCopyable, NonMovable {
+ private:
+  mutable std::atomic<int> users_;
+
+ public:
+  ImplicitSharingInfo(const int initial_users) : users_(initial_users)
+  {
+  }
+
+  virtual ~ImplicitSharingInfo()
+  {
+    BLI_assert(users_ <= 1);
+  }
+
+  /** True when there is more than one user, so the data must not be modified. */
+  bool is_shared() const
+  {
+    return users_.load(std::memory_order_acquire) >= 2;
+  }
+
+  void add_user() const
+  {
+    users_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /** Remove a user and free the data together with the sharing info when it was the last. */
+  void remove_user_and_delete_if_last() const
+  {
+    const int old_users = users_.fetch_sub(1, std::memory_order_acq_rel);
+    BLI_assert(old_users >= 1);
+    if (old_users == 1) {
+      const_cast<ImplicitSharingInfo *>(this)->delete_self_with_data();
+    }
+  }
+
+ private:
+  virtual void delete_self_with_data() = 0;
+};
+
+}  // namespace blender
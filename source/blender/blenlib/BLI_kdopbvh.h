@@ -97,12 +97,22 @@ enum {
   /* Use a priority queue to process nodes in the optimal order (for slow callbacks) */
   BVH_NEAREST_OPTIMAL_ORDER = (1 << 0),
 };
+enum {
+  /**
+   * Split nodes based on the surface area heuristic instead of building a balanced tree.
+   * Building is slower, but queries are faster, especially for unevenly distributed elements.
+   * Only used for k-DOP types that include the x, y and z axis.
+   */
+  BVH_BUILD_SAH = (1 << 0),
+};
 enum {
   /* calculate IsectRayPrecalc data */
   BVH_RAYCAST_WATERTIGHT = (1 << 0),
 };
 #define BVH_RAYCAST_DEFAULT (BVH_RAYCAST_WATERTIGHT)
 #define BVH_RAYCAST_DIST_MAX (FLT_MAX / 2.0f)
+/** Number of rays that are traversed together by #BLI_bvhtree_ray_cast_batch. */
+#define BVH_RAY_PACKET_SIZE 4
 
 /**
  * Callback must update nearest in case it finds a nearest result.
@@ -163,6 +173,10 @@ typedef bool (*BVHTree_WalkOrderCallback)(const BVHTreeAxisRange *bounds,
  * \note many callers don't check for `NULL` return.
  */
 BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis);
+/**
+ * \param flag: #BVH_BUILD_SAH etc.
+ */
+BVHTree *BLI_bvhtree_new_ex(int maxsize, float epsilon, char tree_type, char axis, int flag);
 void BLI_bvhtree_free(BVHTree *tree);
 
 /**
@@ -224,6 +238,13 @@ float BLI_bvhtree_get_epsilon(const BVHTree *tree);
  * This function returns the bounding box of the BVH tree.
  */
 void BLI_bvhtree_get_bounding_box(BVHTree *tree, float r_bb_min[3], float r_bb_max[3]);
+/**
+ * Sum of the surface areas of all branches relative to the surface area of the root. Rays and
+ * queries have to visit more branches when this grows, so it can be compared with the value of a
+ * freshly built tree to decide when refitting with #BLI_bvhtree_update_tree degraded the tree
+ * enough that it should be rebuilt instead. Trees without any area give 1.
+ */
+float BLI_bvhtree_get_branch_area_ratio(const BVHTree *tree);
 
 /**
  * Find nearest node to the given coordinates
@@ -242,6 +263,22 @@ int BLI_bvhtree_find_nearest(BVHTree *tree,
                              BVHTree_NearestPointCallback callback,
                              void *userdata);
 
+/**
+ * Find the nearest node for many coordinates. This gives the same result as calling
+ * #BLI_bvhtree_find_nearest_ex for every coordinate, but is faster because nearby coordinates
+ * are processed one after another, which allows using the previous result to prune the search.
+ *
+ * \param nearest: One element per coordinate. Like for #BLI_bvhtree_find_nearest_ex, only nodes
+ * closer than the initial `dist_sq` are found, so it has to be initialized by the caller.
+ */
+void BLI_bvhtree_find_nearest_batch(BVHTree *tree,
+                                    const float (*co)[3],
+                                    int co_num,
+                                    BVHTreeNearest *nearest,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    int flag);
+
 /**
  * Find the first node nearby.
  * Favors speed over quality since it doesn't find the best target node.
@@ -268,6 +305,26 @@ int BLI_bvhtree_ray_cast(BVHTree *tree,
                          BVHTree_RayCastCallback callback,
                          void *userdata);
 
+/**
+ * Cast many rays. This gives the same result as calling #BLI_bvhtree_ray_cast_ex for every ray,
+ * but is faster for large numbers of rays. Rays with similar origins and directions are traversed
+ * together in packets of #BVH_RAY_PACKET_SIZE rays, testing every node against all of them at
+ * once.
+ *
+ * \param hits: One element per ray. It has to be initialized like the hit passed to
+ * #BLI_bvhtree_ray_cast_ex, its distance limits the length of the ray.
+ * \note The rays are not processed in the order they are given.
+ */
+void BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                                const float (*origins)[3],
+                                const float (*directions)[3],
+                                int rays_num,
+                                float radius,
+                                BVHTreeRayHit *hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                int flag);
+
 /**
  * Calls the callback for every ray intersection
  *
@@ -44,7 +44,9 @@
  * - Key and Value must be movable types.
  * - Pointers to keys and values might be invalidated when the map is changed or moved.
  * - The hash function can be customized. See BLI_hash.hh for details.
- * - The probing strategy can be customized. See BLI_probing_strategies.hh for details.
+ * - The probing strategy can be customized. See BLI_probing_strategies.hh for details. Passing
+ *   GroupProbingStrategy makes the map store an additional control byte per slot, which are
+ *   compared 16 at a time during lookups.
  * - The slot type can be customized. See BLI_map_slots.hh for details.
  * - Small buffer optimization is enabled by default, if Key and Value are not too large.
  * - The methods `add_new` and `remove_contained` should be used instead of `add` and `remove`
@@ -70,6 +72,7 @@
 #include <unordered_map>
 
 #include "BLI_array.hh"
+#include "BLI_group_probing.hh"
 #include "BLI_hash.hh"
 #include "BLI_hash_tables.hh"
 #include "BLI_map_slots.hh"
@@ -162,11 +165,19 @@ class Map {
    */
   SlotArray slots_;
 
+  /**
+   * Additional per-slot state that is only used by some probing strategies (currently
+   * GroupProbingStrategy). It has to be kept in sync with the slots.
+   */
+  using Controls = ProbingControls<ProbingStrategy, Allocator>;
+  Controls controls_;
+
   /** Iterate over a slot index sequence for a given hash. */
 #define MAP_SLOT_PROBING_BEGIN(HASH, R_SLOT) \
-  SLOT_PROBING_BEGIN (ProbingStrategy, HASH, slot_mask_, SLOT_INDEX) \
-    auto &R_SLOT = slots_[SLOT_INDEX];
-#define MAP_SLOT_PROBING_END() SLOT_PROBING_END()
+  for (ProbingCursor<ProbingStrategy> probing_cursor(HASH, slot_mask_, controls_);; \
+       probing_cursor.next()) { \
+    auto &R_SLOT = slots_[probing_cursor.slot_index()];
+#define MAP_SLOT_PROBING_END() }
 
  public:
   /**
@@ -181,7 +192,8 @@ class Map {
         slot_mask_(0),
         hash_(),
         is_equal_(),
-        slots_(1, allocator)
+        slots_(1, allocator),
+        controls_(allocator)
   {
   }
 
@@ -210,6 +222,7 @@ class Map {
     }
     removed_slots_ = other.removed_slots_;
     occupied_and_removed_slots_ = other.occupied_and_removed_slots_;
+    controls_ = std::move(other.controls_);
     usable_slots_ = other.usable_slots_;
     slot_mask_ = other.slot_mask_;
     hash_ = std::move(other.hash_);
@@ -344,8 +357,7 @@ class Map {
     if (slot == nullptr) {
       return false;
     }
-    slot->remove();
-    removed_slots_++;
+    this->remove_slot(*slot);
     return true;
   }
 
@@ -360,8 +372,7 @@ class Map {
   template<typename ForwardKey> void remove_contained_as(const ForwardKey &key)
   {
     Slot &slot = this->lookup_slot(key, hash_(key));
-    slot.remove();
-    removed_slots_++;
+    this->remove_slot(slot);
   }
 
   /**
@@ -376,8 +387,7 @@ class Map {
   {
     Slot &slot = this->lookup_slot(key, hash_(key));
     Value value = std::move(*slot.value());
-    slot.remove();
-    removed_slots_++;
+    this->remove_slot(slot);
     return value;
   }
 
@@ -396,8 +406,7 @@ class Map {
       return {};
     }
     std::optional<Value> value = std::move(*slot->value());
-    slot->remove();
-    removed_slots_++;
+    this->remove_slot(*slot);
     return value;
   }
 
@@ -421,8 +430,7 @@ class Map {
       return Value(std::forward<ForwardValue>(default_value)...);
     }
     Value value = std::move(*slot->value());
-    slot->remove();
-    removed_slots_++;
+    this->remove_slot(*slot);
     return value;
   }
 
@@ -896,8 +904,7 @@ class Map {
   {
     Slot &slot = iterator.current_slot();
     BLI_assert(slot.is_occupied());
-    slot.remove();
-    removed_slots_++;
+    this->remove_slot(slot);
   }
 
   /**
@@ -957,7 +964,7 @@ class Map {
    */
   int64_t size_in_bytes() const
   {
-    return static_cast<int64_t>(sizeof(Slot) * slots_.size());
+    return static_cast<int64_t>(sizeof(Slot) * slots_.size()) + controls_.size_in_bytes();
   }
 
   /**
@@ -1003,6 +1010,7 @@ class Map {
     if (this->size() == 0) {
       try {
         slots_.reinitialize(total_slots);
+        controls_.reinitialize(total_slots);
       }
       catch (...) {
         this->noexcept_reset();
@@ -1018,13 +1026,16 @@ class Map {
     SlotArray new_slots(total_slots);
 
     try {
+      Controls new_controls(slots_.allocator());
+      new_controls.reinitialize(total_slots);
       for (Slot &slot : slots_) {
         if (slot.is_occupied()) {
-          this->add_after_grow(slot, new_slots, new_slot_mask);
+          this->add_after_grow(slot, new_slots, new_controls, new_slot_mask);
           slot.remove();
         }
       }
       slots_ = std::move(new_slots);
+      controls_ = std::move(new_controls);
     }
     catch (...) {
       this->noexcept_reset();
@@ -1037,17 +1048,35 @@ class Map {
     slot_mask_ = new_slot_mask;
   }
 
-  void add_after_grow(Slot &old_slot, SlotArray &new_slots, uint64_t new_slot_mask)
+  void add_after_grow(Slot &old_slot,
+                      SlotArray &new_slots,
+                      Controls &new_controls,
+                      uint64_t new_slot_mask)
   {
     uint64_t hash = old_slot.get_hash(Hash());
-    SLOT_PROBING_BEGIN (ProbingStrategy, hash, new_slot_mask, slot_index) {
+    for (ProbingCursor<ProbingStrategy> probing_cursor(hash, new_slot_mask, new_controls);;
+         probing_cursor.next()) {
+      const int64_t slot_index = probing_cursor.slot_index();
       Slot &slot = new_slots[slot_index];
       if (slot.is_empty()) {
         slot.occupy(std::move(*old_slot.key()), hash, std::move(*old_slot.value()));
+        new_controls.occupy(slot_index, hash);
         return;
       }
     }
-    SLOT_PROBING_END();
+  }
+
+  /** Has to be called after a slot has been occupied, to keep the controls in sync. */
+  void occupy_control(const Slot &slot, const uint64_t hash)
+  {
+    controls_.occupy(&slot - slots_.data(), hash);
+  }
+
+  void remove_slot(Slot &slot)
+  {
+    slot.remove();
+    controls_.remove(&slot - slots_.data());
+    removed_slots_++;
   }
 
   void noexcept_reset() noexcept
@@ -1067,6 +1096,7 @@ class Map {
     MAP_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.is_empty()) {
         slot.occupy(std::forward<ForwardKey>(key), hash, std::forward<ForwardValue>(value)...);
+        this->occupy_control(slot, hash);
         occupied_and_removed_slots_++;
         return;
       }
@@ -1082,6 +1112,7 @@ class Map {
     MAP_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.is_empty()) {
         slot.occupy(std::forward<ForwardKey>(key), hash, std::forward<ForwardValue>(value)...);
+        this->occupy_control(slot, hash);
         occupied_and_removed_slots_++;
         return true;
       }
@@ -1111,12 +1142,14 @@ class Map {
         if constexpr (std::is_void_v<CreateReturnT>) {
           create_value(value_ptr);
           slot.occupy_no_value(std::forward<ForwardKey>(key), hash);
+          this->occupy_control(slot, hash);
           occupied_and_removed_slots_++;
           return;
         }
         else {
           auto &&return_value = create_value(value_ptr);
           slot.occupy_no_value(std::forward<ForwardKey>(key), hash);
+          this->occupy_control(slot, hash);
           occupied_and_removed_slots_++;
           return return_value;
         }
@@ -1137,6 +1170,7 @@ class Map {
     MAP_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.is_empty()) {
         slot.occupy(std::forward<ForwardKey>(key), hash, create_value());
+        this->occupy_control(slot, hash);
         occupied_and_removed_slots_++;
         return *slot.value();
       }
@@ -1155,6 +1189,7 @@ class Map {
     MAP_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.is_empty()) {
         slot.occupy(std::forward<ForwardKey>(key), hash, std::forward<ForwardValue>(value)...);
+        this->occupy_control(slot, hash);
         occupied_and_removed_slots_++;
         return *slot.value();
       }
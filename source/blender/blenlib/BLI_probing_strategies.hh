@@ -38,7 +38,12 @@
  * This is necessary for correctness. If this is not the case, empty slots might not be found.
  *
  * The SLOT_PROBING_BEGIN and SLOT_PROBING_END macros can be used to implement a loop that iterates
- * over a probing sequence.
+ * over a probing sequence. SlotProbingCursor does the same, but as an object.
+ *
+ * GroupProbingStrategy is different from the other strategies. It does not produce a sequence
+ * of slot indices on its own. Instead, a hash table using it stores an additional control byte
+ * per slot (see GroupProbingControls in BLI_group_probing.hh) and GroupProbingCursor compares 16 of them at once to only
+ * visit slots that may contain the key or that are empty.
  *
  * Probing strategies can be evaluated with many different criteria. Different use cases often
  * have different optimal strategies. Examples:
@@ -53,7 +58,14 @@
  *   probing might work best.
  */
 
+#include <type_traits>
+
 #include "BLI_sys_types.h"
+#include "BLI_utildefines.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
 
 namespace blender {
 
@@ -212,6 +224,101 @@ template<uint64_t LinearSteps = 2, bool PreShuffle = false> class ShuffleProbing
  */
 using DefaultProbingStrategy = PythonProbingStrategy<>;
 
+/**
+ * Iterates over the slot indices produced by a probing strategy, including its linear steps.
+ * This is the same sequence as the one of SLOT_PROBING_BEGIN, but it can be used by hash tables
+ * that also support GroupProbingStrategy. The controls are ignored.
+ */
+template<typename ProbingStrategy> class SlotProbingCursor {
+ private:
+  ProbingStrategy probing_strategy_;
+  uint64_t current_hash_;
+  uint64_t slot_mask_;
+  int64_t linear_offset_ = 0;
+
+ public:
+  template<typename Controls>
+  SlotProbingCursor(const uint64_t hash, const uint64_t slot_mask, const Controls &UNUSED(controls))
+      : probing_strategy_(hash), current_hash_(probing_strategy_.get()), slot_mask_(slot_mask)
+  {
+  }
+
+  int64_t slot_index() const
+  {
+    return static_cast<int64_t>((current_hash_ + static_cast<uint64_t>(linear_offset_)) &
+                                slot_mask_);
+  }
+
+  void next()
+  {
+    if (++linear_offset_ >= probing_strategy_.linear_steps()) {
+      probing_strategy_.next();
+      current_hash_ = probing_strategy_.get();
+      linear_offset_ = 0;
+    }
+  }
+};
+
+/**
+ * Probing in groups of 16 slots, similar to "Swiss tables". Every slot has a control byte that is
+ * either empty, removed or a 7 bit tag computed from the hash of the key in the slot. Lookups
+ * compare the tag of the key with all control bytes of a group at once (using SSE2 or Neon when
+ * available), so that most slots with other keys don't have to be accessed at all.
+ *
+ * This is mostly useful for large tables with keys that are expensive to compare or to access
+ * (e.g. when the slots don't fit into the cache anymore). It costs one byte per slot.
+ *
+ * Use it by passing it as ProbingStrategy to blender::Map or blender::Set.
+ */
+class GroupProbingStrategy {
+ public:
+  static constexpr int64_t group_size = 16;
+
+  static constexpr uint8_t control_empty = 0x80;
+  static constexpr uint8_t control_removed = 0xfe;
+  /** Used for the unused part of the group, when there are fewer slots than #group_size. */
+  static constexpr uint8_t control_sentinel = 0xff;
+
+  /** Mix the hash, because many hash functions (e.g. for integers) leave the high bits empty. */
+  static uint64_t mix_hash(const uint64_t hash)
+  {
+    const uint64_t mixed = hash * 0x9e3779b97f4a7c15;
+    return mixed ^ (mixed >> 32);
+  }
+
+  /** The tag of an occupied slot, it never has the high bit set. */
+  static uint8_t hash_tag(const uint64_t mixed_hash)
+  {
+    return static_cast<uint8_t>(mixed_hash >> 57);
+  }
+
+  /**
+   * Returns a bit mask with bit i set when control byte i of the group is the given tag or empty.
+   */
+  static uint32_t match_tag_or_empty(const uint8_t *group, const uint8_t tag)
+  {
+#ifdef __SSE2__
+    const __m128i controls = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+    const __m128i matches = _mm_or_si128(
+        _mm_cmpeq_epi8(controls, _mm_set1_epi8(static_cast<char>(tag))),
+        _mm_cmpeq_epi8(controls, _mm_set1_epi8(static_cast<char>(control_empty))));
+    return static_cast<uint32_t>(_mm_movemask_epi8(matches));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < group_size; i++) {
+      if (group[i] == tag || group[i] == control_empty) {
+        mask |= 1u << i;
+      }
+    }
+    return mask;
+#endif
+  }
+};
+
+template<typename ProbingStrategy>
+inline constexpr bool is_group_probing_strategy_v =
+    std::is_same_v<ProbingStrategy, GroupProbingStrategy>;
+
 /* Turning off clang format here, because otherwise it will mess up the alignment between the
  * macros. */
 // clang-format off
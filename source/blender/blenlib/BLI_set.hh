@@ -43,7 +43,9 @@
  * - Key must be a movable type.
  * - Pointers to keys might be invalidated when the set is changed or moved.
  * - The hash function can be customized. See BLI_hash.hh for details.
- * - The probing strategy can be customized. See BLI_probing_stragies.hh for details.
+ * - The probing strategy can be customized. See BLI_probing_stragies.hh for details. Passing
+ *   GroupProbingStrategy makes the set store an additional control byte per slot, which are
+ *   compared 16 at a time during lookups.
  * - The slot type can be customized. See BLI_set_slots.hh for details.
  * - Small buffer optimization is enabled by default, if the key is not too large.
  * - The methods `add_new` and `remove_contained` should be used instead of `add` and `remove`
@@ -72,6 +74,7 @@
 #include <unordered_set>
 
 #include "BLI_array.hh"
+#include "BLI_group_probing.hh"
 #include "BLI_hash.hh"
 #include "BLI_hash_tables.hh"
 #include "BLI_probing_strategies.hh"
@@ -168,11 +171,19 @@ class Set {
    */
   SlotArray slots_;
 
+  /**
+   * Additional per-slot state that is only used by some probing strategies (currently
+   * GroupProbingStrategy). It has to be kept in sync with the slots.
+   */
+  using Controls = ProbingControls<ProbingStrategy, Allocator>;
+  Controls controls_;
+
   /** Iterate over a slot index sequence for a given hash. */
 #define SET_SLOT_PROBING_BEGIN(HASH, R_SLOT) \
-  SLOT_PROBING_BEGIN (ProbingStrategy, HASH, slot_mask_, SLOT_INDEX) \
-    auto &R_SLOT = slots_[SLOT_INDEX];
-#define SET_SLOT_PROBING_END() SLOT_PROBING_END()
+  for (ProbingCursor<ProbingStrategy> probing_cursor(HASH, slot_mask_, controls_);; \
+       probing_cursor.next()) { \
+    auto &R_SLOT = slots_[probing_cursor.slot_index()];
+#define SET_SLOT_PROBING_END() }
 
  public:
   /**
@@ -185,7 +196,8 @@ class Set {
         occupied_and_removed_slots_(0),
         usable_slots_(0),
         slot_mask_(0),
-        slots_(1, allocator)
+        slots_(1, allocator),
+        controls_(allocator)
   {
   }
 
@@ -227,6 +239,7 @@ class Set {
     }
     removed_slots_ = other.removed_slots_;
     occupied_and_removed_slots_ = other.occupied_and_removed_slots_;
+    controls_ = std::move(other.controls_);
     usable_slots_ = other.usable_slots_;
     slot_mask_ = other.slot_mask_;
     hash_ = std::move(other.hash_);
@@ -502,8 +515,7 @@ class Set {
     /* The const cast is valid because this method itself is not const. */
     Slot &slot = const_cast<Slot &>(iterator.current_slot());
     BLI_assert(slot.is_occupied());
-    slot.remove();
-    removed_slots_++;
+    this->remove_slot(slot);
   }
 
   /**
@@ -588,7 +600,7 @@ class Set {
    */
   int64_t size_in_bytes() const
   {
-    return sizeof(Slot) * slots_.size();
+    return sizeof(Slot) * slots_.size() + controls_.size_in_bytes();
   }
 
   /**
@@ -643,6 +655,7 @@ class Set {
     if (this->size() == 0) {
       try {
         slots_.reinitialize(total_slots);
+        controls_.reinitialize(total_slots);
       }
       catch (...) {
         this->noexcept_reset();
@@ -659,13 +672,16 @@ class Set {
     SlotArray new_slots(total_slots);
 
     try {
+      Controls new_controls(slots_.allocator());
+      new_controls.reinitialize(total_slots);
       for (Slot &slot : slots_) {
         if (slot.is_occupied()) {
-          this->add_after_grow(slot, new_slots, new_slot_mask);
+          this->add_after_grow(slot, new_slots, new_controls, new_slot_mask);
           slot.remove();
         }
       }
       slots_ = std::move(new_slots);
+      controls_ = std::move(new_controls);
     }
     catch (...) {
       this->noexcept_reset();
@@ -678,18 +694,36 @@ class Set {
     slot_mask_ = new_slot_mask;
   }
 
-  void add_after_grow(Slot &old_slot, SlotArray &new_slots, const uint64_t new_slot_mask)
+  void add_after_grow(Slot &old_slot,
+                      SlotArray &new_slots,
+                      Controls &new_controls,
+                      const uint64_t new_slot_mask)
   {
     const uint64_t hash = old_slot.get_hash(Hash());
 
-    SLOT_PROBING_BEGIN (ProbingStrategy, hash, new_slot_mask, slot_index) {
+    for (ProbingCursor<ProbingStrategy> probing_cursor(hash, new_slot_mask, new_controls);;
+         probing_cursor.next()) {
+      const int64_t slot_index = probing_cursor.slot_index();
       Slot &slot = new_slots[slot_index];
       if (slot.is_empty()) {
         slot.occupy(std::move(*old_slot.key()), hash);
+        new_controls.occupy(slot_index, hash);
         return;
       }
     }
-    SLOT_PROBING_END();
+  }
+
+  /** Has to be called after a slot has been occupied, to keep the controls in sync. */
+  void occupy_control(const Slot &slot, const uint64_t hash)
+  {
+    controls_.occupy(&slot - slots_.data(), hash);
+  }
+
+  void remove_slot(Slot &slot)
+  {
+    slot.remove();
+    controls_.remove(&slot - slots_.data());
+    removed_slots_++;
   }
 
   /**
@@ -753,6 +787,7 @@ class Set {
     SET_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.is_empty()) {
         slot.occupy(std::forward<ForwardKey>(key), hash);
+        this->occupy_control(slot, hash);
         occupied_and_removed_slots_++;
         return;
       }
@@ -767,6 +802,7 @@ class Set {
     SET_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.is_empty()) {
         slot.occupy(std::forward<ForwardKey>(key), hash);
+        this->occupy_control(slot, hash);
         occupied_and_removed_slots_++;
         return true;
       }
@@ -781,8 +817,7 @@ class Set {
   {
     SET_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.contains(key, is_equal_, hash)) {
-        slot.remove();
-        removed_slots_++;
+        this->remove_slot(slot);
         return true;
       }
       if (slot.is_empty()) {
@@ -799,8 +834,7 @@ class Set {
 
     SET_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.contains(key, is_equal_, hash)) {
-        slot.remove();
-        removed_slots_++;
+        this->remove_slot(slot);
         return;
       }
     }
@@ -818,6 +852,7 @@ class Set {
       }
       if (slot.is_empty()) {
         slot.occupy(std::forward<ForwardKey>(key), hash);
+        this->occupy_control(slot, hash);
         occupied_and_removed_slots_++;
         return *slot.key();
       }
@@ -359,7 +359,8 @@ int BLI_task_parallel_thread_id(const TaskParallelTLS *tls);
  * Any node can be triggered to start a chain of tasks. Normally you would trigger a root node but
  * it is supported to start the chain of tasks anywhere in the forest or tree. When a node
  * completes, the execution flow is forwarded via the created edges.
- * When a child node has multiple parents the child node will be triggered once for each parent.
+ * When a child node has multiple parents the child node will be triggered once all its parents
+ * have finished.
  *
  *    `BLI_task_graph_node_push_work(root);`
  *
@@ -393,6 +394,36 @@ int BLI_task_parallel_thread_id(const TaskParallelTLS *tls);
  * TaskNode *node_3 = BLI_task_graph_node_create(task_graph, node_exec, task_data, NULL);
  * TaskNode *node_4 = BLI_task_graph_node_create(task_graph, node_exec, task_data, NULL);
  * \endcode
+ *
+ * Priorities
+ * ----------
+ *
+ * When more nodes are ready to run than there are threads available, nodes with
+ * #TASK_PRIORITY_HIGH (the default) are executed before nodes with #TASK_PRIORITY_LOW.
+ * The priority passed to #BLI_task_graph_create_ex is the priority of the graph as a whole
+ * compared to other task pools, so interactive work can go ahead of background jobs.
+ *
+ * Dynamic Nodes
+ * -------------
+ *
+ * Nodes can be created and pushed while the graph is being executed, for example from the run
+ * function of another node. Edges can be added as long as the run function of `from_node` did
+ * not return yet, which allows a running node to add follow-up work that is started when it is
+ * done. Edges added to a node after that are only followed the next time it runs.
+ *
+ * Cancellation
+ * ------------
+ *
+ * #BLI_task_graph_cancel and the optional cancel token (typically the `stop` flag of a job) make
+ * the graph skip all nodes that did not start yet. Long running nodes can poll
+ * #BLI_task_graph_is_canceled to stop early. The cancellation is cleared when
+ * #BLI_task_graph_work_and_wait returns, the cancel token is not changed.
+ *
+ * Statistics
+ * ----------
+ *
+ * Every node keeps track of how often it ran and how long that took. These can be queried per
+ * node or accumulated for the whole graph, after #BLI_task_graph_work_and_wait.
  * \{ */
 
 struct TaskGraph;
@@ -401,15 +432,42 @@ struct TaskNode;
 typedef void (*TaskGraphNodeRunFunction)(void *__restrict task_data);
 typedef void (*TaskGraphNodeFreeFunction)(void *task_data);
 
+typedef struct TaskGraphStats {
+  /** Number of nodes the statistics are accumulated over. */
+  int nodes_num;
+  /** Number of times nodes were executed. */
+  int run_count;
+  /** Number of times nodes were skipped because the graph was canceled. */
+  int skip_count;
+  /** Total and longest execution time of a single node, in seconds. */
+  double time_total;
+  double time_max;
+} TaskGraphStats;
+
 struct TaskGraph *BLI_task_graph_create(void);
+struct TaskGraph *BLI_task_graph_create_ex(eTaskPriority priority);
 void BLI_task_graph_work_and_wait(struct TaskGraph *task_graph);
 void BLI_task_graph_free(struct TaskGraph *task_graph);
+/**
+ * Skip all nodes that did not start yet, until #BLI_task_graph_work_and_wait returns.
+ * Can be called from any thread, including from the run function of a node.
+ */
+void BLI_task_graph_cancel(struct TaskGraph *task_graph);
+/**
+ * Skip all nodes that did not start yet while `*cancel_token` is non-zero.
+ * The token must stay valid for as long as the graph is executed, pass NULL to clear it.
+ */
+void BLI_task_graph_cancel_token_set(struct TaskGraph *task_graph, const short *cancel_token);
+bool BLI_task_graph_is_canceled(const struct TaskGraph *task_graph);
 struct TaskNode *BLI_task_graph_node_create(struct TaskGraph *task_graph,
                                             TaskGraphNodeRunFunction run,
                                             void *user_data,
                                             TaskGraphNodeFreeFunction free_func);
+void BLI_task_graph_node_priority_set(struct TaskNode *task_node, eTaskPriority priority);
 bool BLI_task_graph_node_push_work(struct TaskNode *task_node);
 void BLI_task_graph_edge_create(struct TaskNode *from_node, struct TaskNode *to_node);
+void BLI_task_graph_node_stats_get(const struct TaskNode *task_node, TaskGraphStats *r_stats);
+void BLI_task_graph_stats_get(struct TaskGraph *task_graph, TaskGraphStats *r_stats);
 
 /** \} */
 
@@ -30,8 +30,10 @@
  *
  * - Ray-cast:
  *   #BLI_bvhtree_ray_cast, #BVHRayCastData
+ * - Batched ray-cast in packets:
+ *   #BLI_bvhtree_ray_cast_batch, #BVHRayPacket
  * - Nearest point on surface:
- *   #BLI_bvhtree_find_nearest, #BVHNearestData
+ *   #BLI_bvhtree_find_nearest, #BLI_bvhtree_find_nearest_batch, #BVHNearestData
  * - Overlapping 2 trees:
  *   #BLI_bvhtree_overlap, #BVHOverlapData_Shared, #BVHOverlapData_Thread
  * - Range Query:
@@ -100,11 +102,12 @@ struct BVHTree {
   axis_t start_axis, stop_axis; /* bvhtree_kdop_axes array indices according to axis */
   axis_t axis;                  /* KDOP type (6 => OBB, 7 => AABB, ...) */
   char tree_type;               /* type of tree (4 => quad-tree). */
+  char build_flag;              /* #BVH_BUILD_SAH etc. */
 };
 
 /* optimization, ensure we stay small */
-BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 48) ||
-                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 32),
+BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 56) ||
+                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 36),
                   "over sized")
 
 /* avoid duplicating vars in BVHOverlapData_Thread */
@@ -863,11 +866,245 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Surface Area Heuristic Build
+ *
+ * Alternative to the implicit tree build for #BVH_BUILD_SAH. Leafs are split where the sum of
+ * the surface areas of both parts, weighted by their number of leafs, is smallest. The candidate
+ * splits are found by sorting the leaf centers into a fixed number of bins per axis, which is
+ * much faster than trying every position. Binary splits are repeated until a branch has
+ * `tree_type` children.
+ *
+ * The resulting tree is not balanced, but uses tighter bounds for unevenly distributed leafs,
+ * which makes queries faster.
+ * \{ */
+
+#define BVH_SAH_BINS 16
+
+typedef struct BVHSAHBuildData {
+  BVHTree *tree;
+  /** The leafs, the order is changed so that every branch references a contiguous range. */
+  BVHNode **leafs;
+  int branches_num;
+} BVHSAHBuildData;
+
+static float sah_bounds_area(const float bounds[6])
+{
+  const float size_x = bounds[1] - bounds[0];
+  const float size_y = bounds[3] - bounds[2];
+  const float size_z = bounds[5] - bounds[4];
+  return size_x * size_y + size_y * size_z + size_z * size_x;
+}
+
+static void sah_bounds_init(float bounds[6])
+{
+  for (int axis = 0; axis < 3; axis++) {
+    bounds[2 * axis] = FLT_MAX;
+    bounds[2 * axis + 1] = -FLT_MAX;
+  }
+}
+
+static void sah_bounds_add(float bounds[6], const float bv[6])
+{
+  for (int axis = 0; axis < 3; axis++) {
+    bounds[2 * axis] = min_ff(bounds[2 * axis], bv[2 * axis]);
+    bounds[2 * axis + 1] = max_ff(bounds[2 * axis + 1], bv[2 * axis + 1]);
+  }
+}
+
+BLI_INLINE float sah_leaf_center(const BVHNode *leaf, const int axis)
+{
+  return (leaf->bv[2 * axis] + leaf->bv[2 * axis + 1]) * 0.5f;
+}
+
+BLI_INLINE int sah_leaf_bin(const BVHNode *leaf,
+                            const int axis,
+                            const float center_min,
+                            const float scale)
+{
+  const int bin = (int)((sah_leaf_center(leaf, axis) - center_min) * scale);
+  return min_ii(bin, BVH_SAH_BINS - 1);
+}
+
+/**
+ * Partition the leafs in the range at the split with the lowest cost.
+ * \return The index of the first leaf of the second part.
+ */
+static int sah_split_leafs(BVHNode **leafs, const int begin, const int end)
+{
+  float center_min[3], center_max[3];
+  INIT_MINMAX(center_min, center_max);
+  for (int i = begin; i < end; i++) {
+    for (int axis = 0; axis < 3; axis++) {
+      const float center = sah_leaf_center(leafs[i], axis);
+      center_min[axis] = min_ff(center_min[axis], center);
+      center_max[axis] = max_ff(center_max[axis], center);
+    }
+  }
+
+  int best_axis = -1;
+  int best_bin = 0;
+  float best_cost = FLT_MAX;
+  float best_scale = 0.0f;
+
+  for (int axis = 0; axis < 3; axis++) {
+    const float extent = center_max[axis] - center_min[axis];
+    if (!(extent > 0.0f)) {
+      continue;
+    }
+    const float scale = (float)BVH_SAH_BINS / extent;
+
+    int bin_count[BVH_SAH_BINS] = {0};
+    float bin_bounds[BVH_SAH_BINS][6];
+    for (int bin = 0; bin < BVH_SAH_BINS; bin++) {
+      sah_bounds_init(bin_bounds[bin]);
+    }
+    for (int i = begin; i < end; i++) {
+      const int bin = sah_leaf_bin(leafs[i], axis, center_min[axis], scale);
+      bin_count[bin]++;
+      sah_bounds_add(bin_bounds[bin], leafs[i]->bv);
+    }
+
+    /* Cost of the right side when splitting before every bin. */
+    float right_cost[BVH_SAH_BINS];
+    float bounds[6];
+    sah_bounds_init(bounds);
+    int count = 0;
+    for (int bin = BVH_SAH_BINS - 1; bin > 0; bin--) {
+      sah_bounds_add(bounds, bin_bounds[bin]);
+      count += bin_count[bin];
+      right_cost[bin] = (count > 0) ? sah_bounds_area(bounds) * (float)count : 0.0f;
+    }
+
+    sah_bounds_init(bounds);
+    count = 0;
+    for (int bin = 1; bin < BVH_SAH_BINS; bin++) {
+      sah_bounds_add(bounds, bin_bounds[bin - 1]);
+      count += bin_count[bin - 1];
+      if (count == 0 || count == end - begin) {
+        continue;
+      }
+      const float cost = sah_bounds_area(bounds) * (float)count + right_cost[bin];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin = bin;
+        best_scale = scale;
+      }
+    }
+  }
+
+  if (best_axis == -1) {
+    /* All leafs have the same center, any split is as good as another. */
+    return (begin + end) / 2;
+  }
+
+  int i = begin;
+  int j = end - 1;
+  while (i <= j) {
+    if (sah_leaf_bin(leafs[i], best_axis, center_min[best_axis], best_scale) < best_bin) {
+      i++;
+    }
+    else {
+      SWAP(BVHNode *, leafs[i], leafs[j]);
+      j--;
+    }
+  }
+  return i;
+}
+
+static BVHNode *sah_build_branch(BVHSAHBuildData *data,
+                                 const int begin,
+                                 const int end,
+                                 BVHNode *parent)
+{
+  BVHTree *tree = data->tree;
+  /* Branches are allocated before their children, #BLI_bvhtree_update_tree relies on children
+   * having a larger index than their parent. */
+  BVHNode *node = &tree->nodearray[tree->totleaf + data->branches_num];
+  data->branches_num++;
+  node->parent = parent;
+
+  /* Split the child with the most leafs until there are enough children. The children stay
+   * ordered along the split axes, which is used to pick the traversal order in queries. */
+  int child_begin[MAX_TREETYPE + 1];
+  int children_num = 1;
+  child_begin[0] = begin;
+  child_begin[1] = end;
+  while (children_num < tree->tree_type) {
+    int largest = 0;
+    for (int k = 1; k < children_num; k++) {
+      if (child_begin[k + 1] - child_begin[k] > child_begin[largest + 1] - child_begin[largest]) {
+        largest = k;
+      }
+    }
+    if (child_begin[largest + 1] - child_begin[largest] <= 1) {
+      break;
+    }
+    const int split = sah_split_leafs(
+        data->leafs, child_begin[largest], child_begin[largest + 1]);
+    for (int k = children_num + 1; k > largest + 1; k--) {
+      child_begin[k] = child_begin[k - 1];
+    }
+    child_begin[largest + 1] = split;
+    children_num++;
+  }
+
+  for (int k = 0; k < children_num; k++) {
+    if (child_begin[k + 1] - child_begin[k] == 1) {
+      node->children[k] = data->leafs[child_begin[k]];
+      node->children[k]->parent = node;
+    }
+    else {
+      node->children[k] = sah_build_branch(data, child_begin[k], child_begin[k + 1], node);
+    }
+  }
+  for (int k = children_num; k < tree->tree_type; k++) {
+    node->children[k] = NULL;
+  }
+  node->totnode = (char)children_num;
+
+  node_join(tree, node);
+  node->main_axis = get_largest_axis(node->bv) / 2;
+  return node;
+}
+
+/**
+ * Build the tree with the surface area heuristic.
+ * \return The number of branches.
+ */
+static int sah_bvh_build(BVHTree *tree)
+{
+  BVHSAHBuildData data = {
+      .tree = tree,
+      .leafs = tree->nodes,
+      .branches_num = 0,
+  };
+  sah_build_branch(&data, 0, tree->totleaf, NULL);
+  return data.branches_num;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
 
+/**
+ * The SAH build needs the axis aligned bounds, which are only stored when the k-DOP axes start
+ * with the x, y and z axis.
+ */
+static bool bvhtree_use_sah_build(const BVHTree *tree)
+{
+  return (tree->build_flag & BVH_BUILD_SAH) && tree->start_axis == 0 && tree->stop_axis >= 3;
+}
+
 BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
+{
+  return BLI_bvhtree_new_ex(maxsize, epsilon, tree_type, axis, 0);
+}
+
+BVHTree *BLI_bvhtree_new_ex(int maxsize, float epsilon, char tree_type, char axis, int flag)
 {
   BVHTree *tree;
   int numnodes, i;
@@ -886,6 +1123,7 @@ BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
     tree->epsilon = epsilon;
     tree->tree_type = tree_type;
     tree->axis = axis;
+    tree->build_flag = (char)flag;
 
     if (axis == 26) {
       tree->start_axis = 0;
@@ -916,6 +1154,10 @@ BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
 
     /* Allocate arrays */
     numnodes = maxsize + implicit_needed_branches(tree_type, maxsize) + tree_type;
+    if (bvhtree_use_sah_build(tree)) {
+      /* An unbalanced tree can need more branches, but never more than one per leaf. */
+      numnodes = maxsize + max_ii(1, maxsize) + tree_type;
+    }
 
     tree->nodes = MEM_callocN(sizeof(BVHNode *) * (size_t)numnodes, "BVHNodes");
     tree->nodebv = MEM_callocN(sizeof(float) * (size_t)(axis * numnodes), "BVHNodeBV");
@@ -958,13 +1200,18 @@ void BLI_bvhtree_balance(BVHTree *tree)
    * (some big bug goes here if its being called more than once per tree) */
   BLI_assert(tree->totbranch == 0);
 
-  /* Build the implicit tree */
-  non_recursive_bvh_div_nodes(
-      tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
+  if (bvhtree_use_sah_build(tree) && tree->totleaf > 1) {
+    tree->totbranch = sah_bvh_build(tree);
+  }
+  else {
+    /* Build the implicit tree */
+    non_recursive_bvh_div_nodes(
+        tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
+    tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
+  }
 
   /* current code expects the branches to be linked to the nodes array
    * we perform that linkage here */
-  tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
   for (int i = 0; i < tree->totbranch; i++) {
     tree->nodes[tree->totleaf + i] = &tree->nodearray[tree->totleaf + i];
   }
@@ -1078,6 +1325,38 @@ void BLI_bvhtree_get_bounding_box(BVHTree *tree, float r_bb_min[3], float r_bb_m
   }
 }
 
+/**
+ * Sum of the products of the extents along every pair of axes of the tree. For trees with 6 axes
+ * this is half the surface area of the bounding box.
+ */
+static float bvhtree_node_area(const BVHTree *tree, const BVHNode *node)
+{
+  float area = 0.0f;
+  for (axis_t axis_a = tree->start_axis; axis_a < tree->stop_axis; axis_a++) {
+    const float size_a = node->bv[2 * axis_a + 1] - node->bv[2 * axis_a];
+    for (axis_t axis_b = (axis_t)(axis_a + 1); axis_b < tree->stop_axis; axis_b++) {
+      area += size_a * (node->bv[2 * axis_b + 1] - node->bv[2 * axis_b]);
+    }
+  }
+  return area;
+}
+
+float BLI_bvhtree_get_branch_area_ratio(const BVHTree *tree)
+{
+  if (tree->totbranch < 2) {
+    return 1.0f;
+  }
+  const float root_area = bvhtree_node_area(tree, tree->nodes[tree->totleaf]);
+  if (!(root_area > 0.0f)) {
+    return 1.0f;
+  }
+  double area_sum = 0.0;
+  for (int i = 0; i < tree->totbranch; i++) {
+    area_sum += (double)bvhtree_node_area(tree, tree->nodes[tree->totleaf + i]);
+  }
+  return (float)(area_sum / (double)root_area);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -2042,6 +2321,339 @@ void BLI_bvhtree_ray_cast_all(BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree_ray_cast_batch / BLI_bvhtree_find_nearest_batch
+ *
+ * Queries are processed in an order where consecutive queries are close to each other, so that
+ * they visit mostly the same nodes. Rays are additionally traversed in packets, where every node
+ * is tested against all rays of the packet at once.
+ *
+ * \{ */
+
+typedef struct BVHBatchQueryKey {
+  uint64_t key;
+  int index;
+} BVHBatchQueryKey;
+
+/** Spread the lower 10 bits of the value so that there are two zero bits between each bit. */
+static uint32_t batch_query_morton_expand(uint32_t value)
+{
+  value &= 0x3FFu;
+  value = (value | (value << 16)) & 0x030000FFu;
+  value = (value | (value << 8)) & 0x0300F00Fu;
+  value = (value | (value << 4)) & 0x030C30C3u;
+  value = (value | (value << 2)) & 0x09249249u;
+  return value;
+}
+
+static int batch_query_key_cmp(const void *a_v, const void *b_v)
+{
+  const BVHBatchQueryKey *a = a_v;
+  const BVHBatchQueryKey *b = b_v;
+  if (a->key < b->key) {
+    return -1;
+  }
+  if (a->key > b->key) {
+    return 1;
+  }
+  /* Keep the order stable, so that the result does not depend on the sorting algorithm. */
+  return (a->index > b->index) - (a->index < b->index);
+}
+
+/**
+ * Order the queries along a Morton curve through their coordinates. When directions are given,
+ * rays pointing into the same octant are grouped first, so that packets contain similar rays.
+ *
+ * \return An array with the query indices in the order they should be processed.
+ */
+static int *batch_query_order(const float (*co)[3], const float (*dir)[3], const int num)
+{
+  int *order = MEM_mallocN(sizeof(*order) * (size_t)num, __func__);
+
+  float min[3], max[3];
+  INIT_MINMAX(min, max);
+  for (int i = 0; i < num; i++) {
+    if (is_finite_v3(co[i])) {
+      minmax_v3v3_v3(min, max, co[i]);
+    }
+  }
+
+  float scale[3];
+  for (int axis = 0; axis < 3; axis++) {
+    const float size = max[axis] - min[axis];
+    scale[axis] = (size > 0.0f && isfinite(size)) ? 1023.0f / size : 0.0f;
+  }
+
+  BVHBatchQueryKey *keys = MEM_mallocN(sizeof(*keys) * (size_t)num, __func__);
+  for (int i = 0; i < num; i++) {
+    uint64_t key = 0;
+    /* Queries with non-finite coordinates can't be placed on the curve, they go last. Converting
+     * them to an unsigned integer would be undefined. */
+    if (is_finite_v3(co[i])) {
+      for (int axis = 0; axis < 3; axis++) {
+        const float cell = clamp_f((co[i][axis] - min[axis]) * scale[axis], 0.0f, 1023.0f);
+        key |= (uint64_t)batch_query_morton_expand((uint32_t)cell) << axis;
+      }
+    }
+    else {
+      key = (uint64_t)0x3FFFFFFF;
+    }
+    if (dir) {
+      const uint64_t octant = (uint64_t)((dir[i][0] < 0.0f) | ((dir[i][1] < 0.0f) << 1) |
+                                         ((dir[i][2] < 0.0f) << 2));
+      key |= octant << 30;
+    }
+    keys[i].key = key;
+    keys[i].index = i;
+  }
+
+  qsort(keys, (size_t)num, sizeof(*keys), batch_query_key_cmp);
+
+  for (int i = 0; i < num; i++) {
+    order[i] = keys[i].index;
+  }
+  MEM_freeN(keys);
+  return order;
+}
+
+/**
+ * Rays that are traversed together. The ray data that is needed to test nodes is stored as
+ * structure of arrays, so that the tests for all rays of the packet are done in loops with a fixed
+ * length that the compiler can vectorize.
+ */
+typedef struct BVHRayPacket {
+  BVHTree_RayCastCallback callback;
+  void *userdata;
+
+  float radius;
+  float origin[3][BVH_RAY_PACKET_SIZE];
+  float idot_axis[3][BVH_RAY_PACKET_SIZE];
+  /** Copy of `hit[i].dist`, unused lanes have a negative distance so that they never hit. */
+  float hit_dist[BVH_RAY_PACKET_SIZE];
+  /** Sum of all ray directions, used to pick the order in which children are visited. */
+  float direction_sum[3];
+
+  int rays_num;
+  BVHTreeRay ray[BVH_RAY_PACKET_SIZE];
+  BVHTreeRayHit hit[BVH_RAY_PACKET_SIZE];
+#ifdef USE_KDOPBVH_WATERTIGHT
+  struct IsectRayPrecalc isect_precalc[BVH_RAY_PACKET_SIZE];
+#endif
+} BVHRayPacket;
+
+/**
+ * Determines the distance that every ray of the packet must travel to hit the bounding volume of
+ * the node. The distance is #FLT_MAX for rays that miss it or already have a closer hit.
+ *
+ * \return True when any ray of the packet may hit something in the node.
+ */
+static bool ray_packet_nearest_hit(const BVHRayPacket *packet,
+                                   const BVHNode *node,
+                                   float r_dist[BVH_RAY_PACKET_SIZE])
+{
+  const float *bv = node->bv;
+  float low[BVH_RAY_PACKET_SIZE], upper[BVH_RAY_PACKET_SIZE];
+
+  for (int i = 0; i < BVH_RAY_PACKET_SIZE; i++) {
+    low[i] = -FLT_MAX;
+    upper[i] = packet->hit_dist[i];
+  }
+  for (int axis = 0; axis < 3; axis++) {
+    const float bv_min = bv[2 * axis] - packet->radius;
+    const float bv_max = bv[2 * axis + 1] + packet->radius;
+    for (int i = 0; i < BVH_RAY_PACKET_SIZE; i++) {
+      const float t1 = (bv_min - packet->origin[axis][i]) * packet->idot_axis[axis][i];
+      const float t2 = (bv_max - packet->origin[axis][i]) * packet->idot_axis[axis][i];
+      low[i] = max_ff(low[i], min_ff(t1, t2));
+      upper[i] = min_ff(upper[i], max_ff(t1, t2));
+    }
+  }
+
+  bool any_hit = false;
+  for (int i = 0; i < BVH_RAY_PACKET_SIZE; i++) {
+    const bool is_hit = (low[i] <= upper[i]) && (upper[i] >= 0.0f) &&
+                        (low[i] < packet->hit_dist[i]);
+    r_dist[i] = is_hit ? low[i] : FLT_MAX;
+    any_hit |= is_hit;
+  }
+  return any_hit;
+}
+
+static void dfs_raycast_packet(BVHRayPacket *packet, const BVHNode *node)
+{
+  float dist[BVH_RAY_PACKET_SIZE];
+  if (!ray_packet_nearest_hit(packet, node, dist)) {
+    return;
+  }
+
+  if (node->totnode == 0) {
+    for (int i = 0; i < packet->rays_num; i++) {
+      if (dist[i] >= packet->hit[i].dist) {
+        continue;
+      }
+      if (packet->callback) {
+        packet->callback(packet->userdata, node->index, &packet->ray[i], &packet->hit[i]);
+      }
+      else {
+        packet->hit[i].index = node->index;
+        packet->hit[i].dist = dist[i];
+        madd_v3_v3v3fl(
+            packet->hit[i].co, packet->ray[i].origin, packet->ray[i].direction, dist[i]);
+      }
+      packet->hit_dist[i] = packet->hit[i].dist;
+    }
+  }
+  else {
+    /* Pick loop direction to dive into the tree (based on the average ray direction and the split
+     * axis), like #dfs_raycast. */
+    if (packet->direction_sum[(int)node->main_axis] > 0.0f) {
+      for (int i = 0; i != node->totnode; i++) {
+        dfs_raycast_packet(packet, node->children[i]);
+      }
+    }
+    else {
+      for (int i = node->totnode - 1; i >= 0; i--) {
+        dfs_raycast_packet(packet, node->children[i]);
+      }
+    }
+  }
+}
+
+static void ray_packet_init(BVHRayPacket *packet,
+                            const float (*origins)[3],
+                            const float (*directions)[3],
+                            const int *indices,
+                            const int rays_num,
+                            const BVHTreeRayHit *hits,
+                            const int flag)
+{
+  packet->rays_num = rays_num;
+  zero_v3(packet->direction_sum);
+
+  for (int i = 0; i < BVH_RAY_PACKET_SIZE; i++) {
+    if (i >= rays_num) {
+      for (int axis = 0; axis < 3; axis++) {
+        packet->origin[axis][i] = 0.0f;
+        packet->idot_axis[axis][i] = 0.0f;
+      }
+      packet->hit_dist[i] = -FLT_MAX;
+      continue;
+    }
+
+    const int index = indices[i];
+    BVHTreeRay *ray = &packet->ray[i];
+    BLI_ASSERT_UNIT_V3(directions[index]);
+    copy_v3_v3(ray->origin, origins[index]);
+    copy_v3_v3(ray->direction, directions[index]);
+    ray->radius = packet->radius;
+    add_v3_v3(packet->direction_sum, ray->direction);
+
+    for (int axis = 0; axis < 3; axis++) {
+      packet->origin[axis][i] = ray->origin[axis];
+      /* Same as in #bvhtree_ray_cast_data_precalc. */
+      packet->idot_axis[axis][i] = (fabsf(ray->direction[axis]) < FLT_EPSILON) ?
+                                       FLT_MAX :
+                                       1.0f / ray->direction[axis];
+    }
+
+#ifdef USE_KDOPBVH_WATERTIGHT
+    if (flag & BVH_RAYCAST_WATERTIGHT) {
+      isect_ray_tri_watertight_v3_precalc(&packet->isect_precalc[i], ray->direction);
+      ray->isect_precalc = &packet->isect_precalc[i];
+    }
+    else {
+      ray->isect_precalc = NULL;
+    }
+#else
+    UNUSED_VARS(flag);
+#endif
+
+    packet->hit[i] = hits[index];
+    packet->hit_dist[i] = hits[index].dist;
+  }
+}
+
+void BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                                const float (*origins)[3],
+                                const float (*directions)[3],
+                                const int rays_num,
+                                const float radius,
+                                BVHTreeRayHit *hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                const int flag)
+{
+  BVHNode *root = tree->nodes[tree->totleaf];
+  if (root == NULL || rays_num == 0) {
+    return;
+  }
+
+  int *order = batch_query_order(origins, directions, rays_num);
+
+  BVHRayPacket packet;
+  packet.callback = callback;
+  packet.userdata = userdata;
+  packet.radius = radius;
+
+  for (int start = 0; start < rays_num; start += BVH_RAY_PACKET_SIZE) {
+    const int packet_size = min_ii(BVH_RAY_PACKET_SIZE, rays_num - start);
+    ray_packet_init(&packet, origins, directions, order + start, packet_size, hits, flag);
+
+    dfs_raycast_packet(&packet, root);
+
+    for (int i = 0; i < packet_size; i++) {
+      hits[order[start + i]] = packet.hit[i];
+    }
+  }
+
+  MEM_freeN(order);
+}
+
+void BLI_bvhtree_find_nearest_batch(BVHTree *tree,
+                                    const float (*co)[3],
+                                    const int co_num,
+                                    BVHTreeNearest *nearest,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    const int flag)
+{
+  if (co_num == 0) {
+    return;
+  }
+
+  int *order = batch_query_order(co, NULL, co_num);
+
+  const BVHTreeNearest *prev_nearest = NULL;
+  for (int i = 0; i < co_num; i++) {
+    const int index = order[i];
+    BVHTreeNearest *query_nearest = &nearest[index];
+
+    /* The previous query was close by, so its result is likely close as well. Using the distance
+     * to it as upper bound prunes most of the tree. The found node is only kept when nothing
+     * closer is found, which is correct because the traversal still visits that node. */
+    if (prev_nearest && prev_nearest->index != -1) {
+      if (callback) {
+        /* Let the callback test the element like any other, it may reject it for this query. */
+        callback(userdata, prev_nearest->index, co[index], query_nearest);
+      }
+      else {
+        const float dist_sq = len_squared_v3v3(co[index], prev_nearest->co);
+        if (dist_sq < query_nearest->dist_sq) {
+          *query_nearest = *prev_nearest;
+          query_nearest->dist_sq = dist_sq;
+        }
+      }
+    }
+
+    BLI_bvhtree_find_nearest_ex(tree, co[index], query_nearest, callback, userdata, flag);
+    prev_nearest = query_nearest;
+  }
+
+  MEM_freeN(order);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_range_query
  *
@@ -143,3 +143,37 @@ FileReader *BLI_filereader_new_mmap(int filedes)
 
   return (FileReader *)mem;
 }
+
+/* Direct access to the underlying memory. */
+
+static bool is_memory_reader(const FileReader *reader)
+{
+  return ELEM(reader->read, memory_read_raw, memory_read_mmap);
+}
+
+const void *BLI_filereader_memory_pointer(FileReader *reader, off64_t offset, size_t size)
+{
+  if (!is_memory_reader(reader)) {
+    return NULL;
+  }
+
+  MemoryReader *mem = (MemoryReader *)reader;
+  if (offset < 0 || (size_t)offset > mem->length || size > mem->length - (size_t)offset) {
+    return NULL;
+  }
+
+  if (mem->mmap == NULL) {
+    return mem->data + offset;
+  }
+  if (BLI_mmap_any_io_error(mem->mmap)) {
+    return NULL;
+  }
+  return (const char *)BLI_mmap_get_pointer(mem->mmap) + offset;
+}
+
+bool BLI_filereader_memory_check(FileReader *reader)
+{
+  BLI_assert(is_memory_reader(reader));
+  MemoryReader *mem = (MemoryReader *)reader;
+  return (mem->mmap == NULL) || !BLI_mmap_any_io_error(mem->mmap);
+}
@@ -28,9 +28,42 @@
 #include "BLI_endian_switch.h"
 #include "BLI_filereader.h"
 #include "BLI_math_base.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
+/* Maximum number of frames that are kept decompressed when seeking is supported.
+ * Frames following the one that is being read are decompressed ahead of time on worker threads,
+ * so that sequential reading does not have to wait for decompression. */
+#define ZSTD_READ_AHEAD_MAX 16
+
+typedef enum eZstdFrameState {
+  /** Nothing stored, or the slot is being refilled. */
+  ZSTD_FRAME_EMPTY = 0,
+  /** Compressed data is loaded, waiting to be decompressed. */
+  ZSTD_FRAME_QUEUED,
+  /** A thread is decompressing the frame. */
+  ZSTD_FRAME_DECODING,
+  ZSTD_FRAME_DONE,
+  ZSTD_FRAME_FAILED,
+} eZstdFrameState;
+
+typedef struct ZstdFrameSlot {
+  /* Only changed by the reading thread, which can read it without the mutex. */
+  int frame;
+  /* #eZstdFrameState, changed with the mutex locked. The reading thread checks it without the
+   * mutex, see #zstd_slot_state. */
+  int32_t state;
+
+  char *compressed_data;
+  size_t compressed_size;
+  char *content;
+  size_t uncompressed_size;
+} ZstdFrameSlot;
+
 typedef struct {
   FileReader reader;
 
@@ -45,8 +78,15 @@ typedef struct {
     size_t *compressed_ofs;
     size_t *uncompressed_ofs;
 
-    char *cached_content;
-    int cached_frame;
+    /* Decompressed frames, frame `i` is always stored in `slots[i % num_slots]`. */
+    ZstdFrameSlot *slots;
+    int num_slots;
+
+    /* Decompresses the frames ahead of the current one, NULL when running single-threaded. */
+    TaskPool *pool;
+    /* Protects the state of the slots. */
+    ThreadMutex mutex;
+    ThreadCondition condition;
   } seek;
 } ZstdReader;
 
@@ -142,11 +182,43 @@ static bool zstd_read_seek_table(ZstdReader *zstd)
     return false;
   }
 
-  zstd->seek.cached_frame = -1;
-
   return true;
 }
 
+static void zstd_init_frame_cache(ZstdReader *zstd)
+{
+  const int num_threads = BLI_task_scheduler_num_threads();
+
+  zstd->seek.num_slots = clamp_i(num_threads, 1, ZSTD_READ_AHEAD_MAX);
+  zstd->seek.slots = MEM_calloc_arrayN(
+      zstd->seek.num_slots, sizeof(ZstdFrameSlot), "zstd frame slots");
+  for (int i = 0; i < zstd->seek.num_slots; i++) {
+    zstd->seek.slots[i].frame = -1;
+  }
+
+  if (zstd->seek.num_slots > 1) {
+    zstd->seek.pool = BLI_task_pool_create(zstd, TASK_PRIORITY_HIGH);
+  }
+  BLI_mutex_init(&zstd->seek.mutex);
+  BLI_condition_init(&zstd->seek.condition);
+}
+
+static void zstd_free_frame_cache(ZstdReader *zstd)
+{
+  if (zstd->seek.pool) {
+    /* Skips frames that weren't started yet, and waits for the ones being decompressed. */
+    BLI_task_pool_cancel(zstd->seek.pool);
+    BLI_task_pool_free(zstd->seek.pool);
+  }
+  for (int i = 0; i < zstd->seek.num_slots; i++) {
+    MEM_SAFE_FREE(zstd->seek.slots[i].compressed_data);
+    MEM_SAFE_FREE(zstd->seek.slots[i].content);
+  }
+  MEM_freeN(zstd->seek.slots);
+  BLI_mutex_end(&zstd->seek.mutex);
+  BLI_condition_end(&zstd->seek.condition);
+}
+
 /* Find out which frame contains the given position in the uncompressed stream.
  * Basically just bisection. */
 static int zstd_frame_from_pos(ZstdReader *zstd, size_t pos)
@@ -170,41 +242,139 @@ static int zstd_frame_from_pos(ZstdReader *zstd, size_t pos)
   return low;
 }
 
-/* Ensure that the currently loaded frame is the correct one. */
-static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
+/* Read the state of a slot without locking the mutex. Workers change it after storing the
+ * content, so the content can be used once the state is #ZSTD_FRAME_DONE. */
+static eZstdFrameState zstd_slot_state(ZstdFrameSlot *slot)
+{
+  return (eZstdFrameState)atomic_fetch_and_add_int32(&slot->state, 0);
+}
+
+/* Decompress a frame whose state was changed to #ZSTD_FRAME_DECODING by the calling thread.
+ * Doesn't need the mutex, no other thread accesses the slot in that state. */
+static void zstd_decompress_frame(ZstdFrameSlot *slot)
+{
+  char *uncompressed_data = MEM_mallocN(slot->uncompressed_size, __func__);
+  size_t res = ZSTD_decompress(
+      uncompressed_data, slot->uncompressed_size, slot->compressed_data, slot->compressed_size);
+  MEM_SAFE_FREE(slot->compressed_data);
+
+  if (ZSTD_isError(res) || res < slot->uncompressed_size) {
+    MEM_freeN(uncompressed_data);
+    uncompressed_data = NULL;
+  }
+  slot->content = uncompressed_data;
+}
+
+/* Decompress the frame stored in the slot, unless another thread already started on it. */
+static void zstd_decompress_slot(ZstdReader *zstd, ZstdFrameSlot *slot, int frame)
+{
+  BLI_mutex_lock(&zstd->seek.mutex);
+  if (slot->frame != frame || slot->state != ZSTD_FRAME_QUEUED) {
+    BLI_mutex_unlock(&zstd->seek.mutex);
+    return;
+  }
+  slot->state = ZSTD_FRAME_DECODING;
+  BLI_mutex_unlock(&zstd->seek.mutex);
+
+  zstd_decompress_frame(slot);
+
+  BLI_mutex_lock(&zstd->seek.mutex);
+  slot->state = slot->content ? ZSTD_FRAME_DONE : ZSTD_FRAME_FAILED;
+  BLI_mutex_unlock(&zstd->seek.mutex);
+  BLI_condition_notify_all(&zstd->seek.condition);
+}
+
+static void zstd_decompress_task(TaskPool *__restrict pool, void *taskdata)
+{
+  ZstdReader *zstd = BLI_task_pool_user_data(pool);
+  const int frame = POINTER_AS_INT(taskdata);
+  zstd_decompress_slot(zstd, &zstd->seek.slots[frame % zstd->seek.num_slots], frame);
+}
+
+/* Load the compressed data of the frame into its slot, evicting what was stored there before.
+ * Only called from the reading thread, which is the only one to use the base reader.
+ * Returns whether the frame needs to be decompressed. */
+static bool zstd_load_frame(ZstdReader *zstd, int frame)
 {
-  if (zstd->seek.cached_frame == frame) {
-    /* Cached frame matches, so just return it. */
-    return zstd->seek.cached_content;
+  ZstdFrameSlot *slot = &zstd->seek.slots[frame % zstd->seek.num_slots];
+
+  /* Frames that are already loaded don't need the mutex, only this thread changes the frame of a
+   * slot. A failed frame is loaded again. */
+  if (slot->frame == frame &&
+      ELEM(zstd_slot_state(slot), ZSTD_FRAME_QUEUED, ZSTD_FRAME_DECODING, ZSTD_FRAME_DONE)) {
+    return false;
   }
 
-  /* Cached frame doesn't match, so discard it and cache the wanted one instead. */
-  MEM_SAFE_FREE(zstd->seek.cached_content);
+  BLI_mutex_lock(&zstd->seek.mutex);
+  while (slot->state == ZSTD_FRAME_DECODING) {
+    BLI_condition_wait(&zstd->seek.condition, &zstd->seek.mutex);
+  }
+  if (slot->frame == frame && slot->state != ZSTD_FRAME_FAILED) {
+    BLI_mutex_unlock(&zstd->seek.mutex);
+    return false;
+  }
+  /* Tasks that are still pending for the previous frame will skip the emptied slot. */
+  slot->state = ZSTD_FRAME_EMPTY;
+  BLI_mutex_unlock(&zstd->seek.mutex);
+
+  MEM_SAFE_FREE(slot->compressed_data);
+  MEM_SAFE_FREE(slot->content);
 
-  size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
-  size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
-                             zstd->seek.uncompressed_ofs[frame];
+  slot->compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
+  slot->uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
+                            zstd->seek.uncompressed_ofs[frame];
+  slot->compressed_data = MEM_mallocN(slot->compressed_size, __func__);
 
-  char *uncompressed_data = MEM_mallocN(uncompressed_size, __func__);
-  char *compressed_data = MEM_mallocN(compressed_size, __func__);
+  eZstdFrameState state = ZSTD_FRAME_QUEUED;
   if (zstd->base->seek(zstd->base, zstd->seek.compressed_ofs[frame], SEEK_SET) < 0 ||
-      zstd->base->read(zstd->base, compressed_data, compressed_size) < compressed_size) {
-    MEM_freeN(compressed_data);
-    MEM_freeN(uncompressed_data);
-    return NULL;
+      zstd->base->read(zstd->base, slot->compressed_data, slot->compressed_size) <
+          slot->compressed_size) {
+    MEM_SAFE_FREE(slot->compressed_data);
+    state = ZSTD_FRAME_FAILED;
   }
 
-  size_t res = ZSTD_decompressDCtx(
-      zstd->ctx, uncompressed_data, uncompressed_size, compressed_data, compressed_size);
-  MEM_freeN(compressed_data);
-  if (ZSTD_isError(res) || res < uncompressed_size) {
-    MEM_freeN(uncompressed_data);
-    return NULL;
+  BLI_mutex_lock(&zstd->seek.mutex);
+  slot->frame = frame;
+  slot->state = state;
+  BLI_mutex_unlock(&zstd->seek.mutex);
+
+  return state == ZSTD_FRAME_QUEUED;
+}
+
+/* Ensure that the given frame is decompressed, and schedule decompression of the following
+ * frames on worker threads. When reading sequentially, the frames are usually decompressed and
+ * scheduled already, the mutex is only locked when a slot has to be changed or waited for. */
+static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
+{
+  zstd_load_frame(zstd, frame);
+
+  if (zstd->seek.pool) {
+    const int last_frame = min_ii(frame + zstd->seek.num_slots, zstd->seek.num_frames) - 1;
+    for (int ahead = frame + 1; ahead <= last_frame; ahead++) {
+      if (zstd_load_frame(zstd, ahead)) {
+        BLI_task_pool_push(
+            zstd->seek.pool, zstd_decompress_task, POINTER_FROM_INT(ahead), false, NULL);
+      }
+    }
+  }
+
+  ZstdFrameSlot *slot = &zstd->seek.slots[frame % zstd->seek.num_slots];
+  if (zstd_slot_state(slot) == ZSTD_FRAME_DONE) {
+    return slot->content;
+  }
+
+  /* Decompress the requested frame on this thread if no worker started on it yet,
+   * otherwise wait for it. */
+  zstd_decompress_slot(zstd, slot, frame);
+
+  BLI_mutex_lock(&zstd->seek.mutex);
+  while (slot->state == ZSTD_FRAME_DECODING) {
+    BLI_condition_wait(&zstd->seek.condition, &zstd->seek.mutex);
   }
+  const char *content = (slot->state == ZSTD_FRAME_DONE) ? slot->content : NULL;
+  BLI_mutex_unlock(&zstd->seek.mutex);
 
-  zstd->seek.cached_frame = frame;
-  zstd->seek.cached_content = uncompressed_data;
-  return uncompressed_data;
+  return content;
 }
 
 static ssize_t zstd_read_seekable(FileReader *reader, void *buffer, size_t size)
@@ -295,9 +465,9 @@ static void zstd_close(FileReader *reader)
 
   ZSTD_freeDCtx(zstd->ctx);
   if (zstd->reader.seek) {
+    zstd_free_frame_cache(zstd);
     MEM_freeN(zstd->seek.uncompressed_ofs);
     MEM_freeN(zstd->seek.compressed_ofs);
-    MEM_freeN(zstd->seek.cached_content);
   }
   else {
     MEM_freeN((void *)zstd->in_buf.src);
@@ -315,6 +485,7 @@ FileReader *BLI_filereader_new_zstd(FileReader *base)
   zstd->base = base;
 
   if (zstd_read_seek_table(zstd)) {
+    zstd_init_frame_cache(zstd);
     zstd->reader.read = zstd_read_seekable;
     zstd->reader.seek = zstd_seek;
   }
@@ -0,0 +1,260 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <algorithm>
+
+#include "atomic_ops.h"
+
+#include "BLI_array.hh"
+#include "BLI_hash_grid.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_task.hh"
+
+namespace blender::hash_grid {
+
+/** The cell coordinates use this many bits per axis, so that a cell fits in a 64 bit key. */
+static constexpr int cell_bits = 21;
+/** Leave room for the neighbors of the cells on the boundary of the grid. */
+static constexpr int64_t max_cells_per_axis = (int64_t(1) << cell_bits) - 2;
+
+namespace {
+
+struct MinMaxResult {
+  float3 min;
+  float3 max;
+};
+
+/**
+ * The selected points, sorted by the bucket of their cell in a hash table.
+ * A bucket can contain points of different cells, so their keys are stored as well.
+ */
+struct PointGrid {
+  double3 min;
+  double cell_size;
+  int bucket_bits;
+  /** The start of every bucket in the arrays below, with an extra entry for the end. */
+  Array<int> bucket_offsets;
+  Array<uint64_t> keys;
+  Array<int> indices;
+  Array<float3> positions;
+
+  /**
+   * The coordinates of the cell containing \a co, offset by one so that the neighbors of every
+   * cell have positive coordinates. The coordinates are computed with doubles, where the
+   * subtraction is exact, so that points closer than the cell size are never more than one cell
+   * apart.
+   */
+  int3 cell(const float3 &co) const
+  {
+    int3 cell;
+    for (int axis = 0; axis < 3; axis++) {
+      const int64_t c = int64_t((double(co[axis]) - min[axis]) / cell_size);
+      cell[axis] = int(std::clamp<int64_t>(c, 0, max_cells_per_axis - 1)) + 1;
+    }
+    return cell;
+  }
+
+  static uint64_t key(const int3 &cell)
+  {
+    return uint64_t(cell.x) | (uint64_t(cell.y) << cell_bits) |
+           (uint64_t(cell.z) << (2 * cell_bits));
+  }
+
+  int bucket(const uint64_t key) const
+  {
+    /* Fibonacci hashing, the higher bits of the product depend on all bits of the key. */
+    return int((key * 0x9E3779B97F4A7C15ull) >> (64 - bucket_bits));
+  }
+
+  /**
+   * Call \a fn with the index of every point in the cells around \a co, which contain at least
+   * all points closer to \a co than the cell size. Stop when \a fn returns false.
+   */
+  template<typename Fn> bool foreach_point_around(const float3 &co, const Fn &fn) const
+  {
+    const int3 center = this->cell(co);
+    for (int z = center.z - 1; z <= center.z + 1; z++) {
+      for (int y = center.y - 1; y <= center.y + 1; y++) {
+        for (int x = center.x - 1; x <= center.x + 1; x++) {
+          const uint64_t cell_key = key(int3(x, y, z));
+          const int bucket = this->bucket(cell_key);
+          for (int i = bucket_offsets[bucket]; i < bucket_offsets[bucket + 1]; i++) {
+            if (keys[i] == cell_key) {
+              if (!fn(indices[i], positions[i])) {
+                return false;
+              }
+            }
+          }
+        }
+      }
+    }
+    return true;
+  }
+};
+
+}  // namespace
+
+static MinMaxResult selection_bounds(Span<float3> positions, IndexMask selection)
+{
+  using namespace blender::math;
+
+  return threading::parallel_reduce(
+      selection.index_range(),
+      1024,
+      MinMaxResult{float3(FLT_MAX), float3(-FLT_MAX)},
+      [&](IndexRange range, const MinMaxResult &init) {
+        MinMaxResult result = init;
+        for (const int i : selection.slice(range)) {
+          min_max(positions[i], result.min, result.max);
+        }
+        return result;
+      },
+      [](const MinMaxResult &a, const MinMaxResult &b) {
+        return MinMaxResult{min(a.min, b.min), max(a.max, b.max)};
+      });
+}
+
+static void build_grid(PointGrid &grid,
+                       Span<float3> positions,
+                       IndexMask selection,
+                       const float range)
+{
+  const MinMaxResult bounds = selection_bounds(positions, selection);
+  const double3 size = double3(bounds.max) - double3(bounds.min);
+  const double max_size = std::max({size.x, size.y, size.z});
+  grid.min = double3(bounds.min);
+  /* Make the cells slightly larger than the range to be safe from rounding errors. Larger cells
+   * are still correct, so limit the number of cells to fit the coordinates in the keys. */
+  grid.cell_size = std::max(double(range) * (1.0 + 1e-6), max_size / double(max_cells_per_axis));
+
+  const int points_num = int(selection.size());
+  grid.bucket_bits = 1;
+  while ((1 << grid.bucket_bits) < points_num && grid.bucket_bits < 30) {
+    grid.bucket_bits++;
+  }
+  const int buckets_num = 1 << grid.bucket_bits;
+
+  Array<uint64_t> point_keys(points_num);
+  Array<int> point_buckets(points_num);
+  Array<int> bucket_sizes(buckets_num, 0);
+  threading::parallel_for(selection.index_range(), 4096, [&](IndexRange range) {
+    for (const int i : range) {
+      point_keys[i] = PointGrid::key(grid.cell(positions[selection[i]]));
+      point_buckets[i] = grid.bucket(point_keys[i]);
+      atomic_add_and_fetch_int32(&bucket_sizes[point_buckets[i]], 1);
+    }
+  });
+
+  grid.bucket_offsets.reinitialize(buckets_num + 1);
+  int offset = 0;
+  for (const int bucket : IndexRange(buckets_num)) {
+    grid.bucket_offsets[bucket] = offset;
+    offset += bucket_sizes[bucket];
+  }
+  grid.bucket_offsets.last() = offset;
+
+  /* The order of the points within a bucket does not matter, so they can be added in parallel.
+   * Reuse the bucket sizes to count the points added to every bucket. */
+  bucket_sizes.fill(0);
+  grid.keys.reinitialize(points_num);
+  grid.indices.reinitialize(points_num);
+  grid.positions.reinitialize(points_num);
+  threading::parallel_for(selection.index_range(), 4096, [&](IndexRange range) {
+    for (const int i : range) {
+      const int bucket = point_buckets[i];
+      const int slot = grid.bucket_offsets[bucket] +
+                       atomic_fetch_and_add_int32(&bucket_sizes[bucket], 1);
+      grid.keys[slot] = point_keys[i];
+      grid.indices[slot] = selection[i];
+      grid.positions[slot] = positions[selection[i]];
+    }
+  });
+}
+
+/**
+ * Points in range have to be closer than \a range along every axis as well, because that is
+ * how the #KDTree decides which nodes to visit. This also means that nothing is merged for a
+ * range of zero.
+ */
+static bool in_range(const float3 &a, const float3 &b, const float range, const float range_sq)
+{
+  const float3 diff = a - b;
+  if (std::abs(diff.x) >= range || std::abs(diff.y) >= range || std::abs(diff.z) >= range) {
+    return false;
+  }
+  return math::length_squared(diff) <= range_sq;
+}
+
+int calc_duplicates(Span<float3> positions,
+                    IndexMask selection,
+                    const float range,
+                    MutableSpan<int> r_duplicates)
+{
+  BLI_assert(r_duplicates.size() == positions.size());
+  if (selection.is_empty() || !(range > 0.0f)) {
+    return 0;
+  }
+  const float range_sq = range * range;
+
+  PointGrid grid;
+  build_grid(grid, positions, selection, range);
+
+  /* Finding the points that have any other point in range is the expensive part and can be done
+   * in parallel. Usually most points have no duplicates and are skipped in the serial loop. */
+  Array<bool> has_neighbor(positions.size(), false);
+  threading::parallel_for(grid.indices.index_range(), 1024, [&](IndexRange slots) {
+    for (const int slot : slots) {
+      const int index = grid.indices[slot];
+      const float3 &co = grid.positions[slot];
+      grid.foreach_point_around(co, [&](const int other, const float3 &other_co) {
+        if (other != index && in_range(co, other_co, range, range_sq)) {
+          has_neighbor[index] = true;
+          return false;
+        }
+        return true;
+      });
+    }
+  });
+
+  /* Merge in index order, like the #KDTree does with `use_index_order`. */
+  int found = 0;
+  for (const int index : selection) {
+    if (!has_neighbor[index] || !ELEM(r_duplicates[index], -1, index)) {
+      continue;
+    }
+    const int found_prev = found;
+    const float3 &co = positions[index];
+    grid.foreach_point_around(co, [&](const int other, const float3 &other_co) {
+      if (other != index && r_duplicates[other] == -1 &&
+          in_range(co, other_co, range, range_sq)) {
+        r_duplicates[other] = index;
+        found++;
+      }
+      return true;
+    });
+    if (found != found_prev) {
+      /* Prevent chains of doubles. */
+      r_duplicates[index] = index;
+    }
+  }
+  return found;
+}
+
+}  // namespace blender::hash_grid
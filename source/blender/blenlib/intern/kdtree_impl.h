@@ -22,6 +22,7 @@
 
 #include "BLI_kdtree_impl.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_strict_flags.h"
 #include "BLI_utildefines.h"
 
@@ -58,6 +59,9 @@ struct KDTree {
 
 #define KD_NODE_UNSET ((uint)-1)
 
+/** Balance sub-trees with at least this many nodes in separate tasks. */
+#define KD_BALANCE_TASK_THRESHOLD 16384
+
 /**
  * When set we know all values are unbalanced,
  * otherwise clear them when re-balancing: see T62210.
@@ -145,19 +149,16 @@ void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS])
 #endif
 }
 
-static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+/**
+ * Reorder \a nodes so that the median node along \a axis is in the middle,
+ * with nodes that are smaller before and nodes that are larger after it.
+ * \return The index of the median.
+ */
+static uint kdtree_balance_partition(KDTreeNode *nodes, uint nodes_len, uint axis)
 {
-  KDTreeNode *node;
   float co;
   uint left, right, median, i, j;
 
-  if (nodes_len <= 0) {
-    return KD_NODE_UNSET;
-  }
-  else if (nodes_len == 1) {
-    return 0 + ofs;
-  }
-
   /* Quick-sort style sorting around median. */
   left = 0;
   right = nodes_len - 1;
@@ -190,6 +191,23 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
     }
   }
 
+  return median;
+}
+
+static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  KDTreeNode *node;
+  uint median;
+
+  if (nodes_len <= 0) {
+    return KD_NODE_UNSET;
+  }
+  else if (nodes_len == 1) {
+    return 0 + ofs;
+  }
+
+  median = kdtree_balance_partition(nodes, nodes_len, axis);
+
   /* Set node and sort sub-nodes. */
   node = &nodes[median];
   node->d = axis;
@@ -201,6 +219,59 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
   return median + ofs;
 }
 
+typedef struct KDTreeBalanceTaskData {
+  KDTreeNode *nodes;
+  uint nodes_len;
+  uint axis;
+  uint ofs;
+  /** Where to store the root of the balanced sub-tree. */
+  uint *r_root;
+} KDTreeBalanceTaskData;
+
+static void kdtree_balance_task(TaskPool *__restrict pool, void *taskdata);
+
+/**
+ * Same as #kdtree_balance, but the left sub-trees of large trees are balanced in tasks
+ * of \a pool. The sub-trees don't share any nodes, and the result is the same.
+ */
+static uint kdtree_balance_parallel(
+    TaskPool *pool, KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  KDTreeNode *node;
+  KDTreeBalanceTaskData *task_data;
+  uint median;
+
+  if (nodes_len < KD_BALANCE_TASK_THRESHOLD) {
+    return kdtree_balance(nodes, nodes_len, axis, ofs);
+  }
+
+  median = kdtree_balance_partition(nodes, nodes_len, axis);
+
+  node = &nodes[median];
+  node->d = axis;
+  axis = (axis + 1) % KD_DIMS;
+
+  task_data = MEM_mallocN(sizeof(*task_data), __func__);
+  task_data->nodes = nodes;
+  task_data->nodes_len = median;
+  task_data->axis = axis;
+  task_data->ofs = ofs;
+  task_data->r_root = &node->left;
+  BLI_task_pool_push(pool, kdtree_balance_task, task_data, true, NULL);
+
+  node->right = kdtree_balance_parallel(
+      pool, nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs);
+
+  return median + ofs;
+}
+
+static void kdtree_balance_task(TaskPool *__restrict pool, void *taskdata)
+{
+  const KDTreeBalanceTaskData *task_data = taskdata;
+  *task_data->r_root = kdtree_balance_parallel(
+      pool, task_data->nodes, task_data->nodes_len, task_data->axis, task_data->ofs);
+}
+
 void BLI_kdtree_nd_(balance)(KDTree *tree)
 {
   if (tree->root != KD_NODE_ROOT_IS_INIT) {
@@ -210,7 +281,15 @@ void BLI_kdtree_nd_(balance)(KDTree *tree)
     }
   }
 
-  tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  if (tree->nodes_len >= KD_BALANCE_TASK_THRESHOLD) {
+    TaskPool *pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+    tree->root = kdtree_balance_parallel(pool, tree->nodes, tree->nodes_len, 0, 0);
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+  }
+  else {
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  }
 
 #ifdef DEBUG
   tree->is_balanced = true;
@@ -600,6 +679,140 @@ int BLI_kdtree_nd_(find_nearest_n)(const KDTree *tree,
       tree, co, r_nearest, nearest_len_capacity, NULL, NULL);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_kdtree_3d_find_nearest_n_batch
+ * \{ */
+
+/** Bits per axis of the keys used to sort the queries, limited to fit in 64 bits. */
+#define KD_QUERY_KEY_BITS MIN2(21u, 63u / KD_DIMS)
+
+typedef struct KDTreeQueryOrder {
+  uint64_t key;
+  uint index;
+} KDTreeQueryOrder;
+
+typedef struct KDTreeNearestNBatchData {
+  const KDTree *tree;
+  const float (*co)[KD_DIMS];
+  const KDTreeQueryOrder *order;
+  KDTreeNearest *r_nearest;
+  uint nearest_len_capacity;
+  int *r_nearest_len;
+} KDTreeNearestNBatchData;
+
+static int kdtree_query_order_cmp(const void *a, const void *b)
+{
+  const KDTreeQueryOrder *qa = a;
+  const KDTreeQueryOrder *qb = b;
+
+  if (qa->key != qb->key) {
+    return qa->key < qb->key ? -1 : 1;
+  }
+  return qa->index < qb->index ? -1 : (qa->index > qb->index ? 1 : 0);
+}
+
+/**
+ * A key that orders the queries along a Z-order curve, so that consecutive queries are close to
+ * each other and mostly visit the same nodes of the tree.
+ */
+static uint64_t kdtree_query_key(const float co[KD_DIMS],
+                                 const float min[KD_DIMS],
+                                 const float scale[KD_DIMS])
+{
+  const float max_cell = (float)((1u << KD_QUERY_KEY_BITS) - 1u);
+  uint cell[KD_DIMS];
+  for (uint j = 0; j < KD_DIMS; j++) {
+    cell[j] = (uint)clamp_f((co[j] - min[j]) * scale[j], 0.0f, max_cell);
+  }
+  uint64_t key = 0;
+  for (uint bit = KD_QUERY_KEY_BITS; bit-- > 0;) {
+    for (uint j = 0; j < KD_DIMS; j++) {
+      key = (key << 1) | ((cell[j] >> bit) & 1u);
+    }
+  }
+  return key;
+}
+
+static void kdtree_find_nearest_n_batch_cb(void *__restrict userdata,
+                                           const int iter,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KDTreeNearestNBatchData *data = userdata;
+  const uint i = data->order[iter].index;
+  const int nearest_len = BLI_kdtree_nd_(find_nearest_n)(
+      data->tree,
+      data->co[i],
+      &data->r_nearest[(size_t)i * data->nearest_len_capacity],
+      data->nearest_len_capacity);
+  if (data->r_nearest_len) {
+    data->r_nearest_len[i] = nearest_len;
+  }
+}
+
+/**
+ * Find the \a nearest_len_capacity nearest points of every one of the \a co_len coordinates,
+ * which gives the same result as calling #BLI_kdtree_3d_find_nearest_n for each of them.
+ * The queries are done in parallel, in an order where consecutive queries are close to each
+ * other for better cache usage.
+ *
+ * \param r_nearest: An array of `co_len * nearest_len_capacity` items,
+ * the results of query `i` start at `i * nearest_len_capacity`.
+ * \param r_nearest_len: An optional array of `co_len` items,
+ * filled with the number of results of every query.
+ */
+void BLI_kdtree_nd_(find_nearest_n_batch)(const KDTree *tree,
+                                          const float (*co)[KD_DIMS],
+                                          uint co_len,
+                                          KDTreeNearest *r_nearest,
+                                          uint nearest_len_capacity,
+                                          int *r_nearest_len)
+{
+  float min[KD_DIMS], max[KD_DIMS], scale[KD_DIMS];
+
+  if (co_len == 0) {
+    return;
+  }
+
+  copy_vn_vn(min, co[0]);
+  copy_vn_vn(max, co[0]);
+  for (uint i = 1; i < co_len; i++) {
+    for (uint j = 0; j < KD_DIMS; j++) {
+      min[j] = min_ff(min[j], co[i][j]);
+      max[j] = max_ff(max[j], co[i][j]);
+    }
+  }
+  for (uint j = 0; j < KD_DIMS; j++) {
+    const float size = max[j] - min[j];
+    scale[j] = size > 0.0f ? (float)((1u << KD_QUERY_KEY_BITS) - 1u) / size : 0.0f;
+  }
+
+  KDTreeQueryOrder *order = MEM_mallocN(sizeof(*order) * co_len, __func__);
+  for (uint i = 0; i < co_len; i++) {
+    order[i].key = kdtree_query_key(co[i], min, scale);
+    order[i].index = i;
+  }
+  qsort(order, (size_t)co_len, sizeof(*order), kdtree_query_order_cmp);
+
+  KDTreeNearestNBatchData data = {
+      .tree = tree,
+      .co = co,
+      .order = order,
+      .r_nearest = r_nearest,
+      .nearest_len_capacity = nearest_len_capacity,
+      .r_nearest_len = r_nearest_len,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  /* Keep chunks of consecutive queries together on one thread. */
+  settings.min_iter_per_thread = 256;
+  BLI_task_parallel_range(0, (int)co_len, &data, kdtree_find_nearest_n_batch_cb, &settings);
+
+  MEM_freeN(order);
+}
+
+/** \} */
+
 static int nearest_cmp_dist(const void *a, const void *b)
 {
   const KDTreeNearest *kda = a;
@@ -886,6 +886,38 @@ static const Vert *find_flap_vert(const Face &tri, const Edge e, bool *r_rev)
   return flapv;
 }
 
+/**
+ * Return the sign of `orient3d(a, b, c, d)` using the double coordinates of the vertices,
+ * or 0 if the double calculation cannot determine the sign.
+ * The double coordinates may have been rounded from the exact ones, so they are taken to
+ * have index 1 in the error analysis of Burnikel et al. (see `mesh_intersect.cc`).
+ * The determinant is `dot(a - d, cross(b - d, c - d))`, which then has index 11.
+ */
+static int filter_orient3d(const Vert *a, const Vert *b, const Vert *c, const Vert *d)
+{
+  constexpr int index_orient3d = 11;
+  const double3 ad = a->co - d->co;
+  const double3 bd = b->co - d->co;
+  const double3 cd = c->co - d->co;
+  const double det = math::dot(ad, math::cross(bd, cd));
+
+  const double3 abs_d = math::abs(d->co);
+  const double3 sup_ad = math::abs(a->co) + abs_d;
+  const double3 sup_bd = math::abs(b->co) + abs_d;
+  const double3 sup_cd = math::abs(c->co) + abs_d;
+  const double3 sup_cross(sup_bd[1] * sup_cd[2] + sup_bd[2] * sup_cd[1],
+                          sup_bd[2] * sup_cd[0] + sup_bd[0] * sup_cd[2],
+                          sup_bd[0] * sup_cd[1] + sup_bd[1] * sup_cd[0]);
+  const double err_bound = math::dot(sup_ad, sup_cross) * index_orient3d * DBL_EPSILON;
+  if (det > err_bound) {
+    return 1;
+  }
+  if (det < -err_bound) {
+    return -1;
+  }
+  return 0;
+}
+
 /**
  * Triangle \a tri and tri0 share edge e.
  * Classify \a tri with respect to tri0 as described in
@@ -906,9 +938,6 @@ static int sort_tris_class(const Face &tri, const Face &tri0, const Edge e)
   if (dbg_level > 0) {
     std::cout << "classify  e = " << e << "\n";
   }
-  mpq3 a0 = tri0[0]->co_exact;
-  mpq3 a1 = tri0[1]->co_exact;
-  mpq3 a2 = tri0[2]->co_exact;
   bool rev;
   bool rev0;
   const Vert *flapv0 = find_flap_vert(tri0, e, &rev0);
@@ -920,9 +949,12 @@ static int sort_tris_class(const Face &tri, const Face &tri0, const Edge e)
     std::cout << " rev = " << rev << " flapv = " << flapv << "\n";
   }
   BLI_assert(flapv != nullptr && flapv0 != nullptr);
-  const mpq3 flap = flapv->co_exact;
-  /* orient will be positive if flap is below oriented plane of a0,a1,a2. */
-  int orient = orient3d(a0, a1, a2, flap);
+  /* orient will be positive if flap is below oriented plane of tri0.
+   * Most flaps are far from that plane, so try doubles before the exact calculation. */
+  int orient = filter_orient3d(tri0[0], tri0[1], tri0[2], flapv);
+  if (orient == 0) {
+    orient = orient3d(tri0[0]->co_exact, tri0[1]->co_exact, tri0[2]->co_exact, flapv->co_exact);
+  }
   int ans;
   if (orient > 0) {
     ans = rev0 ? 4 : 3;
@@ -1081,27 +1113,23 @@ static Array<int> sort_tris_around_edge(
 }
 
 /**
- * Find the Cells around edge e.
+ * Find the Cells around edge e, given the triangles around e
+ * as sorted by #sort_tris_around_edge.
  * This possibly makes new cells in \a cinfo, and sets up the
  * bipartite graph edges between cells and patches.
  * Will modify \a pinfo and \a cinfo and the patches and cells they contain.
  */
 static void find_cells_from_edge(const IMesh &tm,
-                                 const TriMeshTopology &tmtopo,
                                  PatchesInfo &pinfo,
                                  CellsInfo &cinfo,
-                                 const Edge e)
+                                 const Edge e,
+                                 const Span<int> sorted_tris)
 {
   const int dbg_level = 0;
   if (dbg_level > 0) {
     std::cout << "FIND_CELLS_FROM_EDGE " << e << "\n";
   }
-  const Vector<int> *edge_tris = tmtopo.edge_tris(e);
-  BLI_assert(edge_tris != nullptr);
-  Array<int> sorted_tris = sort_tris_around_edge(
-      tm, e, Span<int>(*edge_tris), (*edge_tris)[0], nullptr);
-
-  int n_edge_tris = edge_tris->size();
+  int n_edge_tris = sorted_tris.size();
   Array<int> edge_patches(n_edge_tris);
   for (int i = 0; i < n_edge_tris; ++i) {
     edge_patches[i] = pinfo.tri_patch(sorted_tris[i]);
@@ -1202,18 +1230,29 @@ static CellsInfo find_cells(const IMesh &tm, const TriMeshTopology &tmtopo, Patc
     std::cout << "\nFIND_CELLS\n";
   }
   CellsInfo cinfo;
-  /* For each unique edge shared between patch pairs, process it. */
-  Set<Edge> processed_edges;
+  /* Find the unique edges shared between patch pairs. */
+  VectorSet<Edge> patch_edges;
   for (const auto item : pinfo.patch_patch_edge_map().items()) {
     int p = item.key.first;
     int q = item.key.second;
     if (p < q) {
-      const Edge &e = item.value;
-      if (!processed_edges.contains(e)) {
-        processed_edges.add_new(e);
-        find_cells_from_edge(tm, tmtopo, pinfo, cinfo, e);
-      }
+      patch_edges.add(item.value);
+    }
+  }
+  /* Sorting the triangles around the edges only reads the mesh and is the expensive part,
+   * so do it in parallel. Building the cells from the sorted triangles must be done in order. */
+  Array<Array<int>> sorted_edge_tris(patch_edges.size());
+  threading::parallel_for(patch_edges.index_range(), 256, [&](IndexRange range) {
+    for (int i : range) {
+      const Edge e = patch_edges[i];
+      const Vector<int> *edge_tris = tmtopo.edge_tris(e);
+      BLI_assert(edge_tris != nullptr);
+      sorted_edge_tris[i] = sort_tris_around_edge(
+          tm, e, Span<int>(*edge_tris), (*edge_tris)[0], nullptr);
     }
+  });
+  for (int i : patch_edges.index_range()) {
+    find_cells_from_edge(tm, pinfo, cinfo, patch_edges[i], sorted_edge_tris[i]);
   }
   /* Some patches may have no cells at this point. These are either:
    * (a) a closed manifold patch only incident on itself (sphere, torus, klein bottle, etc.).
@@ -18,25 +18,46 @@
  * \ingroup bli
  *
  * Task graph.
+ *
+ * Nodes are scheduled by counting the finished predecessors, nodes that are ready to run are
+ * kept in a queue per priority. Every ready node pushes a single task into a task pool, which
+ * executes the most important ready node at the time it runs. The task pool takes care of
+ * distributing (and stealing) the work between threads.
  */
 
 #include "MEM_guardedalloc.h"
 
 #include "BLI_task.h"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+#include "PIL_time.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <vector>
 
-#ifdef WITH_TBB
-#  include <tbb/flow_graph.h>
-#endif
-
 /* Task Graph */
 struct TaskGraph {
-#ifdef WITH_TBB
-  tbb::flow::graph tbb_graph;
-#endif
+  /* Pool executing the ready nodes, null when running single threaded. */
+  TaskPool *task_pool = nullptr;
+
+  /* Protects the nodes, the edges between them and the ready queues, so that nodes can be added
+   * while the graph is being executed. */
+  std::mutex mutex;
   std::vector<std::unique_ptr<TaskNode>> nodes;
+  /* Nodes that can be executed, indexed by #eTaskPriority. */
+  std::deque<TaskNode *> ready_nodes[2];
+  /* Single threaded execution, avoids recursing into #task_graph_run_ready_nodes. */
+  bool is_running = false;
+
+  /* Cancellation, nodes which did not start yet are skipped when either is set. */
+  std::atomic<bool> is_canceled{false};
+  const short *cancel_token = nullptr;
 
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("task_graph:TaskGraph")
@@ -45,12 +66,15 @@ struct TaskGraph {
 
 /* TaskNode - a node in the task graph. */
 struct TaskNode {
-  /* TBB Node. */
-#ifdef WITH_TBB
-  tbb::flow::continue_node<tbb::flow::continue_msg> tbb_node;
-#endif
-  /* Successors to execute after this task, for serial execution fallback. */
+  TaskGraph *task_graph;
+  /* Successors to execute after this task. */
   std::vector<TaskNode *> successors;
+  /* Number of incoming edges, and the number of predecessors that still have to finish before
+   * this node is executed. The latter is reset when the node is scheduled, so that the graph can
+   * be reused. */
+  int predecessors_num = 0;
+  std::atomic<int> predecessors_pending{0};
+  eTaskPriority priority = TASK_PRIORITY_HIGH;
 
   /* User function to be executed with given task data. */
   TaskGraphNodeRunFunction run_func;
@@ -59,23 +83,18 @@ struct TaskNode {
    * is shared between nodes, only a single task node should free the data. */
   TaskGraphNodeFreeFunction free_func;
 
+  /* Execution statistics. */
+  int run_count = 0;
+  int skip_count = 0;
+  double time_total = 0.0;
+  double time_max = 0.0;
+
   TaskNode(TaskGraph *task_graph,
            TaskGraphNodeRunFunction run_func,
            void *task_data,
            TaskGraphNodeFreeFunction free_func)
-      :
-#ifdef WITH_TBB
-        tbb_node(task_graph->tbb_graph,
-                 tbb::flow::unlimited,
-                 [&](const tbb::flow::continue_msg input) { run(input); }),
-#endif
-        run_func(run_func),
-        task_data(task_data),
-        free_func(free_func)
+      : task_graph(task_graph), run_func(run_func), task_data(task_data), free_func(free_func)
   {
-#ifndef WITH_TBB
-    UNUSED_VARS(task_graph);
-#endif
   }
 
   TaskNode(const TaskNode &other) = delete;
@@ -88,44 +107,161 @@ struct TaskNode {
     }
   }
 
-#ifdef WITH_TBB
-  tbb::flow::continue_msg run(const tbb::flow::continue_msg UNUSED(input))
-  {
-    run_func(task_data);
-    return tbb::flow::continue_msg();
-  }
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("task_graph:TaskNode")
 #endif
+};
 
-  void run_serial()
+/* -------------------------------------------------------------------- */
+/** \name Execution
+ * \{ */
+
+static bool task_graph_is_canceled(const TaskGraph *task_graph)
+{
+  return task_graph->is_canceled || (task_graph->cancel_token && *task_graph->cancel_token);
+}
+
+static TaskNode *task_graph_pop_ready_node(TaskGraph *task_graph)
+{
+  std::lock_guard lock{task_graph->mutex};
+  for (const eTaskPriority priority : {TASK_PRIORITY_HIGH, TASK_PRIORITY_LOW}) {
+    std::deque<TaskNode *> &queue = task_graph->ready_nodes[priority];
+    if (!queue.empty()) {
+      TaskNode *task_node = queue.front();
+      queue.pop_front();
+      return task_node;
+    }
+  }
+  return nullptr;
+}
+
+static void task_graph_schedule_node(TaskNode *task_node);
+
+static void task_graph_node_run(TaskNode *task_node)
+{
+  if (task_graph_is_canceled(task_node->task_graph)) {
+    task_node->skip_count++;
+  }
+  else {
+    const double start_time = PIL_check_seconds_timer();
+    task_node->run_func(task_node->task_data);
+    const double time = PIL_check_seconds_timer() - start_time;
+
+    task_node->run_count++;
+    task_node->time_total += time;
+    task_node->time_max = std::max(task_node->time_max, time);
+  }
+
+  /* Edges from this node may still be added by other threads until its run function returned,
+   * so copy the successors under the lock. Edges added after this are not followed in this run. */
+  blender::Vector<TaskNode *, 16> successors;
   {
-    run_func(task_data);
-    for (TaskNode *successor : successors) {
-      successor->run_serial();
+    std::lock_guard lock{task_node->task_graph->mutex};
+    successors.extend(task_node->successors.data(), int64_t(task_node->successors.size()));
+  }
+
+  /* Successors are still released when skipped, so that their pending predecessors are reset
+   * and the graph can be reused. */
+  for (TaskNode *successor : successors) {
+    if (successor->predecessors_pending.fetch_sub(1) == 1) {
+      successor->predecessors_pending = successor->predecessors_num;
+      task_graph_schedule_node(successor);
     }
   }
+}
 
-#ifdef WITH_CXX_GUARDEDALLOC
-  MEM_CXX_CLASS_ALLOC_FUNCS("task_graph:TaskNode")
-#endif
-};
+static void task_graph_pool_run(TaskPool *__restrict pool, void *UNUSED(taskdata))
+{
+  TaskGraph *task_graph = static_cast<TaskGraph *>(BLI_task_pool_user_data(pool));
+  /* Every scheduled node pushed a task, so there always is a node to run. Which one depends on
+   * the priorities of the nodes that are ready at this point. */
+  if (TaskNode *task_node = task_graph_pop_ready_node(task_graph)) {
+    task_graph_node_run(task_node);
+  }
+}
+
+static void task_graph_run_ready_nodes(TaskGraph *task_graph)
+{
+  if (task_graph->is_running) {
+    /* Nodes scheduled from a running node are picked up by the outer loop. */
+    return;
+  }
+  task_graph->is_running = true;
+  while (TaskNode *task_node = task_graph_pop_ready_node(task_graph)) {
+    task_graph_node_run(task_node);
+  }
+  task_graph->is_running = false;
+}
+
+static void task_graph_schedule_node(TaskNode *task_node)
+{
+  TaskGraph *task_graph = task_node->task_graph;
+  {
+    std::lock_guard lock{task_graph->mutex};
+    task_graph->ready_nodes[task_node->priority].push_back(task_node);
+  }
+
+  if (task_graph->task_pool) {
+    BLI_task_pool_push(task_graph->task_pool, task_graph_pool_run, nullptr, false, nullptr);
+  }
+  else {
+    task_graph_run_ready_nodes(task_graph);
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Public API
+ * \{ */
 
 TaskGraph *BLI_task_graph_create()
 {
-  return new TaskGraph();
+  return BLI_task_graph_create_ex(TASK_PRIORITY_HIGH);
+}
+
+TaskGraph *BLI_task_graph_create_ex(eTaskPriority priority)
+{
+  TaskGraph *task_graph = new TaskGraph();
+#ifdef WITH_TBB
+  if (BLI_task_scheduler_num_threads() > 1) {
+    task_graph->task_pool = BLI_task_pool_create(task_graph, priority);
+  }
+#else
+  UNUSED_VARS(priority);
+#endif
+  return task_graph;
 }
 
 void BLI_task_graph_free(TaskGraph *task_graph)
 {
+  if (task_graph->task_pool) {
+    BLI_task_pool_free(task_graph->task_pool);
+  }
   delete task_graph;
 }
 
 void BLI_task_graph_work_and_wait(TaskGraph *task_graph)
 {
-#ifdef WITH_TBB
-  task_graph->tbb_graph.wait_for_all();
-#else
-  UNUSED_VARS(task_graph);
-#endif
+  if (task_graph->task_pool) {
+    BLI_task_pool_work_and_wait(task_graph->task_pool);
+  }
+  task_graph->is_canceled = false;
+}
+
+void BLI_task_graph_cancel(TaskGraph *task_graph)
+{
+  task_graph->is_canceled = true;
+}
+
+void BLI_task_graph_cancel_token_set(TaskGraph *task_graph, const short *cancel_token)
+{
+  task_graph->cancel_token = cancel_token;
+}
+
+bool BLI_task_graph_is_canceled(const TaskGraph *task_graph)
+{
+  return task_graph_is_canceled(task_graph);
 }
 
 struct TaskNode *BLI_task_graph_node_create(struct TaskGraph *task_graph,
@@ -134,30 +270,51 @@ struct TaskNode *BLI_task_graph_node_create(struct TaskGraph *task_graph,
                                             TaskGraphNodeFreeFunction free_func)
 {
   TaskNode *task_node = new TaskNode(task_graph, run, user_data, free_func);
+  std::lock_guard lock{task_graph->mutex};
   task_graph->nodes.push_back(std::unique_ptr<TaskNode>(task_node));
   return task_node;
 }
 
-bool BLI_task_graph_node_push_work(struct TaskNode *task_node)
+void BLI_task_graph_node_priority_set(struct TaskNode *task_node, eTaskPriority priority)
 {
-#ifdef WITH_TBB
-  if (BLI_task_scheduler_num_threads() > 1) {
-    return task_node->tbb_node.try_put(tbb::flow::continue_msg());
-  }
-#endif
+  task_node->priority = priority;
+}
 
-  task_node->run_serial();
+bool BLI_task_graph_node_push_work(struct TaskNode *task_node)
+{
+  task_graph_schedule_node(task_node);
   return true;
 }
 
 void BLI_task_graph_edge_create(struct TaskNode *from_node, struct TaskNode *to_node)
 {
-#ifdef WITH_TBB
-  if (BLI_task_scheduler_num_threads() > 1) {
-    tbb::flow::make_edge(from_node->tbb_node, to_node->tbb_node);
-    return;
-  }
-#endif
-
+  BLI_assert(from_node->task_graph == to_node->task_graph);
+  std::lock_guard lock{from_node->task_graph->mutex};
   from_node->successors.push_back(to_node);
+  to_node->predecessors_num++;
+  to_node->predecessors_pending++;
 }
+
+void BLI_task_graph_node_stats_get(const struct TaskNode *task_node, TaskGraphStats *r_stats)
+{
+  r_stats->nodes_num = 1;
+  r_stats->run_count = task_node->run_count;
+  r_stats->skip_count = task_node->skip_count;
+  r_stats->time_total = task_node->time_total;
+  r_stats->time_max = task_node->time_max;
+}
+
+void BLI_task_graph_stats_get(struct TaskGraph *task_graph, TaskGraphStats *r_stats)
+{
+  memset(r_stats, 0, sizeof(*r_stats));
+  std::lock_guard lock{task_graph->mutex};
+  for (const std::unique_ptr<TaskNode> &task_node : task_graph->nodes) {
+    r_stats->nodes_num++;
+    r_stats->run_count += task_node->run_count;
+    r_stats->skip_count += task_node->skip_count;
+    r_stats->time_total += task_node->time_total;
+    r_stats->time_max = std::max(r_stats->time_max, task_node->time_max);
+  }
+}
+
+/** \} */
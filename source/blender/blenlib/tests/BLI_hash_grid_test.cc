@@ -0,0 +1,126 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_hash_grid.hh"
+#include "BLI_kdtree.h"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
+
+namespace blender::hash_grid::tests {
+
+/**
+ * Random points in a box, where some of the points have copies that are moved by up to
+ * \a max_offset, so that there are clusters of points close to each other.
+ */
+static Array<float3> random_clustered_points(const int size,
+                                             const float max_offset,
+                                             const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float3> positions(size);
+  for (const int i : positions.index_range()) {
+    if (i > 0 && rng.get_float() < 0.5f) {
+      const float3 &other = positions[rng.get_int32(i)];
+      const float3 offset = (float3(rng.get_float(), rng.get_float(), rng.get_float()) * 2.0f -
+                             float3(1.0f)) *
+                            max_offset;
+      positions[i] = other + offset;
+    }
+    else {
+      positions[i] = float3(rng.get_float(), rng.get_float(), rng.get_float()) * 10.0f;
+    }
+  }
+  return positions;
+}
+
+/** Find the duplicates with a #KDTree, which only contains the selected points. */
+static int calc_duplicates_kdtree(Span<float3> positions,
+                                  IndexMask selection,
+                                  const float range,
+                                  MutableSpan<int> r_duplicates)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(selection.size());
+  for (const int i : selection.index_range()) {
+    BLI_kdtree_3d_insert(tree, i, positions[selection[i]]);
+  }
+  BLI_kdtree_3d_balance(tree);
+  Array<int> selection_duplicates(selection.size(), -1);
+  const int found = BLI_kdtree_3d_calc_duplicates_fast(
+      tree, range, true, selection_duplicates.data());
+  BLI_kdtree_3d_free(tree);
+
+  for (const int i : selection.index_range()) {
+    const int duplicate = selection_duplicates[i];
+    r_duplicates[selection[i]] = duplicate == -1 ? -1 : int(selection[duplicate]);
+  }
+  return found;
+}
+
+static void expect_same_duplicates_as_kdtree(Span<float3> positions,
+                                             IndexMask selection,
+                                             const float range)
+{
+  Array<int> expected(positions.size(), -1);
+  Array<int> duplicates(positions.size(), -1);
+  const int expected_found = calc_duplicates_kdtree(positions, selection, range, expected);
+  const int found = calc_duplicates(positions, selection, range, duplicates);
+  EXPECT_EQ(found, expected_found);
+  EXPECT_EQ_ARRAY(duplicates.data(), expected.data(), positions.size());
+}
+
+TEST(hash_grid, Empty)
+{
+  Array<int> duplicates;
+  EXPECT_EQ(calc_duplicates({}, IndexMask(0), 0.1f, duplicates), 0);
+}
+
+TEST(hash_grid, CoincidentPoints)
+{
+  Array<float3> positions(5, float3(1.0f, 2.0f, 3.0f));
+  positions[3] = float3(1.0f, 2.0f, 5.0f);
+  Array<int> duplicates(positions.size(), -1);
+  EXPECT_EQ(calc_duplicates(positions, IndexMask(positions.size()), 0.1f, duplicates), 3);
+  EXPECT_EQ(duplicates[0], 0);
+  EXPECT_EQ(duplicates[1], 0);
+  EXPECT_EQ(duplicates[2], 0);
+  EXPECT_EQ(duplicates[3], -1);
+  EXPECT_EQ(duplicates[4], 0);
+}
+
+TEST(hash_grid, SameAsKDTree)
+{
+  const Array<float3> positions = random_clustered_points(20000, 0.02f, 0);
+  for (const float range : {0.0f, 0.001f, 0.01f, 0.02f, 0.05f, 1.0f}) {
+    expect_same_duplicates_as_kdtree(positions, IndexMask(positions.size()), range);
+  }
+}
+
+TEST(hash_grid, SameAsKDTreeSelection)
+{
+  const Array<float3> positions = random_clustered_points(20000, 0.02f, 1);
+  Vector<int64_t> indices;
+  for (const int i : positions.index_range()) {
+    if (i % 3 != 0) {
+      indices.append(i);
+    }
+  }
+  for (const float range : {0.005f, 0.02f, 0.1f}) {
+    expect_same_duplicates_as_kdtree(positions, indices.as_span(), range);
+  }
+}
+
+TEST(hash_grid, SameAsKDTreeLargeCoordinates)
+{
+  /* The range is small compared to the size of the bounds, so the cells are larger than it. */
+  Array<float3> positions = random_clustered_points(5000, 0.02f, 2);
+  for (float3 &position : positions) {
+    position *= 1e5f;
+  }
+  for (const float range : {0.01f, 1000.0f}) {
+    expect_same_duplicates_as_kdtree(positions, IndexMask(positions.size()), range);
+  }
+}
+
+}  // namespace blender::hash_grid::tests
@@ -0,0 +1,58 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_implicit_sharing.hh"
+
+namespace blender::tests {
+
+/** Shares an array of integers and counts how often shared data has been freed. */
+class SharedArray : public ImplicitSharingInfo {
+ public:
+  int *data;
+  int *deleted_num;
+
+  SharedArray(const int size, int *deleted_num)
+      : ImplicitSharingInfo(1),
+        data(static_cast<int *>(MEM_calloc_arrayN(size, sizeof(int), __func__))),
+        deleted_num(deleted_num)
+  {
+  }
+
+ private:
+  void delete_self_with_data() override
+  {
+    MEM_freeN(data);
+    (*deleted_num)++;
+    MEM_delete(this);
+  }
+};
+
+TEST(implicit_sharing, DeleteLastUser)
+{
+  int deleted_num = 0;
+  const SharedArray *sharing_info = MEM_new<SharedArray>(__func__, 10, &deleted_num);
+  EXPECT_FALSE(sharing_info->is_shared());
+  sharing_info->remove_user_and_delete_if_last();
+  EXPECT_EQ(deleted_num, 1);
+}
+
+TEST(implicit_sharing, MultipleUsers)
+{
+  int deleted_num = 0;
+  const SharedArray *sharing_info = MEM_new<SharedArray>(__func__, 10, &deleted_num);
+  sharing_info->add_user();
+  sharing_info->add_user();
+  EXPECT_TRUE(sharing_info->is_shared());
+  sharing_info->remove_user_and_delete_if_last();
+  EXPECT_TRUE(sharing_info->is_shared());
+  sharing_info->remove_user_and_delete_if_last();
+  EXPECT_FALSE(sharing_info->is_shared());
+  EXPECT_EQ(deleted_num, 0);
+  sharing_info->remove_user_and_delete_if_last();
+  EXPECT_EQ(deleted_num, 1);
+}
+
+}  // namespace blender::tests
@@ -8,6 +8,7 @@
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_kdopbvh.h"
+#include "BLI_math_geom.h"
 #include "BLI_math_vector.h"
 #include "BLI_rand.h"
 
@@ -132,3 +133,407 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+/* -------------------------------------------------------------------- */
+/* Batched Queries */
+
+struct BatchTestTriangles {
+  float (*verts)[3];
+};
+
+static void batch_raycast_callback(void *userdata,
+                                   int index,
+                                   const BVHTreeRay *ray,
+                                   BVHTreeRayHit *hit)
+{
+  const BatchTestTriangles *data = (const BatchTestTriangles *)userdata;
+  const float *v0 = data->verts[index * 3];
+  const float *v1 = data->verts[index * 3 + 1];
+  const float *v2 = data->verts[index * 3 + 2];
+  float dist;
+  if (isect_ray_tri_watertight_v3(ray->origin, ray->isect_precalc, v0, v1, v2, &dist, nullptr) &&
+      dist < hit->dist) {
+    hit->index = index;
+    hit->dist = dist;
+    madd_v3_v3v3fl(hit->co, ray->origin, ray->direction, dist);
+  }
+}
+
+static void raycast_batch_test(int tris_len, int rays_len, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(tris_len, 0.0, 4, 6);
+
+  BatchTestTriangles data;
+  data.verts = (float(*)[3])MEM_mallocN(sizeof(float[3]) * tris_len * 3, __func__);
+  for (int i = 0; i < tris_len; i++) {
+    float center[3];
+    rng_v3_round(center, 3, rng, 1000, 1.0f);
+    for (int j = 0; j < 3; j++) {
+      rng_v3_round(data.verts[i * 3 + j], 3, rng, 1000, 0.1f);
+      add_v3_v3(data.verts[i * 3 + j], center);
+    }
+    BLI_bvhtree_insert(tree, i, data.verts[i * 3], 3);
+  }
+  BLI_bvhtree_balance(tree);
+
+  float(*origins)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  float(*directions)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(BVHTreeRayHit) * rays_len, __func__);
+  for (int i = 0; i < rays_len; i++) {
+    rng_v3_round(origins[i], 3, rng, 1000, 1.5f);
+    if (i % 2 == 0) {
+      /* Aim at the center of a triangle, so that there are enough hits. */
+      const int tri = BLI_rng_get_int(rng) % tris_len;
+      mid_v3_v3v3v3(directions[i],
+                    data.verts[tri * 3],
+                    data.verts[tri * 3 + 1],
+                    data.verts[tri * 3 + 2]);
+      sub_v3_v3(directions[i], origins[i]);
+      normalize_v3(directions[i]);
+    }
+    else {
+      BLI_rng_get_float_unit_v3(rng, directions[i]);
+    }
+    /* Also test rays that are aligned with an axis. */
+    if (i % 7 == 0) {
+      zero_v3(directions[i]);
+      directions[i][i % 3] = (i % 2) ? 1.0f : -1.0f;
+    }
+    hits[i].index = -1;
+    hits[i].dist = (i % 5 == 0) ? 0.5f : BVH_RAYCAST_DIST_MAX;
+  }
+
+  BLI_bvhtree_ray_cast_batch(tree,
+                             origins,
+                             directions,
+                             rays_len,
+                             0.0f,
+                             hits,
+                             batch_raycast_callback,
+                             &data,
+                             BVH_RAYCAST_DEFAULT);
+
+  int hits_num = 0;
+  for (int i = 0; i < rays_len; i++) {
+    BVHTreeRayHit hit;
+    hit.index = -1;
+    hit.dist = (i % 5 == 0) ? 0.5f : BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(
+        tree, origins[i], directions[i], 0.0f, &hit, batch_raycast_callback, &data);
+    EXPECT_EQ(hits[i].index, hit.index);
+    if (hit.index != -1) {
+      EXPECT_FLOAT_EQ(hits[i].dist, hit.dist);
+      hits_num++;
+    }
+  }
+  /* Make sure that the test is meaningful. */
+  EXPECT_GT(hits_num, 0);
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(data.verts);
+  MEM_freeN(origins);
+  MEM_freeN(directions);
+  MEM_freeN(hits);
+}
+
+TEST(kdopbvh, RayCastBatch_1)
+{
+  raycast_batch_test(1, 100, 1234);
+}
+TEST(kdopbvh, RayCastBatch_500)
+{
+  raycast_batch_test(500, 1001, 12);
+}
+
+static void find_nearest_batch_test(int points_len, int queries_len, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
+
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  float(*queries)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * queries_len, __func__);
+  BVHTreeNearest *nearest = (BVHTreeNearest *)MEM_mallocN(sizeof(BVHTreeNearest) * queries_len,
+                                                           __func__);
+  for (int i = 0; i < queries_len; i++) {
+    rng_v3_round(queries[i], 3, rng, 1000, 1.2f);
+    nearest[i].index = -1;
+    /* Limit the search distance for some queries. */
+    nearest[i].dist_sq = (i % 3 == 0) ? 0.01f : FLT_MAX;
+  }
+
+  BLI_bvhtree_find_nearest_batch(tree, queries, queries_len, nearest, nullptr, nullptr, 0);
+
+  for (int i = 0; i < queries_len; i++) {
+    BVHTreeNearest expected;
+    expected.index = -1;
+    expected.dist_sq = (i % 3 == 0) ? 0.01f : FLT_MAX;
+    BLI_bvhtree_find_nearest(tree, queries[i], &expected, nullptr, nullptr);
+    EXPECT_EQ(nearest[i].index == -1, expected.index == -1);
+    if (expected.index != -1) {
+      EXPECT_FLOAT_EQ(len_squared_v3v3(queries[i], points[nearest[i].index]),
+                      len_squared_v3v3(queries[i], points[expected.index]));
+    }
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+  MEM_freeN(queries);
+  MEM_freeN(nearest);
+}
+
+TEST(kdopbvh, FindNearestBatch_1)
+{
+  find_nearest_batch_test(1, 100, 1234);
+}
+TEST(kdopbvh, FindNearestBatch_500)
+{
+  find_nearest_batch_test(500, 1000, 12);
+}
+
+TEST(kdopbvh, FindNearestBatch_NonFinite)
+{
+  BVHTree *tree = BLI_bvhtree_new(2, 0.0, 8, 8);
+  const float points[2][3] = {{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}};
+  BLI_bvhtree_insert(tree, 0, points[0], 1);
+  BLI_bvhtree_insert(tree, 1, points[1], 1);
+  BLI_bvhtree_balance(tree);
+
+  /* Queries that can't be ordered must not affect the results of the other queries. */
+  const float queries[4][3] = {{0.9f, 0.9f, 0.9f},
+                               {NAN, 0.0f, 0.0f},
+                               {0.0f, INFINITY, -INFINITY},
+                               {0.1f, 0.1f, 0.1f}};
+  BVHTreeNearest nearest[4];
+  for (int i = 0; i < 4; i++) {
+    nearest[i].index = -1;
+    nearest[i].dist_sq = FLT_MAX;
+  }
+  BLI_bvhtree_find_nearest_batch(tree, queries, 4, nearest, nullptr, nullptr, 0);
+  EXPECT_EQ(nearest[0].index, 1);
+  EXPECT_EQ(nearest[3].index, 0);
+
+  BLI_bvhtree_free(tree);
+}
+
+/** Nearest point callback that never accepts the second point for queries with a positive Y. */
+static void nearest_reject_callback(void *userdata,
+                                    int index,
+                                    const float co[3],
+                                    BVHTreeNearest *nearest)
+{
+  const float(*points)[3] = static_cast<const float(*)[3]>(userdata);
+  if (index == 1 && co[1] > 0.0f) {
+    return;
+  }
+  const float dist_sq = len_squared_v3v3(co, points[index]);
+  if (dist_sq < nearest->dist_sq) {
+    nearest->index = index;
+    nearest->dist_sq = dist_sq;
+    copy_v3_v3(nearest->co, points[index]);
+  }
+}
+
+TEST(kdopbvh, FindNearestBatch_Callback)
+{
+  BVHTree *tree = BLI_bvhtree_new(2, 0.0, 8, 8);
+  float points[2][3] = {{-2.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}};
+  BLI_bvhtree_insert(tree, 0, points[0], 1);
+  BLI_bvhtree_insert(tree, 1, points[1], 1);
+  BLI_bvhtree_balance(tree);
+
+  /* The first query is processed first and finds the second point, which must not be used as
+   * result for the next query just because it is closer. */
+  const float queries[2][3] = {{0.9f, 0.0f, 0.0f}, {0.9f, 0.01f, 0.0f}};
+  BVHTreeNearest nearest[2];
+  for (int i = 0; i < 2; i++) {
+    nearest[i].index = -1;
+    nearest[i].dist_sq = FLT_MAX;
+  }
+  BLI_bvhtree_find_nearest_batch(tree, queries, 2, nearest, nearest_reject_callback, points, 0);
+  EXPECT_EQ(nearest[0].index, 1);
+  EXPECT_EQ(nearest[1].index, 0);
+
+  BLI_bvhtree_free(tree);
+}
+
+/* -------------------------------------------------------------------- */
+/* Surface Area Heuristic Build */
+
+/**
+ * Build trees from unevenly distributed triangles with and without #BVH_BUILD_SAH and check that
+ * queries give the same results.
+ */
+static void sah_build_test(int tris_len, int tree_type, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(tris_len, 0.0, tree_type, 6);
+  BVHTree *tree_sah = BLI_bvhtree_new_ex(tris_len, 0.0, tree_type, 6, BVH_BUILD_SAH);
+
+  BatchTestTriangles data;
+  data.verts = (float(*)[3])MEM_mallocN(sizeof(float[3]) * tris_len * 3, __func__);
+  for (int i = 0; i < tris_len; i++) {
+    /* Most triangles are small and in a dense cluster, a few are large and spread out. */
+    const bool is_dense = (i % 10) != 0;
+    float center[3];
+    rng_v3_round(center, 3, rng, 1000, is_dense ? 0.1f : 1.0f);
+    for (int j = 0; j < 3; j++) {
+      rng_v3_round(data.verts[i * 3 + j], 3, rng, 1000, is_dense ? 0.01f : 0.2f);
+      add_v3_v3(data.verts[i * 3 + j], center);
+    }
+    BLI_bvhtree_insert(tree, i, data.verts[i * 3], 3);
+    BLI_bvhtree_insert(tree_sah, i, data.verts[i * 3], 3);
+  }
+  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance(tree_sah);
+
+  for (int i = 0; i < 1000; i++) {
+    float origin[3], direction[3];
+    rng_v3_round(origin, 3, rng, 1000, 1.5f);
+    if (i % 2 == 0) {
+      const int tri = BLI_rng_get_int(rng) % tris_len;
+      sub_v3_v3v3(direction, data.verts[tri * 3], origin);
+      normalize_v3(direction);
+    }
+    else {
+      BLI_rng_get_float_unit_v3(rng, direction);
+    }
+
+    BVHTreeRayHit hit, hit_sah;
+    hit.index = hit_sah.index = -1;
+    hit.dist = hit_sah.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(tree, origin, direction, 0.0f, &hit, batch_raycast_callback, &data);
+    BLI_bvhtree_ray_cast(
+        tree_sah, origin, direction, 0.0f, &hit_sah, batch_raycast_callback, &data);
+    EXPECT_EQ(hit.index, hit_sah.index);
+    EXPECT_FLOAT_EQ(hit.dist, hit_sah.dist);
+
+    BVHTreeNearest nearest, nearest_sah;
+    nearest.index = nearest_sah.index = -1;
+    nearest.dist_sq = nearest_sah.dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(tree, origin, &nearest, nullptr, nullptr);
+    BLI_bvhtree_find_nearest(tree_sah, origin, &nearest_sah, nullptr, nullptr);
+    EXPECT_FLOAT_EQ(nearest.dist_sq, nearest_sah.dist_sq);
+  }
+
+  /* Updating the tree after moving the elements has to work for unbalanced trees as well. */
+  for (int i = 0; i < tris_len; i++) {
+    for (int j = 0; j < 3; j++) {
+      data.verts[i * 3 + j][2] += 2.0f;
+    }
+    BLI_bvhtree_update_node(tree_sah, i, data.verts[i * 3], nullptr, 3);
+  }
+  BLI_bvhtree_update_tree(tree_sah);
+  for (int i = 0; i < tris_len; i += 7) {
+    float co[3];
+    mid_v3_v3v3v3(co, data.verts[i * 3], data.verts[i * 3 + 1], data.verts[i * 3 + 2]);
+    const float origin[3] = {co[0], co[1], co[2] + 10.0f};
+    const float direction[3] = {0.0f, 0.0f, -1.0f};
+    BVHTreeRayHit hit;
+    hit.index = -1;
+    hit.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(tree_sah, origin, direction, 0.0f, &hit, batch_raycast_callback, &data);
+    EXPECT_NE(hit.index, -1);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_bvhtree_free(tree_sah);
+  BLI_rng_free(rng);
+  MEM_freeN(data.verts);
+}
+
+TEST(kdopbvh, SAHBuild_2)
+{
+  sah_build_test(2, 4, 1234);
+}
+TEST(kdopbvh, SAHBuild_Binary)
+{
+  sah_build_test(1000, 2, 12);
+}
+TEST(kdopbvh, SAHBuild_Quad)
+{
+  sah_build_test(1000, 4, 123);
+}
+TEST(kdopbvh, SAHBuild_Oct)
+{
+  sah_build_test(1000, 8, 1);
+}
+
+/* -------------------------------------------------------------------- */
+/* Refit Quality */
+
+/**
+ * Moving the elements uniformly keeps the relative layout of the tree, so the branch area ratio
+ * must not change. Shuffling them makes a refitted tree much worse than a rebuilt one.
+ */
+static void branch_area_ratio_test(int points_len, int tree_type, int axis, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, tree_type, axis);
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+  const float build_ratio = BLI_bvhtree_get_branch_area_ratio(tree);
+  EXPECT_GT(build_ratio, 2.0f);
+
+  for (int i = 0; i < points_len; i++) {
+    mul_v3_fl(points[i], 2.0f);
+    points[i][0] += 5.0f;
+    BLI_bvhtree_update_node(tree, i, points[i], nullptr, 1);
+  }
+  BLI_bvhtree_update_tree(tree);
+  EXPECT_NEAR(BLI_bvhtree_get_branch_area_ratio(tree), build_ratio, build_ratio * 1e-4f);
+
+  BLI_rng_shuffle_array(rng, points, sizeof(*points), (unsigned int)points_len);
+  for (int i = 0; i < points_len; i++) {
+    BLI_bvhtree_update_node(tree, i, points[i], nullptr, 1);
+  }
+  BLI_bvhtree_update_tree(tree);
+  const float shuffled_ratio = BLI_bvhtree_get_branch_area_ratio(tree);
+
+  BVHTree *tree_rebuilt = BLI_bvhtree_new(points_len, 0.0, tree_type, axis);
+  for (int i = 0; i < points_len; i++) {
+    BLI_bvhtree_insert(tree_rebuilt, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree_rebuilt);
+  EXPECT_GT(shuffled_ratio, BLI_bvhtree_get_branch_area_ratio(tree_rebuilt) * 2.0f);
+
+  BLI_bvhtree_free(tree);
+  BLI_bvhtree_free(tree_rebuilt);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+}
+
+TEST(kdopbvh, BranchAreaRatio_Single)
+{
+  BVHTree *tree = BLI_bvhtree_new(1, 0.0, 4, 6);
+  const float co[3] = {0.0f, 0.0f, 0.0f};
+  BLI_bvhtree_insert(tree, 0, co, 1);
+  BLI_bvhtree_balance(tree);
+  /* A single point has no area. */
+  EXPECT_EQ(BLI_bvhtree_get_branch_area_ratio(tree), 1.0f);
+  BLI_bvhtree_free(tree);
+}
+TEST(kdopbvh, BranchAreaRatio_Binary)
+{
+  branch_area_ratio_test(1000, 2, 6, 5);
+}
+TEST(kdopbvh, BranchAreaRatio_Quad)
+{
+  branch_area_ratio_test(1000, 4, 6, 6);
+}
+TEST(kdopbvh, BranchAreaRatio_Kdop)
+{
+  branch_area_ratio_test(1000, 4, 26, 7);
+}
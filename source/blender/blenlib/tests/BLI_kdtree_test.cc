@@ -0,0 +1,106 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_kdtree.h"
+#include "BLI_math_vec_types.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+
+namespace blender::tests {
+
+static Array<float3> random_points(const int size, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float3> points(size);
+  for (float3 &point : points) {
+    point = float3(rng.get_float(), rng.get_float(), rng.get_float());
+  }
+  return points;
+}
+
+static KDTree_3d *build_tree(Span<float3> points)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(points.size());
+  for (const int i : points.index_range()) {
+    BLI_kdtree_3d_insert(tree, i, points[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+  return tree;
+}
+
+TEST(kdtree, FindNearestLargeTree)
+{
+  /* Large enough to be balanced with multiple tasks. */
+  const Array<float3> points = random_points(100000, 0);
+  const Array<float3> queries = random_points(100, 1);
+  KDTree_3d *tree = build_tree(points);
+
+  for (const float3 &query : queries) {
+    int expected_index = 0;
+    for (const int i : points.index_range()) {
+      if (math::distance_squared(points[i], query) <
+          math::distance_squared(points[expected_index], query)) {
+        expected_index = i;
+      }
+    }
+    KDTreeNearest_3d nearest;
+    EXPECT_EQ(BLI_kdtree_3d_find_nearest(tree, query, &nearest), expected_index);
+  }
+
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, FindNearestNBatch)
+{
+  const Array<float3> points = random_points(20000, 2);
+  const Array<float3> queries = random_points(5000, 3);
+  KDTree_3d *tree = build_tree(points);
+
+  const int nearest_len = 5;
+  Array<KDTreeNearest_3d> nearest(queries.size() * nearest_len);
+  Array<int> found(queries.size(), -1);
+  BLI_kdtree_3d_find_nearest_n_batch(tree,
+                                     reinterpret_cast<const float(*)[3]>(queries.data()),
+                                     queries.size(),
+                                     nearest.data(),
+                                     nearest_len,
+                                     found.data());
+
+  for (const int i : queries.index_range()) {
+    KDTreeNearest_3d expected[nearest_len];
+    const int expected_found = BLI_kdtree_3d_find_nearest_n(
+        tree, queries[i], expected, nearest_len);
+    EXPECT_EQ(found[i], expected_found);
+    for (const int j : IndexRange(expected_found)) {
+      EXPECT_EQ(nearest[i * nearest_len + j].index, expected[j].index);
+      EXPECT_EQ(nearest[i * nearest_len + j].dist, expected[j].dist);
+    }
+  }
+
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, FindNearestNBatchFewPoints)
+{
+  const Array<float3> points = random_points(3, 4);
+  const Array<float3> queries = random_points(10, 5);
+  KDTree_3d *tree = build_tree(points);
+
+  Array<KDTreeNearest_3d> nearest(queries.size() * 4);
+  Array<int> found(queries.size(), -1);
+  BLI_kdtree_3d_find_nearest_n_batch(tree,
+                                     reinterpret_cast<const float(*)[3]>(queries.data()),
+                                     queries.size(),
+                                     nearest.data(),
+                                     4,
+                                     found.data());
+  for (const int i : queries.index_range()) {
+    EXPECT_EQ(found[i], 3);
+  }
+
+  BLI_kdtree_3d_free(tree);
+}
+
+}  // namespace blender::tests
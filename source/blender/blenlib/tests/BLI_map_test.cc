@@ -653,6 +653,78 @@ TEST(map, LookupKey)
   EXPECT_EQ(map.lookup_key_ptr("a"), map.lookup_key_ptr_as("a"));
 }
 
+TEST(map, GroupProbing)
+{
+  Map<int, int, 4, GroupProbingStrategy> map;
+  EXPECT_FALSE(map.contains(0));
+  for (int i = 0; i < 10000; i++) {
+    EXPECT_TRUE(map.add(i * 7, i));
+  }
+  EXPECT_EQ(map.size(), 10000);
+  EXPECT_FALSE(map.add(7, 0));
+  for (int i = 0; i < 10000; i++) {
+    EXPECT_EQ(map.lookup(i * 7), i);
+    EXPECT_FALSE(map.contains(i * 7 + 1));
+  }
+  for (int i = 0; i < 10000; i += 2) {
+    EXPECT_TRUE(map.remove(i * 7));
+  }
+  EXPECT_EQ(map.size(), 5000);
+  for (int i = 0; i < 10000; i++) {
+    EXPECT_EQ(map.contains(i * 7), i % 2 == 1);
+  }
+  map.add_overwrite(7, 100);
+  EXPECT_EQ(map.lookup(7), 100);
+  EXPECT_EQ(map.lookup_or_add(14, 5), 5);
+  EXPECT_EQ(map.pop(14), 5);
+  EXPECT_FALSE(map.contains(14));
+}
+
+TEST(map, GroupProbingCopyAndMove)
+{
+  Map<std::string, int, 0, GroupProbingStrategy> map;
+  for (int i = 0; i < 100; i++) {
+    map.add(std::to_string(i), i);
+  }
+  Map<std::string, int, 0, GroupProbingStrategy> map_copy = map;
+  Map<std::string, int, 0, GroupProbingStrategy> map_moved = std::move(map);
+  EXPECT_EQ(map.size(), 0); /* NOLINT: bugprone-use-after-move */
+  EXPECT_FALSE(map.contains("1"));
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(map_copy.lookup(std::to_string(i)), i);
+    EXPECT_EQ(map_moved.lookup_as(std::to_string(i)), i);
+  }
+  map_copy.clear();
+  EXPECT_FALSE(map_copy.contains("5"));
+  map_copy.add("5", 5);
+  EXPECT_EQ(map_copy.lookup("5"), 5);
+}
+
+TEST(map, GroupProbingRemoveDuringIteration)
+{
+  using MapType = Map<int, int, 0, GroupProbingStrategy>;
+  MapType map;
+  for (int i = 0; i < 1000; i++) {
+    map.add(i, i);
+  }
+  using Iter = MapType::MutableItemIterator;
+  Iter begin = map.items().begin();
+  Iter end = map.items().end();
+  for (Iter iter = begin; iter != end; ++iter) {
+    if ((*iter).key % 3 == 0) {
+      map.remove(iter);
+    }
+  }
+  EXPECT_EQ(map.size(), 666);
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(map.contains(i), i % 3 != 0);
+  }
+  for (int i = 0; i < 1000; i += 3) {
+    map.add_new(i, i);
+  }
+  EXPECT_EQ(map.size(), 1000);
+}
+
 /**
  * Set this to 1 to activate the benchmark. It is disabled by default, because it prints a lot.
  */
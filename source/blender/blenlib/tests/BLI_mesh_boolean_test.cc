@@ -8,13 +8,18 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "PIL_time.h"
+
 #include "BLI_array.hh"
 #include "BLI_map.hh"
 #include "BLI_math_mpq.hh"
 #include "BLI_math_vec_mpq_types.hh"
 #include "BLI_mesh_boolean.hh"
+#include "BLI_task.h"
 #include "BLI_vector.hh"
 
+#define DO_PERF_TESTS 0
+
 #ifdef WITH_GMP
 namespace blender::meshintersect::tests {
 
@@ -953,5 +958,184 @@ TEST(boolean_polymesh, CubePlane)
   }
 }
 
+/**
+ * Add the quads of a box from \a min to \a max to \a faces, with each side subdivided
+ * into `subdiv * subdiv` quads and the box rotated by \a rot_deg degrees around the
+ * z axis through its center. The vertices are shared between the sides because the arena
+ * merges vertices with the same coordinates.
+ */
+static void fill_box_data(const double3 &min,
+                          const double3 &max,
+                          int subdiv,
+                          double rot_deg,
+                          Vector<Face *> &faces,
+                          int *r_vid,
+                          IMeshArena *arena)
+{
+  const double3 center = (min + max) / 2.0;
+  const double cos_rot = cos(rot_deg * M_PI / 180.0);
+  const double sin_rot = sin(rot_deg * M_PI / 180.0);
+  /* Compute coordinates the same way for all sides, so that the shared vertices are equal. */
+  auto coord = [&](int axis, int i) {
+    return i == subdiv ? max[axis] : min[axis] + i * (max[axis] - min[axis]) / subdiv;
+  };
+  auto add_vert = [&](double3 co) {
+    if (rot_deg != 0.0) {
+      const double x = co[0] - center[0];
+      const double y = co[1] - center[1];
+      co[0] = center[0] + x * cos_rot - y * sin_rot;
+      co[1] = center[1] + x * sin_rot + y * cos_rot;
+    }
+    return arena->add_or_find_vert(mpq3(co[0], co[1], co[2]), (*r_vid)++);
+  };
+  Array<int> eid = {NO_INDEX, NO_INDEX, NO_INDEX, NO_INDEX};
+  for (int axis = 0; axis < 3; axis++) {
+    const int u_axis = (axis + 1) % 3;
+    const int v_axis = (axis + 2) % 3;
+    for (int side = 0; side < 2; side++) {
+      Array<const Vert *> verts((subdiv + 1) * (subdiv + 1));
+      for (int j = 0; j <= subdiv; j++) {
+        for (int i = 0; i <= subdiv; i++) {
+          double3 co;
+          co[axis] = side == 0 ? min[axis] : max[axis];
+          co[u_axis] = coord(u_axis, i);
+          co[v_axis] = coord(v_axis, j);
+          verts[j * (subdiv + 1) + i] = add_vert(co);
+        }
+      }
+      for (int j = 0; j < subdiv; j++) {
+        for (int i = 0; i < subdiv; i++) {
+          const Vert *v0 = verts[j * (subdiv + 1) + i];
+          const Vert *v1 = verts[j * (subdiv + 1) + i + 1];
+          const Vert *v2 = verts[(j + 1) * (subdiv + 1) + i + 1];
+          const Vert *v3 = verts[(j + 1) * (subdiv + 1) + i];
+          /* Make the normals point out of the box. */
+          if (side == 1) {
+            faces.append(arena->add_face({v0, v1, v2, v3}, faces.size(), eid));
+          }
+          else {
+            faces.append(arena->add_face({v3, v2, v1, v0}, faces.size(), eid));
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * A hard-surface style workload: a 4x4x4 box with each side subdivided into
+ * `box_subdiv * box_subdiv` quads, and a `cutters * cutters` array of boxes rotated by
+ * \a cutter_rot_deg that cut into its top side. The box faces come first in the mesh.
+ */
+static IMesh make_box_cutters_mesh(
+    int box_subdiv, int cutters, double cutter_rot_deg, int *r_box_faces, IMeshArena *arena)
+{
+  Vector<Face *> faces;
+  int vid = 0;
+  fill_box_data(double3(-2, -2, -2), double3(2, 2, 2), box_subdiv, 0.0, faces, &vid, arena);
+  *r_box_faces = faces.size();
+  const double cell_size = 4.0 / cutters;
+  const double half_size = 0.3 * cell_size;
+  for (int iy = 0; iy < cutters; iy++) {
+    for (int ix = 0; ix < cutters; ix++) {
+      const double x = -2.0 + (ix + 0.5) * cell_size;
+      const double y = -2.0 + (iy + 0.5) * cell_size;
+      fill_box_data(double3(x - half_size, y - half_size, 1.5),
+                    double3(x + half_size, y + half_size, 2.5),
+                    1,
+                    cutter_rot_deg,
+                    faces,
+                    &vid,
+                    arena);
+    }
+  }
+  return IMesh(faces);
+}
+
+TEST(boolean_polymesh, BoxCutters)
+{
+  for (const double rot_deg : {0.0, 20.0}) {
+    IMeshArena arena;
+    int box_faces;
+    IMesh mesh = make_box_cutters_mesh(5, 2, rot_deg, &box_faces, &arena);
+    IMesh out = boolean_mesh(
+        mesh,
+        BoolOpType::Difference,
+        2,
+        [box_faces](int t) { return t < box_faces ? 0 : 1; },
+        false,
+        false,
+        nullptr,
+        &arena);
+    out.populate_vert();
+    if (rot_deg == 0.0) {
+      EXPECT_EQ(out.vert_size(), 200);
+      EXPECT_EQ(out.face_size(), 173);
+    }
+    else {
+      EXPECT_EQ(out.vert_size(), 208);
+      EXPECT_EQ(out.face_size(), 174);
+    }
+    if (DO_OBJ) {
+      write_obj_mesh(out, rot_deg == 0.0 ? "box_cutters" : "box_cutters_rot");
+    }
+  }
+}
+
+#  if DO_PERF_TESTS
+
+static void box_cutters_perf_test(int box_subdiv, int cutters, double cutter_rot_deg)
+{
+  BLI_task_scheduler_init(); /* Without this, no parallelism. */
+  double time_start = PIL_check_seconds_timer();
+  IMeshArena arena;
+  int box_faces;
+  IMesh mesh = make_box_cutters_mesh(box_subdiv, cutters, cutter_rot_deg, &box_faces, &arena);
+  double time_create = PIL_check_seconds_timer();
+  IMesh out = boolean_mesh(
+      mesh,
+      BoolOpType::Difference,
+      2,
+      [box_faces](int t) { return t < box_faces ? 0 : 1; },
+      false,
+      false,
+      nullptr,
+      &arena);
+  double time_boolean = PIL_check_seconds_timer();
+  std::cout << "Input triangles: " << 2 * mesh.face_size() << "\n";
+  std::cout << "Output faces: " << out.face_size() << "\n";
+  std::cout << "Create time: " << time_create - time_start << "\n";
+  std::cout << "Boolean time: " << time_boolean - time_create << "\n";
+  std::cout << "Total time: " << time_boolean - time_start << "\n";
+  if (DO_OBJ) {
+    write_obj_mesh(out, "box_cutters_perf");
+  }
+  BLI_task_scheduler_exit();
+}
+
+/* The box has `12 * box_subdiv^2` triangles. */
+
+TEST(boolean_polymesh_perf, BoxCutters100K)
+{
+  box_cutters_perf_test(91, 8, 0.0);
+}
+
+TEST(boolean_polymesh_perf, BoxCuttersTilt100K)
+{
+  box_cutters_perf_test(91, 8, 15.0);
+}
+
+TEST(boolean_polymesh_perf, BoxCutters1M)
+{
+  box_cutters_perf_test(289, 32, 15.0);
+}
+
+TEST(boolean_polymesh_perf, BoxCutters5M)
+{
+  box_cutters_perf_test(645, 64, 15.0);
+}
+
+#  endif
+
 }  // namespace blender::meshintersect::tests
 #endif
@@ -570,6 +570,35 @@ TEST(set, RemoveDuringIteration)
   EXPECT_TRUE(set.contains(3));
 }
 
+TEST(set, GroupProbing)
+{
+  Set<int, 4, GroupProbingStrategy> set;
+  EXPECT_FALSE(set.contains(0));
+  for (int i = 0; i < 10000; i++) {
+    EXPECT_TRUE(set.add(i << 16));
+  }
+  EXPECT_EQ(set.size(), 10000);
+  EXPECT_FALSE(set.add(1 << 16));
+  for (int i = 0; i < 10000; i++) {
+    EXPECT_TRUE(set.contains(i << 16));
+    EXPECT_FALSE(set.contains((i << 16) + 1));
+  }
+  for (int i = 0; i < 10000; i += 2) {
+    EXPECT_TRUE(set.remove(i << 16));
+  }
+  EXPECT_EQ(set.size(), 5000);
+  for (int i = 0; i < 10000; i++) {
+    EXPECT_EQ(set.contains(i << 16), i % 2 == 1);
+  }
+
+  Set<int, 4, GroupProbingStrategy> set_copy = set;
+  set.clear();
+  EXPECT_FALSE(set.contains(1 << 16));
+  EXPECT_TRUE(set_copy.contains(1 << 16));
+  EXPECT_EQ(set_copy.lookup_key_or_add(3 << 16), 3 << 16);
+  EXPECT_EQ(set_copy.size(), 5000);
+}
+
 /**
  * Set this to 1 to activate the benchmark. It is disabled by default, because it prints a lot.
  */
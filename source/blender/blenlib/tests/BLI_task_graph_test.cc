@@ -2,6 +2,8 @@
 
 #include "testing/testing.h"
 
+#include <atomic>
+
 #include "MEM_guardedalloc.h"
 
 #include "BLI_task.h"
@@ -188,3 +190,176 @@ TEST(task, GraphTaskData)
   EXPECT_EQ(1, data.value);
   EXPECT_EQ(0, data.store);
 }
+
+static void TaskData_atomic_increase_value(void *taskdata)
+{
+  std::atomic<int> *value = (std::atomic<int> *)taskdata;
+  *value += 1;
+}
+
+/* A node with multiple parents only runs after all of them finished. */
+TEST(task, GraphJoin)
+{
+  TaskData data = {2};
+  TaskGraph *graph = BLI_task_graph_create();
+  TaskNode *node_a = BLI_task_graph_node_create(graph, TaskData_store_value, &data, nullptr);
+  TaskNode *node_b = BLI_task_graph_node_create(
+      graph, TaskData_multiply_by_two_store, &data, nullptr);
+  TaskNode *node_c = BLI_task_graph_node_create(graph, TaskData_square_value, &data, nullptr);
+  TaskNode *node_d = BLI_task_graph_node_create(graph, TaskData_increase_value, &data, nullptr);
+  BLI_task_graph_edge_create(node_a, node_b);
+  BLI_task_graph_edge_create(node_a, node_c);
+  BLI_task_graph_edge_create(node_b, node_d);
+  BLI_task_graph_edge_create(node_c, node_d);
+
+  for (int i = 0; i < 2; i++) {
+    data = {2, 0};
+    EXPECT_TRUE(BLI_task_graph_node_push_work(node_a));
+    BLI_task_graph_work_and_wait(graph);
+    EXPECT_EQ(5, data.value);
+    EXPECT_EQ(4, data.store);
+  }
+
+  TaskGraphStats stats;
+  BLI_task_graph_node_stats_get(node_d, &stats);
+  EXPECT_EQ(1, stats.nodes_num);
+  EXPECT_EQ(2, stats.run_count);
+  EXPECT_EQ(0, stats.skip_count);
+  BLI_task_graph_free(graph);
+}
+
+struct CancelData {
+  TaskGraph *graph;
+  std::atomic<int> value;
+};
+
+static void CancelData_cancel(void *taskdata)
+{
+  CancelData *data = (CancelData *)taskdata;
+  data->value += 1;
+  BLI_task_graph_cancel(data->graph);
+  EXPECT_TRUE(BLI_task_graph_is_canceled(data->graph));
+}
+
+static void CancelData_increase_value(void *taskdata)
+{
+  CancelData *data = (CancelData *)taskdata;
+  data->value += 1;
+}
+
+TEST(task, GraphCancel)
+{
+  CancelData data;
+  data.graph = BLI_task_graph_create();
+  data.value = 0;
+
+  TaskNode *node_a = BLI_task_graph_node_create(data.graph, CancelData_cancel, &data, nullptr);
+  TaskNode *node_b = BLI_task_graph_node_create(
+      data.graph, CancelData_increase_value, &data, nullptr);
+  TaskNode *node_c = BLI_task_graph_node_create(
+      data.graph, CancelData_increase_value, &data, nullptr);
+  BLI_task_graph_edge_create(node_a, node_b);
+  BLI_task_graph_edge_create(node_b, node_c);
+
+  EXPECT_TRUE(BLI_task_graph_node_push_work(node_a));
+  BLI_task_graph_work_and_wait(data.graph);
+  EXPECT_EQ(1, data.value);
+  EXPECT_FALSE(BLI_task_graph_is_canceled(data.graph));
+
+  /* The cancellation is cleared after waiting, so the graph can run again. */
+  EXPECT_TRUE(BLI_task_graph_node_push_work(node_b));
+  BLI_task_graph_work_and_wait(data.graph);
+  EXPECT_EQ(3, data.value);
+
+  TaskGraphStats stats;
+  BLI_task_graph_stats_get(data.graph, &stats);
+  EXPECT_EQ(3, stats.nodes_num);
+  EXPECT_EQ(3, stats.run_count);
+  EXPECT_EQ(2, stats.skip_count);
+  BLI_task_graph_free(data.graph);
+}
+
+TEST(task, GraphCancelToken)
+{
+  std::atomic<int> value = 0;
+  short stop = 1;
+  TaskGraph *graph = BLI_task_graph_create();
+  BLI_task_graph_cancel_token_set(graph, &stop);
+
+  TaskNode *node_a = BLI_task_graph_node_create(
+      graph, TaskData_atomic_increase_value, &value, nullptr);
+  TaskNode *node_b = BLI_task_graph_node_create(
+      graph, TaskData_atomic_increase_value, &value, nullptr);
+  BLI_task_graph_edge_create(node_a, node_b);
+
+  EXPECT_TRUE(BLI_task_graph_node_push_work(node_a));
+  BLI_task_graph_work_and_wait(graph);
+  EXPECT_EQ(0, value);
+
+  stop = 0;
+  EXPECT_TRUE(BLI_task_graph_node_push_work(node_a));
+  BLI_task_graph_work_and_wait(graph);
+  EXPECT_EQ(2, value);
+  BLI_task_graph_free(graph);
+}
+
+struct DynamicData {
+  TaskGraph *graph;
+  TaskNode *node;
+  std::atomic<int> value;
+  int depth;
+};
+
+/* Adds a successor to the running node, and a separate node that is pushed right away. */
+static void DynamicData_spawn(void *taskdata)
+{
+  DynamicData *data = (DynamicData *)taskdata;
+  data->value += 1;
+  if (data->depth == 0) {
+    return;
+  }
+  for (int i = 0; i < 2; i++) {
+    DynamicData *child = (DynamicData *)MEM_callocN(sizeof(DynamicData), __func__);
+    child->graph = data->graph;
+    child->depth = data->depth - 1;
+    child->node = BLI_task_graph_node_create(data->graph, DynamicData_spawn, child, MEM_freeN);
+    /* Only the child data is freed with the graph, the value is accumulated in the root. */
+    child->value = 0;
+    if (i == 0) {
+      BLI_task_graph_edge_create(data->node, child->node);
+    }
+    else {
+      BLI_task_graph_node_push_work(child->node);
+    }
+  }
+}
+
+static void DynamicData_sum(void *taskdata)
+{
+  DynamicData *data = (DynamicData *)taskdata;
+  data->value += 1;
+}
+
+TEST(task, GraphDynamicNodes)
+{
+  DynamicData data;
+  data.graph = BLI_task_graph_create();
+  data.node = BLI_task_graph_node_create(data.graph, DynamicData_spawn, &data, nullptr);
+  data.value = 0;
+  data.depth = 4;
+  TaskNode *node_low = BLI_task_graph_node_create(data.graph, DynamicData_sum, &data, nullptr);
+  BLI_task_graph_node_priority_set(node_low, TASK_PRIORITY_LOW);
+  BLI_task_graph_edge_create(data.node, node_low);
+
+  EXPECT_TRUE(BLI_task_graph_node_push_work(data.node));
+  BLI_task_graph_work_and_wait(data.graph);
+  EXPECT_EQ(2, data.value);
+
+  /* Every node ran exactly once: the root, the low priority node and 2 + 4 + 8 + 16 children. */
+  TaskGraphStats stats;
+  BLI_task_graph_stats_get(data.graph, &stats);
+  EXPECT_EQ(32, stats.nodes_num);
+  EXPECT_EQ(32, stats.run_count);
+  EXPECT_GE(stats.time_total, stats.time_max);
+  BLI_task_graph_free(data.graph);
+}
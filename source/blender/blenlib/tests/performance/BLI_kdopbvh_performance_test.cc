@@ -0,0 +1,172 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array.hh"
+#include "BLI_kdopbvh.h"
+#include "BLI_math_geom.h"
+#include "BLI_math_vec_types.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.h"
+#include "BLI_task.hh"
+#include "BLI_timeit.hh"
+#include "BLI_vector.hh"
+
+namespace blender::tests {
+
+struct Triangles {
+  Vector<float3> verts;
+};
+
+/**
+ * Create a triangle soup where most triangles are small and packed into a few clusters, similar to
+ * meshes that are very detailed in some places and coarse in others.
+ */
+static Triangles create_uneven_triangles(const int tris_num)
+{
+  RNG *rng = BLI_rng_new(0);
+  Triangles triangles;
+  triangles.verts.resize(tris_num * 3);
+  for (const int i : IndexRange(tris_num)) {
+    const bool is_dense = (i % 16) != 0;
+    float3 center;
+    BLI_rng_get_float_unit_v3(rng, center);
+    center *= is_dense ? 0.05f : 1.0f;
+    center[0] += is_dense ? (float)(i % 5) * 0.3f : 0.0f;
+    const float size = is_dense ? 0.001f : 0.05f;
+    for (const int j : IndexRange(3)) {
+      float3 offset;
+      BLI_rng_get_float_unit_v3(rng, offset);
+      triangles.verts[i * 3 + j] = center + offset * size;
+    }
+  }
+  BLI_rng_free(rng);
+  return triangles;
+}
+
+static void raycast_callback(void *userdata, int index, const BVHTreeRay *ray, BVHTreeRayHit *hit)
+{
+  const Triangles &triangles = *static_cast<const Triangles *>(userdata);
+  const float3 &v0 = triangles.verts[index * 3];
+  const float3 &v1 = triangles.verts[index * 3 + 1];
+  const float3 &v2 = triangles.verts[index * 3 + 2];
+  float dist;
+  if (isect_ray_tri_watertight_v3(ray->origin, ray->isect_precalc, v0, v1, v2, &dist, nullptr) &&
+      dist < hit->dist) {
+    hit->index = index;
+    hit->dist = dist;
+  }
+}
+
+static BVHTree *build_tree(const Triangles &triangles, const int tree_type, const int flag)
+{
+  const int tris_num = triangles.verts.size() / 3;
+  BVHTree *tree = BLI_bvhtree_new_ex(tris_num, 0.0f, tree_type, 6, flag);
+  for (const int i : IndexRange(tris_num)) {
+    BLI_bvhtree_insert(tree, i, triangles.verts[i * 3], 3);
+  }
+  BLI_bvhtree_balance(tree);
+  return tree;
+}
+
+static void benchmark_tree(const Triangles &triangles,
+                           const int tree_type,
+                           const int flag,
+                           const Span<float3> origins,
+                           const Span<float3> directions)
+{
+  const std::string name = std::string(flag & BVH_BUILD_SAH ? "SAH   " : "Median") + " tree " +
+                           std::to_string(tree_type);
+  BVHTree *tree;
+  {
+    SCOPED_TIMER(name + " build");
+    tree = build_tree(triangles, tree_type, flag);
+  }
+
+  Array<BVHTreeRayHit> hits(origins.size());
+  {
+    SCOPED_TIMER(name + " ray cast");
+    threading::parallel_for(origins.index_range(), 1024, [&](const IndexRange range) {
+      for (const int i : range) {
+        hits[i].index = -1;
+        hits[i].dist = BVH_RAYCAST_DIST_MAX;
+        BLI_bvhtree_ray_cast(tree,
+                             origins[i],
+                             directions[i],
+                             0.0f,
+                             &hits[i],
+                             raycast_callback,
+                             const_cast<Triangles *>(&triangles));
+      }
+    });
+  }
+  {
+    SCOPED_TIMER(name + " ray cast batch");
+    threading::parallel_for(origins.index_range(), 4096, [&](const IndexRange range) {
+      for (const int i : range) {
+        hits[i].index = -1;
+        hits[i].dist = BVH_RAYCAST_DIST_MAX;
+      }
+      BLI_bvhtree_ray_cast_batch(tree,
+                                 reinterpret_cast<const float(*)[3]>(&origins[range.start()]),
+                                 reinterpret_cast<const float(*)[3]>(&directions[range.start()]),
+                                 range.size(),
+                                 0.0f,
+                                 &hits[range.start()],
+                                 raycast_callback,
+                                 const_cast<Triangles *>(&triangles),
+                                 BVH_RAYCAST_DEFAULT);
+    });
+  }
+
+  int hits_num = 0;
+  for (const BVHTreeRayHit &hit : hits) {
+    hits_num += hit.index != -1;
+  }
+  /* Print the value for simple error checking and to avoid some compiler optimizations. */
+  std::cout << "Hits: " << hits_num << "\n";
+
+  BLI_bvhtree_free(tree);
+}
+
+static void benchmark_trees(const int tris_num, const int rays_num)
+{
+  std::cout << "\n========== " << tris_num << " triangles, " << rays_num
+            << " rays ==========\n";
+
+  const Triangles triangles = create_uneven_triangles(tris_num);
+
+  /* Rays start on a grid above the triangles and point down with some variation. */
+  RNG *rng = BLI_rng_new(1);
+  Array<float3> origins(rays_num);
+  Array<float3> directions(rays_num);
+  const int side = (int)sqrtf((float)rays_num);
+  for (const int i : IndexRange(rays_num)) {
+    origins[i] = float3((float)(i % side) / side * 2.0f - 1.0f,
+                        (float)(i / side) / side * 2.0f - 1.0f,
+                        2.0f);
+    float3 jitter;
+    BLI_rng_get_float_unit_v3(rng, jitter);
+    directions[i] = math::normalize(float3(0.0f, 0.0f, -1.0f) + jitter * 0.1f);
+  }
+  BLI_rng_free(rng);
+
+  for (const int tree_type : {4, 8}) {
+    benchmark_tree(triangles, tree_type, 0, origins, directions);
+    benchmark_tree(triangles, tree_type, BVH_BUILD_SAH, origins, directions);
+  }
+}
+
+TEST(kdopbvh, Uneven100K)
+{
+  benchmark_trees(100000, 1000000);
+}
+
+TEST(kdopbvh, Uneven1M)
+{
+  benchmark_trees(1000000, 10000000);
+}
+
+}  // namespace blender::tests
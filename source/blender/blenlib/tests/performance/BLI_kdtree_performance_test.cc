@@ -0,0 +1,116 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array.hh"
+#include "BLI_kdtree.h"
+#include "BLI_rand.hh"
+#include "BLI_task.hh"
+#include "BLI_timeit.hh"
+
+namespace blender::tests {
+
+/** Access the functions of the KD-trees with different dimensions in the same way. */
+template<int Dims> struct KDTreeFunctions;
+
+#define KDTREE_FUNCTIONS(DIMS) \
+  template<> struct KDTreeFunctions<DIMS> { \
+    using Tree = KDTree_##DIMS##d; \
+    using Nearest = KDTreeNearest_##DIMS##d; \
+    static constexpr auto tree_new = BLI_kdtree_##DIMS##d_new; \
+    static constexpr auto tree_free = BLI_kdtree_##DIMS##d_free; \
+    static constexpr auto insert = BLI_kdtree_##DIMS##d_insert; \
+    static constexpr auto balance = BLI_kdtree_##DIMS##d_balance; \
+    static constexpr auto find_nearest_n = BLI_kdtree_##DIMS##d_find_nearest_n; \
+    static constexpr auto find_nearest_n_batch = BLI_kdtree_##DIMS##d_find_nearest_n_batch; \
+  };
+
+KDTREE_FUNCTIONS(1)
+KDTREE_FUNCTIONS(2)
+KDTREE_FUNCTIONS(3)
+KDTREE_FUNCTIONS(4)
+
+#undef KDTREE_FUNCTIONS
+
+template<int Dims> static Array<float> random_coords(const int size, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float> coords(size * Dims);
+  for (float &value : coords) {
+    value = rng.get_float();
+  }
+  return coords;
+}
+
+template<int Dims>
+static void benchmark_kdtree(const int points_num, const int queries_num, const int nearest_len)
+{
+  using Fn = KDTreeFunctions<Dims>;
+  using Nearest = typename Fn::Nearest;
+  const std::string name = std::to_string(Dims) + "D";
+  std::cout << "\n========== " << name << ", " << points_num << " points, " << queries_num
+            << " queries ==========\n";
+
+  const Array<float> points = random_coords<Dims>(points_num, 0);
+  const Array<float> queries = random_coords<Dims>(queries_num, 1);
+  const float(*query_coords)[Dims] = reinterpret_cast<const float(*)[Dims]>(queries.data());
+
+  typename Fn::Tree *tree = Fn::tree_new(points_num);
+  for (const int i : IndexRange(points_num)) {
+    Fn::insert(tree, i, &points[i * Dims]);
+  }
+  {
+    SCOPED_TIMER(name + " balance");
+    Fn::balance(tree);
+  }
+
+  Array<Nearest> nearest(queries_num * nearest_len);
+  Array<int> found(queries_num);
+  {
+    SCOPED_TIMER(name + " find nearest n");
+    threading::parallel_for(IndexRange(queries_num), 256, [&](const IndexRange range) {
+      for (const int i : range) {
+        found[i] = Fn::find_nearest_n(
+            tree, query_coords[i], &nearest[i * nearest_len], nearest_len);
+      }
+    });
+  }
+  {
+    SCOPED_TIMER(name + " find nearest n batch");
+    Fn::find_nearest_n_batch(
+        tree, query_coords, queries_num, nearest.data(), nearest_len, found.data());
+  }
+
+  /* Print a value for simple error checking and to avoid some compiler optimizations. */
+  int64_t index_sum = 0;
+  for (const int i : IndexRange(queries_num)) {
+    for (const int j : IndexRange(found[i])) {
+      index_sum += nearest[i * nearest_len + j].index;
+    }
+  }
+  std::cout << "Index sum: " << index_sum << "\n";
+
+  Fn::tree_free(tree);
+}
+
+static void benchmark_kdtrees(const int points_num, const int queries_num)
+{
+  benchmark_kdtree<1>(points_num, queries_num, 8);
+  benchmark_kdtree<2>(points_num, queries_num, 8);
+  benchmark_kdtree<3>(points_num, queries_num, 8);
+  benchmark_kdtree<4>(points_num, queries_num, 8);
+}
+
+TEST(kdtree, Random1M)
+{
+  benchmark_kdtrees(1000000, 1000000);
+}
+
+TEST(kdtree, Random10M)
+{
+  benchmark_kdtrees(10000000, 1000000);
+}
+
+}  // namespace blender::tests
@@ -0,0 +1,141 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_ghash.h"
+#include "BLI_map.hh"
+#include "BLI_rand.h"
+#include "BLI_timeit.hh"
+#include "BLI_vector.hh"
+
+/* Run the longest tests (100M entries, needs several GB of memory)! */
+//#define MAP_RUN_BIG
+
+namespace blender::tests {
+
+using GroupProbingMap = Map<int,
+                            int,
+                            default_inline_buffer_capacity(sizeof(int) * 2),
+                            GroupProbingStrategy>;
+
+/**
+ * Gives GHash the same interface as blender::Map, so that the same benchmark can be used.
+ */
+class GHashIntWrapper {
+ private:
+  GHash *ghash_;
+
+ public:
+  GHashIntWrapper() : ghash_(BLI_ghash_int_new(__func__))
+  {
+  }
+
+  ~GHashIntWrapper()
+  {
+    BLI_ghash_free(ghash_, nullptr, nullptr);
+  }
+
+  bool add(const int key, const int value)
+  {
+    void **value_p;
+    if (BLI_ghash_ensure_p(ghash_, POINTER_FROM_INT(key), &value_p)) {
+      return false;
+    }
+    *value_p = POINTER_FROM_INT(value);
+    return true;
+  }
+
+  bool contains(const int key) const
+  {
+    return BLI_ghash_haskey(ghash_, POINTER_FROM_INT(key));
+  }
+
+  bool remove(const int key)
+  {
+    return BLI_ghash_remove(ghash_, POINTER_FROM_INT(key), nullptr, nullptr);
+  }
+};
+
+template<typename MapT>
+static void benchmark_random_ints(StringRef name, const Span<int> values, const Span<int> misses)
+{
+  MapT map;
+  {
+    SCOPED_TIMER(name + " Add");
+    for (const int value : values) {
+      map.add(value, value);
+    }
+  }
+  int64_t count = 0;
+  {
+    SCOPED_TIMER(name + " Contains");
+    for (const int value : values) {
+      count += map.contains(value);
+    }
+  }
+  {
+    SCOPED_TIMER(name + " Contains (missing)");
+    for (const int value : misses) {
+      count += map.contains(value);
+    }
+  }
+  {
+    SCOPED_TIMER(name + " Remove");
+    for (const int value : values) {
+      count += map.remove(value);
+    }
+  }
+
+  /* Print the value for simple error checking and to avoid some compiler optimizations. */
+  std::cout << "Count: " << count << "\n";
+}
+
+static void benchmark_maps(const int amount, const int factor)
+{
+  std::cout << "\n========== " << amount << " random ints (factor " << factor
+            << ") ==========\n";
+
+  RNG *rng = BLI_rng_new(0);
+  Vector<int> values(amount);
+  Vector<int> misses(amount);
+  for (const int i : IndexRange(amount)) {
+    /* Even values are added, odd values are never found. */
+    values[i] = (BLI_rng_get_int(rng) & ~1) * factor;
+    misses[i] = (BLI_rng_get_int(rng) | 1) * factor;
+  }
+  BLI_rng_free(rng);
+
+  benchmark_random_ints<Map<int, int>>("blender::Map              ", values, misses);
+  benchmark_random_ints<GroupProbingMap>("blender::Map (group probe)", values, misses);
+  benchmark_random_ints<GHashIntWrapper>("GHash                     ", values, misses);
+}
+
+TEST(map, IntRandom1K)
+{
+  benchmark_maps(1000, 1);
+  benchmark_maps(1000, 3 << 10);
+}
+
+TEST(map, IntRandom100K)
+{
+  benchmark_maps(100000, 1);
+  benchmark_maps(100000, 3 << 10);
+}
+
+TEST(map, IntRandom10M)
+{
+  benchmark_maps(10000000, 1);
+  benchmark_maps(10000000, 3 << 10);
+}
+
+#ifdef MAP_RUN_BIG
+TEST(map, IntRandom100M)
+{
+  benchmark_maps(100000000, 1);
+  benchmark_maps(100000000, 3 << 10);
+}
+#endif
+
+}  // namespace blender::tests
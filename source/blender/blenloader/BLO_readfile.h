@@ -98,7 +98,14 @@ typedef struct BlendFileReadReport {
   /* Timing information. */
   struct {
     double whole;
+    /** Reading the data-blocks of the main file, including DNA reconstruction. */
+    double read_data;
+    /** Reading the libraries and linking pointers between all data-blocks. */
     double libraries;
+    /** Part of #libraries spent reading the data-blocks of the libraries (#read_libraries). */
+    double read_libraries;
+    /** Part of #libraries spent linking pointers between data-blocks (#lib_link_all). */
+    double lib_link;
     double lib_overrides;
     double lib_overrides_resync;
     double lib_overrides_recursive_resync;
@@ -27,6 +27,7 @@
 #include "BLI_filereader.h"
 
 struct GHash;
+struct GSet;
 struct Scene;
 
 typedef struct {
@@ -36,6 +37,10 @@ typedef struct {
   size_t size;
   /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
   bool is_identical;
+  /** When true, this chunk doesn't own the memory either, it's shared with a previous
+   * #MemFileChunk of the same ID that has the same content but not at the same position
+   * (so unlike #is_identical, it doesn't mean the ID is unchanged). */
+  bool is_shared;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
    * Defined when writing the next step (i.e. last undo step has those always false). */
@@ -43,6 +48,10 @@ typedef struct {
   /** Session UUID of the ID being currently written (MAIN_ID_SESSION_UUID_UNSET when not writing
    * ID-related data). Used to find matching chunks in previous memundo step. */
   uint id_session_uuid;
+  /** Hash of the content, used to find matching chunks in the next memundo step.
+   * Only computed when needed, see #is_hashed. */
+  uint hash;
+  bool is_hashed;
 } MemFileChunk;
 
 typedef struct MemFile {
@@ -59,6 +68,12 @@ typedef struct MemFileWriteData {
 
   /** Maps an ID session uuid to its first reference MemFileChunk, if existing. */
   struct GHash *id_session_uuid_mapping;
+  /** Set of ID-related reference MemFileChunk, looked up by content hash, size and ID session
+   * uuid when a chunk doesn't match the one at the same position. Only the chunks of IDs in
+   * #reference_hashed_ids are added, on the first mismatch of each ID. */
+  struct GSet *reference_chunks_by_hash;
+  /** Session uuids of the IDs whose reference chunks are in #reference_chunks_by_hash. */
+  struct GSet *reference_hashed_ids;
 } MemFileWriteData;
 
 typedef struct MemFileUndoData {
@@ -73,6 +73,12 @@ extern bool BLO_write_file(struct Main *mainvar,
                            const struct BlendFileWriteParams *params,
                            struct ReportList *reports);
 
+/**
+ * Free the information kept about previously written compressed files,
+ * which is used to speed up saving them again.
+ */
+extern void BLO_write_file_cache_free(void);
+
 /**
  * \return Success.
  */
@@ -69,6 +69,7 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "PIL_time.h"
@@ -951,11 +952,37 @@ BHead *blo_bhead_next(FileData *fd, BHead *thisblock)
 }
 
 #ifdef USE_BHEAD_READ_ON_DEMAND
+/**
+ * Access the data of a block that hasn't been read yet directly in the memory backing the file
+ * (memory-mapped and in-memory files), avoiding a temporary copy.
+ *
+ * \return NULL when the file isn't backed by memory.
+ * Otherwise #BLI_filereader_memory_check must be called once the data has been accessed.
+ */
+static const void *blo_bhead_peek_mapped_data(FileData *fd, BHead *thisblock)
+{
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  if (fd->flags & FD_FLAGS_IS_MEMFILE) {
+    return NULL;
+  }
+  return BLI_filereader_memory_pointer(
+      fd->file, new_bhead->file_offset, (size_t)new_bhead->bhead.len);
+}
+
 static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
 {
   bool success = true;
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+
+  /* Skip seeking back and forth when the data can be copied from memory directly. */
+  const void *mapped_data = blo_bhead_peek_mapped_data(fd, thisblock);
+  if (mapped_data != NULL) {
+    memcpy(buf, mapped_data, (size_t)new_bhead->bhead.len);
+    return BLI_filereader_memory_check(fd->file);
+  }
+
   off64_t offset_backup = fd->file->offset;
   if (UNLIKELY(fd->file->seek(fd->file, new_bhead->file_offset, SEEK_SET) == -1)) {
     success = false;
@@ -1888,6 +1915,18 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
+          /* Reconstruct straight from the mapped file when possible,
+           * instead of reading the whole block into a temporary buffer first. */
+          const void *mapped_data = blo_bhead_peek_mapped_data(fd, bh);
+          if (mapped_data != NULL) {
+            temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, mapped_data);
+            if (UNLIKELY(!BLI_filereader_memory_check(fd->file))) {
+              fd->flags &= ~FD_FLAGS_FILE_OK;
+              MEM_SAFE_FREE(temp);
+            }
+            return temp;
+          }
+
           bh = blo_bhead_read_full(fd, bh);
           if (UNLIKELY(bh == NULL)) {
             fd->flags &= ~FD_FLAGS_FILE_OK;
@@ -1929,6 +1968,50 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   return temp;
 }
 
+#ifdef USE_BHEAD_READ_ON_DEMAND
+/**
+ * Return the data of a block when it can be accessed without reading from the file,
+ * either because it was read already or because the file is backed by memory.
+ */
+static const void *blo_bhead_data_in_memory(FileData *fd, BHead *bh)
+{
+  if (BHEADN_FROM_BHEAD(bh)->has_data) {
+    return (bh + 1);
+  }
+  return blo_bhead_peek_mapped_data(fd, bh);
+}
+
+/**
+ * Same as #read_struct for blocks whose data is available in memory
+ * (see #blo_bhead_data_in_memory) and that don't need endian switching.
+ * Does not modify the #FileData, so it can be called from multiple threads at once.
+ * When reading from a memory-mapped file, #BLI_filereader_memory_check must be called after.
+ */
+static void *read_struct_from_memory(const FileData *fd, BHead *bh, const char *blockname)
+{
+  BLI_assert((fd->flags & FD_FLAGS_SWITCH_ENDIAN) == 0);
+
+  if (bh->len == 0 || fd->compflags[bh->SDNAnr] == SDNA_CMP_REMOVED) {
+    return NULL;
+  }
+
+  const void *old_data = BHEADN_FROM_BHEAD(bh)->has_data ?
+                             (const void *)(bh + 1) :
+                             BLI_filereader_memory_pointer(
+                                 fd->file, BHEADN_FROM_BHEAD(bh)->file_offset, (size_t)bh->len);
+  BLI_assert(old_data != NULL);
+
+  if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+    return DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, old_data);
+  }
+
+  /* SDNA_CMP_EQUAL */
+  void *temp = MEM_mallocN(bh->len, blockname);
+  memcpy(temp, old_data, bh->len);
+  return temp;
+}
+#endif /* USE_BHEAD_READ_ON_DEMAND */
+
 /* Like read_struct, but gets a pointer without allocating. Only works for
  * undo since DNA must match. */
 static const void *peek_struct_undo(FileData *fd, BHead *bhead)
@@ -3052,11 +3135,108 @@ static bool direct_link_id(FileData *fd, Main *main, const int tag, ID *id, ID *
   return success;
 }
 
+#ifdef USE_BHEAD_READ_ON_DEMAND
+
+/** Minimum number of data blocks in a data-block to reconstruct them in parallel. */
+#define DATAMAP_PARALLEL_MIN_BLOCKS 8
+/** Minimum total size of data blocks in a data-block to reconstruct them in parallel. */
+#define DATAMAP_PARALLEL_MIN_SIZE (1 << 20)
+
+typedef struct ReadDataParallelData {
+  const FileData *fd;
+  BHead **bheads;
+  void **data;
+  const char *allocname;
+} ReadDataParallelData;
+
+static void read_data_parallel_fn(void *__restrict userdata,
+                                  const int index,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ReadDataParallelData *data = userdata;
+  data->data[index] = read_struct_from_memory(data->fd, data->bheads[index], data->allocname);
+}
+
+/**
+ * Read the data blocks of a data-block in parallel, when they can be accessed in memory
+ * without reading from the file (e.g. memory-mapped files) and DNA reconstruction is
+ * independent for every block. Only the insertion in the datamap is done sequentially.
+ *
+ * \return The first block that isn't part of the data-block, or \a bhead unchanged when the
+ * blocks can't be read in parallel.
+ */
+static BHead *read_data_into_datamap_parallel(FileData *fd, BHead *bhead, const char *allocname)
+{
+  if (fd->flags & (FD_FLAGS_SWITCH_ENDIAN | FD_FLAGS_IS_MEMFILE)) {
+    return bhead;
+  }
+
+  int blocks_num = 0;
+  size_t blocks_size = 0;
+  for (BHead *bh = bhead; bh && bh->code == DATA; bh = blo_bhead_next(fd, bh)) {
+    if (bh->len && blo_bhead_data_in_memory(fd, bh) == NULL) {
+      return bhead;
+    }
+    blocks_num++;
+    blocks_size += (size_t)bh->len;
+  }
+  if (blocks_num < DATAMAP_PARALLEL_MIN_BLOCKS || blocks_size < DATAMAP_PARALLEL_MIN_SIZE) {
+    return bhead;
+  }
+
+  ReadDataParallelData data = {
+      .fd = fd,
+      .bheads = MEM_malloc_arrayN(blocks_num, sizeof(BHead *), __func__),
+      .data = MEM_malloc_arrayN(blocks_num, sizeof(void *), __func__),
+      .allocname = allocname,
+  };
+  int index = 0;
+  for (BHead *bh = bhead; bh && bh->code == DATA; bh = blo_bhead_next(fd, bh)) {
+    data.bheads[index++] = bh;
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, blocks_num, &data, read_data_parallel_fn, &settings);
+
+  /* IO errors of memory-mapped files are only known after accessing the memory. */
+  const bool success = BLI_filereader_memory_check(fd->file);
+  if (UNLIKELY(!success)) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+  }
+
+  for (index = 0; index < blocks_num; index++) {
+    if (data.data[index] == NULL) {
+      continue;
+    }
+    if (success) {
+      oldnewmap_insert(fd->datamap, data.bheads[index]->old, data.data[index], 0);
+    }
+    else {
+      MEM_freeN(data.data[index]);
+    }
+  }
+
+  BHead *bhead_next = blo_bhead_next(fd, data.bheads[blocks_num - 1]);
+
+  MEM_freeN(data.bheads);
+  MEM_freeN(data.data);
+
+  return bhead_next;
+}
+
+#endif /* USE_BHEAD_READ_ON_DEMAND */
+
 /* Read all data associated with a datablock into datamap. */
 static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *allocname)
 {
   bhead = blo_bhead_next(fd, bhead);
 
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  /* Heavy data-blocks (e.g. meshes with many large attribute layers) are read in parallel. */
+  bhead = read_data_into_datamap_parallel(fd, bhead, allocname);
+#endif
+
   while (bhead && bhead->code == DATA) {
     /* The code below is useful for debugging leaks in data read from the blend file.
      * Without this the messages only tell us what ID-type the memory came from,
@@ -3882,6 +4062,8 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  fd->reports->duration.read_data = PIL_check_seconds_timer();
+
   while (bhead) {
     switch (bhead->code) {
       case DATA:
@@ -3933,6 +4115,8 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  fd->reports->duration.read_data = PIL_check_seconds_timer() - fd->reports->duration.read_data;
+
   /* do before read_libraries, but skip undo case */
   if ((fd->flags & FD_FLAGS_IS_MEMFILE) == 0) {
     if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
@@ -3950,9 +4134,14 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 
     blo_join_main(&mainlist);
 
+    fd->reports->duration.lib_link = PIL_check_seconds_timer();
+    fd->reports->duration.read_libraries = fd->reports->duration.lib_link -
+                                           fd->reports->duration.libraries;
+
     lib_link_all(fd, bfd->main);
     after_liblink_merged_bmain_process(bfd->main);
 
+    fd->reports->duration.lib_link = PIL_check_seconds_timer() - fd->reports->duration.lib_link;
     fd->reports->duration.libraries = PIL_check_seconds_timer() - fd->reports->duration.libraries;
 
     /* Skip in undo case. */
@@ -42,6 +42,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
@@ -60,7 +61,7 @@ void BLO_memfile_free(MemFile *memfile)
   MemFileChunk *chunk;
 
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
+    if (!chunk->is_identical && !chunk->is_shared) {
       MEM_freeN((void *)chunk->buf);
     }
     MEM_freeN(chunk);
@@ -77,19 +78,22 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
 
   /* First, detect all memchunks in second memfile that are not owned by it. */
   for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
+    if (sc->is_identical || sc->is_shared) {
+      /* Several chunks of the second memfile may share the same buffer, only one of them needs
+       * to take ownership of it. */
+      BLI_ghash_reinsert(buffer_to_second_memchunk, (void *)sc->buf, sc, NULL, NULL);
     }
   }
 
   /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
    * it is also used by the second memfile, transfer the ownership. */
   for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
-    if (!fc->is_identical) {
+    if (!fc->is_identical && !fc->is_shared) {
       MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
       if (sc != NULL) {
-        BLI_assert(sc->is_identical);
+        BLI_assert(sc->is_identical || sc->is_shared);
         sc->is_identical = false;
+        sc->is_shared = false;
         fc->is_identical = true;
       }
       /* Note that if the second memfile does not use that chunk, we assume that the first one
@@ -110,6 +114,28 @@ void BLO_memfile_clear_future(MemFile *memfile)
   }
 }
 
+static void memfile_chunk_hash_ensure(MemFileChunk *chunk, const char *buf)
+{
+  if (!chunk->is_hashed) {
+    chunk->hash = BLI_hash_mm2((const uchar *)buf, chunk->size, 0);
+    chunk->is_hashed = true;
+  }
+}
+
+static uint memfile_chunk_hash(const void *key)
+{
+  const MemFileChunk *chunk = key;
+  return chunk->hash ^ BLI_ghashutil_uinthash(chunk->id_session_uuid);
+}
+
+static bool memfile_chunk_cmp(const void *a, const void *b)
+{
+  const MemFileChunk *chunk_a = a;
+  const MemFileChunk *chunk_b = b;
+  return (chunk_a->hash != chunk_b->hash) || (chunk_a->size != chunk_b->size) ||
+         (chunk_a->id_session_uuid != chunk_b->id_session_uuid);
+}
+
 void BLO_memfile_write_init(MemFileWriteData *mem_data,
                             MemFile *written_memfile,
                             MemFile *reference_memfile)
@@ -117,6 +143,9 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
   mem_data->written_memfile = written_memfile;
   mem_data->reference_memfile = reference_memfile;
   mem_data->reference_current_chunk = reference_memfile ? reference_memfile->chunks.first : NULL;
+  mem_data->id_session_uuid_mapping = NULL;
+  mem_data->reference_chunks_by_hash = NULL;
+  mem_data->reference_hashed_ids = NULL;
 
   /* If we have a reference memfile, we generate a mapping between the session_uuid's of the
    * IDs stored in that previous undo step, and its first matching memchunk. This will allow
@@ -141,6 +170,14 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
         }
       }
     }
+
+    /* Chunks that don't match the one at the same position in the reference memfile (e.g. after
+     * inserting elements into an array) can still share the memory of any other chunk of the same
+     * ID with the same content. Chunks not related to an ID are not worth it, those are small.
+     * The reference chunks of an ID are only hashed once one of its chunks doesn't match. */
+    mem_data->reference_chunks_by_hash = BLI_gset_new(
+        memfile_chunk_hash, memfile_chunk_cmp, __func__);
+    mem_data->reference_hashed_ids = BLI_gset_int_new(__func__);
   }
 }
 
@@ -149,6 +186,31 @@ void BLO_memfile_write_finalize(MemFileWriteData *mem_data)
   if (mem_data->id_session_uuid_mapping != NULL) {
     BLI_ghash_free(mem_data->id_session_uuid_mapping, NULL, NULL);
   }
+  if (mem_data->reference_chunks_by_hash != NULL) {
+    BLI_gset_free(mem_data->reference_chunks_by_hash, NULL);
+  }
+  if (mem_data->reference_hashed_ids != NULL) {
+    BLI_gset_free(mem_data->reference_hashed_ids, NULL);
+  }
+}
+
+/**
+ * Add all reference chunks of the given ID to the set looked up by content, once per ID.
+ */
+static void memfile_reference_id_chunks_hash_ensure(MemFileWriteData *mem_data,
+                                                    const uint id_session_uuid)
+{
+  if (!BLI_gset_add(mem_data->reference_hashed_ids, POINTER_FROM_UINT(id_session_uuid))) {
+    return;
+  }
+  MemFileChunk *mem_chunk = BLI_ghash_lookup(mem_data->id_session_uuid_mapping,
+                                             POINTER_FROM_UINT(id_session_uuid));
+  /* Chunks of an ID are contiguous, starting at the first one stored in the mapping. */
+  for (; mem_chunk != NULL && mem_chunk->id_session_uuid == id_session_uuid;
+       mem_chunk = mem_chunk->next) {
+    memfile_chunk_hash_ensure(mem_chunk, mem_chunk->buf);
+    BLI_gset_add(mem_data->reference_chunks_by_hash, mem_chunk);
+  }
 }
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size)
@@ -160,11 +222,14 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   curchunk->size = size;
   curchunk->buf = NULL;
   curchunk->is_identical = false;
+  curchunk->is_shared = false;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
    * will then not be undo. Though it's not entirely clear that is wrong behavior. */
   curchunk->is_identical_future = true;
   curchunk->id_session_uuid = mem_data->current_id_session_uuid;
+  curchunk->hash = 0;
+  curchunk->is_hashed = false;
   BLI_addtail(&memfile->chunks, curchunk);
 
   /* we compare compchunk with buf */
@@ -174,12 +239,29 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
       if (memcmp(compchunk->buf, buf, size) == 0) {
         curchunk->buf = compchunk->buf;
         curchunk->is_identical = true;
+        curchunk->hash = compchunk->hash;
+        curchunk->is_hashed = compchunk->is_hashed;
         compchunk->is_identical_future = true;
       }
     }
     *compchunk_step = compchunk->next;
   }
 
+  /* Not at the same position, look for the same content anywhere in the reference data of the
+   * same ID. The ID did change, so this chunk isn't considered identical. */
+  if (curchunk->buf == NULL && mem_data->reference_chunks_by_hash != NULL &&
+      curchunk->id_session_uuid != MAIN_ID_SESSION_UUID_UNSET &&
+      BLI_ghash_haskey(mem_data->id_session_uuid_mapping,
+                       POINTER_FROM_UINT(curchunk->id_session_uuid))) {
+    memfile_reference_id_chunks_hash_ensure(mem_data, curchunk->id_session_uuid);
+    memfile_chunk_hash_ensure(curchunk, buf);
+    const MemFileChunk *refchunk = BLI_gset_lookup(mem_data->reference_chunks_by_hash, curchunk);
+    if (refchunk != NULL && memcmp(refchunk->buf, buf, size) == 0) {
+      curchunk->buf = refchunk->buf;
+      curchunk->is_shared = true;
+    }
+  }
+
   /* not equal... */
   if (curchunk->buf == NULL) {
     char *buf_new = MEM_mallocN(size, "Chunk buffer");
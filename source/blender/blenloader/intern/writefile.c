@@ -101,10 +101,13 @@
 #include "BLI_blenlib.h"
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
+#include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_link_utils.h"
 #include "BLI_linklist.h"
 #include "BLI_math_base.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
 #include "BLI_threads.h"
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
@@ -144,6 +147,15 @@
 #define MEM_BUFFER_SIZE (MEM_SIZE_OPTIMAL(1 << 17)) /* 128kb */
 #define MEM_CHUNK_SIZE (MEM_SIZE_OPTIMAL(1 << 15))  /* ~32kb */
 
+/* Bounds of the content-defined chunks big arrays are split into for undo,
+ * see #mywrite_memfile_chunk_len. */
+#define MEM_CHUNK_SIZE_MIN (MEM_CHUNK_SIZE / 4)
+#define MEM_CHUNK_SIZE_MAX (MEM_CHUNK_SIZE * 2)
+/* Number of trailing bytes the rolling hash depends on. */
+#define MEM_CHUNK_HASH_WINDOW 32
+/* High bits of the rolling hash that must be zero to end a chunk (~16kb past the minimum). */
+#define MEM_CHUNK_HASH_MASK 0xfffc0000u
+
 #define ZSTD_BUFFER_SIZE (1 << 21) /* 2mb */
 #define ZSTD_CHUNK_SIZE (1 << 20)  /* 1mb */
 
@@ -166,8 +178,31 @@ typedef struct ZstdFrame {
 
   uint32_t compressed_size;
   uint32_t uncompressed_size;
+  /** Hash of the uncompressed content, see #ZstdFrameCache. */
+  uint32_t hash;
 } ZstdFrame;
 
+/** A frame in a previously written file. */
+typedef struct ZstdFrameRecord {
+  uint32_t hash;
+  uint32_t compressed_size;
+  uint32_t uncompressed_size;
+  size_t file_offset;
+} ZstdFrameRecord;
+
+/** The frames of a previously written compressed file, see #zstd_reuse_begin. */
+typedef struct ZstdFrameCache {
+  struct ZstdFrameCache *next, *prev;
+
+  char filepath[FILE_MAX];
+  /** Size and modification time of the file, to detect when it was changed by others. */
+  int64_t file_size;
+  int64_t file_mtime;
+
+  ZstdFrameRecord *records;
+  int records_num;
+} ZstdFrameCache;
+
 typedef struct WriteWrap WriteWrap;
 struct WriteWrap {
   /* callbacks */
@@ -192,6 +227,16 @@ struct WriteWrap {
     ListBase frames;
 
     bool write_error;
+
+    /** Frames of the previous version of the file that can be copied instead of compressed. */
+    struct {
+      int file_handle;
+      BLI_mmap_file *mmap;
+      /** Maps content hashes to #ZstdFrameRecord. */
+      GHash *frame_map;
+    } reuse;
+    /** Frames of the file being written, to be stored once it's successfully written. */
+    ZstdFrameCache *written_frames;
   } zstd;
 };
 
@@ -220,6 +265,164 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 
 /* zstd */
 
+/* Re-saving a compressed file mostly writes the same data again, especially big arrays like mesh
+ * attributes, which get frames of their own starting at the array (see #mywrite).
+ * The frames of the last few compressed files that were written are remembered by content hash,
+ * so that unchanged frames can be copied from the previous version of the file instead of being
+ * compressed again. Since the previous file could have been changed in the meantime, a reused
+ * frame is always decompressed and compared with the data first, which is a lot faster than
+ * compressing it. */
+
+/** Maximum number of files for which the frames are remembered. */
+#define ZSTD_FRAME_CACHE_FILES_MAX 4
+
+/** Most recently written files first. Only accessed from the thread that writes files. */
+static ListBase zstd_frame_caches = {NULL, NULL};
+
+static void zstd_frame_cache_free(ZstdFrameCache *cache)
+{
+  MEM_SAFE_FREE(cache->records);
+  MEM_freeN(cache);
+}
+
+static bool zstd_file_identity(const char *filepath, int64_t *r_size, int64_t *r_mtime)
+{
+  BLI_stat_t st;
+  if (BLI_stat(filepath, &st) != 0) {
+    return false;
+  }
+  *r_size = (int64_t)st.st_size;
+  *r_mtime = (int64_t)st.st_mtime;
+  return true;
+}
+
+/** Prepare reusing the frames of the file at `filepath`, which is about to be overwritten. */
+static void zstd_reuse_begin(WriteWrap *ww, const char *filepath)
+{
+  ZstdFrameCache *cache = NULL;
+  LISTBASE_FOREACH (ZstdFrameCache *, iter, &zstd_frame_caches) {
+    if (BLI_path_cmp(iter->filepath, filepath) == 0) {
+      cache = iter;
+      break;
+    }
+  }
+  int64_t file_size, file_mtime;
+  if (cache == NULL || cache->records_num == 0 ||
+      !zstd_file_identity(filepath, &file_size, &file_mtime) || file_size != cache->file_size ||
+      file_mtime != cache->file_mtime) {
+    return;
+  }
+
+  const int file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
+    return;
+  }
+  BLI_mmap_file *mmap_file = BLI_mmap_open(file);
+  if (mmap_file == NULL) {
+    close(file);
+    return;
+  }
+
+  ww->zstd.reuse.file_handle = file;
+  ww->zstd.reuse.mmap = mmap_file;
+  ww->zstd.reuse.frame_map = BLI_ghash_int_new_ex(__func__, (uint)cache->records_num);
+  for (int i = 0; i < cache->records_num; i++) {
+    ZstdFrameRecord *record = &cache->records[i];
+    void **val_p;
+    if (!BLI_ghash_ensure_p(ww->zstd.reuse.frame_map, POINTER_FROM_UINT(record->hash), &val_p)) {
+      *val_p = record;
+    }
+  }
+}
+
+static void zstd_reuse_end(WriteWrap *ww)
+{
+  if (ww->zstd.reuse.frame_map) {
+    BLI_ghash_free(ww->zstd.reuse.frame_map, NULL, NULL);
+    ww->zstd.reuse.frame_map = NULL;
+  }
+  if (ww->zstd.reuse.mmap) {
+    BLI_mmap_free(ww->zstd.reuse.mmap);
+    ww->zstd.reuse.mmap = NULL;
+  }
+  if (ww->zstd.reuse.file_handle != -1) {
+    close(ww->zstd.reuse.file_handle);
+    ww->zstd.reuse.file_handle = -1;
+  }
+}
+
+/**
+ * Find a frame with the same content in the previous version of the file.
+ * Safe to call from multiple threads.
+ *
+ * \return The compressed data of the frame, or NULL when it has to be compressed.
+ */
+static void *zstd_reuse_frame(WriteWrap *ww,
+                              const void *data,
+                              size_t size,
+                              uint32_t hash,
+                              size_t *r_compressed_size)
+{
+  if (ww->zstd.reuse.frame_map == NULL) {
+    return NULL;
+  }
+  const ZstdFrameRecord *record = BLI_ghash_lookup(ww->zstd.reuse.frame_map,
+                                                   POINTER_FROM_UINT(hash));
+  if (record == NULL || record->uncompressed_size != size) {
+    return NULL;
+  }
+
+  void *compressed_data = MEM_mallocN(record->compressed_size, __func__);
+  void *uncompressed_data = MEM_mallocN(size, __func__);
+
+  bool is_equal = false;
+  if (BLI_mmap_read(
+          ww->zstd.reuse.mmap, compressed_data, record->file_offset, record->compressed_size)) {
+    const size_t res = ZSTD_decompress(
+        uncompressed_data, size, compressed_data, record->compressed_size);
+    is_equal = !ZSTD_isError(res) && (res == size) && (memcmp(uncompressed_data, data, size) == 0);
+  }
+  MEM_freeN(uncompressed_data);
+
+  if (!is_equal) {
+    MEM_freeN(compressed_data);
+    return NULL;
+  }
+  *r_compressed_size = record->compressed_size;
+  return compressed_data;
+}
+
+/** Remember the frames of a file that was just written, `temp_filepath` is its current path. */
+static void zstd_frame_cache_store(WriteWrap *ww, const char *filepath, const char *temp_filepath)
+{
+  ZstdFrameCache *cache = ww->zstd.written_frames;
+  ww->zstd.written_frames = NULL;
+  if (cache == NULL) {
+    return;
+  }
+
+  LISTBASE_FOREACH_MUTABLE (ZstdFrameCache *, iter, &zstd_frame_caches) {
+    if (BLI_path_cmp(iter->filepath, filepath) == 0) {
+      BLI_remlink(&zstd_frame_caches, iter);
+      zstd_frame_cache_free(iter);
+    }
+  }
+
+  if (!zstd_file_identity(temp_filepath, &cache->file_size, &cache->file_mtime)) {
+    zstd_frame_cache_free(cache);
+    return;
+  }
+  STRNCPY(cache->filepath, filepath);
+  BLI_addhead(&zstd_frame_caches, cache);
+
+  while (BLI_listbase_count_at_most(&zstd_frame_caches, ZSTD_FRAME_CACHE_FILES_MAX + 1) >
+         ZSTD_FRAME_CACHE_FILES_MAX) {
+    ZstdFrameCache *last = zstd_frame_caches.last;
+    BLI_remlink(&zstd_frame_caches, last);
+    zstd_frame_cache_free(last);
+  }
+}
+
 typedef struct {
   struct ZstdWriteBlockTask *next, *prev;
   void *data;
@@ -233,10 +436,15 @@ static void *zstd_write_task(void *userdata)
   ZstdWriteBlockTask *task = userdata;
   WriteWrap *ww = task->ww;
 
-  size_t out_buf_len = ZSTD_compressBound(task->size);
-  void *out_buf = MEM_mallocN(out_buf_len, "Zstd out buffer");
-  size_t out_size = ZSTD_compress(
-      out_buf, out_buf_len, task->data, task->size, ZSTD_COMPRESSION_LEVEL);
+  const uint32_t hash = BLI_hash_mm2(task->data, task->size, 0);
+
+  size_t out_size;
+  void *out_buf = zstd_reuse_frame(ww, task->data, task->size, hash, &out_size);
+  if (out_buf == NULL) {
+    size_t out_buf_len = ZSTD_compressBound(task->size);
+    out_buf = MEM_mallocN(out_buf_len, "Zstd out buffer");
+    out_size = ZSTD_compress(out_buf, out_buf_len, task->data, task->size, ZSTD_COMPRESSION_LEVEL);
+  }
 
   MEM_freeN(task->data);
 
@@ -254,6 +462,7 @@ static void *zstd_write_task(void *userdata)
       ZstdFrame *frameinfo = MEM_mallocN(sizeof(ZstdFrame), "zstd frameinfo");
       frameinfo->uncompressed_size = task->size;
       frameinfo->compressed_size = out_size;
+      frameinfo->hash = hash;
       BLI_addtail(&ww->zstd.frames, frameinfo);
     }
     else {
@@ -281,6 +490,7 @@ static bool ww_open_zstd(WriteWrap *ww, const char *filepath)
   BLI_threadpool_init(&ww->zstd.threadpool, zstd_write_task, num_threads);
   BLI_mutex_init(&ww->zstd.mutex);
   BLI_condition_init(&ww->zstd.condition);
+  ww->zstd.reuse.file_handle = -1;
 
   return true;
 }
@@ -334,7 +544,26 @@ static bool ww_close_zstd(WriteWrap *ww)
   BLI_mutex_end(&ww->zstd.mutex);
   BLI_condition_end(&ww->zstd.condition);
 
+  zstd_reuse_end(ww);
+
   zstd_write_seekable_frames(ww);
+
+  if (!ww->zstd.write_error) {
+    ZstdFrameCache *cache = MEM_callocN(sizeof(ZstdFrameCache), __func__);
+    cache->records_num = BLI_listbase_count(&ww->zstd.frames);
+    cache->records = MEM_malloc_arrayN(cache->records_num, sizeof(ZstdFrameRecord), __func__);
+    size_t file_offset = 0;
+    int i = 0;
+    LISTBASE_FOREACH (ZstdFrame *, frame, &ww->zstd.frames) {
+      ZstdFrameRecord *record = &cache->records[i++];
+      record->hash = frame->hash;
+      record->compressed_size = frame->compressed_size;
+      record->uncompressed_size = frame->uncompressed_size;
+      record->file_offset = file_offset;
+      file_offset += frame->compressed_size;
+    }
+    ww->zstd.written_frames = cache;
+  }
   BLI_freelistN(&ww->zstd.frames);
 
   return ww_close_none(ww) && !ww->zstd.write_error;
@@ -521,6 +750,33 @@ static void mywrite_flush(WriteData *wd)
   }
 }
 
+/**
+ * Find the length of the next undo chunk of a big array.
+ *
+ * Cutting at fixed offsets means that inserting or removing a single element shifts the content
+ * of every following chunk, which then can't be shared with the previous undo step anymore.
+ * Instead, chunks end where a rolling hash of the last #MEM_CHUNK_HASH_WINDOW bytes matches
+ * #MEM_CHUNK_HASH_MASK, so the boundaries only depend on the local content and re-synchronize
+ * right after an edit (see #BLO_memfile_chunk_add for how the chunks are then shared).
+ */
+static size_t mywrite_memfile_chunk_len(const uchar *data, const size_t len)
+{
+  if (len <= MEM_CHUNK_SIZE_MAX) {
+    return len;
+  }
+
+  /* Each byte is shifted out of the hash after #MEM_CHUNK_HASH_WINDOW steps,
+   * no need to hash anything before that window. */
+  uint32_t hash = 0;
+  for (size_t i = MEM_CHUNK_SIZE_MIN - MEM_CHUNK_HASH_WINDOW; i < MEM_CHUNK_SIZE_MAX; i++) {
+    hash = (hash << 1) + (uint32_t)(data[i] + 1) * 0x9e3779b1u;
+    if (i >= MEM_CHUNK_SIZE_MIN && (hash & MEM_CHUNK_HASH_MASK) == 0) {
+      return i + 1;
+    }
+  }
+  return MEM_CHUNK_SIZE_MAX;
+}
+
 /**
  * Low level WRITE(2) wrapper that buffers data
  * \param adr: Pointer to new chunk of data
@@ -554,7 +810,8 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
       }
 
       do {
-        size_t writelen = MIN2(len, wd->buffer.chunk_size);
+        size_t writelen = wd->use_memfile ? mywrite_memfile_chunk_len(adr, len) :
+                                            MIN2(len, wd->buffer.chunk_size);
         writedata_do_write(wd, adr, writelen);
         adr = (const char *)adr + writelen;
         len -= writelen;
@@ -1345,7 +1602,8 @@ bool BLO_write_file(Main *mainvar,
   /* open temporary file, so we preserve the original in case we crash */
   BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
 
-  ww_handle_init((write_flags & G_FILE_COMPRESS) ? WW_WRAP_ZSTD : WW_WRAP_NONE, &ww);
+  const eWriteWrapType ww_type = (write_flags & G_FILE_COMPRESS) ? WW_WRAP_ZSTD : WW_WRAP_NONE;
+  ww_handle_init(ww_type, &ww);
 
   if (ww.open(&ww, tempname) == false) {
     BKE_reportf(
@@ -1353,6 +1611,10 @@ bool BLO_write_file(Main *mainvar,
     return 0;
   }
 
+  if (ww_type == WW_WRAP_ZSTD) {
+    zstd_reuse_begin(&ww, filepath);
+  }
+
   if (remap_mode == BLO_WRITE_PATH_REMAP_ABSOLUTE) {
     /* Paths will already be absolute, no remapping to do. */
     if (relbase_valid == false) {
@@ -1433,6 +1695,15 @@ bool BLO_write_file(Main *mainvar,
 
   ww.close(&ww);
 
+  if (ww.zstd.written_frames) {
+    if (err) {
+      zstd_frame_cache_free(ww.zstd.written_frames);
+    }
+    else {
+      zstd_frame_cache_store(&ww, filepath, tempname);
+    }
+  }
+
   if (UNLIKELY(path_list_backup)) {
     BKE_bpath_list_restore(mainvar, path_list_flag, path_list_backup);
     BKE_bpath_list_free(path_list_backup);
@@ -1468,6 +1739,14 @@ bool BLO_write_file(Main *mainvar,
   return 1;
 }
 
+void BLO_write_file_cache_free(void)
+{
+  LISTBASE_FOREACH_MUTABLE (ZstdFrameCache *, cache, &zstd_frame_caches) {
+    zstd_frame_cache_free(cache);
+  }
+  BLI_listbase_clear(&zstd_frame_caches);
+}
+
 bool BLO_write_file_mem(Main *mainvar, MemFile *compare, MemFile *current, int write_flags)
 {
   bool use_userdef = false;
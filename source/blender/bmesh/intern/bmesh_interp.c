@@ -161,7 +161,14 @@ void BM_face_interp_from_face_ex(BMesh *bm,
   BMLoop *l_iter;
   BMLoop *l_first;
 
-  float *w = BLI_array_alloca(w, f_src->len);
+  /* Calculate the weights of all loops first, so that every layer can be interpolated
+   * for the whole face at once. */
+  const int weights_len = f_dst->len * f_src->len;
+  float *w = (weights_len > BM_DEFAULT_NGON_STACK_SIZE * 4) ?
+                 MEM_mallocN(sizeof(*w) * (size_t)weights_len, __func__) :
+                 BLI_array_alloca(w, BM_DEFAULT_NGON_STACK_SIZE * 4);
+  void **dst_blocks_l = BLI_array_alloca(dst_blocks_l, f_dst->len);
+  void **dst_blocks_v = do_vertex ? BLI_array_alloca(dst_blocks_v, f_dst->len) : NULL;
   float co[2];
   int i;
 
@@ -174,12 +181,22 @@ void BM_face_interp_from_face_ex(BMesh *bm,
   l_iter = l_first = BM_FACE_FIRST_LOOP(f_dst);
   do {
     mul_v2_m3v3(co, axis_mat, l_iter->v->co);
-    interp_weights_poly_v2(w, cos_2d, f_src->len, co);
-    CustomData_bmesh_interp(&bm->ldata, blocks_l, w, NULL, f_src->len, l_iter->head.data);
+    interp_weights_poly_v2(&w[i * f_src->len], cos_2d, f_src->len, co);
+    dst_blocks_l[i] = l_iter->head.data;
     if (do_vertex) {
-      CustomData_bmesh_interp(&bm->vdata, blocks_v, w, NULL, f_src->len, l_iter->v->head.data);
+      dst_blocks_v[i] = l_iter->v->head.data;
     }
   } while ((void)i++, (l_iter = l_iter->next) != l_first);
+
+  CustomData_bmesh_interp_batch(&bm->ldata, blocks_l, w, f_src->len, dst_blocks_l, f_dst->len);
+  if (do_vertex) {
+    CustomData_bmesh_interp_batch(
+        &bm->vdata, blocks_v, w, f_src->len, dst_blocks_v, f_dst->len);
+  }
+
+  if (weights_len > BM_DEFAULT_NGON_STACK_SIZE * 4) {
+    MEM_freeN(w);
+  }
 }
 
 void BM_face_interp_from_face(BMesh *bm, BMFace *f_dst, const BMFace *f_src, const bool do_vertex)
@@ -628,9 +628,10 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
 #if 0
   oldverts = MEM_dupallocN(me->mvert);
 #else
-    oldverts = me->mvert;
-    me->mvert = nullptr;
     CustomData_update_typemap(&me->vdata);
+    /* The vertices may be shared with evaluated copies of the mesh, then they are copied. */
+    oldverts = (MVert *)CustomData_duplicate_referenced_layer(&me->vdata, CD_MVERT, me->totvert);
+    me->mvert = nullptr;
     CustomData_set_layer(&me->vdata, CD_MVERT, nullptr);
 #endif
   }
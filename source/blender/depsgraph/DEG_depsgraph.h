@@ -203,6 +203,29 @@ void DEG_evaluate_on_framechange(Depsgraph *graph, float frame);
  */
 void DEG_evaluate_on_refresh(Depsgraph *graph);
 
+typedef void (*DEG_FrameEvaluatedFn)(Depsgraph *depsgraph, float frame, void *user_data);
+
+/**
+ * Evaluate the given frames of the view layer, for baking and exporting animation.
+ *
+ * Up to \a max_depsgraphs independent dependency graphs are built and evaluate different frames
+ * in parallel. Scenes where a frame depends on the previous one (point caches, rigid body
+ * simulation) are evaluated with a single dependency graph instead.
+ *
+ * The \a callback is called once for every frame in the order of \a frames, while the evaluated
+ * state of that frame is available in its dependency graph. Calls are never concurrent, but they
+ * can happen from different threads. The graphs are freed once all frames have been delivered.
+ */
+void DEG_evaluate_frames(struct Main *bmain,
+                         struct Scene *scene,
+                         struct ViewLayer *view_layer,
+                         eEvaluationMode mode,
+                         const float *frames,
+                         int frames_num,
+                         int max_depsgraphs,
+                         DEG_FrameEvaluatedFn callback,
+                         void *user_data);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
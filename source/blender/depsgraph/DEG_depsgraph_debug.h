@@ -68,6 +68,26 @@ void DEG_debug_stats_gnuplot(const struct Depsgraph *graph,
                              const char *label,
                              const char *output_filename);
 
+/* ************************************************ */
+/* Evaluation Tracing */
+
+/**
+ * Start recording the evaluation of every operation in all dependency graphs: its start and end
+ * time, the thread, the ID and the component. Records of a previous trace are discarded.
+ *
+ * \note Starting and ending a trace is not allowed while dependency graphs are being evaluated.
+ */
+void DEG_debug_trace_begin(void);
+
+/**
+ * Stop recording and write the recorded operations to \a fp in the Chrome Trace Event JSON
+ * format, which can be opened in Perfetto or `chrome://tracing`. The records are freed afterwards,
+ * passing NULL discards them without writing.
+ */
+void DEG_debug_trace_end(FILE *fp);
+
+bool DEG_debug_trace_is_active(void);
+
 /* ************************************************ */
 
 /** Compare two dependency graphs. */
@@ -82,6 +82,13 @@ bool DEG_id_type_any_exists(const struct Depsgraph *depsgraph, short id_type);
 /** Get additional evaluation flags for the given ID. */
 uint32_t DEG_get_eval_flags_for_id(const struct Depsgraph *graph, struct ID *id);
 
+/**
+ * Get a number that changes whenever the given ID is updated by the graph. It never has the same
+ * value for different updates of an ID, also not after the relations have been rebuilt, so it can
+ * be used to detect changes between evaluations. Zero is returned when the ID is not in the graph.
+ */
+uint64_t DEG_get_update_count_for_id(const struct Depsgraph *graph, const struct ID *id);
+
 /** Get additional mesh CustomData_MeshMasks flags for the given object. */
 void DEG_get_customdata_mask_for_object(const struct Depsgraph *graph,
                                         struct Object *object,
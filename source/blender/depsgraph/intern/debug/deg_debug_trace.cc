@@ -0,0 +1,291 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Evaluated operations are recorded into per-thread buffers and written in the Chrome Trace Event
+ * format, which can be opened in Perfetto (ui.perfetto.dev) or `chrome://tracing`.
+ */
+
+#include "intern/debug/deg_debug_trace.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+#include "DEG_depsgraph_debug.h"
+
+#include "DNA_ID.h"
+
+#include "intern/depsgraph.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace deg = blender::deg;
+
+namespace blender::deg {
+namespace {
+
+struct TraceEvent {
+  /* Interned copies of the names, the nodes might be freed before the trace is written. */
+  const char *id_name;
+  NodeType component_type;
+  const char *component_name;
+  OperationCode opcode;
+  const char *operation_name;
+  const char *depsgraph_name;
+  double start_time;
+  double end_time;
+};
+
+/* Events of one thread, only accessed by that thread until the trace ends. */
+struct ThreadTrace {
+  int thread_index;
+  /* Set while the thread records an event, so that ending the trace can wait for it. */
+  std::atomic<bool> is_recording = false;
+  std::vector<TraceEvent> events;
+  /* Interned names by the address they were recorded from. The address is only a hint, the
+   * name stored there can change when nodes are freed and allocated again. */
+  std::unordered_map<const char *, const char *> names;
+  /* Elements of a deque don't move, so pointers to the strings stay valid. */
+  std::deque<std::string> name_storage;
+
+  const char *intern(const char *name)
+  {
+    const char *&interned = names[name];
+    if (interned == nullptr || !STREQ(interned, name)) {
+      interned = name_storage.emplace_back(name).c_str();
+    }
+    return interned;
+  }
+};
+
+/* Standard containers are used so that a trace which is still active on exit is not reported as
+ * leaked memory. */
+struct TraceSession {
+  double start_time = 0.0;
+  /* Added with the mutex of the trace locked, while the session is active. */
+  std::vector<std::unique_ptr<ThreadTrace>> threads;
+};
+
+struct Trace {
+  /* The session being recorded, null when no trace is active. */
+  std::atomic<TraceSession *> active_session = nullptr;
+  /* Protects #session and the registration of threads. */
+  std::mutex mutex;
+  std::shared_ptr<TraceSession> session;
+};
+
+Trace &get_trace()
+{
+  static Trace trace;
+  return trace;
+}
+
+/* Threads keep the session they record into alive, so that they never write into freed buffers
+ * when the trace ends while they evaluate. */
+thread_local std::shared_ptr<TraceSession> thread_session;
+thread_local ThreadTrace *thread_trace = nullptr;
+
+/* Returns null when the session ended in the meantime. */
+ThreadTrace *ensure_thread_trace(Trace &trace, TraceSession *session)
+{
+  if (thread_session.get() == session) {
+    return thread_trace;
+  }
+  std::lock_guard<std::mutex> lock(trace.mutex);
+  if (trace.session.get() != session) {
+    return nullptr;
+  }
+  std::unique_ptr<ThreadTrace> new_thread_trace = std::make_unique<ThreadTrace>();
+  new_thread_trace->thread_index = int(session->threads.size());
+  thread_trace = new_thread_trace.get();
+  thread_session = trace.session;
+  session->threads.push_back(std::move(new_thread_trace));
+  return thread_trace;
+}
+
+void write_json_string(FILE *fp, const char *str)
+{
+  fputc('"', fp);
+  for (const char *c = str; *c != '\0'; c++) {
+    switch (*c) {
+      case '"':
+        fputs("\\\"", fp);
+        break;
+      case '\\':
+        fputs("\\\\", fp);
+        break;
+      default:
+        if (static_cast<unsigned char>(*c) < 0x20) {
+          fprintf(fp, "\\u%04x", *c);
+        }
+        else {
+          fputc(*c, fp);
+        }
+        break;
+    }
+  }
+  fputc('"', fp);
+}
+
+void write_trace_event(FILE *fp, const TraceEvent &event, const int tid, const double start_time)
+{
+  string name = string(event.id_name) + " " + operationCodeAsString(event.opcode);
+  if (event.operation_name[0] != '\0') {
+    name += string(" ") + event.operation_name;
+  }
+  fputs(",\n{\"name\":", fp);
+  write_json_string(fp, name.c_str());
+  fputs(",\"cat\":", fp);
+  write_json_string(fp, nodeTypeAsString(event.component_type));
+  fprintf(fp,
+          ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"id\":",
+          (event.start_time - start_time) * 1e6,
+          (event.end_time - event.start_time) * 1e6,
+          tid);
+  write_json_string(fp, event.id_name);
+  fputs(",\"component\":", fp);
+  write_json_string(fp, event.component_name);
+  fputs(",\"operation\":", fp);
+  write_json_string(fp, operationCodeAsString(event.opcode));
+  fputs(",\"depsgraph\":", fp);
+  write_json_string(fp, event.depsgraph_name);
+  fputs("}}", fp);
+}
+
+void write_trace_json(FILE *fp, const TraceSession &session)
+{
+  fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", fp);
+  fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Depsgraph\"}}",
+        fp);
+  for (const std::unique_ptr<ThreadTrace> &thread : session.threads) {
+    fprintf(fp,
+            ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+            "\"args\":{\"name\":\"Thread %d\"}}",
+            thread->thread_index,
+            thread->thread_index);
+    for (const TraceEvent &event : thread->events) {
+      write_trace_event(fp, event, thread->thread_index, session.start_time);
+    }
+  }
+  fputs("\n]}\n", fp);
+}
+
+}  // namespace
+
+bool trace_is_active()
+{
+  return get_trace().active_session.load(std::memory_order_relaxed) != nullptr;
+}
+
+void trace_record_operation(const Depsgraph *graph,
+                            const OperationNode *operation_node,
+                            const double start_time,
+                            const double end_time)
+{
+  Trace &trace = get_trace();
+  TraceSession *session = trace.active_session.load(std::memory_order_acquire);
+  if (session == nullptr) {
+    return;
+  }
+  ThreadTrace *thread = ensure_thread_trace(trace, session);
+  if (thread == nullptr) {
+    return;
+  }
+
+  /* The trace can be ended by another thread while this graph is still evaluating. Ending it
+   * clears the active session first and then waits for threads that are still recording, so
+   * the buffer is only written to when the session is still active after marking this thread
+   * as recording. */
+  thread->is_recording.store(true, std::memory_order_seq_cst);
+  if (trace.active_session.load(std::memory_order_seq_cst) == session) {
+    const ComponentNode *component_node = operation_node->owner;
+    const IDNode *id_node = component_node->owner;
+
+    TraceEvent event;
+    event.id_name = thread->intern(id_node->id_orig->name);
+    event.component_type = component_node->type;
+    event.component_name = thread->intern(component_node->name.c_str());
+    event.opcode = operation_node->opcode;
+    event.operation_name = thread->intern(operation_node->name.c_str());
+    event.depsgraph_name = thread->intern(graph->debug.name.c_str());
+    event.start_time = start_time;
+    event.end_time = end_time;
+    thread->events.push_back(event);
+  }
+  thread->is_recording.store(false, std::memory_order_release);
+}
+
+}  // namespace blender::deg
+
+void DEG_debug_trace_begin()
+{
+  std::shared_ptr<deg::TraceSession> session = std::make_shared<deg::TraceSession>();
+  session->start_time = PIL_check_seconds_timer();
+
+  deg::Trace &trace = deg::get_trace();
+  std::lock_guard<std::mutex> lock(trace.mutex);
+  trace.session = session;
+  trace.active_session.store(session.get(), std::memory_order_release);
+}
+
+void DEG_debug_trace_end(FILE *fp)
+{
+  deg::Trace &trace = deg::get_trace();
+  std::shared_ptr<deg::TraceSession> session;
+  {
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    session = std::move(trace.session);
+    trace.active_session.store(nullptr, std::memory_order_seq_cst);
+  }
+  if (!session) {
+    return;
+  }
+
+  /* No thread registers anymore, wait for the ones that started recording before the trace
+   * ended. The file is written without holding the lock. */
+  for (const std::unique_ptr<deg::ThreadTrace> &thread : session->threads) {
+    while (thread->is_recording.load(std::memory_order_seq_cst)) {
+      std::this_thread::yield();
+    }
+  }
+  if (fp != nullptr) {
+    deg::write_trace_json(fp, *session);
+  }
+
+  /* Threads keep the session alive until they record into another one, only free the events. */
+  for (const std::unique_ptr<deg::ThreadTrace> &thread : session->threads) {
+    std::vector<deg::TraceEvent>().swap(thread->events);
+    thread->names.clear();
+    thread->name_storage.clear();
+  }
+}
+
+bool DEG_debug_trace_is_active()
+{
+  return deg::trace_is_active();
+}
@@ -0,0 +1,42 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Recording of evaluated operations, to be inspected in trace viewers.
+ */
+
+#pragma once
+
+namespace blender::deg {
+
+struct Depsgraph;
+struct OperationNode;
+
+/** Whether operations are to be recorded, checked by the evaluation before recording. */
+bool trace_is_active();
+
+/**
+ * Record evaluation of the operation on the current thread. Times are in seconds. Nothing is
+ * recorded when the trace was ended since #trace_is_active was checked.
+ */
+void trace_record_operation(const Depsgraph *graph,
+                            const OperationNode *operation_node,
+                            double start_time,
+                            double end_time);
+
+}  // namespace blender::deg
@@ -23,23 +23,37 @@
  * Evaluation engine entry-points for Depsgraph Engine.
  */
 
+#include <algorithm>
+
 #include "MEM_guardedalloc.h"
 
 #include "BLI_listbase.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_scene.h"
 
 #include "DNA_object_types.h"
+#include "DNA_rigidbody_types.h"
 #include "DNA_scene_types.h"
 
 #include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
 #include "DEG_depsgraph_query.h"
 
+#ifdef WITH_PYTHON
+#  include "BPY_extern.h"
+#endif
+
+#include "atomic_ops.h"
+
 #include "intern/eval/deg_eval.h"
 #include "intern/eval/deg_eval_flush.h"
 
 #include "intern/node/deg_node.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
 #include "intern/node/deg_node_operation.h"
 #include "intern/node/deg_node_time.h"
 
@@ -86,3 +100,152 @@ void DEG_evaluate_on_framechange(Depsgraph *graph, float frame)
   deg_graph->ctime = BKE_scene_frame_to_ctime(scene, frame);
   deg_flush_updates_and_refresh(deg_graph);
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Multi-Frame Evaluation
+ * \{ */
+
+namespace blender::deg {
+namespace {
+
+struct FrameEvaluationState {
+  Span<float> frames;
+  DEG_FrameEvaluatedFn callback;
+  void *user_data;
+
+  /* Index of the next frame which is to be claimed by a thread. */
+  int next_frame_index;
+  /* Index of the next frame which is to be passed to the callback. Frames which are evaluated
+   * ahead of it wait until it is their turn, which keeps the graph in the evaluated state. */
+  int next_deliver_index;
+  ThreadMutex mutex;
+  ThreadCondition condition;
+};
+
+struct FrameEvaluationThread {
+  FrameEvaluationState *state;
+  ::Depsgraph *depsgraph;
+};
+
+/* Point caches and rigid body simulation step from the previous frame, so frames of such
+ * scenes can not be evaluated independently of each other. */
+bool graph_has_frame_dependencies(const Depsgraph *graph)
+{
+  if (graph->scene->rigidbody_world != nullptr) {
+    return true;
+  }
+  for (const IDNode *id_node : graph->id_nodes) {
+    if (id_node->find_component(NodeType::POINT_CACHE) != nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void *evaluate_frames_thread(void *thread_data)
+{
+  FrameEvaluationThread *thread = static_cast<FrameEvaluationThread *>(thread_data);
+  FrameEvaluationState *state = thread->state;
+  while (true) {
+    const int index = atomic_fetch_and_add_int32(&state->next_frame_index, 1);
+    if (index >= state->frames.size()) {
+      break;
+    }
+    const float frame = state->frames[index];
+    DEG_evaluate_on_framechange(thread->depsgraph, frame);
+
+    BLI_mutex_lock(&state->mutex);
+    while (state->next_deliver_index != index) {
+      BLI_condition_wait(&state->condition, &state->mutex);
+    }
+    state->callback(thread->depsgraph, frame, state->user_data);
+    state->next_deliver_index++;
+    BLI_condition_notify_all(&state->condition);
+    BLI_mutex_unlock(&state->mutex);
+  }
+  return nullptr;
+}
+
+}  // namespace
+}  // namespace blender::deg
+
+void DEG_evaluate_frames(Main *bmain,
+                         Scene *scene,
+                         ViewLayer *view_layer,
+                         eEvaluationMode mode,
+                         const float *frames,
+                         int frames_num,
+                         int max_depsgraphs,
+                         DEG_FrameEvaluatedFn callback,
+                         void *user_data)
+{
+  using namespace blender;
+  if (frames_num <= 0) {
+    return;
+  }
+
+  Depsgraph *first_graph = DEG_graph_new(bmain, scene, view_layer, mode);
+  DEG_graph_build_from_view_layer(first_graph);
+
+  int graphs_num = std::min({max_depsgraphs, frames_num, BLI_system_thread_count()});
+  if (deg::graph_has_frame_dependencies(reinterpret_cast<deg::Depsgraph *>(first_graph))) {
+    graphs_num = 1;
+  }
+
+  if (graphs_num <= 1) {
+    for (const int i : IndexRange(frames_num)) {
+      DEG_evaluate_on_framechange(first_graph, frames[i]);
+      callback(first_graph, frames[i], user_data);
+    }
+    DEG_graph_free(first_graph);
+    return;
+  }
+
+  /* Building is not thread-safe (it registers the graph and may modify original data-blocks),
+   * so all graphs are built here before any evaluation starts. */
+  Vector<Depsgraph *> graphs = {first_graph};
+  for (int i = 1; i < graphs_num; i++) {
+    Depsgraph *graph = DEG_graph_new(bmain, scene, view_layer, mode);
+    DEG_graph_build_from_view_layer(graph);
+    graphs.append(graph);
+  }
+
+  deg::FrameEvaluationState state;
+  state.frames = Span<float>(frames, frames_num);
+  state.callback = callback;
+  state.user_data = user_data;
+  state.next_frame_index = 0;
+  state.next_deliver_index = 0;
+  BLI_mutex_init(&state.mutex);
+  BLI_condition_init(&state.condition);
+
+  Vector<deg::FrameEvaluationThread> threads_data;
+  for (Depsgraph *graph : graphs) {
+    threads_data.append({&state, graph});
+  }
+
+#ifdef WITH_PYTHON
+  /* Python drivers are evaluated from the worker threads. */
+  BPy_BEGIN_ALLOW_THREADS;
+#endif
+
+  ListBase threads;
+  BLI_threadpool_init(&threads, deg::evaluate_frames_thread, graphs_num);
+  for (deg::FrameEvaluationThread &thread : threads_data) {
+    BLI_threadpool_insert(&threads, &thread);
+  }
+  BLI_threadpool_end(&threads);
+
+#ifdef WITH_PYTHON
+  BPy_END_ALLOW_THREADS;
+#endif
+
+  BLI_condition_end(&state.condition);
+  BLI_mutex_end(&state.mutex);
+
+  for (Depsgraph *graph : graphs) {
+    DEG_graph_free(graph);
+  }
+}
+
+/** \} */
@@ -0,0 +1,192 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2022 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "testing/testing.h"
+
+#include "BLI_set.hh"
+#include "BLI_threads.h"
+#include "BLI_vector.hh"
+
+#include "CLG_log.h"
+
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "RNA_define.h"
+
+#include "BKE_appdir.h"
+#include "BKE_collection.h"
+#include "BKE_global.h"
+#include "BKE_idtype.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_rigidbody.h"
+#include "BKE_scene.h"
+#include "BKE_softbody.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_query.h"
+
+#include "IMB_imbuf.h"
+
+namespace blender::deg::tests {
+
+struct EvaluatedFrames {
+  Vector<float> frames;
+  Vector<float> scene_frames;
+  Set<Depsgraph *> depsgraphs;
+};
+
+static void expect_frames_eq(Span<float> a, Span<float> b)
+{
+  ASSERT_EQ(a.size(), b.size());
+  for (const int i : a.index_range()) {
+    EXPECT_FLOAT_EQ(a[i], b[i]) << "at index " << i;
+  }
+}
+
+static void frame_evaluated(Depsgraph *depsgraph, float frame, void *user_data)
+{
+  EvaluatedFrames &result = *static_cast<EvaluatedFrames *>(user_data);
+  result.frames.append(frame);
+  result.scene_frames.append(BKE_scene_frame_get(DEG_get_evaluated_scene(depsgraph)));
+  result.depsgraphs.add(depsgraph);
+}
+
+class EvaluateFramesTest : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+    RNA_init();
+    BKE_appdir_init();
+    IMB_init();
+    BKE_modifier_init();
+    DEG_register_node_types();
+  }
+
+  static void TearDownTestSuite()
+  {
+    DEG_free_node_types();
+    RNA_exit();
+    IMB_exit();
+    BKE_appdir_exit();
+    CLG_exit();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    G.main = bmain;
+    scene = BKE_scene_add(bmain, "Scene");
+    /* Allow several graphs regardless of the number of cores of the machine running the test. */
+    BLI_system_num_threads_override_set(4);
+  }
+
+  void TearDown() override
+  {
+    BLI_system_num_threads_override_set(0);
+    BKE_main_free(bmain);
+    G.main = nullptr;
+  }
+
+  Object *add_mesh_object()
+  {
+    Object *object = BKE_object_add_only_object(bmain, OB_MESH, "Object");
+    object->data = BKE_mesh_add(bmain, "Mesh");
+    BKE_collection_object_add(bmain, scene->master_collection, object);
+    return object;
+  }
+
+  EvaluatedFrames evaluate_frames(Span<float> frames, const int max_depsgraphs)
+  {
+    EvaluatedFrames result;
+    DEG_evaluate_frames(bmain,
+                        scene,
+                        BKE_view_layer_default_view(scene),
+                        DAG_EVAL_RENDER,
+                        frames.data(),
+                        frames.size(),
+                        max_depsgraphs,
+                        frame_evaluated,
+                        &result);
+    return result;
+  }
+};
+
+TEST_F(EvaluateFramesTest, DeliverInRequestedOrder)
+{
+  add_mesh_object();
+  const Vector<float> frames = {3.0f, 1.0f, 4.0f, 1.5f, 9.0f, 2.0f, 6.0f, 5.0f, 3.0f};
+  const EvaluatedFrames result = evaluate_frames(frames, 4);
+
+  expect_frames_eq(result.frames, frames);
+  /* Every frame is still evaluated in its graph while it is passed to the callback. */
+  expect_frames_eq(result.scene_frames, frames);
+  EXPECT_GE(result.depsgraphs.size(), 1);
+  EXPECT_LE(result.depsgraphs.size(), 4);
+}
+
+TEST_F(EvaluateFramesTest, SingleGraphWithPointCache)
+{
+  Object *object = add_mesh_object();
+  object->soft = sbNew();
+  const Vector<float> frames = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f};
+  const EvaluatedFrames result = evaluate_frames(frames, 4);
+
+  expect_frames_eq(result.frames, frames);
+  expect_frames_eq(result.scene_frames, frames);
+  /* Each frame steps from the previous one, so they all have to be evaluated in one graph. */
+  EXPECT_EQ(result.depsgraphs.size(), 1);
+}
+
+TEST_F(EvaluateFramesTest, SingleGraphWithRigidBodyWorld)
+{
+  add_mesh_object();
+  RigidBodyWorld *rigidbody_world = BKE_rigidbody_create_world(scene);
+  if (rigidbody_world == nullptr) {
+    GTEST_SKIP() << "Rigid body simulation is not available in this build";
+  }
+  BKE_rigidbody_validate_sim_world(scene, rigidbody_world, false);
+  scene->rigidbody_world = rigidbody_world;
+  const Vector<float> frames = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f};
+  const EvaluatedFrames result = evaluate_frames(frames, 4);
+
+  expect_frames_eq(result.frames, frames);
+  EXPECT_EQ(result.depsgraphs.size(), 1);
+}
+
+TEST_F(EvaluateFramesTest, NoFrames)
+{
+  const EvaluatedFrames result = evaluate_frames({}, 4);
+  EXPECT_TRUE(result.frames.is_empty());
+}
+
+}  // namespace blender::deg::tests
@@ -126,6 +126,20 @@ uint32_t DEG_get_eval_flags_for_id(const Depsgraph *graph, ID *id)
   return id_node->eval_flags;
 }
 
+uint64_t DEG_get_update_count_for_id(const Depsgraph *graph, const ID *id)
+{
+  if (graph == nullptr) {
+    return 0;
+  }
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+  const deg::IDNode *id_node = deg_graph->find_id_node(
+      DEG_get_original_id(const_cast<ID *>(id)));
+  if (id_node == nullptr) {
+    return 0;
+  }
+  return id_node->update_count;
+}
+
 void DEG_get_customdata_mask_for_object(const Depsgraph *graph,
                                         Object *ob,
                                         CustomData_MeshMasks *r_mask)
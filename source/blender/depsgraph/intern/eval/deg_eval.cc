@@ -29,7 +29,9 @@
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
+#include "BLI_heap.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_global.h"
@@ -47,6 +49,7 @@
 
 #include "atomic_ops.h"
 
+#include "intern/debug/deg_debug_trace.h"
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_relation.h"
 #include "intern/depsgraph_tag.h"
@@ -73,11 +76,6 @@ void schedule_children(DepsgraphEvalState *state,
                        ScheduleFunction *schedule_function,
                        ScheduleFunctionArgs... schedule_function_args);
 
-void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
-{
-  BLI_task_pool_push(pool, deg_task_run_func, node, false, nullptr);
-}
-
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
   /* Stage 1: Only  Copy-on-Write operations are to be evaluated, prior to anything else.
@@ -100,32 +98,64 @@ struct DepsgraphEvalState {
   bool do_stats;
   EvaluationStage stage;
   bool need_single_thread_pass;
+  /* Operations which are ready to be evaluated, ordered by their priority. Every task in the
+   * pool evaluates the operation with the highest priority at the time it starts, rather than
+   * the operation which caused the task to be pushed. */
+  Heap *ready_operations;
+  SpinLock ready_operations_lock;
 };
 
+/* Assumed evaluation time in seconds of operations which have not been timed yet, so that the
+ * number of operations in a chain is taken into account when there are no timings. */
+constexpr double default_operation_time = 1e-6;
+
+void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
+{
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_user_data(pool);
+  BLI_spin_lock(&state->ready_operations_lock);
+  /* The heap pops the smallest value first. */
+  BLI_heap_insert(state->ready_operations, -node->priority, node);
+  BLI_spin_unlock(&state->ready_operations_lock);
+  BLI_task_pool_push(pool, deg_task_run_func, nullptr, false, nullptr);
+}
+
+OperationNode *pop_ready_operation(DepsgraphEvalState *state)
+{
+  BLI_spin_lock(&state->ready_operations_lock);
+  OperationNode *operation_node = (OperationNode *)BLI_heap_pop_min(state->ready_operations);
+  BLI_spin_unlock(&state->ready_operations_lock);
+  return operation_node;
+}
+
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
 {
   ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(state->graph);
 
   /* Sanity checks. */
   BLI_assert_msg(!operation_node->is_noop(), "NOOP nodes should not actually be scheduled");
-  /* Perform operation. */
-  if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+  /* Perform operation. The time is always measured, since it is used to prioritize operations
+   * in the following evaluations. */
+  const double start_time = PIL_check_seconds_timer();
+  operation_node->evaluate(depsgraph);
+  const double end_time = PIL_check_seconds_timer();
+  const double time = end_time - start_time;
+  operation_node->stats.add_time_sample(time);
+  if (trace_is_active()) {
+    trace_record_operation(state->graph, operation_node, start_time, end_time);
   }
-  else {
-    operation_node->evaluate(depsgraph);
+  if (state->do_stats) {
+    operation_node->stats.current_time += time;
   }
 }
 
-void deg_task_run_func(TaskPool *pool, void *taskdata)
+void deg_task_run_func(TaskPool *pool, void *UNUSED(taskdata))
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
-  /* Evaluate node. */
-  OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
+  /* Evaluate node. Every scheduled node pushes one task, so there is always a node left. */
+  OperationNode *operation_node = pop_ready_operation(state);
+  BLI_assert(operation_node != nullptr);
   evaluate_node(state, operation_node);
 
   /* Schedule children. */
@@ -182,10 +212,69 @@ void calculate_pending_parents(Depsgraph *graph)
   }
 }
 
+/* Children of the node which wait for it to be evaluated, following the same rules as
+ * #calculate_pending_parents_for_node. */
+template<typename Fn> void foreach_pending_child(OperationNode *node, const Fn &fn)
+{
+  for (Relation *rel : node->outlinks) {
+    if (rel->to->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+      continue;
+    }
+    OperationNode *child = (OperationNode *)rel->to;
+    if (!check_operation_node_visible(child) || (child->flag & DEPSOP_FLAG_NEEDS_UPDATE) == 0) {
+      continue;
+    }
+    fn(child);
+  }
+}
+
+/* Set the priority of every operation which is to be evaluated to the estimated time of the
+ * longest chain of operations starting with it, based on the timings of previous evaluations.
+ * Scheduling by this priority starts the critical path of the graph as early as possible,
+ * instead of letting cheap operations occupy the threads while a long chain waits. */
+void calculate_priorities(Depsgraph *graph)
+{
+  /* Sort the operations which are to be evaluated topologically, using the custom flags to count
+   * the parents which are not in the order yet. Cyclic relations are ignored like they are
+   * during scheduling, so the remaining relations form an acyclic graph. */
+  Vector<OperationNode *> order;
+  for (OperationNode *node : graph->operations) {
+    node->priority = 0.0f;
+    node->custom_flags = node->num_links_pending;
+    if (node->num_links_pending == 0 && check_operation_node_visible(node) &&
+        (node->flag & DEPSOP_FLAG_NEEDS_UPDATE) != 0) {
+      order.append(node);
+    }
+  }
+  for (int64_t i = 0; i < order.size(); i++) {
+    foreach_pending_child(order[i], [&](OperationNode *child) {
+      BLI_assert(child->custom_flags > 0);
+      if (--child->custom_flags == 0) {
+        order.append(child);
+      }
+    });
+  }
+  /* Accumulate the times from the end of the chains. */
+  for (int64_t i = order.size() - 1; i >= 0; i--) {
+    OperationNode *node = order[i];
+    float children_priority = 0.0f;
+    foreach_pending_child(node, [&](OperationNode *child) {
+      children_priority = std::max(children_priority, child->priority);
+    });
+    float time = 0.0f;
+    if (!node->is_noop()) {
+      time = float(node->stats.average_time == 0.0 ? default_operation_time :
+                                                     node->stats.average_time);
+    }
+    node->priority = time + children_priority;
+  }
+}
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   const bool do_stats = state->do_stats;
   calculate_pending_parents(graph);
+  calculate_priorities(graph);
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
     if (do_stats) {
@@ -382,6 +471,8 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
   state.need_single_thread_pass = false;
+  state.ready_operations = BLI_heap_new();
+  BLI_spin_init(&state.ready_operations_lock);
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
 
@@ -405,6 +496,9 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
     evaluate_graph_single_threaded(&state);
   }
 
+  BLI_heap_free(state.ready_operations, nullptr);
+  BLI_spin_end(&state.ready_operations_lock);
+
   /* Finalize statistics gathering. This is because we only gather single
    * operation timing here, without aggregating anything to avoid any extra
    * synchronization. */
@@ -775,6 +775,9 @@ void update_id_after_copy(const Depsgraph *depsgraph,
       const Scene *scene_orig = (const Scene *)id_orig;
       scene_cow->toolsettings = scene_orig->toolsettings;
       scene_cow->eevee.light_cache_data = scene_orig->eevee.light_cache_data;
+      /* The graph can be evaluated at another frame than the original scene, see
+       * #DEG_evaluate_on_framechange. */
+      BKE_scene_frame_set(scene_cow, depsgraph->frame);
       scene_setup_view_layers_after_remap(depsgraph, id_node, reinterpret_cast<Scene *>(id_cow));
       break;
     }
@@ -288,6 +288,7 @@ Node::Stats::Stats()
 void Node::Stats::reset()
 {
   current_time = 0.0;
+  average_time = 0.0;
 }
 
 void Node::Stats::reset_current()
@@ -295,6 +296,18 @@ void Node::Stats::reset_current()
   current_time = 0.0;
 }
 
+void Node::Stats::add_time_sample(const double time)
+{
+  /* Exponential moving average, so that the estimate follows changes in the evaluated data
+   * without storing a history of samples. The first sample is used as is. */
+  if (average_time == 0.0) {
+    average_time = time;
+  }
+  else {
+    average_time += (time - average_time) * 0.25;
+  }
+}
+
 /*******************************************************************************
  * Node itself.
  */
@@ -178,8 +178,13 @@ struct Node {
     /* Reset counters needed for the current graph evaluation, does not
      * touch averaging accumulators. */
     void reset_current();
+    /* Add the time of an evaluation of the node to the average. */
+    void add_time_sample(double time);
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Running average of the time spent on this node in evaluations where it was evaluated.
+     * Used to prioritize expensive chains of operations during threaded evaluation. */
+    double average_time;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
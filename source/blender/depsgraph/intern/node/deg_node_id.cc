@@ -23,6 +23,7 @@
 
 #include "intern/node/deg_node_id.h"
 
+#include <atomic>
 #include <cstdio>
 #include <cstring> /* required for STREQ later on. */
 
@@ -90,11 +91,18 @@ void IDNode::init(const ID *id, const char *UNUSED(subdata))
   has_base = false;
   is_user_modified = false;
   id_cow_recalc_backup = 0;
+  update_count_bump();
 
   visible_components_mask = 0;
   previously_visible_components_mask = 0;
 }
 
+void IDNode::update_count_bump()
+{
+  static std::atomic<uint64_t> global_update_count = 0;
+  update_count = global_update_count.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
 void IDNode::init_copy_on_write(ID *id_cow_hint)
 {
   /* Create pointer as early as possible, so we can use it for function
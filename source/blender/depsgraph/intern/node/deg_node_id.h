@@ -124,6 +124,11 @@ struct IDNode : public Node {
   /* Accumulate recalc flags from multiple update passes. */
   int id_cow_recalc_backup;
 
+  /* Changes whenever the ID is updated, see #DEG_get_update_count_for_id. The values come from a
+   * counter shared by all nodes, so they don't repeat when the node is created again. */
+  uint64_t update_count;
+  void update_count_bump();
+
   IDComponentsMask visible_components_mask;
   IDComponentsMask previously_visible_components_mask;
 
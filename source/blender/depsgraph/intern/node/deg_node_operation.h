@@ -272,6 +272,11 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Estimated time of the longest chain of operations which are waiting for this one to be
+   * evaluated, including this operation itself. Operations with a higher priority are evaluated
+   * first, so that long chains of dependencies start as early as possible. */
+  float priority;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
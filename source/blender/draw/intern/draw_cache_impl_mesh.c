@@ -240,7 +240,7 @@ static DRWBatchFlag g_buffer_deps_d[ARRAY_SIZE(g_buffer_deps)] = {0};
 #endif
 
 static void mesh_batch_cache_discard_surface_batches(MeshBatchCache *cache);
-static void mesh_batch_cache_clear(Mesh *me);
+static void mesh_batch_cache_clear(MeshBatchCache *cache);
 
 static void mesh_batch_cache_discard_batch(MeshBatchCache *cache, const DRWBatchFlag batch_map)
 {
@@ -866,7 +866,7 @@ static void mesh_batch_cache_init(Object *object, Mesh *me)
 void DRW_mesh_batch_cache_validate(Object *object, Mesh *me)
 {
   if (!mesh_batch_cache_valid(object, me)) {
-    mesh_batch_cache_clear(me);
+    mesh_batch_cache_clear(me->runtime.batch_cache);
     mesh_batch_cache_init(object, me);
   }
 }
@@ -980,6 +980,40 @@ static void mesh_batch_cache_discard_uvedit_select(MeshBatchCache *cache)
   mesh_batch_cache_discard_batch(cache, batch_map);
 }
 
+/**
+ * Only triangles keep their triangulation when vertex positions change. Quads are split along
+ * the diagonal that avoids degenerate triangles and n-gons are triangulated with polyfill, both
+ * depending on the positions (see #BKE_mesh_recalc_looptri).
+ */
+static bool mesh_triangulation_depends_on_positions(const Mesh *me)
+{
+  if (me->edit_mesh != NULL) {
+    return true;
+  }
+  for (int i = 0; i < me->totpoly; i++) {
+    if (me->mpoly[i].totloop > 3) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void mesh_batch_cache_discard_tris(MeshBatchCache *cache)
+{
+  FOREACH_MESH_BUFFER_CACHE (cache, mbc) {
+    GPU_INDEXBUF_DISCARD_SAFE(mbc->buff.ibo.tris);
+    GPU_INDEXBUF_DISCARD_SAFE(mbc->buff.ibo.lines_adjacency);
+    GPU_INDEXBUF_DISCARD_SAFE(mbc->buff.ibo.edituv_tris);
+  }
+  /* These are sub-ranges of the triangle index buffer that was just freed. */
+  for (int i = 0; i < cache->mat_len; i++) {
+    GPU_INDEXBUF_DISCARD_SAFE(cache->tris_per_mat[i]);
+  }
+  DRWBatchFlag batch_map = BATCH_MAP(ibo.tris, ibo.lines_adjacency, ibo.edituv_tris);
+  mesh_batch_cache_discard_batch(cache, batch_map);
+  mesh_batch_cache_discard_surface_batches(cache);
+}
+
 void DRW_mesh_batch_cache_dirty_tag(Mesh *me, eMeshBatchDirtyMode mode)
 {
   MeshBatchCache *cache = me->runtime.batch_cache;
@@ -1013,6 +1047,42 @@ void DRW_mesh_batch_cache_dirty_tag(Mesh *me, eMeshBatchDirtyMode mode)
     case BKE_MESH_BATCH_DIRTY_ALL:
       cache->is_dirty = true;
       break;
+    case BKE_MESH_BATCH_DIRTY_POSITIONS:
+      if (cache->subdiv_cache) {
+        /* GPU subdivision buffers are all derived from the coarse positions. */
+        cache->is_dirty = true;
+        break;
+      }
+      /* Keep the index buffers and the attributes that don't depend on the positions. */
+      FOREACH_MESH_BUFFER_CACHE (cache, mbc) {
+        GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.pos_nor);
+        GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.lnor);
+        GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.tan);
+        GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.orco);
+        GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.edge_fac);
+        GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.mesh_analysis);
+        GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.edituv_stretch_area);
+        GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.edituv_stretch_angle);
+        GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.fdots_pos);
+        GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.fdots_nor);
+      }
+      batch_map = BATCH_MAP(vbo.pos_nor,
+                            vbo.lnor,
+                            vbo.tan,
+                            vbo.orco,
+                            vbo.edge_fac,
+                            vbo.mesh_analysis,
+                            vbo.edituv_stretch_area,
+                            vbo.edituv_stretch_angle,
+                            vbo.fdots_pos,
+                            vbo.fdots_nor);
+      mesh_batch_cache_discard_batch(cache, batch_map);
+      if (mesh_triangulation_depends_on_positions(me)) {
+        mesh_batch_cache_discard_tris(cache);
+      }
+      cache->tot_area = 0.0f;
+      cache->tot_uv_area = 0.0f;
+      break;
     case BKE_MESH_BATCH_DIRTY_SHADING:
       mesh_batch_cache_discard_shaded_tri(cache);
       mesh_batch_cache_discard_uvedit(cache);
@@ -1068,9 +1138,8 @@ static void mesh_batch_cache_free_subdiv_cache(MeshBatchCache *cache)
   }
 }
 
-static void mesh_batch_cache_clear(Mesh *me)
+static void mesh_batch_cache_clear(MeshBatchCache *cache)
 {
-  MeshBatchCache *cache = me->runtime.batch_cache;
   if (!cache) {
     return;
   }
@@ -1101,10 +1170,16 @@ static void mesh_batch_cache_clear(Mesh *me)
 
 void DRW_mesh_batch_cache_free(Mesh *me)
 {
-  mesh_batch_cache_clear(me);
+  mesh_batch_cache_clear(me->runtime.batch_cache);
   MEM_SAFE_FREE(me->runtime.batch_cache);
 }
 
+void DRW_mesh_batch_cache_stash_free(void *batch_cache)
+{
+  mesh_batch_cache_clear(batch_cache);
+  MEM_freeN(batch_cache);
+}
+
 /** \} */
 
 /* ---------------------------------------------------------------------- */
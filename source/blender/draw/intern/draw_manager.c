@@ -2938,6 +2938,7 @@ void DRW_engines_register(void)
 
     BKE_mesh_batch_cache_dirty_tag_cb = DRW_mesh_batch_cache_dirty_tag;
     BKE_mesh_batch_cache_free_cb = DRW_mesh_batch_cache_free;
+    BKE_mesh_batch_cache_stash_free_cb = DRW_mesh_batch_cache_stash_free;
 
     BKE_lattice_batch_cache_dirty_tag_cb = DRW_lattice_batch_cache_dirty_tag;
     BKE_lattice_batch_cache_free_cb = DRW_lattice_batch_cache_free;
@@ -24,10 +24,59 @@
 
 #include <functional>
 
+#include "BLI_memory_utils.hh"
+
 #include "FN_multi_function.hh"
 
 namespace blender::fn {
 
+namespace detail {
+
+/**
+ * Calls the element function for every index in the mask and constructs the results in the
+ * uninitialized output. The inputs are expected to be devirtualized already (i.e. spans or
+ * #SingleAsSpan), otherwise every element access is a virtual function call. When the mask is a
+ * range, the loop has no indirection and simple element functions can be auto-vectorized.
+ */
+template<typename Out1, typename ElementFuncT, typename... Inputs>
+inline void execute_element_fn(const IndexMask mask,
+                               const ElementFuncT &element_fn,
+                               MutableSpan<Out1> out1,
+                               const Inputs &...inputs)
+{
+  Out1 *out1_data = out1.data();
+  if (mask.is_range()) {
+    const IndexRange range = mask.as_range();
+    const int64_t end = range.one_after_last();
+    for (int64_t i = range.start(); i < end; i++) {
+      new (static_cast<void *>(out1_data + i)) Out1(element_fn(inputs[i]...));
+    }
+    return;
+  }
+  for (const int64_t i : mask) {
+    new (static_cast<void *>(out1_data + i)) Out1(element_fn(inputs[i]...));
+  }
+}
+
+/**
+ * Constructs the same value at every index in the mask. Used when all inputs are single values,
+ * in which case the element function only has to be evaluated once.
+ */
+template<typename Out1>
+inline void fill_single_output(const IndexMask mask, MutableSpan<Out1> out1, const Out1 &value)
+{
+  if (mask.is_range()) {
+    const IndexRange range = mask.as_range();
+    uninitialized_fill_n(out1.data() + range.start(), range.size(), value);
+    return;
+  }
+  for (const int64_t i : mask) {
+    new (static_cast<void *>(&out1[i])) Out1(value);
+  }
+}
+
+}  // namespace detail
+
 /**
  * Generates a multi-function with the following parameters:
  * 1. single input (SI) of type In1
@@ -61,10 +110,16 @@ template<typename In1, typename Out1> class CustomMF_SI_SO : public MultiFunctio
   template<typename ElementFuncT> static FunctionT create_function(ElementFuncT element_fn)
   {
     return [=](IndexMask mask, const VArray<In1> &in1, MutableSpan<Out1> out1) {
+      if (mask.is_empty()) {
+        return;
+      }
+      if (in1.is_single()) {
+        detail::fill_single_output(mask, out1, Out1(element_fn(in1.get_internal_single())));
+        return;
+      }
       /* Devirtualization results in a 2-3x speedup for some simple functions. */
       devirtualize_varray(in1, [&](const auto &in1) {
-        mask.foreach_index(
-            [&](int i) { new (static_cast<void *>(&out1[i])) Out1(element_fn(in1[i])); });
+        detail::execute_element_fn(mask, element_fn, out1, in1);
       });
     };
   }
@@ -114,10 +169,17 @@ class CustomMF_SI_SI_SO : public MultiFunction {
                const VArray<In1> &in1,
                const VArray<In2> &in2,
                MutableSpan<Out1> out1) {
+      if (mask.is_empty()) {
+        return;
+      }
+      if (in1.is_single() && in2.is_single()) {
+        detail::fill_single_output(
+            mask, out1, Out1(element_fn(in1.get_internal_single(), in2.get_internal_single())));
+        return;
+      }
       /* Devirtualization results in a 2-3x speedup for some simple functions. */
       devirtualize_varray2(in1, in2, [&](const auto &in1, const auto &in2) {
-        mask.foreach_index(
-            [&](int i) { new (static_cast<void *>(&out1[i])) Out1(element_fn(in1[i], in2[i])); });
+        detail::execute_element_fn(mask, element_fn, out1, in1, in2);
       });
     };
   }
@@ -174,9 +236,29 @@ class CustomMF_SI_SI_SI_SO : public MultiFunction {
                const VArray<In2> &in2,
                const VArray<In3> &in3,
                MutableSpan<Out1> out1) {
-      mask.foreach_index([&](int i) {
-        new (static_cast<void *>(&out1[i])) Out1(element_fn(in1[i], in2[i], in3[i]));
-      });
+      if (mask.is_empty()) {
+        return;
+      }
+      if (in1.is_single() && in2.is_single() && in3.is_single()) {
+        detail::fill_single_output(mask,
+                                   out1,
+                                   Out1(element_fn(in1.get_internal_single(),
+                                                   in2.get_internal_single(),
+                                                   in3.get_internal_single())));
+        return;
+      }
+      /* Only devirtualize the case where all inputs are spans, devirtualizing every combination
+       * would result in too many instantiations. */
+      if (in1.is_span() && in2.is_span() && in3.is_span()) {
+        detail::execute_element_fn(mask,
+                                   element_fn,
+                                   out1,
+                                   in1.get_internal_span(),
+                                   in2.get_internal_span(),
+                                   in3.get_internal_span());
+        return;
+      }
+      detail::execute_element_fn(mask, element_fn, out1, in1, in2, in3);
     };
   }
 
@@ -237,9 +319,30 @@ class CustomMF_SI_SI_SI_SI_SO : public MultiFunction {
                const VArray<In3> &in3,
                const VArray<In4> &in4,
                MutableSpan<Out1> out1) {
-      mask.foreach_index([&](int i) {
-        new (static_cast<void *>(&out1[i])) Out1(element_fn(in1[i], in2[i], in3[i], in4[i]));
-      });
+      if (mask.is_empty()) {
+        return;
+      }
+      if (in1.is_single() && in2.is_single() && in3.is_single() && in4.is_single()) {
+        detail::fill_single_output(mask,
+                                   out1,
+                                   Out1(element_fn(in1.get_internal_single(),
+                                                   in2.get_internal_single(),
+                                                   in3.get_internal_single(),
+                                                   in4.get_internal_single())));
+        return;
+      }
+      /* See #CustomMF_SI_SI_SI_SO. */
+      if (in1.is_span() && in2.is_span() && in3.is_span() && in4.is_span()) {
+        detail::execute_element_fn(mask,
+                                   element_fn,
+                                   out1,
+                                   in1.get_internal_span(),
+                                   in2.get_internal_span(),
+                                   in3.get_internal_span(),
+                                   in4.get_internal_span());
+        return;
+      }
+      detail::execute_element_fn(mask, element_fn, out1, in1, in2, in3, in4);
     };
   }
 
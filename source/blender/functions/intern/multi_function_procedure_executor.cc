@@ -166,11 +166,24 @@ class ValueAllocator : NonCopyable, NonMovable {
   /** The cached memory buffers can hold #VariableState values. */
   Stack<void *> variable_state_free_list_;
 
+  /**
+   * Span buffers are allocated with at least this many elements, so that they can be reused when
+   * the procedure is executed for multiple chunks of different sizes.
+   */
+  int64_t min_span_size_ = 0;
+
  public:
   ValueAllocator(LinearAllocator<> &linear_allocator) : linear_allocator_(linear_allocator)
   {
   }
 
+  void set_min_span_size(const int64_t size)
+  {
+    /* Buffers in the free-list might be too small otherwise. */
+    BLI_assert(span_buffers_free_list_.is_empty());
+    min_span_size_ = size;
+  }
+
   template<typename... Args> VariableState *obtain_variable_state(Args &&...args);
 
   void release_variable_state(VariableState *state);
@@ -196,15 +209,16 @@ class ValueAllocator : NonCopyable, NonMovable {
 
     const int64_t element_size = type.size();
     const int64_t alignment = type.alignment();
+    const int64_t buffer_size = std::max<int64_t>(size, min_span_size_);
 
     if (alignment > min_alignment) {
       /* In this rare case we fallback to not reusing existing buffers. */
-      buffer = linear_allocator_.allocate(element_size * size, alignment);
+      buffer = linear_allocator_.allocate(element_size * buffer_size, alignment);
     }
     else {
       Stack<void *> *stack = span_buffers_free_list_.lookup_ptr(element_size);
       if (stack == nullptr || stack->is_empty()) {
-        buffer = linear_allocator_.allocate(element_size * size, min_alignment);
+        buffer = linear_allocator_.allocate(element_size * buffer_size, min_alignment);
       }
       else {
         /* Reuse existing buffer. */
@@ -828,13 +842,13 @@ void ValueAllocator::release_variable_state(VariableState *state)
 /** Keeps track of the states of all variables during evaluation. */
 class VariableStates {
  private:
-  ValueAllocator value_allocator_;
+  ValueAllocator &value_allocator_;
   Map<const MFVariable *, VariableState *> variable_states_;
   IndexMask full_mask_;
 
  public:
-  VariableStates(LinearAllocator<> &linear_allocator, IndexMask full_mask)
-      : value_allocator_(linear_allocator), full_mask_(full_mask)
+  VariableStates(ValueAllocator &value_allocator, IndexMask full_mask)
+      : value_allocator_(value_allocator), full_mask_(full_mask)
   {
   }
 
@@ -1177,17 +1191,18 @@ class InstructionScheduler {
   }
 };
 
-void MFProcedureExecutor::call(IndexMask full_mask, MFParams params, MFContext context) const
+static void execute_procedure(const MFProcedureExecutor &fn,
+                              const MFProcedure &procedure,
+                              const IndexMask full_mask,
+                              MFParams params,
+                              const MFContext &context,
+                              ValueAllocator &value_allocator)
 {
-  BLI_assert(procedure_.validate());
-
-  LinearAllocator<> linear_allocator;
-
-  VariableStates variable_states{linear_allocator, full_mask};
-  variable_states.add_initial_variable_states(*this, procedure_, params);
+  VariableStates variable_states{value_allocator, full_mask};
+  variable_states.add_initial_variable_states(fn, procedure, params);
 
   InstructionScheduler scheduler;
-  scheduler.add_referenced_indices(*procedure_.entry(), full_mask);
+  scheduler.add_referenced_indices(*procedure.entry(), full_mask);
 
   /* Loop until all indices got to a return instruction. */
   while (NextInstructionInfo instr_info = scheduler.pop_next()) {
@@ -1233,9 +1248,9 @@ void MFProcedureExecutor::call(IndexMask full_mask, MFParams params, MFContext c
     }
   }
 
-  for (const int param_index : this->param_indices()) {
-    const MFParamType param_type = this->param_type(param_index);
-    const MFVariable *variable = procedure_.params()[param_index].variable;
+  for (const int param_index : fn.param_indices()) {
+    const MFParamType param_type = fn.param_type(param_index);
+    const MFVariable *variable = procedure.params()[param_index].variable;
     VariableState &variable_state = variable_states.get_variable_state(*variable);
     switch (param_type.interface_type()) {
       case MFParamType::Input: {
@@ -1256,6 +1271,84 @@ void MFProcedureExecutor::call(IndexMask full_mask, MFParams params, MFContext c
   }
 }
 
+/**
+ * Large masks are processed in chunks of this many indices. The intermediate buffers of a chunk
+ * stay in the CPU cache while all instructions of the procedure are executed, and the same
+ * buffers are reused for all chunks.
+ */
+static constexpr int64_t chunk_size = 4096;
+
+static bool supports_chunking(const MultiFunction &fn)
+{
+  for (const int param_index : fn.param_indices()) {
+    if (fn.param_type(param_index).data_type().is_vector()) {
+      /* Vector parameters can't be sliced. */
+      return false;
+    }
+  }
+  return true;
+}
+
+void MFProcedureExecutor::call(IndexMask full_mask, MFParams params, MFContext context) const
+{
+  BLI_assert(procedure_.validate());
+
+  LinearAllocator<> linear_allocator;
+  ValueAllocator value_allocator{linear_allocator};
+
+  if (full_mask.size() <= chunk_size || !supports_chunking(*this)) {
+    execute_procedure(*this, procedure_, full_mask, params, context, value_allocator);
+    return;
+  }
+
+  /* Make all buffers large enough for every chunk, so that they can be reused. */
+  int64_t max_chunk_array_size = 0;
+  for (int64_t start = 0; start < full_mask.size(); start += chunk_size) {
+    const IndexRange sub_range{start, std::min(chunk_size, full_mask.size() - start)};
+    const IndexMask chunk_mask = full_mask.slice(sub_range);
+    max_chunk_array_size = std::max(max_chunk_array_size, chunk_mask.last() - chunk_mask[0] + 1);
+  }
+  value_allocator.set_min_span_size(max_chunk_array_size);
+
+  Vector<int64_t> offset_mask_indices;
+  for (int64_t start = 0; start < full_mask.size(); start += chunk_size) {
+    const IndexRange sub_range{start, std::min(chunk_size, full_mask.size() - start)};
+    const IndexMask chunk_mask = full_mask.slice(sub_range);
+    const IndexRange input_slice_range{chunk_mask[0], chunk_mask.last() - chunk_mask[0] + 1};
+    const IndexMask offset_mask = full_mask.slice_and_offset(sub_range, offset_mask_indices);
+
+    MFParamsBuilder chunk_params{*this, offset_mask.min_array_size()};
+    for (const int param_index : this->param_indices()) {
+      const MFParamType param_type = this->param_type(param_index);
+      switch (param_type.category()) {
+        case MFParamType::SingleInput: {
+          const GVArray &varray = params.readonly_single_input(param_index);
+          chunk_params.add_readonly_single_input(varray.slice(input_slice_range));
+          break;
+        }
+        case MFParamType::SingleMutable: {
+          const GMutableSpan span = params.single_mutable(param_index);
+          chunk_params.add_single_mutable(span.slice(input_slice_range));
+          break;
+        }
+        case MFParamType::SingleOutput: {
+          const GMutableSpan span = params.uninitialized_single_output(param_index);
+          chunk_params.add_uninitialized_single_output(span.slice(input_slice_range));
+          break;
+        }
+        case MFParamType::VectorInput:
+        case MFParamType::VectorMutable:
+        case MFParamType::VectorOutput: {
+          BLI_assert_unreachable();
+          break;
+        }
+      }
+    }
+
+    execute_procedure(*this, procedure_, offset_mask, chunk_params, context, value_allocator);
+  }
+}
+
 MultiFunction::ExecutionHints MFProcedureExecutor::get_execution_hints() const
 {
   ExecutionHints hints;
@@ -378,4 +378,76 @@ TEST(multi_function_procedure, BufferReuse)
   EXPECT_EQ(results[4], 53);
 }
 
+TEST(multi_function_procedure, ChunkedExecution)
+{
+  /**
+   * procedure(int &a, bool cond, int *out) {
+   *   if (cond) {
+   *     a += 100;
+   *   }
+   *   int b = a + 10;
+   *   out = b + 10;
+   * }
+   */
+
+  CustomMF_SM<int> add_100_fn{"add_100", [](int &a) { a += 100; }};
+  CustomMF_SI_SO<int, int> add_10_fn{"add 10", [](int a) { return a + 10; }};
+
+  MFProcedure procedure;
+  MFProcedureBuilder builder{procedure};
+
+  MFVariable *var_a = &builder.add_single_mutable_parameter<int>();
+  MFVariable *var_cond = &builder.add_single_input_parameter<bool>();
+  MFProcedureBuilder::Branch branch = builder.add_branch(*var_cond);
+  branch.branch_true.add_call(add_100_fn, {var_a});
+  builder.set_cursor_after_branch(branch);
+  auto [var_b] = builder.add_call<1>(add_10_fn, {var_a});
+  auto [var_out] = builder.add_call<1>(add_10_fn, {var_b});
+  builder.add_destruct({var_b, var_cond});
+  builder.add_return();
+  builder.add_output_parameter(*var_out);
+
+  EXPECT_TRUE(procedure.validate());
+
+  MFProcedureExecutor procedure_fn{procedure};
+
+  /* Large enough to be split into multiple chunks, one of which is smaller than the others. */
+  const int size = 20000;
+  Array<int> values_a(size);
+  Array<bool> values_cond(size);
+  for (const int i : IndexRange(size)) {
+    values_a[i] = i;
+    values_cond[i] = i % 3 == 0;
+  }
+
+  /* Skip some indices so that the chunks are not ranges. */
+  Vector<int64_t> indices;
+  for (const int i : IndexRange(10, size - 10)) {
+    if (i % 7 != 0) {
+      indices.append(i);
+    }
+  }
+
+  Array<int> results(size, -1);
+  MFParamsBuilder params{procedure_fn, size};
+  params.add_single_mutable(values_a.as_mutable_span());
+  params.add_readonly_single_input(values_cond.as_span());
+  params.add_uninitialized_single_output(results.as_mutable_span());
+
+  MFContextBuilder context;
+  procedure_fn.call(indices.as_span(), params, context);
+
+  for (const int i : IndexRange(size)) {
+    if (i < 10 || i % 7 == 0) {
+      EXPECT_EQ(values_a[i], i);
+      EXPECT_EQ(results[i], -1);
+    }
+    else {
+      const int a = i % 3 == 0 ? i + 100 : i;
+      EXPECT_EQ(values_a[i], a);
+      EXPECT_EQ(results[i], a + 20);
+    }
+  }
+}
+
 }  // namespace blender::fn::tests
@@ -221,6 +221,87 @@ TEST(multi_function, CustomMF_SI_SI_SI_SO)
   EXPECT_EQ(outputs[3], 13);
 }
 
+TEST(multi_function, CustomMF_SI_SI_SO_SingleInputs)
+{
+  int calls_num = 0;
+  CustomMF_SI_SI_SO<int, int, int> fn("add", [&](int a, int b) {
+    calls_num++;
+    return a + b;
+  });
+
+  int value_a = 3;
+  int value_b = 4;
+  Array<int> outputs(5, -1);
+
+  MFParamsBuilder params(fn, outputs.size());
+  params.add_readonly_single_input(&value_a);
+  params.add_readonly_single_input(&value_b);
+  params.add_uninitialized_single_output(outputs.as_mutable_span());
+
+  MFContextBuilder context;
+
+  fn.call({1, 2, 4}, params, context);
+
+  /* The function is only evaluated once when all inputs are single values. */
+  EXPECT_EQ(calls_num, 1);
+  EXPECT_EQ(outputs[0], -1);
+  EXPECT_EQ(outputs[1], 7);
+  EXPECT_EQ(outputs[2], 7);
+  EXPECT_EQ(outputs[3], -1);
+  EXPECT_EQ(outputs[4], 7);
+}
+
+TEST(multi_function, CustomMF_SI_SI_SI_SI_SO)
+{
+  CustomMF_SI_SI_SI_SI_SO<float, float, float, int, float> fn{
+      "mix", [](float a, float b, float factor, int offset) {
+        return a * (1.0f - factor) + b * factor + offset;
+      }};
+
+  Array<float> values_a = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f};
+  Array<float> values_b = {10.0f, 11.0f, 12.0f, 13.0f, 14.0f};
+  Array<float> factors = {0.0f, 0.5f, 1.0f, 0.5f, 0.0f};
+  int offset = 100;
+
+  {
+    /* All inputs are spans, evaluated in a contiguous range. */
+    Array<int> offsets(values_a.size(), offset);
+    Array<float> outputs(values_a.size(), -1.0f);
+    MFParamsBuilder params(fn, values_a.size());
+    params.add_readonly_single_input(values_a.as_span());
+    params.add_readonly_single_input(values_b.as_span());
+    params.add_readonly_single_input(factors.as_span());
+    params.add_readonly_single_input(offsets.as_span());
+    params.add_uninitialized_single_output(outputs.as_mutable_span());
+    MFContextBuilder context;
+    fn.call(IndexRange(1, 3), params, context);
+
+    EXPECT_EQ(outputs[0], -1.0f);
+    EXPECT_EQ(outputs[1], 106.0f);
+    EXPECT_EQ(outputs[2], 112.0f);
+    EXPECT_EQ(outputs[3], 108.0f);
+    EXPECT_EQ(outputs[4], -1.0f);
+  }
+  {
+    /* Mixed spans and single values. */
+    Array<float> outputs(values_a.size(), -1.0f);
+    MFParamsBuilder params(fn, values_a.size());
+    params.add_readonly_single_input(values_a.as_span());
+    params.add_readonly_single_input(values_b.as_span());
+    params.add_readonly_single_input(factors.as_span());
+    params.add_readonly_single_input(&offset);
+    params.add_uninitialized_single_output(outputs.as_mutable_span());
+    MFContextBuilder context;
+    fn.call({0, 2, 4}, params, context);
+
+    EXPECT_EQ(outputs[0], 100.0f);
+    EXPECT_EQ(outputs[1], -1.0f);
+    EXPECT_EQ(outputs[2], 112.0f);
+    EXPECT_EQ(outputs[3], -1.0f);
+    EXPECT_EQ(outputs[4], 104.0f);
+  }
+}
+
 TEST(multi_function, CustomMF_SM)
 {
   CustomMF_SM<std::string> fn("AddSuffix", [](std::string &value) { value += " test"; });
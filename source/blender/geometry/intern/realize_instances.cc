@@ -339,6 +339,244 @@ static void foreach_geometry_in_reference(
   }
 }
 
+/**
+ * Preprocessed data about an instance reference whose geometry does not contain nested instances.
+ * All instances of such a reference share the same source geometry and only differ in their
+ * transform, id and attribute fallbacks.
+ */
+struct FlatReferenceInfo {
+  const MeshRealizeInfo *mesh_info = nullptr;
+  const PointCloudRealizeInfo *pointcloud_info = nullptr;
+  const RealizeCurveInfo *curve_info = nullptr;
+};
+
+/** Number of output elements and tasks that are created by a range of instances. */
+struct FlatGatherCounts {
+  MeshElementStartIndices mesh_offsets;
+  int pointcloud_offset = 0;
+  int spline_offset = 0;
+  int mesh_tasks = 0;
+  int pointcloud_tasks = 0;
+  int curve_tasks = 0;
+
+  void add(const FlatReferenceInfo &info)
+  {
+    if (info.mesh_info != nullptr) {
+      const Mesh &mesh = *info.mesh_info->mesh;
+      this->mesh_offsets.vertex += mesh.totvert;
+      this->mesh_offsets.edge += mesh.totedge;
+      this->mesh_offsets.loop += mesh.totloop;
+      this->mesh_offsets.poly += mesh.totpoly;
+      this->mesh_tasks++;
+    }
+    if (info.pointcloud_info != nullptr) {
+      this->pointcloud_offset += info.pointcloud_info->pointcloud->totpoint;
+      this->pointcloud_tasks++;
+    }
+    if (info.curve_info != nullptr) {
+      this->spline_offset += info.curve_info->curve->splines().size();
+      this->curve_tasks++;
+    }
+  }
+
+  void add(const FlatGatherCounts &other)
+  {
+    this->mesh_offsets.vertex += other.mesh_offsets.vertex;
+    this->mesh_offsets.edge += other.mesh_offsets.edge;
+    this->mesh_offsets.loop += other.mesh_offsets.loop;
+    this->mesh_offsets.poly += other.mesh_offsets.poly;
+    this->pointcloud_offset += other.pointcloud_offset;
+    this->spline_offset += other.spline_offset;
+    this->mesh_tasks += other.mesh_tasks;
+    this->pointcloud_tasks += other.pointcloud_tasks;
+    this->curve_tasks += other.curve_tasks;
+  }
+};
+
+/**
+ * Find the preprocessed data for every reference. This fails when any of the references contains
+ * nested instances or volumes, which have to be handled by the recursive gather instead.
+ */
+static bool prepare_flat_references(const GatherTasksInfo &gather_info,
+                                    const Span<InstanceReference> references,
+                                    MutableSpan<FlatReferenceInfo> r_infos)
+{
+  for (const int i : references.index_range()) {
+    const InstanceReference &reference = references[i];
+    GeometrySet geometry_set;
+    switch (reference.type()) {
+      case InstanceReference::Type::Object:
+        geometry_set = object_get_evaluated_geometry_set(reference.object());
+        break;
+      case InstanceReference::Type::GeometrySet:
+        geometry_set = reference.geometry_set();
+        break;
+      case InstanceReference::Type::Collection:
+        return false;
+      case InstanceReference::Type::None:
+        break;
+    }
+    if (geometry_set.has_instances() || geometry_set.has<VolumeComponent>()) {
+      return false;
+    }
+
+    FlatReferenceInfo &info = r_infos[i];
+    const Mesh *mesh = geometry_set.get_mesh_for_read();
+    if (mesh != nullptr && mesh->totvert > 0) {
+      info.mesh_info = &gather_info.meshes.realize_info[gather_info.meshes.order.index_of(mesh)];
+    }
+    const PointCloud *pointcloud = geometry_set.get_pointcloud_for_read();
+    if (pointcloud != nullptr && pointcloud->totpoint > 0) {
+      info.pointcloud_info =
+          &gather_info.pointclouds.realize_info[gather_info.pointclouds.order.index_of(pointcloud)];
+    }
+    const CurveEval *curve = geometry_set.get_curve_for_read();
+    if (curve != nullptr && !curve->splines().is_empty()) {
+      info.curve_info = &gather_info.curves.realize_info[gather_info.curves.order.index_of(curve)];
+    }
+  }
+  return true;
+}
+
+/**
+ * Gather tasks for instances that don't contain nested instances, which is the common case when
+ * millions of instances are scattered. Instead of going through #gather_realize_tasks_recursive
+ * for every instance, this works in two parallel passes over chunks of instances: the first pass
+ * counts the output elements per chunk, so that the start index of every chunk is known after a
+ * prefix sum. The second pass fills the preallocated tasks without further allocations.
+ */
+static bool gather_realize_tasks_for_flat_instances(
+    GatherTasksInfo &gather_info,
+    const InstancesComponent &instances_component,
+    const float4x4 &base_transform,
+    const InstanceContext &base_instance_context,
+    const Span<int> stored_instance_ids,
+    const Span<std::pair<int, GSpan>> pointcloud_attributes_to_override,
+    const Span<std::pair<int, GSpan>> mesh_attributes_to_override,
+    const Span<std::pair<int, GSpan>> curve_attributes_to_override)
+{
+  const Span<InstanceReference> references = instances_component.references();
+  const Span<int> handles = instances_component.instance_reference_handles();
+  const Span<float4x4> transforms = instances_component.instance_transforms();
+
+  Array<FlatReferenceInfo> reference_infos(references.size());
+  if (!prepare_flat_references(gather_info, references, reference_infos)) {
+    return false;
+  }
+
+  const int64_t chunk_size = 4096;
+  const int64_t chunks_num = (transforms.size() + chunk_size - 1) / chunk_size;
+  auto chunk_range = [&](const int64_t chunk) {
+    const int64_t start = chunk * chunk_size;
+    return IndexRange(start, std::min(chunk_size, transforms.size() - start));
+  };
+
+  /* First pass: count the elements and tasks created by every chunk of instances. */
+  Array<FlatGatherCounts> chunk_offsets(chunks_num);
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+    for (const int64_t chunk : range) {
+      FlatGatherCounts counts;
+      for (const int i : chunk_range(chunk)) {
+        counts.add(reference_infos[handles[i]]);
+      }
+      chunk_offsets[chunk] = counts;
+    }
+  });
+
+  /* Turn the counts into start offsets, continuing where the previously gathered tasks end. */
+  GatherTasks &tasks = gather_info.r_tasks;
+  FlatGatherCounts total;
+  total.mesh_offsets = gather_info.r_offsets.mesh_offsets;
+  total.pointcloud_offset = gather_info.r_offsets.pointcloud_offset;
+  total.spline_offset = gather_info.r_offsets.spline_offset;
+  total.mesh_tasks = tasks.mesh_tasks.size();
+  total.pointcloud_tasks = tasks.pointcloud_tasks.size();
+  total.curve_tasks = tasks.curve_tasks.size();
+  for (FlatGatherCounts &offsets : chunk_offsets) {
+    const FlatGatherCounts counts = offsets;
+    offsets = total;
+    total.add(counts);
+  }
+
+  /* All new tasks start out with the attribute fallbacks of the parent context, so that only the
+   * attributes that are overridden by the instances have to be changed below. */
+  tasks.mesh_tasks.resize(
+      total.mesh_tasks,
+      {{}, nullptr, float4x4::identity(), base_instance_context.meshes, base_instance_context.id});
+  tasks.pointcloud_tasks.resize(total.pointcloud_tasks,
+                                {0,
+                                 nullptr,
+                                 float4x4::identity(),
+                                 base_instance_context.pointclouds,
+                                 base_instance_context.id});
+  tasks.curve_tasks.resize(
+      total.curve_tasks,
+      {0, nullptr, float4x4::identity(), base_instance_context.curves, base_instance_context.id});
+
+  /* Second pass: fill in the tasks of every chunk. */
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+    for (const int64_t chunk : range) {
+      FlatGatherCounts offsets = chunk_offsets[chunk];
+      for (const int i : chunk_range(chunk)) {
+        const FlatReferenceInfo &info = reference_infos[handles[i]];
+        if (info.mesh_info == nullptr && info.pointcloud_info == nullptr &&
+            info.curve_info == nullptr) {
+          continue;
+        }
+        const float4x4 transform = base_transform * transforms[i];
+
+        uint32_t local_instance_id = 0;
+        if (gather_info.create_id_attribute_on_any_component) {
+          if (stored_instance_ids.is_empty()) {
+            local_instance_id = (uint32_t)i;
+          }
+          else {
+            local_instance_id = (uint32_t)stored_instance_ids[i];
+          }
+        }
+        const uint32_t id = noise::hash(base_instance_context.id, local_instance_id);
+
+        if (info.mesh_info != nullptr) {
+          RealizeMeshTask &task = tasks.mesh_tasks[offsets.mesh_tasks];
+          task.start_indices = offsets.mesh_offsets;
+          task.mesh_info = info.mesh_info;
+          task.transform = transform;
+          task.id = id;
+          for (const std::pair<int, GSpan> &pair : mesh_attributes_to_override) {
+            task.attribute_fallbacks.array[pair.first] = pair.second[i];
+          }
+        }
+        if (info.pointcloud_info != nullptr) {
+          RealizePointCloudTask &task = tasks.pointcloud_tasks[offsets.pointcloud_tasks];
+          task.start_index = offsets.pointcloud_offset;
+          task.pointcloud_info = info.pointcloud_info;
+          task.transform = transform;
+          task.id = id;
+          for (const std::pair<int, GSpan> &pair : pointcloud_attributes_to_override) {
+            task.attribute_fallbacks.array[pair.first] = pair.second[i];
+          }
+        }
+        if (info.curve_info != nullptr) {
+          RealizeCurveTask &task = tasks.curve_tasks[offsets.curve_tasks];
+          task.start_spline_index = offsets.spline_offset;
+          task.curve_info = info.curve_info;
+          task.transform = transform;
+          task.id = id;
+          for (const std::pair<int, GSpan> &pair : curve_attributes_to_override) {
+            task.attribute_fallbacks.array[pair.first] = pair.second[i];
+          }
+        }
+        offsets.add(info);
+      }
+    }
+  });
+
+  gather_info.r_offsets.mesh_offsets = total.mesh_offsets;
+  gather_info.r_offsets.pointcloud_offset = total.pointcloud_offset;
+  gather_info.r_offsets.spline_offset = total.spline_offset;
+  return true;
+}
+
 static void gather_realize_tasks_for_instances(GatherTasksInfo &gather_info,
                                                const InstancesComponent &instances_component,
                                                const float4x4 &base_transform,
@@ -365,6 +603,17 @@ static void gather_realize_tasks_for_instances(GatherTasksInfo &gather_info,
   Vector<std::pair<int, GSpan>> curve_attributes_to_override = prepare_attribute_fallbacks(
       gather_info, instances_component, gather_info.curves.attributes);
 
+  if (gather_realize_tasks_for_flat_instances(gather_info,
+                                              instances_component,
+                                              base_transform,
+                                              base_instance_context,
+                                              stored_instance_ids,
+                                              pointcloud_attributes_to_override,
+                                              mesh_attributes_to_override,
+                                              curve_attributes_to_override)) {
+    return;
+  }
+
   for (const int i : transforms.index_range()) {
     const int handle = handles[i];
     const float4x4 &transform = transforms[i];
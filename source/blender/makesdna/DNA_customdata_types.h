@@ -32,6 +32,7 @@ extern "C" {
 #endif
 
 struct AnonymousAttributeID;
+struct ImplicitSharingInfoHandle;
 
 /** Descriptor and storage for a custom data layer. */
 typedef struct CustomDataLayer {
@@ -62,6 +63,12 @@ typedef struct CustomDataLayer {
    * automatically.
    */
   const struct AnonymousAttributeID *anonymous_id;
+  /**
+   * Run-time data that allows sharing `data` with other layers. When this is set, the layer is
+   * one of the users of the data, which is freed when the last user is removed. The data must not
+   * be modified while it is shared, see #CustomData_duplicate_referenced_layer.
+   */
+  const struct ImplicitSharingInfoHandle *sharing_info;
 } CustomDataLayer;
 
 #define MAX_CUSTOMDATA_LAYER_NAME 64
@@ -131,8 +131,10 @@ const char *DNA_struct_get_compareflags(const struct SDNA *sdna, const struct SD
  * \param reconstruct_info: Information preprocessed by #DNA_reconstruct_info_create.
  * \param old_struct_nr: Index of struct info within oldsdna.
  * \param blocks: The number of array elements.
- * \param old_blocks: Array of struct data.
+ * \param old_blocks: Array of struct data, it doesn't have to be aligned.
  * \return An allocated reconstructed struct.
+ *
+ * \note Only reads from \a reconstruct_info, so it's safe to call from multiple threads.
  */
 void *DNA_struct_reconstruct(const struct DNA_ReconstructInfo *reconstruct_info,
                              int old_struct_nr,
@@ -42,6 +42,7 @@ extern "C" {
 #endif
 
 struct AnimData;
+struct BVHCache;
 struct BoundBox;
 struct Curve;
 struct FluidsimSettings;
@@ -141,7 +142,14 @@ typedef struct Object_Runtime {
    * when the object is being instanced.
    */
   int select_id;
-  char _pad1[3];
+  char _pad1[2];
+
+  /**
+   * The evaluated mesh only has different positions than the input mesh and shares all other
+   * data with it, so its draw batch cache can be reused for the next one. See
+   * #BKE_object_eval_batch_cache_unstash.
+   */
+  char is_data_eval_deform_only;
 
   /**
    * Denotes whether the evaluated data is owned by this object or is referenced and owned by
@@ -214,6 +222,17 @@ typedef struct Object_Runtime {
   /** Runtime evaluated curve-specific data, not stored in the file. */
   struct CurveCache *curve_cache;
 
+  /**
+   * BVH trees of the last evaluated mesh, kept when that mesh is freed so that they can be
+   * refitted for the next evaluated mesh instead of being built again. See #bvhcache_stash.
+   */
+  struct BVHCache *bvh_cache_stash;
+  /**
+   * Draw batch cache of the last evaluated mesh, kept when that mesh is freed so that buffers
+   * which don't depend on positions can be reused. See #BKE_mesh_batch_cache_stash.
+   */
+  void *batch_cache_stash;
+
   unsigned short local_collections_bits;
   short _pad2[3];
 
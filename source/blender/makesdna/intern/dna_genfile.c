@@ -736,6 +736,8 @@ static void cast_primitive_type(const eSDNA_Type old_type,
   uint64_t old_value_i = 0;
 
   for (int a = 0; a < array_len; a++) {
+    /* The old data is read with `memcpy` because it isn't necessarily aligned,
+     * e.g. when it's read directly from a memory-mapped file. */
     switch (old_type) {
       case SDNA_TYPE_CHAR:
         old_value_i = *old_data;
@@ -745,32 +747,47 @@ static void cast_primitive_type(const eSDNA_Type old_type,
         old_value_i = *((unsigned char *)old_data);
         old_value_f = (double)old_value_i;
         break;
-      case SDNA_TYPE_SHORT:
-        old_value_i = *((short *)old_data);
+      case SDNA_TYPE_SHORT: {
+        short value;
+        memcpy(&value, old_data, sizeof(value));
+        old_value_i = value;
         old_value_f = (double)old_value_i;
         break;
-      case SDNA_TYPE_USHORT:
-        old_value_i = *((unsigned short *)old_data);
+      }
+      case SDNA_TYPE_USHORT: {
+        unsigned short value;
+        memcpy(&value, old_data, sizeof(value));
+        old_value_i = value;
         old_value_f = (double)old_value_i;
         break;
-      case SDNA_TYPE_INT:
-        old_value_i = *((int *)old_data);
+      }
+      case SDNA_TYPE_INT: {
+        int value;
+        memcpy(&value, old_data, sizeof(value));
+        old_value_i = value;
         old_value_f = (double)old_value_i;
         break;
-      case SDNA_TYPE_FLOAT:
-        old_value_f = *((float *)old_data);
+      }
+      case SDNA_TYPE_FLOAT: {
+        float value;
+        memcpy(&value, old_data, sizeof(value));
+        old_value_f = value;
         old_value_i = (uint64_t)(int64_t)old_value_f;
         break;
+      }
       case SDNA_TYPE_DOUBLE:
-        old_value_f = *((double *)old_data);
+        memcpy(&old_value_f, old_data, sizeof(old_value_f));
         old_value_i = (uint64_t)(int64_t)old_value_f;
         break;
-      case SDNA_TYPE_INT64:
-        old_value_i = (uint64_t) * ((int64_t *)old_data);
+      case SDNA_TYPE_INT64: {
+        int64_t value;
+        memcpy(&value, old_data, sizeof(value));
+        old_value_i = (uint64_t)value;
         old_value_f = (double)old_value_i;
         break;
+      }
       case SDNA_TYPE_UINT64:
-        old_value_i = *((uint64_t *)old_data);
+        memcpy(&old_value_i, old_data, sizeof(old_value_i));
         old_value_f = (double)old_value_i;
         break;
       case SDNA_TYPE_INT8:
@@ -822,24 +839,24 @@ static void cast_primitive_type(const eSDNA_Type old_type,
   }
 }
 
-static void cast_pointer_32_to_64(const int array_len,
-                                  const uint32_t *old_data,
-                                  uint64_t *new_data)
+static void cast_pointer_32_to_64(const int array_len, const char *old_data, uint64_t *new_data)
 {
   for (int a = 0; a < array_len; a++) {
-    new_data[a] = old_data[a];
+    uint32_t old_value;
+    memcpy(&old_value, old_data + a * sizeof(uint32_t), sizeof(old_value));
+    new_data[a] = old_value;
   }
 }
 
-static void cast_pointer_64_to_32(const int array_len,
-                                  const uint64_t *old_data,
-                                  uint32_t *new_data)
+static void cast_pointer_64_to_32(const int array_len, const char *old_data, uint32_t *new_data)
 {
   /* WARNING: 32-bit Blender trying to load file saved by 64-bit Blender,
    * pointers may lose uniqueness on truncation! (Hopefully this won't
    * happen unless/until we ever get to multi-gigabyte .blend files...) */
   for (int a = 0; a < array_len; a++) {
-    new_data[a] = old_data[a] >> 3;
+    uint64_t old_value;
+    memcpy(&old_value, old_data + a * sizeof(uint64_t), sizeof(old_value));
+    new_data[a] = old_value >> 3;
   }
 }
 
@@ -1157,12 +1174,12 @@ static void reconstruct_struct(const DNA_ReconstructInfo *reconstruct_info,
         break;
       case RECONSTRUCT_STEP_CAST_POINTER_TO_32:
         cast_pointer_64_to_32(step->data.cast_pointer.array_len,
-                              (const uint64_t *)(old_block + step->data.cast_pointer.old_offset),
+                              old_block + step->data.cast_pointer.old_offset,
                               (uint32_t *)(new_block + step->data.cast_pointer.new_offset));
         break;
       case RECONSTRUCT_STEP_CAST_POINTER_TO_64:
         cast_pointer_32_to_64(step->data.cast_pointer.array_len,
-                              (const uint32_t *)(old_block + step->data.cast_pointer.old_offset),
+                              old_block + step->data.cast_pointer.old_offset,
                               (uint64_t *)(new_block + step->data.cast_pointer.new_offset));
         break;
       case RECONSTRUCT_STEP_SUBSTRUCT:
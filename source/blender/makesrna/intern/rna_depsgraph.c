@@ -254,6 +254,27 @@ static void rna_Depsgraph_debug_stats_gnuplot(Depsgraph *depsgraph,
   fclose(f);
 }
 
+static void rna_Depsgraph_debug_trace_begin(void)
+{
+  DEG_debug_trace_begin();
+}
+
+static void rna_Depsgraph_debug_trace_end(ReportList *reports, const char *filename)
+{
+  if (filename[0] == '\0') {
+    DEG_debug_trace_end(NULL);
+    return;
+  }
+  FILE *f = fopen(filename, "w");
+  if (f == NULL) {
+    BKE_reportf(reports, RPT_ERROR, "Cannot open trace file '%s' for writing", filename);
+    DEG_debug_trace_end(NULL);
+    return;
+  }
+  DEG_debug_trace_end(f);
+  fclose(f);
+}
+
 static void rna_Depsgraph_debug_tag_update(Depsgraph *depsgraph)
 {
   DEG_graph_tag_relations_update(depsgraph);
@@ -667,6 +688,23 @@ static void rna_def_depsgraph(BlenderRNA *brna)
                                   "File name where gnuplot script will save the result");
   RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
 
+  func = RNA_def_function(srna, "debug_trace_begin", "rna_Depsgraph_debug_trace_begin");
+  RNA_def_function_ui_description(
+      func, "Start recording the evaluation of operations in all dependency graphs");
+  RNA_def_function_flag(func, FUNC_NO_SELF);
+
+  func = RNA_def_function(srna, "debug_trace_end", "rna_Depsgraph_debug_trace_end");
+  RNA_def_function_ui_description(func,
+                                  "Stop recording the evaluation of operations and write it in "
+                                  "the Chrome Trace Event format (Perfetto, chrome://tracing)");
+  RNA_def_function_flag(func, FUNC_NO_SELF | FUNC_USE_REPORTS);
+  RNA_def_string_file_path(func,
+                           "filename",
+                           NULL,
+                           FILE_MAX,
+                           "File Name",
+                           "Output path for the trace file, discards the recording when empty");
+
   func = RNA_def_function(srna, "debug_tag_update", "rna_Depsgraph_debug_tag_update");
 
   func = RNA_def_function(srna, "debug_stats", "rna_Depsgraph_debug_stats");
@@ -86,6 +86,7 @@
 #include "MOD_modifiertypes.h"
 #include "MOD_nodes.h"
 #include "MOD_nodes_evaluator.hh"
+#include "MOD_nodes_output_cache.hh"
 #include "MOD_ui_common.h"
 
 #include "ED_object.h"
@@ -126,6 +127,7 @@ using blender::nodes::InputSocketFieldType;
 using blender::threading::EnumerableThreadSpecific;
 using namespace blender::fn::multi_function_types;
 using namespace blender::nodes::derived_node_tree_types;
+using blender::modifiers::geometry_nodes::NodeOutputCache;
 using geo_log::GeometryAttributeInfo;
 
 static void initData(ModifierData *md)
@@ -892,6 +894,19 @@ static void clear_runtime_data(NodesModifierData *nmd)
   }
 }
 
+/**
+ * The output cache is stored as runtime data of the evaluated modifier, so that every depsgraph
+ * has its own cache. It is kept when the evaluated object is copied again, and freed together
+ * with the evaluated modifier.
+ */
+static NodeOutputCache &ensure_output_cache(NodesModifierData &nmd)
+{
+  if (nmd.modifier.runtime == nullptr) {
+    nmd.modifier.runtime = new NodeOutputCache();
+  }
+  return *static_cast<NodeOutputCache *>(nmd.modifier.runtime);
+}
+
 static void store_field_on_geometry_component(GeometryComponent &component,
                                               const StringRef attribute_name,
                                               AttributeDomain domain,
@@ -1038,6 +1053,7 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
   eval_params.depsgraph = ctx->depsgraph;
   eval_params.self_object = ctx->object;
   eval_params.geo_logger = geo_logger.has_value() ? &*geo_logger : nullptr;
+  eval_params.output_cache = &ensure_output_cache(*nmd);
   blender::modifiers::geometry_nodes::evaluate_geometry_nodes(eval_params);
 
   GeometrySet output_geometry_set = eval_params.r_output_values[0].relocate_out<GeometrySet>();
@@ -1575,6 +1591,11 @@ static void copyData(const ModifierData *md, ModifierData *target, const int fla
   }
 }
 
+static void freeRuntimeData(void *runtime_data)
+{
+  delete static_cast<NodeOutputCache *>(runtime_data);
+}
+
 static void freeData(ModifierData *md)
 {
   NodesModifierData *nmd = reinterpret_cast<NodesModifierData *>(md);
@@ -1584,6 +1605,8 @@ static void freeData(ModifierData *md)
   }
 
   clear_runtime_data(nmd);
+  freeRuntimeData(md->runtime);
+  md->runtime = nullptr;
 }
 
 static void requiredDataMask(Object *UNUSED(ob),
@@ -1627,7 +1650,7 @@ ModifierTypeInfo modifierType_Nodes = {
     /* dependsOnNormals */ nullptr,
     /* foreachIDLink */ foreachIDLink,
     /* foreachTexLink */ foreachTexLink,
-    /* freeRuntimeData */ nullptr,
+    /* freeRuntimeData */ freeRuntimeData,
     /* panelRegister */ panelRegister,
     /* blendWrite */ blendWrite,
     /* blendRead */ blendRead,
@@ -15,6 +15,7 @@
  */
 
 #include "MOD_nodes_evaluator.hh"
+#include "MOD_nodes_output_cache.hh"
 
 #include "BKE_type_conversions.hh"
 
@@ -23,6 +24,10 @@
 
 #include "DEG_depsgraph_query.h"
 
+#include "DNA_collection_types.h"
+#include "DNA_color_types.h"
+#include "DNA_object_types.h"
+
 #include "FN_field.hh"
 #include "FN_field_cpp_type.hh"
 #include "FN_generic_value_map.hh"
@@ -31,12 +36,14 @@
 #include "BLT_translation.h"
 
 #include "BLI_enumerable_thread_specific.hh"
+#include "BLI_listbase.h"
 #include "BLI_stack.hh"
 #include "BLI_task.h"
 #include "BLI_task.hh"
 #include "BLI_vector_set.hh"
 
 #include <chrono>
+#include <optional>
 
 namespace blender::modifiers::geometry_nodes {
 
@@ -264,6 +271,31 @@ struct NodeState {
    * not run twice at the same time accidentally.
    */
   NodeScheduleState schedule_state = NodeScheduleState::NotScheduled;
+
+  /**
+   * Hash of everything the outputs of this node depend on, see #NodeOutputCache. It is zero when
+   * the outputs can't be cached. This is computed before evaluation starts and does not change
+   * afterwards, so it can be read without a lock.
+   */
+  uint64_t cache_key = 0;
+
+  /**
+   * True when the outputs of this node are looked up in the output cache. Nodes that are not
+   * looked up themselves still have a key when nodes that depend on them can be cached.
+   */
+  bool use_output_cache = false;
+
+  /**
+   * True when the outputs were not found in the output cache, but should be added to it after the
+   * node has been executed.
+   */
+  bool add_outputs_to_cache = false;
+
+  /**
+   * Copies of the outputs that have been found in the output cache. When this is not empty, these
+   * values are forwarded instead of executing the node.
+   */
+  Vector<GMutablePointer> cached_output_values;
 };
 
 /**
@@ -422,6 +454,255 @@ struct NodeTaskRunState {
   DNode next_node_to_run;
 };
 
+/** Sockets of these types reference data-blocks, whose state is hashed with #hash_id_state. */
+static bool socket_type_references_id(const int socket_type)
+{
+  return ELEM(socket_type, SOCK_OBJECT, SOCK_COLLECTION, SOCK_TEXTURE, SOCK_IMAGE);
+}
+
+/**
+ * Whether the outputs of the node only depend on its inputs, its properties and the data-blocks
+ * it references. Other nodes depend on the evaluation context.
+ */
+static bool node_is_cacheable(const DNode node)
+{
+  const bNode &bnode = *node->bnode();
+  return !ELEM(bnode.type, GEO_NODE_INPUT_SCENE_TIME, GEO_NODE_IS_VIEWPORT, GEO_NODE_VIEWER);
+}
+
+static uint64_t hash_id_state(const Depsgraph *depsgraph, const ID *id);
+
+static uint64_t hash_collection_state(const Depsgraph *depsgraph, const Collection &collection)
+{
+  /* Collections are not updated when the objects in them change. */
+  uint64_t hash = 0;
+  LISTBASE_FOREACH (const CollectionObject *, collection_object, &collection.gobject) {
+    const uint64_t object_hash = hash_id_state(depsgraph, &collection_object->ob->id);
+    if (object_hash == 0) {
+      return 0;
+    }
+    hash = cache_key_combine(hash, object_hash);
+  }
+  LISTBASE_FOREACH (const CollectionChild *, child, &collection.children) {
+    const uint64_t child_hash = hash_id_state(depsgraph, &child->collection->id);
+    if (child_hash == 0) {
+      return 0;
+    }
+    hash = cache_key_combine(hash, child_hash);
+  }
+  return hash;
+}
+
+/**
+ * Hash the state of a data-block that a node depends on. It changes whenever the data-block is
+ * updated by the depsgraph, so that outputs computed from older data are not used. Zero is
+ * returned when changes can't be detected.
+ */
+static uint64_t hash_id_state(const Depsgraph *depsgraph, const ID *id)
+{
+  if (id == nullptr) {
+    return 1;
+  }
+  if (ELEM(GS(id->name), ID_IM, ID_TE)) {
+    /* Images can change without being updated by the depsgraph, e.g. when painting. */
+    return 0;
+  }
+  const uint64_t update_count = DEG_get_update_count_for_id(depsgraph, id);
+  if (update_count == 0) {
+    return 0;
+  }
+  const ID *id_orig = DEG_get_original_id(const_cast<ID *>(id));
+  uint64_t hash = cache_key_combine(uint64_t(id_orig->session_uuid), update_count);
+  hash = cache_key_combine(hash, uint64_t(id->recalc));
+  uint64_t nested_hash = 1;
+  if (GS(id->name) == ID_GR) {
+    nested_hash = hash_collection_state(depsgraph, *reinterpret_cast<const Collection *>(id));
+  }
+  else if (GS(id->name) == ID_OB) {
+    const Object &object = *reinterpret_cast<const Object *>(id);
+    if ((object.transflag & OB_DUPLICOLLECTION) && object.instance_collection != nullptr) {
+      nested_hash = hash_id_state(depsgraph, &object.instance_collection->id);
+    }
+  }
+  return nested_hash == 0 ? 0 : cache_key_combine(hash, nested_hash);
+}
+
+/** Get the data-block referenced by a value of a socket type that references data-blocks. */
+static const ID *socket_value_id(const int socket_type, const void *value)
+{
+  switch (socket_type) {
+    case SOCK_OBJECT:
+      return reinterpret_cast<const ID *>(*static_cast<Object *const *>(value));
+    case SOCK_COLLECTION:
+      return reinterpret_cast<const ID *>(*static_cast<Collection *const *>(value));
+    case SOCK_TEXTURE:
+      return reinterpret_cast<const ID *>(*static_cast<Tex *const *>(value));
+    case SOCK_IMAGE:
+      return reinterpret_cast<const ID *>(*static_cast<Image *const *>(value));
+  }
+  BLI_assert_unreachable();
+  return nullptr;
+}
+
+/**
+ * Hash the structure of all used node trees. This is part of every cache key, so that changing
+ * links or socket types, which affects implicit conversions too, never leads to stale outputs.
+ */
+static uint64_t hash_tree_structure(const DerivedNodeTree &tree)
+{
+  uint64_t hash = 0;
+  auto hash_socket = [&](const SocketRef &socket) {
+    hash = cache_key_hash_string(socket.identifier(), hash);
+    hash = cache_key_hash_string(socket.idname(), hash);
+    hash = cache_key_combine(hash, socket.is_available());
+  };
+  for (const NodeTreeRef *tree_ref : tree.used_node_tree_refs()) {
+    hash = cache_key_hash_string(tree_ref->name(), hash);
+    for (const NodeRef *node : tree_ref->nodes()) {
+      hash = cache_key_hash_string(node->name(), hash);
+      hash = cache_key_hash_string(node->idname(), hash);
+      hash = cache_key_combine(hash, node->is_muted());
+      for (const InputSocketRef *socket : node->inputs()) {
+        hash_socket(*socket);
+      }
+      for (const OutputSocketRef *socket : node->outputs()) {
+        hash_socket(*socket);
+      }
+    }
+    for (const nodes::LinkRef *link : tree_ref->links()) {
+      hash = cache_key_hash_string(link->from().node().name(), hash);
+      hash = cache_key_hash_string(link->from().identifier(), hash);
+      hash = cache_key_hash_string(link->to().node().name(), hash);
+      hash = cache_key_hash_string(link->to().identifier(), hash);
+      hash = cache_key_combine(hash, link->is_muted());
+    }
+  }
+  return hash;
+}
+
+/** Identifies the group nodes that a node is nested in. */
+static uint64_t hash_tree_context(const DTreeContext &context)
+{
+  if (context.is_root()) {
+    return 0;
+  }
+  return cache_key_hash_string(context.parent_node()->name(),
+                               hash_tree_context(*context.parent_context()));
+}
+
+static uint64_t hash_node_storage(const bNode &bnode, uint64_t hash)
+{
+  if (bnode.storage == nullptr) {
+    return hash;
+  }
+  const StringRefNull storage_name = bnode.typeinfo->storagename;
+  if (storage_name == "CurveMapping") {
+    /* Hash the curve points instead of the pointers to them, which change whenever the node tree
+     * is copied. */
+    CurveMapping curve_mapping = *static_cast<const CurveMapping *>(bnode.storage);
+    for (CurveMap &curve_map : curve_mapping.cm) {
+      hash = cache_key_hash_bytes(
+          curve_map.curve, sizeof(CurveMapPoint) * curve_map.totpoint, hash);
+      curve_map.curve = nullptr;
+      curve_map.table = nullptr;
+      curve_map.premultable = nullptr;
+    }
+    return cache_key_hash_bytes(&curve_mapping, sizeof(curve_mapping), hash);
+  }
+  if (storage_name == "NodeInputString") {
+    const NodeInputString &storage = *static_cast<const NodeInputString *>(bnode.storage);
+    return storage.string ? cache_key_hash_string(storage.string, hash) : hash;
+  }
+  return cache_key_hash_bytes(bnode.storage, MEM_allocN_len(bnode.storage), hash);
+}
+
+static uint64_t hash_node(const Depsgraph *depsgraph, const DNode node, const uint64_t tree_hash)
+{
+  const bNode &bnode = *node->bnode();
+  uint64_t hash = 0;
+  if (bnode.id != nullptr) {
+    hash = hash_id_state(depsgraph, bnode.id);
+    if (hash == 0) {
+      return 0;
+    }
+  }
+  hash = cache_key_combine(hash, tree_hash);
+  hash = cache_key_combine(hash, hash_tree_context(*node.context()));
+  hash = cache_key_hash_string(node->name(), hash);
+  hash = cache_key_hash_string(node->idname(), hash);
+  hash = cache_key_combine(hash, uint64_t(bnode.custom1));
+  hash = cache_key_combine(hash, uint64_t(bnode.custom2));
+  hash = cache_key_hash_bytes(&bnode.custom3, sizeof(bnode.custom3), hash);
+  hash = cache_key_hash_bytes(&bnode.custom4, sizeof(bnode.custom4), hash);
+  return hash_node_storage(bnode, hash);
+}
+
+/** Hash the value of an input socket that is not linked, which is stored in the socket itself. */
+static uint64_t hash_unlinked_socket(const Depsgraph *depsgraph, const SocketRef &socket)
+{
+  const bNodeSocket &bsocket = *socket.bsocket();
+  uint64_t hash = cache_key_hash_string(socket.node().name(), 0);
+  hash = cache_key_hash_string(socket.identifier(), hash);
+  if (socket_type_references_id(bsocket.type)) {
+    /* The default values of these sockets only store a pointer to the data-block. */
+    const uint64_t id_hash = hash_id_state(depsgraph,
+                                           socket_value_id(bsocket.type, bsocket.default_value));
+    return id_hash == 0 ? 0 : cache_key_combine(hash, id_hash);
+  }
+  if (bsocket.default_value != nullptr) {
+    /* Material sockets only store a pointer, which is hashed here. That is enough, because nodes
+     * only pass the material on without looking at it. */
+    hash = cache_key_hash_bytes(
+        bsocket.default_value, MEM_allocN_len(bsocket.default_value), hash);
+  }
+  return hash;
+}
+
+/** Hash a value that has been passed into the node group by the modifier. */
+static uint64_t hash_group_input_value(const Depsgraph *depsgraph,
+                                       const OutputSocketRef &socket,
+                                       const GPointer value)
+{
+  const uint64_t seed = cache_key_hash_string(socket.identifier(), 0);
+  const int socket_type = socket.bsocket()->type;
+  if (socket_type_references_id(socket_type)) {
+    const uint64_t id_hash = hash_id_state(depsgraph, socket_value_id(socket_type, value.get()));
+    return id_hash == 0 ? 0 : cache_key_combine(seed, id_hash);
+  }
+  const CPPType &type = *value.type();
+  if (type.is<GeometrySet>()) {
+    const uint64_t geometry_hash = cache_key_hash_geometry(*value.get<GeometrySet>());
+    return geometry_hash == 0 ? 0 : cache_key_combine(seed, geometry_hash);
+  }
+  if (const ValueOrFieldCPPType *field_type = dynamic_cast<const ValueOrFieldCPPType *>(&type)) {
+    if (field_type->is_field(value.get())) {
+      /* Only attribute inputs are passed in by the modifier. Their hash depends on the attribute
+       * name and type, other fields might just hash their address. */
+      const GField &field = *field_type->get_field_ptr(value.get());
+      if (dynamic_cast<const bke::AttributeFieldInput *>(&field.node()) == nullptr) {
+        return 0;
+      }
+      return cache_key_combine(seed, field.node().hash());
+    }
+    const CPPType &base_type = field_type->base_type();
+    if (!base_type.is_hashable()) {
+      return 0;
+    }
+    return cache_key_combine(seed, base_type.hash(field_type->get_value_ptr(value.get())));
+  }
+  if (!type.is_hashable()) {
+    return 0;
+  }
+  return cache_key_combine(seed, type.hash(value.get()));
+}
+
+/** State that is only used while computing the cache keys for all nodes. */
+struct CacheKeyBuildData {
+  uint64_t tree_hash;
+  Map<DNode, uint64_t> node_keys;
+  Map<DOutputSocket, uint64_t> group_input_keys;
+};
+
 /** Implements the callbacks that might be called when a node is executed. */
 class NodeParamsProvider : public nodes::GeoNodeExecParamsProvider {
  private:
@@ -449,6 +730,12 @@ class NodeParamsProvider : public nodes::GeoNodeExecParamsProvider {
   bool lazy_output_is_required(StringRef identifier) const override;
 
   void set_default_remaining_outputs() override;
+
+  /**
+   * When not null, copies of the outputs that may be used are stored here, so that they can be
+   * added to the output cache after the node has been executed.
+   */
+  NodeOutputCache::Entry *cache_entry = nullptr;
 };
 
 class GeometryNodesEvaluator {
@@ -497,6 +784,7 @@ class GeometryNodesEvaluator {
     task_pool_ = BLI_task_pool_create(this, TASK_PRIORITY_HIGH);
 
     this->create_states_for_reachable_nodes();
+    this->compute_cache_keys();
     this->forward_group_inputs();
     this->schedule_initial_nodes();
 
@@ -560,6 +848,108 @@ class GeometryNodesEvaluator {
     }
   }
 
+  /**
+   * Compute the keys that are used to find node outputs in the output cache. The key of a node is
+   * a hash of the node itself, the values of its unlinked inputs and the keys of the sockets that
+   * are linked to it. Therefore it changes whenever anything changes that the node depends on.
+   * This has to run before the group inputs are forwarded, because their values are hashed.
+   */
+  void compute_cache_keys()
+  {
+    if (params_.output_cache == nullptr || node_states_.is_empty()) {
+      return;
+    }
+    CacheKeyBuildData data;
+    data.tree_hash = hash_tree_structure(node_states_[0].node.context()->derived_tree());
+    for (const NodeWithState &item : node_states_) {
+      NodeState &node_state = *item.state;
+      node_state.cache_key = this->compute_node_cache_key(item.node, data);
+      node_state.use_output_cache = node_state.cache_key != 0 &&
+                                    node_supports_output_cache(item.node, node_state);
+    }
+  }
+
+  static bool node_supports_output_cache(const DNode node, const NodeState &node_state)
+  {
+    /* Multi-function nodes are cheap to execute and only output fields, which reference functions
+     * that are freed after the evaluation. Lazy nodes may only compute some of their outputs. */
+    if (node->typeinfo()->geometry_node_execute == nullptr || node_supports_laziness(node)) {
+      return false;
+    }
+    /* Inputs that have to be logged are computed even when the outputs are cached, that is not
+     * worth the extra complexity. */
+    for (const InputState &input_state : node_state.inputs) {
+      if (input_state.force_compute) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  uint64_t compute_node_cache_key(const DNode node, CacheKeyBuildData &data)
+  {
+    if (const uint64_t *key = data.node_keys.lookup_ptr(node)) {
+      return *key;
+    }
+    uint64_t key = 0;
+    if (node_is_cacheable(node)) {
+      key = hash_node(params_.depsgraph, node, data.tree_hash);
+      auto add_origin_key = [&](const uint64_t origin_key) {
+        key = (key == 0 || origin_key == 0) ? 0 : cache_key_combine(key, origin_key);
+      };
+      for (const InputSocketRef *input_ref : node->inputs()) {
+        if (!input_ref->is_available()) {
+          continue;
+        }
+        const DInputSocket input{node.context(), input_ref};
+        bool is_linked = false;
+        input.foreach_origin_socket([&](const DSocket origin) {
+          is_linked = true;
+          add_origin_key(this->compute_origin_cache_key(origin, data));
+        });
+        if (!is_linked) {
+          add_origin_key(hash_unlinked_socket(params_.depsgraph, *input_ref));
+        }
+        if (key == 0) {
+          break;
+        }
+      }
+    }
+    /* The map is not modified by the caller, so it's fine if the recursion added other keys. */
+    data.node_keys.add_new(node, key);
+    return key;
+  }
+
+  uint64_t compute_origin_cache_key(const DSocket origin, CacheKeyBuildData &data)
+  {
+    if (origin->is_input()) {
+      /* The value is taken from an unlinked socket, possibly on a group node. */
+      return hash_unlinked_socket(params_.depsgraph, *origin.socket_ref());
+    }
+    const DOutputSocket origin_output{origin};
+    const DNode origin_node = origin.node();
+    if (!origin_node->is_group_input_node() &&
+        socket_type_references_id(origin->bsocket()->type)) {
+      /* The data-block is only known after the node has been executed, so its state can't be part
+       * of the key. */
+      return 0;
+    }
+    if (origin_node->is_group_input_node()) {
+      return data.group_input_keys.lookup_or_add_cb(origin_output, [&]() -> uint64_t {
+        const GMutablePointer *value = params_.input_values.lookup_ptr(origin_output);
+        if (value == nullptr) {
+          return 0;
+        }
+        return hash_group_input_value(params_.depsgraph, *origin_output.socket_ref(), *value);
+      });
+    }
+    const uint64_t node_key = this->compute_node_cache_key(origin_node, data);
+    if (node_key == 0) {
+      return 0;
+    }
+    return cache_key_combine(node_key, uint64_t(origin->index()));
+  }
+
   void initialize_node_state(const DNode node, NodeState &node_state, LinearAllocator<> &allocator)
   {
     /* Construct arrays of the correct size. */
@@ -811,8 +1201,13 @@ class GeometryNodesEvaluator {
        * required and before we check that all required inputs are provided. This reduces the
        * number of "round-trips" through the task pool by one for most nodes. */
       if (!node_state.non_lazy_inputs_handled) {
-        this->require_non_lazy_inputs(locked_node);
         node_state.non_lazy_inputs_handled = true;
+        if (node_state.use_output_cache && this->load_outputs_from_cache(locked_node)) {
+          /* The inputs are not required, because the node does not have to be executed. */
+          do_execute_node = true;
+          return;
+        }
+        this->require_non_lazy_inputs(locked_node);
       }
       /* Prepare inputs and check if all required inputs are provided. */
       if (!this->prepare_node_inputs_for_execution(locked_node)) {
@@ -910,6 +1305,52 @@ class GeometryNodesEvaluator {
     }
   }
 
+  /**
+   * Copy all outputs that may be used from the output cache. Those are forwarded instead of
+   * executing the node, so the inputs of the node and everything they depend on is not computed.
+   * When the outputs are not found, it is decided whether they are added after execution.
+   */
+  bool load_outputs_from_cache(LockedNode &locked_node)
+  {
+    NodeState &node_state = locked_node.node_state;
+    NodeOutputCache &output_cache = *params_.output_cache;
+    LinearAllocator<> &allocator = local_allocators_.local();
+    const bool found = output_cache.lookup(
+        node_state.cache_key, [&](const NodeOutputCache::Entry &entry) {
+          if (params_.geo_logger != nullptr && !entry.has_warnings) {
+            return false;
+          }
+          for (const int i : node_state.outputs.index_range()) {
+            if (node_state.outputs[i].output_usage_for_execution != ValueUsage::Unused) {
+              if (entry.values[i].get() == nullptr) {
+                return false;
+              }
+            }
+          }
+          node_state.cached_output_values.resize(node_state.outputs.size());
+          for (const int i : node_state.outputs.index_range()) {
+            if (node_state.outputs[i].output_usage_for_execution == ValueUsage::Unused) {
+              continue;
+            }
+            const CPPType &type = *entry.values[i].type();
+            void *buffer = allocator.allocate(type.size(), type.alignment());
+            type.copy_construct(entry.values[i].get(), buffer);
+            node_state.cached_output_values[i] = {type, buffer};
+          }
+          if (params_.geo_logger != nullptr) {
+            for (const geo_log::NodeWarning &warning : entry.warnings) {
+              params_.geo_logger->local().log_node_warning(
+                  locked_node.node, warning.type, warning.message);
+            }
+          }
+          return true;
+        });
+    if (!found) {
+      node_state.add_outputs_to_cache = output_cache.register_miss(node_state.cache_key);
+    }
+    return found;
+  }
+
   /**
    * Checks if requested inputs are available and "marks" all the inputs that are available
    * during the node execution. Inputs that are provided after this function ends but before the
@@ -976,6 +1417,11 @@ class GeometryNodesEvaluator {
     }
     node_state.has_been_executed = true;
 
+    if (!node_state.cached_output_values.is_empty()) {
+      this->forward_cached_outputs(node, node_state, run_state);
+      return;
+    }
+
     /* Use the geometry node execute callback if it exists. */
     if (bnode.typeinfo->geometry_node_execute != nullptr) {
       this->execute_geometry_node(node, node_state, run_state);
@@ -992,11 +1438,34 @@ class GeometryNodesEvaluator {
     this->execute_unknown_node(node, node_state, run_state);
   }
 
+  void forward_cached_outputs(const DNode node, NodeState &node_state, NodeTaskRunState *run_state)
+  {
+    for (const int i : node_state.cached_output_values.index_range()) {
+      const GMutablePointer value = node_state.cached_output_values[i];
+      if (value.get() == nullptr) {
+        continue;
+      }
+      this->forward_output(node.output(i), value, run_state);
+      node_state.outputs[i].has_been_computed = true;
+    }
+    node_state.cached_output_values.clear();
+  }
+
   void execute_geometry_node(const DNode node, NodeState &node_state, NodeTaskRunState *run_state)
   {
     const bNode &bnode = *node->bnode();
 
     NodeParamsProvider params_provider{*this, node, node_state, run_state};
+    std::optional<NodeOutputCache::Entry> cache_entry;
+    int64_t warnings_num_before = 0;
+    if (node_state.add_outputs_to_cache) {
+      cache_entry.emplace();
+      cache_entry->values.resize(node->outputs().size());
+      params_provider.cache_entry = &*cache_entry;
+      if (params_.geo_logger != nullptr) {
+        warnings_num_before = params_.geo_logger->local().node_warnings().size();
+      }
+    }
     GeoNodeExecParams params{params_provider};
     if (node->idname().find("Legacy") != StringRef::not_found) {
       params.error_message_add(geo_log::NodeWarningType::Legacy,
@@ -1011,6 +1480,47 @@ class GeometryNodesEvaluator {
     if (params_.geo_logger != nullptr) {
       params_.geo_logger->local().log_execution_time(node, duration);
     }
+    if (cache_entry.has_value()) {
+      this->add_outputs_to_cache(node, node_state, std::move(*cache_entry), warnings_num_before);
+    }
+  }
+
+  void add_outputs_to_cache(const DNode node,
+                            const NodeState &node_state,
+                            NodeOutputCache::Entry entry,
+                            const int64_t warnings_num_before)
+  {
+    for (const int i : entry.values.index_range()) {
+      const GMutablePointer value = entry.values[i];
+      if (value.get() == nullptr) {
+        if (node_state.outputs[i].output_usage_for_execution != ValueUsage::Unused) {
+          /* The output has not been computed by the node, the entry would never be used. */
+          NodeOutputCache::free_entry(entry);
+          return;
+        }
+        continue;
+      }
+      const ValueOrFieldCPPType *field_type = dynamic_cast<const ValueOrFieldCPPType *>(
+          value.type());
+      if (field_type != nullptr && field_type->is_field(value.get())) {
+        /* Fields may reference multi-functions that are freed after the evaluation. */
+        NodeOutputCache::free_entry(entry);
+        return;
+      }
+      entry.size_in_bytes += NodeOutputCache::estimate_value_size(value);
+    }
+    if (params_.geo_logger != nullptr) {
+      /* Remember the warnings, so that they are still displayed when the outputs are reused. */
+      const Span<geo_log::NodeWithWarning> warnings =
+          params_.geo_logger->local().node_warnings().drop_front(warnings_num_before);
+      for (const geo_log::NodeWithWarning &item : warnings) {
+        if (item.node == node) {
+          entry.warnings.append(item.warning);
+        }
+      }
+      entry.has_warnings = true;
+    }
+    params_.output_cache->add(node_state.cache_key, std::move(entry));
   }
 
   void execute_multi_function_node(const DNode node,
@@ -1868,6 +2378,10 @@ void NodeParamsProvider::set_output(StringRef identifier, GMutablePointer value)
 
   OutputState &output_state = node_state_.outputs[socket->index()];
   BLI_assert(!output_state.has_been_computed);
+  if (this->cache_entry != nullptr &&
+      output_state.output_usage_for_execution != ValueUsage::Unused) {
+    this->cache_entry->values[socket->index()] = NodeOutputCache::copy_value(value);
+  }
   evaluator_.forward_output(socket, value, run_state_);
   output_state.has_been_computed = true;
 }
@@ -1945,6 +2459,9 @@ void NodeParamsProvider::set_default_remaining_outputs()
     BLI_assert(type != nullptr);
     void *buffer = allocator.allocate(type->size(), type->alignment());
     type->copy_construct(type->default_value(), buffer);
+    if (this->cache_entry != nullptr) {
+      this->cache_entry->values[i] = NodeOutputCache::copy_value({type, buffer});
+    }
     evaluator_.forward_output(socket, {type, buffer}, run_state_);
     output_state.has_been_computed = true;
   }
@@ -36,6 +36,8 @@ using namespace nodes::derived_node_tree_types;
 using fn::GMutablePointer;
 using fn::GPointer;
 
+class NodeOutputCache;
+
 struct GeometryNodesEvaluationParams {
   blender::LinearAllocator<> allocator;
 
@@ -52,6 +54,9 @@ struct GeometryNodesEvaluationParams {
   Depsgraph *depsgraph;
   Object *self_object;
   geo_log::GeoLogger *geo_logger;
+  /* Outputs of nodes whose inputs did not change since a previous evaluation are taken from here
+   * instead of executing the node again. May be null. */
+  NodeOutputCache *output_cache = nullptr;
 
   Vector<GMutablePointer> r_output_values;
 };
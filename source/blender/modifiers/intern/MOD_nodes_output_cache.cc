@@ -0,0 +1,363 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup modifiers
+ */
+
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "MOD_nodes_output_cache.hh"
+
+#include "BLI_float4x4.hh"
+#include "BLI_listbase.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "DNA_pointcloud_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_geometry_set.hh"
+
+namespace blender::modifiers::geometry_nodes {
+
+/* -------------------------------------------------------------------- */
+/** \name Hashing
+ * \{ */
+
+/** Finalizer of SplitMix64, every input bit affects every output bit. */
+static uint64_t mix_bits(uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebull;
+  x ^= x >> 31;
+  return x;
+}
+
+uint64_t cache_key_combine(const uint64_t a, const uint64_t b)
+{
+  return mix_bits(a ^ mix_bits(b + 0x9e3779b97f4a7c15ull));
+}
+
+uint64_t cache_key_hash_bytes(const void *data, const int64_t size, const uint64_t seed)
+{
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  uint64_t hash = seed ^ (uint64_t(size) * 0x9e3779b97f4a7c15ull);
+  /* Process eight bytes at once, this is fast enough to hash the attributes of large meshes. */
+  auto add_word = [&](const uint64_t word) {
+    hash ^= word * 0x87c37b91114253d5ull;
+    hash = ((hash << 31) | (hash >> 33)) * 0x4cf5ad432745937full;
+  };
+  int64_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    memcpy(&word, bytes + i, 8);
+    add_word(word);
+  }
+  if (i < size) {
+    uint64_t word = 0;
+    memcpy(&word, bytes + i, size_t(size - i));
+    add_word(word);
+  }
+  return mix_bits(hash);
+}
+
+uint64_t cache_key_hash_string(const StringRef str, const uint64_t seed)
+{
+  return cache_key_hash_bytes(str.data(), str.size(), seed);
+}
+
+static uint64_t hash_pointer(const void *ptr, const uint64_t seed)
+{
+  return cache_key_hash_bytes(&ptr, sizeof(ptr), seed);
+}
+
+static uint64_t hash_custom_data(const CustomData &data, const int size, uint64_t hash)
+{
+  for (const int i : IndexRange(data.totlayer)) {
+    const CustomDataLayer &layer = data.layers[i];
+    if (ELEM(layer.type, CD_MDISPS, CD_GRID_PAINT_MASK, CD_BM_ELEM_PYPTR)) {
+      /* These layers store pointers to data that is not hashed. */
+      return 0;
+    }
+    hash = cache_key_combine(hash, uint64_t(layer.type));
+    hash = cache_key_combine(hash, uint64_t(layer.flag));
+    hash = cache_key_combine(hash, uint64_t(layer.active));
+    hash = cache_key_hash_string(layer.name, hash);
+    hash = hash_pointer(layer.anonymous_id, hash);
+    if (layer.data == nullptr) {
+      continue;
+    }
+    if (layer.type == CD_MDEFORMVERT) {
+      /* Vertex group weights are stored in separate arrays for every vertex. */
+      const MDeformVert *dverts = static_cast<const MDeformVert *>(layer.data);
+      for (const int vert : IndexRange(size)) {
+        const MDeformVert &dvert = dverts[vert];
+        hash = cache_key_hash_bytes(dvert.dw, sizeof(MDeformWeight) * dvert.totweight, hash);
+      }
+      continue;
+    }
+    hash = cache_key_hash_bytes(layer.data, int64_t(CustomData_sizeof(layer.type)) * size, hash);
+  }
+  return hash;
+}
+
+static uint64_t hash_materials(const Material *const *materials,
+                               const int materials_num,
+                               uint64_t hash)
+{
+  /* Only the pointers are hashed, because nodes just pass them on. Hashing the pointers also
+   * guarantees that cached geometries never reference materials that don't exist anymore. */
+  for (const int i : IndexRange(materials_num)) {
+    hash = hash_pointer(materials[i], hash);
+  }
+  return hash;
+}
+
+static uint64_t hash_mesh(const Mesh &mesh)
+{
+  if (mesh.runtime.wrapper_type != ME_WRAPPER_TYPE_MDATA) {
+    return 0;
+  }
+  uint64_t hash = 4516724387;
+  hash = cache_key_combine(hash, uint64_t(mesh.totvert));
+  hash = cache_key_combine(hash, uint64_t(mesh.totedge));
+  hash = cache_key_combine(hash, uint64_t(mesh.totpoly));
+  hash = cache_key_combine(hash, uint64_t(mesh.totloop));
+  hash = cache_key_combine(hash, uint64_t(mesh.flag));
+  hash = cache_key_hash_bytes(&mesh.smoothresh, sizeof(mesh.smoothresh), hash);
+  hash = hash_materials(mesh.mat, mesh.totcol, hash);
+  LISTBASE_FOREACH (const bDeformGroup *, group, &mesh.vertex_group_names) {
+    hash = cache_key_hash_string(group->name, hash);
+  }
+  hash = hash_custom_data(mesh.vdata, mesh.totvert, hash);
+  hash = hash_custom_data(mesh.edata, mesh.totedge, hash);
+  hash = hash_custom_data(mesh.pdata, mesh.totpoly, hash);
+  hash = hash_custom_data(mesh.ldata, mesh.totloop, hash);
+  return hash;
+}
+
+static uint64_t hash_pointcloud(const PointCloud &pointcloud)
+{
+  uint64_t hash = 9813245673;
+  hash = cache_key_combine(hash, uint64_t(pointcloud.totpoint));
+  hash = hash_materials(pointcloud.mat, pointcloud.totcol, hash);
+  return hash_custom_data(pointcloud.pdata, pointcloud.totpoint, hash);
+}
+
+uint64_t cache_key_hash_geometry(const GeometrySet &geometry)
+{
+  /* Curves, instances and volumes are not hashed. They are rarely passed into the modifier and
+   * the latter two can reference data that is not owned by the geometry. */
+  if (geometry.has_curve() || geometry.has_instances() || geometry.has_volume()) {
+    return 0;
+  }
+  uint64_t hash = 2374698121;
+  if (const Mesh *mesh = geometry.get_mesh_for_read()) {
+    const uint64_t mesh_hash = hash_mesh(*mesh);
+    if (mesh_hash == 0) {
+      return 0;
+    }
+    hash = cache_key_combine(hash, mesh_hash);
+  }
+  if (const PointCloud *pointcloud = geometry.get_pointcloud_for_read()) {
+    const uint64_t pointcloud_hash = hash_pointcloud(*pointcloud);
+    if (pointcloud_hash == 0) {
+      return 0;
+    }
+    hash = cache_key_combine(hash, pointcloud_hash);
+  }
+  return hash;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Output Cache
+ * \{ */
+
+/** Limits the memory used by #NodeOutputCache::missed_keys_ when keys keep changing. */
+static constexpr int64_t max_missed_keys_num = 1 << 16;
+
+NodeOutputCache::NodeOutputCache(const int64_t max_size_in_bytes)
+    : max_size_in_bytes_(max_size_in_bytes)
+{
+}
+
+NodeOutputCache::~NodeOutputCache()
+{
+  this->clear();
+}
+
+bool NodeOutputCache::lookup(const uint64_t key, FunctionRef<bool(const Entry &entry)> fn)
+{
+  std::lock_guard lock{mutex_};
+  Entry *entry = entries_.lookup_ptr(key);
+  if (entry == nullptr) {
+    return false;
+  }
+  if (!fn(*entry)) {
+    return false;
+  }
+  entry->last_used = ++use_counter_;
+  return true;
+}
+
+bool NodeOutputCache::register_miss(const uint64_t key)
+{
+  std::lock_guard lock{mutex_};
+  if (missed_keys_.size() >= max_missed_keys_num) {
+    missed_keys_.clear();
+  }
+  return !missed_keys_.add(key);
+}
+
+void NodeOutputCache::add(const uint64_t key, Entry entry)
+{
+  std::lock_guard lock{mutex_};
+  if (entry.size_in_bytes > max_size_in_bytes_) {
+    this->free_entry(entry);
+    return;
+  }
+  if (Entry *old_entry = entries_.lookup_ptr(key)) {
+    size_in_bytes_ -= old_entry->size_in_bytes;
+    this->free_entry(*old_entry);
+    entries_.remove(key);
+  }
+  missed_keys_.remove(key);
+  while (size_in_bytes_ + entry.size_in_bytes > max_size_in_bytes_) {
+    this->remove_least_recently_used();
+  }
+  entry.last_used = ++use_counter_;
+  size_in_bytes_ += entry.size_in_bytes;
+  entries_.add_new(key, std::move(entry));
+}
+
+void NodeOutputCache::clear()
+{
+  std::lock_guard lock{mutex_};
+  for (Entry &entry : entries_.values()) {
+    this->free_entry(entry);
+  }
+  entries_.clear();
+  missed_keys_.clear();
+  size_in_bytes_ = 0;
+}
+
+int64_t NodeOutputCache::size_in_bytes() const
+{
+  std::lock_guard lock{mutex_};
+  return size_in_bytes_;
+}
+
+int64_t NodeOutputCache::entries_num() const
+{
+  std::lock_guard lock{mutex_};
+  return entries_.size();
+}
+
+void NodeOutputCache::free_entry(Entry &entry)
+{
+  for (GMutablePointer &value : entry.values) {
+    if (value.get() != nullptr) {
+      value.destruct();
+      MEM_freeN(value.get());
+    }
+  }
+  entry.values.clear();
+}
+
+void NodeOutputCache::remove_least_recently_used()
+{
+  BLI_assert(!entries_.is_empty());
+  uint64_t oldest_key = 0;
+  uint64_t oldest_use = UINT64_MAX;
+  for (auto item : entries_.items()) {
+    if (item.value.last_used < oldest_use) {
+      oldest_use = item.value.last_used;
+      oldest_key = item.key;
+    }
+  }
+  Entry &entry = entries_.lookup(oldest_key);
+  size_in_bytes_ -= entry.size_in_bytes;
+  this->free_entry(entry);
+  entries_.remove(oldest_key);
+}
+
+GMutablePointer NodeOutputCache::copy_value(const GPointer value)
+{
+  const CPPType &type = *value.type();
+  void *buffer = MEM_mallocN_aligned(type.size(), type.alignment(), __func__);
+  type.copy_construct(value.get(), buffer);
+  if (type.is<GeometrySet>()) {
+    static_cast<GeometrySet *>(buffer)->ensure_owns_direct_data();
+  }
+  return {type, buffer};
+}
+
+static int64_t custom_data_size(const CustomData &data, const int size)
+{
+  int64_t size_in_bytes = 0;
+  for (const int i : IndexRange(data.totlayer)) {
+    size_in_bytes += int64_t(CustomData_sizeof(data.layers[i].type)) * size;
+  }
+  return size_in_bytes;
+}
+
+int64_t NodeOutputCache::estimate_value_size(const GPointer value)
+{
+  const CPPType &type = *value.type();
+  if (!type.is<GeometrySet>()) {
+    return type.size();
+  }
+  const GeometrySet &geometry = *value.get<GeometrySet>();
+  int64_t size_in_bytes = sizeof(GeometrySet);
+  if (const Mesh *mesh = geometry.get_mesh_for_read()) {
+    size_in_bytes += custom_data_size(mesh->vdata, mesh->totvert);
+    size_in_bytes += custom_data_size(mesh->edata, mesh->totedge);
+    size_in_bytes += custom_data_size(mesh->pdata, mesh->totpoly);
+    size_in_bytes += custom_data_size(mesh->ldata, mesh->totloop);
+  }
+  if (const PointCloud *pointcloud = geometry.get_pointcloud_for_read()) {
+    size_in_bytes += custom_data_size(pointcloud->pdata, pointcloud->totpoint);
+  }
+  if (const CurveComponent *component = geometry.get_component_for_read<CurveComponent>()) {
+    component->attribute_foreach(
+        [&](const bke::AttributeIDRef &UNUSED(attribute_id), const AttributeMetaData &meta_data) {
+          size_in_bytes += int64_t(component->attribute_domain_size(meta_data.domain)) *
+                           CustomData_sizeof(meta_data.data_type);
+          return true;
+        });
+  }
+  if (const InstancesComponent *component =
+          geometry.get_component_for_read<InstancesComponent>()) {
+    size_in_bytes += int64_t(component->instances_amount()) * (sizeof(float4x4) + sizeof(int));
+  }
+  if (geometry.has_volume()) {
+    /* The memory used by the grids is not known, assume that volumes are large. */
+    size_in_bytes += 64 * 1024 * 1024;
+  }
+  return size_in_bytes;
+}
+
+/** \} */
+
+}  // namespace blender::modifiers::geometry_nodes
@@ -0,0 +1,141 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup modifiers
+ *
+ * Cache for the outputs of geometry nodes that is kept alive between evaluations of the same
+ * modifier. Every cacheable node gets a key that is a hash of everything its outputs depend on:
+ * the node itself, the values of unlinked inputs and the keys of the nodes that are linked to it.
+ * When the key of a node did not change since a previous evaluation, its outputs are taken from
+ * the cache and the node (and everything it depends on) does not have to run again.
+ */
+
+#include <mutex>
+
+#include "BLI_function_ref.hh"
+#include "BLI_map.hh"
+#include "BLI_set.hh"
+#include "BLI_string_ref.hh"
+#include "BLI_utility_mixins.hh"
+#include "BLI_vector.hh"
+
+#include "FN_generic_pointer.hh"
+
+#include "NOD_geometry_nodes_eval_log.hh"
+
+struct GeometrySet;
+
+namespace blender::modifiers::geometry_nodes {
+
+using fn::CPPType;
+using fn::GMutablePointer;
+using fn::GPointer;
+
+/**
+ * Combine two hashes in a way that depends on their order. This is used to build cache keys from
+ * many smaller hashes, so it mixes the bits more thoroughly than #get_default_hash_2.
+ */
+uint64_t cache_key_combine(uint64_t a, uint64_t b);
+
+/** Hash arbitrary memory. */
+uint64_t cache_key_hash_bytes(const void *data, int64_t size, uint64_t seed);
+uint64_t cache_key_hash_string(StringRef str, uint64_t seed);
+
+/**
+ * Hash the contents of a geometry. Zero is returned when the geometry contains data that can't be
+ * hashed reliably (e.g. instances that reference objects or volume grids).
+ */
+uint64_t cache_key_hash_geometry(const GeometrySet &geometry);
+
+class NodeOutputCache : NonCopyable, NonMovable {
+ public:
+  struct Entry {
+    /**
+     * Owned copies of the output values of the node, indexed by the output socket index. Outputs
+     * that were not computed when the entry was created are null.
+     */
+    Vector<GMutablePointer> values;
+    /** Warnings that were created when the node was executed, so that they can be shown again. */
+    Vector<nodes::geometry_nodes_eval_log::NodeWarning> warnings;
+    /** False when the entry was created without a logger, so that the warnings are unknown. */
+    bool has_warnings = false;
+    /** Approximate memory used by the values, to stay within the memory budget. */
+    int64_t size_in_bytes = 0;
+    /** Value of #NodeOutputCache::use_counter_ when the entry was used the last time. */
+    uint64_t last_used = 0;
+  };
+
+ private:
+  mutable std::mutex mutex_;
+  Map<uint64_t, Entry> entries_;
+  /**
+   * Keys that have been looked up without finding an entry. Outputs are only added once their key
+   * has been missed before. This avoids copying the outputs of nodes whose inputs change with
+   * every evaluation (e.g. because they depend on an animated value), which would never be used.
+   */
+  Set<uint64_t> missed_keys_;
+  int64_t size_in_bytes_ = 0;
+  int64_t max_size_in_bytes_;
+  uint64_t use_counter_ = 0;
+
+ public:
+  /** Default for the memory that the output cache of a single modifier may use. */
+  static constexpr int64_t default_max_size_in_bytes = 256ll * 1024 * 1024;
+
+  NodeOutputCache(int64_t max_size_in_bytes = default_max_size_in_bytes);
+  ~NodeOutputCache();
+
+  /**
+   * Call the function with the entry that belongs to the key while the cache is locked.
+   * \return True when an entry was found and the function returned true.
+   */
+  bool lookup(uint64_t key, FunctionRef<bool(const Entry &entry)> fn);
+
+  /**
+   * Remember that no usable entry was found for the key.
+   * \return True when that happened before, in which case the outputs should be added.
+   */
+  bool register_miss(uint64_t key);
+
+  /**
+   * Take ownership of the entry. Least recently used entries are removed when the cache becomes
+   * too large. An entry that is larger than the entire budget is not added at all.
+   */
+  void add(uint64_t key, Entry entry);
+
+  void clear();
+
+  int64_t size_in_bytes() const;
+  int64_t entries_num() const;
+
+  /**
+   * Create an owned copy of the value that is independent of the evaluation it comes from.
+   * Geometries are made to own their data, because they might reference data owned by the
+   * modifier stack.
+   */
+  static GMutablePointer copy_value(GPointer value);
+  static int64_t estimate_value_size(GPointer value);
+  /** Destruct and free the values of an entry, e.g. when it is not added after all. */
+  static void free_entry(Entry &entry);
+
+ private:
+  void remove_least_recently_used();
+};
+
+}  // namespace blender::modifiers::geometry_nodes
@@ -0,0 +1,150 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <optional>
+
+#include "MOD_nodes_output_cache.hh"
+
+#include "BKE_geometry_set.hh"
+#include "BKE_idtype.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+
+namespace blender::modifiers::geometry_nodes::tests {
+
+static NodeOutputCache::Entry int_entry(const int value, const int64_t size_in_bytes = 4)
+{
+  NodeOutputCache::Entry entry;
+  entry.values.append(NodeOutputCache::copy_value({CPPType::get<int>(), &value}));
+  entry.size_in_bytes = size_in_bytes;
+  return entry;
+}
+
+static std::optional<int> lookup_int(NodeOutputCache &cache, const uint64_t key)
+{
+  std::optional<int> value;
+  cache.lookup(key, [&](const NodeOutputCache::Entry &entry) {
+    value = *entry.values[0].get<int>();
+    return true;
+  });
+  return value;
+}
+
+TEST(node_output_cache, AddAfterSecondMiss)
+{
+  NodeOutputCache cache;
+  EXPECT_FALSE(lookup_int(cache, 1).has_value());
+  EXPECT_FALSE(cache.register_miss(1));
+  EXPECT_TRUE(cache.register_miss(1));
+  EXPECT_FALSE(cache.register_miss(2));
+
+  cache.add(1, int_entry(42));
+  EXPECT_EQ(lookup_int(cache, 1), 42);
+  EXPECT_FALSE(lookup_int(cache, 2).has_value());
+  EXPECT_EQ(cache.entries_num(), 1);
+  EXPECT_EQ(cache.size_in_bytes(), 4);
+
+  /* A key that is missed again after its entry has been added starts over. */
+  EXPECT_FALSE(cache.register_miss(1));
+}
+
+TEST(node_output_cache, RejectedEntryIsMiss)
+{
+  NodeOutputCache cache;
+  cache.add(1, int_entry(42));
+  EXPECT_FALSE(cache.lookup(1, [](const NodeOutputCache::Entry & /*entry*/) { return false; }));
+  EXPECT_TRUE(cache.lookup(1, [](const NodeOutputCache::Entry & /*entry*/) { return true; }));
+}
+
+TEST(node_output_cache, ReplaceEntry)
+{
+  NodeOutputCache cache;
+  cache.add(1, int_entry(1, 100));
+  cache.add(1, int_entry(2, 50));
+  EXPECT_EQ(lookup_int(cache, 1), 2);
+  EXPECT_EQ(cache.entries_num(), 1);
+  EXPECT_EQ(cache.size_in_bytes(), 50);
+}
+
+TEST(node_output_cache, RemoveLeastRecentlyUsed)
+{
+  NodeOutputCache cache(300);
+  cache.add(1, int_entry(1, 100));
+  cache.add(2, int_entry(2, 100));
+  cache.add(3, int_entry(3, 100));
+  /* Using the first entry makes the second one the least recently used. */
+  EXPECT_EQ(lookup_int(cache, 1), 1);
+  cache.add(4, int_entry(4, 100));
+
+  EXPECT_EQ(lookup_int(cache, 1), 1);
+  EXPECT_FALSE(lookup_int(cache, 2).has_value());
+  EXPECT_EQ(lookup_int(cache, 3), 3);
+  EXPECT_EQ(lookup_int(cache, 4), 4);
+  EXPECT_EQ(cache.size_in_bytes(), 300);
+
+  /* Entries that don't fit into the budget at all are not added. */
+  cache.add(5, int_entry(5, 301));
+  EXPECT_FALSE(lookup_int(cache, 5).has_value());
+  EXPECT_EQ(cache.entries_num(), 3);
+
+  cache.clear();
+  EXPECT_EQ(cache.entries_num(), 0);
+  EXPECT_EQ(cache.size_in_bytes(), 0);
+}
+
+TEST(node_output_cache, GeometryKeyChangesWithData)
+{
+  BKE_idtype_init();
+  GeometrySet geometry = GeometrySet::create_with_mesh(BKE_mesh_new_nomain(4, 0, 0, 0, 0));
+  const uint64_t key = cache_key_hash_geometry(geometry);
+  EXPECT_NE(key, 0);
+
+  GeometrySet geometry_copy = geometry;
+  EXPECT_EQ(cache_key_hash_geometry(geometry_copy), key);
+  {
+    MeshComponent &component = geometry_copy.get_component_for_write<MeshComponent>();
+    bke::OutputAttribute_Typed<float3> positions =
+        component.attribute_try_get_for_output<float3>("position", ATTR_DOMAIN_POINT, {0, 0, 0});
+    positions.as_span()[2].x += 1.0f;
+    positions.save();
+  }
+  /* The outputs that were cached for the old geometry must not be found anymore. */
+  EXPECT_NE(cache_key_hash_geometry(geometry_copy), key);
+  EXPECT_EQ(cache_key_hash_geometry(geometry), key);
+
+  GeometrySet geometry_attribute = geometry;
+  {
+    MeshComponent &component = geometry_attribute.get_component_for_write<MeshComponent>();
+    bke::OutputAttribute_Typed<float> attribute =
+        component.attribute_try_get_for_output<float>("weight", ATTR_DOMAIN_POINT, 0.0f);
+    attribute.save();
+  }
+  EXPECT_NE(cache_key_hash_geometry(geometry_attribute), key);
+}
+
+TEST(node_output_cache, CachedGeometryIsIndependent)
+{
+  BKE_idtype_init();
+  GeometrySet geometry = GeometrySet::create_with_mesh(BKE_mesh_new_nomain(4, 0, 0, 0, 0));
+  const uint64_t key = cache_key_hash_geometry(geometry);
+
+  NodeOutputCache cache;
+  NodeOutputCache::Entry entry;
+  entry.values.append(NodeOutputCache::copy_value({CPPType::get<GeometrySet>(), &geometry}));
+  entry.size_in_bytes = NodeOutputCache::estimate_value_size(entry.values[0]);
+  EXPECT_GT(entry.size_in_bytes, 4 * sizeof(float3));
+  cache.add(key, std::move(entry));
+
+  /* Changing or freeing the evaluated geometry does not affect the cached copy. */
+  geometry.clear();
+  EXPECT_TRUE(cache.lookup(key, [&](const NodeOutputCache::Entry &entry) {
+    const GeometrySet &cached_geometry = *entry.values[0].get<GeometrySet>();
+    EXPECT_EQ(cached_geometry.get_mesh_for_read()->totvert, 4);
+    EXPECT_EQ(cache_key_hash_geometry(cached_geometry), key);
+    return true;
+  }));
+}
+
+}  // namespace blender::modifiers::geometry_nodes::tests
@@ -221,6 +221,12 @@ class LocalGeoLogger {
    * This should only be used for debugging purposes and not to display information to users.
    */
   void log_debug_message(DNode node, std::string message);
+
+  /** Warnings that have been logged on this thread so far, in the order they were added. */
+  Span<NodeWithWarning> node_warnings() const
+  {
+    return node_warnings_;
+  }
 };
 
 /** The root logger class. */
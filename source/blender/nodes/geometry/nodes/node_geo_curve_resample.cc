@@ -75,7 +75,9 @@ struct SampleModeParam {
   Field<bool> selection;
 };
 
-static SplinePtr resample_spline(const Spline &src, const int count)
+static SplinePtr resample_spline(const Spline &src,
+                                 Span<float3> evaluated_positions,
+                                 const int count)
 {
   std::unique_ptr<PolySpline> dst = std::make_unique<PolySpline>();
   Spline::copy_base_settings(src, *dst);
@@ -108,8 +110,7 @@ static SplinePtr resample_spline(const Spline &src, const int count)
 
   Array<float> uniform_samples = src.sample_uniform_index_factors(count);
 
-  src.sample_with_index_factors<float3>(
-      src.evaluated_positions(), uniform_samples, dst->positions());
+  src.sample_with_index_factors<float3>(evaluated_positions, uniform_samples, dst->positions());
 
   src.sample_with_index_factors<float>(
       src.interpolate_to_evaluated(src.radii()), uniform_samples, dst->radii());
@@ -139,14 +140,13 @@ static SplinePtr resample_spline(const Spline &src, const int count)
   return dst;
 }
 
-static SplinePtr resample_spline_evaluated(const Spline &src)
+static SplinePtr resample_spline_evaluated(const Spline &src, Span<float3> evaluated_positions)
 {
   std::unique_ptr<PolySpline> dst = std::make_unique<PolySpline>();
   Spline::copy_base_settings(src, *dst);
   dst->resize(src.evaluated_points_size());
 
-  dst->positions().copy_from(src.evaluated_positions());
-  dst->positions().copy_from(src.evaluated_positions());
+  dst->positions().copy_from(evaluated_positions);
   src.interpolate_to_evaluated(src.radii()).materialize(dst->radii());
   src.interpolate_to_evaluated(src.tilts()).materialize(dst->tilts());
 
@@ -177,6 +177,11 @@ static std::unique_ptr<CurveEval> resample_curve(const CurveComponent *component
   const int domain_size = component->attribute_domain_size(ATTR_DOMAIN_CURVE);
 
   Span<SplinePtr> input_splines = input_curve->splines();
+  const CurveEval::EvaluatedData &evaluated_data = input_curve->evaluated_data(
+      CurveEval::EvaluatedFields::Positions);
+  const auto evaluated_positions = [&](const int spline_index) {
+    return evaluated_data.positions.as_span().slice(evaluated_data.range(spline_index));
+  };
 
   std::unique_ptr<CurveEval> output_curve = std::make_unique<CurveEval>();
   output_curve->resize(input_splines.size());
@@ -194,7 +199,8 @@ static std::unique_ptr<CurveEval> resample_curve(const CurveComponent *component
       for (const int i : range) {
         BLI_assert(mode_param.count);
         if (selections[i] && input_splines[i]->evaluated_points_size() > 0) {
-          output_splines[i] = resample_spline(*input_splines[i], std::max(cuts[i], 1));
+          output_splines[i] = resample_spline(
+              *input_splines[i], evaluated_positions(i), std::max(cuts[i], 1));
         }
         else {
           output_splines[i] = input_splines[i]->copy();
@@ -217,7 +223,7 @@ static std::unique_ptr<CurveEval> resample_curve(const CurveComponent *component
           const float divide_length = std::max(lengths[i], 0.0001f);
           const float spline_length = input_splines[i]->length();
           const int count = std::max(int(spline_length / divide_length) + 1, 1);
-          output_splines[i] = resample_spline(*input_splines[i], count);
+          output_splines[i] = resample_spline(*input_splines[i], evaluated_positions(i), count);
         }
         else {
           output_splines[i] = input_splines[i]->copy();
@@ -234,7 +240,8 @@ static std::unique_ptr<CurveEval> resample_curve(const CurveComponent *component
     threading::parallel_for(input_splines.index_range(), 128, [&](IndexRange range) {
       for (const int i : range) {
         if (selections[i] && input_splines[i]->evaluated_points_size() > 0) {
-          output_splines[i] = resample_spline_evaluated(*input_splines[i]);
+          output_splines[i] = resample_spline_evaluated(*input_splines[i],
+                                                        evaluated_positions(i));
         }
         else {
           output_splines[i] = input_splines[i]->copy();
@@ -230,6 +230,7 @@ static void trim_poly_spline(Spline &spline,
  * Trim NURB splines by converting to a poly spline.
  */
 static PolySpline trim_nurbs_spline(const Spline &spline,
+                                    Span<float3> evaluated_positions,
                                     const Spline::LookupResult &start_lookup,
                                     const Spline::LookupResult &end_lookup)
 {
@@ -267,8 +268,7 @@ static PolySpline trim_nurbs_spline(const Spline &spline,
       },
       ATTR_DOMAIN_POINT);
 
-  linear_trim_to_output_data<float3>(
-      start, end, spline.evaluated_positions(), new_spline.positions());
+  linear_trim_to_output_data<float3>(start, end, evaluated_positions, new_spline.positions());
 
   VArray<float> evaluated_radii = spline.interpolate_to_evaluated(spline.radii());
   linear_trim_to_output_data<float>(
@@ -376,7 +376,12 @@ static void trim_bezier_spline(Spline &spline,
   bezier_spline.resize(size);
 }
 
+/**
+ * \param evaluated_positions: The evaluated positions of the spline before trimming,
+ * from #CurveEval::evaluated_data.
+ */
 static void trim_spline(SplinePtr &spline,
+                        Span<float3> evaluated_positions,
                         const Spline::LookupResult start,
                         const Spline::LookupResult end)
 {
@@ -388,7 +393,8 @@ static void trim_spline(SplinePtr &spline,
       trim_poly_spline(*spline, start, end);
       break;
     case Spline::Type::NURBS:
-      spline = std::make_unique<PolySpline>(trim_nurbs_spline(*spline, start, end));
+      spline = std::make_unique<PolySpline>(
+          trim_nurbs_spline(*spline, evaluated_positions, start, end));
       break;
   }
   spline->mark_cache_invalid();
@@ -454,7 +460,9 @@ static void to_single_point_poly(Spline &spline, const Spline::LookupResult &loo
   spline.resize(1);
 }
 
-static PolySpline to_single_point_nurbs(const Spline &spline, const Spline::LookupResult &lookup)
+static PolySpline to_single_point_nurbs(const Spline &spline,
+                                        Span<float3> evaluated_positions,
+                                        const Spline::LookupResult &lookup)
 {
   /* Since this outputs a poly spline, the evaluated indices are the control point indices. */
   const TrimLocation trim{lookup.evaluated_index, lookup.next_evaluated_index, lookup.factor};
@@ -477,7 +485,7 @@ static PolySpline to_single_point_nurbs(const Spline &spline, const Spline::Look
       },
       ATTR_DOMAIN_POINT);
 
-  to_single_point_data<float3>(trim, spline.evaluated_positions(), new_spline.positions());
+  to_single_point_data<float3>(trim, evaluated_positions, new_spline.positions());
 
   VArray<float> evaluated_radii = spline.interpolate_to_evaluated(spline.radii());
   to_single_point_data<float>(trim, evaluated_radii.get_internal_span(), new_spline.radii());
@@ -488,7 +496,9 @@ static PolySpline to_single_point_nurbs(const Spline &spline, const Spline::Look
   return new_spline;
 }
 
-static void to_single_point_spline(SplinePtr &spline, const Spline::LookupResult &lookup)
+static void to_single_point_spline(SplinePtr &spline,
+                                   Span<float3> evaluated_positions,
+                                   const Spline::LookupResult &lookup)
 {
   switch (spline->type()) {
     case Spline::Type::Bezier:
@@ -498,7 +508,8 @@ static void to_single_point_spline(SplinePtr &spline, const Spline::LookupResult
       to_single_point_poly(*spline, lookup);
       break;
     case Spline::Type::NURBS:
-      spline = std::make_unique<PolySpline>(to_single_point_nurbs(*spline, lookup));
+      spline = std::make_unique<PolySpline>(
+          to_single_point_nurbs(*spline, evaluated_positions, lookup));
       break;
   }
 }
@@ -526,9 +537,16 @@ static void geometry_set_curve_trim(GeometrySet &geometry_set,
   CurveEval &curve = *geometry_set.get_curve_for_write();
   MutableSpan<SplinePtr> splines = curve.splines();
 
+  /* Retrieve the evaluated data before any spline is changed, so that it is calculated in
+   * parallel for all splines at once. Changing splines below doesn't affect the arrays. */
+  const CurveEval::EvaluatedData &evaluated_data = curve.evaluated_data(
+      CurveEval::EvaluatedFields::Positions);
+
   threading::parallel_for(splines.index_range(), 128, [&](IndexRange range) {
     for (const int i : range) {
       SplinePtr &spline = splines[i];
+      const Span<float3> evaluated_positions = evaluated_data.positions.as_span().slice(
+          evaluated_data.range(i));
 
       /* Currently trimming cyclic splines is not supported. It could be in the future though. */
       if (spline->is_cyclic()) {
@@ -552,10 +570,12 @@ static void geometry_set_curve_trim(GeometrySet &geometry_set,
       if (end <= start) {
         if (mode == GEO_NODE_CURVE_SAMPLE_LENGTH) {
           to_single_point_spline(spline,
+                                 evaluated_positions,
                                  spline->lookup_evaluated_length(std::clamp(start, 0.0f, length)));
         }
         else {
           to_single_point_spline(spline,
+                                 evaluated_positions,
                                  spline->lookup_evaluated_factor(std::clamp(start, 0.0f, 1.0f)));
         }
         continue;
@@ -563,11 +583,13 @@ static void geometry_set_curve_trim(GeometrySet &geometry_set,
 
       if (mode == GEO_NODE_CURVE_SAMPLE_LENGTH) {
         trim_spline(spline,
+                    evaluated_positions,
                     spline->lookup_evaluated_length(std::clamp(start, 0.0f, length)),
                     spline->lookup_evaluated_length(std::clamp(end, 0.0f, length)));
       }
       else {
         trim_spline(spline,
+                    evaluated_positions,
                     spline->lookup_evaluated_factor(std::clamp(start, 0.0f, 1.0f)),
                     spline->lookup_evaluated_factor(std::clamp(end, 0.0f, 1.0f)));
       }
@@ -53,6 +53,51 @@ static void geo_proximity_init(bNodeTree *UNUSED(ntree), bNode *node)
   node->storage = node_storage;
 }
 
+/**
+ * Find the nearest element in the tree for every position in the mask. The results are only
+ * written when they are closer than the existing values in #r_distances.
+ */
+static void find_nearest_in_tree(BVHTree *tree,
+                                 BVHTree_NearestPointCallback callback,
+                                 void *userdata,
+                                 const VArray<float3> &positions,
+                                 const IndexMask mask,
+                                 const MutableSpan<float> r_distances,
+                                 const MutableSpan<float3> r_locations)
+{
+  threading::parallel_for(mask.index_range(), 2048, [&](IndexRange range) {
+    const IndexMask chunk_mask = mask.slice(range);
+    Array<float3> chunk_positions(range.size());
+    Array<BVHTreeNearest> nearest(range.size());
+    for (const int i : IndexRange(range.size())) {
+      const int index = chunk_mask[i];
+      chunk_positions[i] = positions[index];
+      nearest[i].index = -1;
+      /* Only look for elements that are closer than what was found before, e.g. the closest point
+       * in the mesh when looking up the point cloud afterwards. */
+      nearest[i].dist_sq = r_distances[index];
+    }
+
+    BLI_bvhtree_find_nearest_batch(tree,
+                                   reinterpret_cast<const float(*)[3]>(chunk_positions.data()),
+                                   range.size(),
+                                   nearest.data(),
+                                   callback,
+                                   userdata,
+                                   0);
+
+    for (const int i : IndexRange(range.size())) {
+      const int index = chunk_mask[i];
+      if (nearest[i].index != -1 && nearest[i].dist_sq < r_distances[index]) {
+        r_distances[index] = nearest[i].dist_sq;
+        if (!r_locations.is_empty()) {
+          r_locations[index] = nearest[i].co;
+        }
+      }
+    }
+  });
+}
+
 static bool calculate_mesh_proximity(const VArray<float3> &positions,
                                      const IndexMask mask,
                                      const Mesh &mesh,
@@ -77,27 +122,13 @@ static bool calculate_mesh_proximity(const VArray<float3> &positions,
     return false;
   }
 
-  threading::parallel_for(mask.index_range(), 512, [&](IndexRange range) {
-    BVHTreeNearest nearest;
-    copy_v3_fl(nearest.co, FLT_MAX);
-    nearest.index = -1;
-
-    for (int i : range) {
-      const int index = mask[i];
-      /* Use the distance to the last found point as upper bound to speedup the bvh lookup. */
-      nearest.dist_sq = math::distance_squared(float3(nearest.co), positions[index]);
-
-      BLI_bvhtree_find_nearest(
-          bvh_data.tree, positions[index], &nearest, bvh_data.nearest_callback, &bvh_data);
-
-      if (nearest.dist_sq < r_distances[index]) {
-        r_distances[index] = nearest.dist_sq;
-        if (!r_locations.is_empty()) {
-          r_locations[index] = nearest.co;
-        }
-      }
-    }
-  });
+  find_nearest_in_tree(bvh_data.tree,
+                       bvh_data.nearest_callback,
+                       &bvh_data,
+                       positions,
+                       mask,
+                       r_distances,
+                       r_locations);
 
   free_bvhtree_from_mesh(&bvh_data);
   return true;
@@ -115,29 +146,13 @@ static bool calculate_pointcloud_proximity(const VArray<float3> &positions,
     return false;
   }
 
-  threading::parallel_for(mask.index_range(), 512, [&](IndexRange range) {
-    BVHTreeNearest nearest;
-    copy_v3_fl(nearest.co, FLT_MAX);
-    nearest.index = -1;
-
-    for (int i : range) {
-      const int index = mask[i];
-      /* Use the distance to the closest point in the mesh to speedup the pointcloud bvh lookup.
-       * This is ok because we only need to find the closest point in the pointcloud if it's
-       * closer than the mesh. */
-      nearest.dist_sq = r_distances[index];
-
-      BLI_bvhtree_find_nearest(
-          bvh_data.tree, positions[index], &nearest, bvh_data.nearest_callback, &bvh_data);
-
-      if (nearest.dist_sq < r_distances[index]) {
-        r_distances[index] = nearest.dist_sq;
-        if (!r_locations.is_empty()) {
-          r_locations[index] = nearest.co;
-        }
-      }
-    }
-  });
+  find_nearest_in_tree(bvh_data.tree,
+                       bvh_data.nearest_callback,
+                       &bvh_data,
+                       positions,
+                       mask,
+                       r_distances,
+                       r_locations);
 
   free_bvhtree_from_pointcloud(&bvh_data);
   return true;
@@ -14,6 +14,8 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <atomic>
+
 #include "DNA_mesh_types.h"
 
 #include "BKE_attribute_math.hh"
@@ -160,57 +162,75 @@ static void raycast_to_mesh(IndexMask mask,
     return;
   }
 
-  for (const int i : mask) {
-    const float ray_length = ray_lengths[i];
-    const float3 ray_origin = ray_origins[i];
-    const float3 ray_direction = math::normalize(ray_directions[i]);
-
-    BVHTreeRayHit hit;
-    hit.index = -1;
-    hit.dist = ray_length;
-    if (BLI_bvhtree_ray_cast(tree_data.tree,
-                             ray_origin,
-                             ray_direction,
-                             0.0f,
-                             &hit,
-                             tree_data.raycast_callback,
-                             &tree_data) != -1) {
-      hit_count++;
-      if (!r_hit.is_empty()) {
-        r_hit[i] = hit.index >= 0;
-      }
-      if (!r_hit_indices.is_empty()) {
-        /* The caller must be able to handle invalid indices anyway, so don't clamp this value. */
-        r_hit_indices[i] = hit.index;
-      }
-      if (!r_hit_positions.is_empty()) {
-        r_hit_positions[i] = hit.co;
-      }
-      if (!r_hit_normals.is_empty()) {
-        r_hit_normals[i] = hit.no;
-      }
-      if (!r_hit_distances.is_empty()) {
-        r_hit_distances[i] = hit.dist;
-      }
+  /* Cast the rays in chunks, so that the tree can process nearby rays together. */
+  std::atomic<int> total_hit_count = 0;
+  threading::parallel_for(mask.index_range(), 4096, [&](const IndexRange range) {
+    const IndexMask chunk_mask = mask.slice(range);
+    Array<float3> origins(range.size());
+    Array<float3> directions(range.size());
+    Array<BVHTreeRayHit> hits(range.size());
+    for (const int i : IndexRange(range.size())) {
+      const int index = chunk_mask[i];
+      origins[i] = ray_origins[index];
+      directions[i] = math::normalize(ray_directions[index]);
+      hits[i].index = -1;
+      hits[i].dist = ray_lengths[index];
     }
-    else {
-      if (!r_hit.is_empty()) {
-        r_hit[i] = false;
-      }
-      if (!r_hit_indices.is_empty()) {
-        r_hit_indices[i] = -1;
-      }
-      if (!r_hit_positions.is_empty()) {
-        r_hit_positions[i] = float3(0.0f, 0.0f, 0.0f);
-      }
-      if (!r_hit_normals.is_empty()) {
-        r_hit_normals[i] = float3(0.0f, 0.0f, 0.0f);
+
+    BLI_bvhtree_ray_cast_batch(tree_data.tree,
+                               reinterpret_cast<const float(*)[3]>(origins.data()),
+                               reinterpret_cast<const float(*)[3]>(directions.data()),
+                               range.size(),
+                               0.0f,
+                               hits.data(),
+                               tree_data.raycast_callback,
+                               &tree_data,
+                               BVH_RAYCAST_DEFAULT);
+
+    int chunk_hit_count = 0;
+    for (const int i : IndexRange(range.size())) {
+      const int index = chunk_mask[i];
+      const BVHTreeRayHit &hit = hits[i];
+      if (hit.index != -1) {
+        chunk_hit_count++;
+        if (!r_hit.is_empty()) {
+          r_hit[index] = hit.index >= 0;
+        }
+        if (!r_hit_indices.is_empty()) {
+          /* The caller must be able to handle invalid indices anyway, so don't clamp this value. */
+          r_hit_indices[index] = hit.index;
+        }
+        if (!r_hit_positions.is_empty()) {
+          r_hit_positions[index] = hit.co;
+        }
+        if (!r_hit_normals.is_empty()) {
+          r_hit_normals[index] = hit.no;
+        }
+        if (!r_hit_distances.is_empty()) {
+          r_hit_distances[index] = hit.dist;
+        }
       }
-      if (!r_hit_distances.is_empty()) {
-        r_hit_distances[i] = ray_length;
+      else {
+        if (!r_hit.is_empty()) {
+          r_hit[index] = false;
+        }
+        if (!r_hit_indices.is_empty()) {
+          r_hit_indices[index] = -1;
+        }
+        if (!r_hit_positions.is_empty()) {
+          r_hit_positions[index] = float3(0.0f, 0.0f, 0.0f);
+        }
+        if (!r_hit_normals.is_empty()) {
+          r_hit_normals[index] = float3(0.0f, 0.0f, 0.0f);
+        }
+        if (!r_hit_distances.is_empty()) {
+          r_hit_distances[index] = ray_lengths[index];
+        }
       }
     }
-  }
+    total_hit_count += chunk_hit_count;
+  });
+  hit_count += total_hit_count;
 
   /* We shouldn't be rebuilding the BVH tree when calling this function in parallel. */
   BLI_assert(tree_data.cached);
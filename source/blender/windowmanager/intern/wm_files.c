@@ -781,7 +781,10 @@ static void wm_file_read_post(bContext *C, const struct wmFileReadPost_Params *p
 static void file_read_reports_finalize(BlendFileReadReport *bf_reports)
 {
   double duration_whole_minutes, duration_whole_seconds;
+  double duration_read_data_minutes, duration_read_data_seconds;
   double duration_libraries_minutes, duration_libraries_seconds;
+  double duration_read_libraries_minutes, duration_read_libraries_seconds;
+  double duration_lib_link_minutes, duration_lib_link_seconds;
   double duration_lib_override_minutes, duration_lib_override_seconds;
   double duration_lib_override_resync_minutes, duration_lib_override_resync_seconds;
   double duration_lib_override_recursive_resync_minutes,
@@ -793,12 +796,30 @@ static void file_read_reports_finalize(BlendFileReadReport *bf_reports)
                                   &duration_whole_minutes,
                                   &duration_whole_seconds,
                                   NULL);
+  BLI_math_time_seconds_decompose(bf_reports->duration.read_data,
+                                  NULL,
+                                  NULL,
+                                  &duration_read_data_minutes,
+                                  &duration_read_data_seconds,
+                                  NULL);
   BLI_math_time_seconds_decompose(bf_reports->duration.libraries,
                                   NULL,
                                   NULL,
                                   &duration_libraries_minutes,
                                   &duration_libraries_seconds,
                                   NULL);
+  BLI_math_time_seconds_decompose(bf_reports->duration.read_libraries,
+                                  NULL,
+                                  NULL,
+                                  &duration_read_libraries_minutes,
+                                  &duration_read_libraries_seconds,
+                                  NULL);
+  BLI_math_time_seconds_decompose(bf_reports->duration.lib_link,
+                                  NULL,
+                                  NULL,
+                                  &duration_lib_link_minutes,
+                                  &duration_lib_link_seconds,
+                                  NULL);
   BLI_math_time_seconds_decompose(bf_reports->duration.lib_overrides,
                                   NULL,
                                   NULL,
@@ -820,11 +841,26 @@ static void file_read_reports_finalize(BlendFileReadReport *bf_reports)
 
   CLOG_INFO(
       &LOG, 0, "Blender file read in %.0fm%.2fs", duration_whole_minutes, duration_whole_seconds);
+  CLOG_INFO(&LOG,
+            0,
+            " * Reading data: %.0fm%.2fs",
+            duration_read_data_minutes,
+            duration_read_data_seconds);
   CLOG_INFO(&LOG,
             0,
             " * Loading libraries: %.0fm%.2fs",
             duration_libraries_minutes,
             duration_libraries_seconds);
+  CLOG_INFO(&LOG,
+            0,
+            "   - Reading libraries: %.0fm%.2fs",
+            duration_read_libraries_minutes,
+            duration_read_libraries_seconds);
+  CLOG_INFO(&LOG,
+            0,
+            "   - Linking data: %.0fm%.2fs",
+            duration_lib_link_minutes,
+            duration_lib_link_seconds);
   CLOG_INFO(&LOG,
             0,
             " * Applying overrides: %.0fm%.2fs",
@@ -317,20 +317,31 @@ int main(int argc,
 
   /* NOTE: Special exception for guarded allocator type switch:
    *       we need to perform switch from lock-free to fully
-   *       guarded allocator before any allocation happened.
+   *       guarded (or pooled) allocator before any allocation happened.
    */
   {
     int i;
+    bool use_guarded_allocator = false, use_pool_allocator = false;
     for (i = 0; i < argc; i++) {
       if (STR_ELEM(argv[i], "-d", "--debug", "--debug-memory", "--debug-all")) {
-        printf("Switching to fully guarded memory allocator.\n");
-        MEM_use_guarded_allocator();
+        use_guarded_allocator = true;
         break;
       }
+      if (STREQ(argv[i], "--enable-pool-allocator")) {
+        use_pool_allocator = true;
+      }
       if (STREQ(argv[i], "--")) {
         break;
       }
     }
+    if (use_guarded_allocator) {
+      printf("Switching to fully guarded memory allocator.\n");
+      MEM_use_guarded_allocator();
+    }
+    else if (use_pool_allocator) {
+      printf("Switching to pooled memory allocator.\n");
+      MEM_use_pool_allocator();
+    }
     MEM_init_memleak_detection();
   }
 
@@ -45,6 +45,7 @@
 
 #  include "BLO_readfile.h" /* only for BLO_has_bfile_extension */
 
+#  include "BKE_blender.h"
 #  include "BKE_blender_version.h"
 #  include "BKE_context.h"
 
@@ -589,6 +590,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-time");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-pretty");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-uuid");
+  BLI_args_print_arg_doc(ba, "--debug-depsgraph-trace");
   BLI_args_print_arg_doc(ba, "--debug-ghost");
   BLI_args_print_arg_doc(ba, "--debug-gpu");
   BLI_args_print_arg_doc(ba, "--debug-gpu-force-workarounds");
@@ -614,6 +616,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--app-template");
   BLI_args_print_arg_doc(ba, "--factory-startup");
   BLI_args_print_arg_doc(ba, "--enable-event-simulate");
+  BLI_args_print_arg_doc(ba, "--enable-pool-allocator");
   printf("\n");
   BLI_args_print_arg_doc(ba, "--env-system-datafiles");
   BLI_args_print_arg_doc(ba, "--env-system-scripts");
@@ -751,6 +754,19 @@ static int arg_handle_abort_handler_disable(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_pool_allocator_enable_doc[] =
+    "\n\t"
+    "Serve small memory allocations from thread-local pools.\n"
+    "\tThis can be faster when many threads allocate at once, but unused memory is kept.\n"
+    "\tIgnored when memory debugging is enabled.";
+static int arg_handle_pool_allocator_enable(int UNUSED(argc),
+                                            const char **UNUSED(argv),
+                                            void *UNUSED(data))
+{
+  /* The allocator has to be switched before any allocation, see `main()`. */
+  return 0;
+}
+
 static void clog_abort_on_error_callback(void *fp)
 {
   BLI_system_backtrace(fp);
@@ -1009,6 +1025,41 @@ static int arg_handle_debug_mode_generic_set(int UNUSED(argc),
   return 0;
 }
 
+static void callback_debug_depsgraph_trace_atexit(void *user_data)
+{
+  FILE *fp = user_data;
+  DEG_debug_trace_end(fp);
+  fclose(fp);
+}
+
+static const char arg_handle_debug_depsgraph_trace_set_doc[] =
+    "<filename>\n"
+    "\tRecord the evaluation of dependency graph operations and write it to the file on exit,\n"
+    "\tin the Chrome Trace Event format (can be opened in Perfetto or 'chrome://tracing').";
+static int arg_handle_debug_depsgraph_trace_set(int argc, const char **argv, void *UNUSED(data))
+{
+  const char *arg_id = "--debug-depsgraph-trace";
+  if (argc > 1) {
+    errno = 0;
+    FILE *fp = BLI_fopen(argv[1], "w");
+    if (fp == NULL) {
+      const char *err_msg = errno ? strerror(errno) : "unknown";
+      printf("\nError: %s '%s %s'.\n", err_msg, arg_id, argv[1]);
+    }
+    else if (DEG_debug_trace_is_active()) {
+      printf("\nError: '%s' given more than once.\n", arg_id);
+      fclose(fp);
+    }
+    else {
+      DEG_debug_trace_begin();
+      BKE_blender_atexit_register(callback_debug_depsgraph_trace_atexit, fp);
+    }
+    return 1;
+  }
+  printf("\nError: '%s' no args given.\n", arg_id);
+  return 0;
+}
+
 static const char arg_handle_debug_mode_io_doc[] =
     "\n\t"
     "Enable debug messages for I/O (Collada, ...).";
@@ -2076,6 +2127,7 @@ void main_args_setup(bContext *C, bArgs *ba)
 
   BLI_args_add(ba, NULL, "--disable-crash-handler", CB(arg_handle_crash_handler_disable), NULL);
   BLI_args_add(ba, NULL, "--disable-abort-handler", CB(arg_handle_abort_handler_disable), NULL);
+  BLI_args_add(ba, NULL, "--enable-pool-allocator", CB(arg_handle_pool_allocator_enable), NULL);
 
   BLI_args_add(ba, "-b", "--background", CB(arg_handle_background_mode_set), NULL);
 
@@ -2198,6 +2250,8 @@ void main_args_setup(bContext *C, bArgs *ba)
                "--debug-depsgraph-uuid",
                CB_EX(arg_handle_debug_mode_generic_set, depsgraph_uuid),
                (void *)G_DEBUG_DEPSGRAPH_UUID);
+  BLI_args_add(
+      ba, NULL, "--debug-depsgraph-trace", CB(arg_handle_debug_depsgraph_trace_set), NULL);
   BLI_args_add(ba,
                NULL,
                "--debug-gpu-force-workarounds",
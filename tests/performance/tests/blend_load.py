@@ -3,6 +3,30 @@
 import api
 import os
 import pathlib
+import re
+
+
+def _read_proc_status(key):
+    # Memory value from `/proc/self/status` in bytes, only available on Linux.
+    try:
+        with open('/proc/self/status') as f:
+            for line in f:
+                if line.startswith(key + ':'):
+                    return int(line.split()[1]) * 1024
+    except OSError:
+        pass
+    return None
+
+
+def _reset_peak_memory():
+    # Reset the peak resident memory of the process, so that it doesn't include
+    # startup and earlier loads. Returns false when not supported.
+    try:
+        with open('/proc/self/clear_refs', 'w') as f:
+            f.write('5')
+    except OSError:
+        return False
+    return True
 
 
 def _run(filepath):
@@ -13,12 +37,40 @@ def _run(filepath):
     bpy.ops.wm.open_mainfile(filepath=filepath)
     bpy.ops.wm.read_homefile()
 
+    # Peak memory used by the load itself, on top of what was in use before.
+    measure_memory = _reset_peak_memory()
+    memory_before = _read_proc_status('VmRSS') if measure_memory else None
+
     # Measure loading the second time
     start_time = time.time()
     bpy.ops.wm.open_mainfile(filepath=filepath)
     elapsed_time = time.time() - start_time
 
     result = {'time': elapsed_time}
+
+    peak_memory = _read_proc_status('VmHWM') if memory_before is not None else None
+    if peak_memory is not None:
+        result['peak_memory'] = max(peak_memory - memory_before, 0)
+
+    return result
+
+
+def _parse_phase_times(lines):
+    # Per-phase timings logged by `wm.files` after reading a file. The last
+    # occurrence is used, which is the measured second load.
+    phases = {
+        'Reading data': 'time_read_data',
+        'Loading libraries': 'time_libraries',
+        'Reading libraries': 'time_read_libraries',
+        'Linking data': 'time_lib_link',
+    }
+
+    result = {}
+    for line in lines:
+        for label, key in phases.items():
+            match = re.search(label + r': (\d+)m([\d.]+)s', line)
+            if match:
+                result[key] = float(match.group(1)) * 60.0 + float(match.group(2))
     return result
 
 
@@ -33,7 +85,8 @@ class BlendLoadTest(api.Test):
         return "blend_load"
 
     def run(self, env, device_id):
-        result, _ = env.run_in_blender(_run, str(self.filepath))
+        result, lines = env.run_in_blender(_run, str(self.filepath), ['--log', 'wm.files'])
+        result.update(_parse_phase_times(lines))
         return result
 
 
@@ -0,0 +1,85 @@
+# Apache License, Version 2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import math
+    import time
+
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+
+    # Instance a small cube on every point of a grid and realize the instances.
+    side = int(math.ceil(math.sqrt(args['instances'])))
+
+    group = bpy.data.node_groups.new("Realize Instances", 'GeometryNodeTree')
+    group.outputs.new('NodeSocketGeometry', "Geometry")
+    nodes = group.nodes
+    links = group.links
+
+    grid = nodes.new('GeometryNodeMeshGrid')
+    grid.inputs['Vertices X'].default_value = side
+    grid.inputs['Vertices Y'].default_value = side
+    to_points = nodes.new('GeometryNodeMeshToPoints')
+    cube = nodes.new('GeometryNodeMeshCube')
+    instance = nodes.new('GeometryNodeInstanceOnPoints')
+    realize = nodes.new('GeometryNodeRealizeInstances')
+    output = nodes.new('NodeGroupOutput')
+
+    links.new(grid.outputs['Mesh'], to_points.inputs['Mesh'])
+    links.new(to_points.outputs['Points'], instance.inputs['Points'])
+    links.new(cube.outputs['Mesh'], instance.inputs['Instance'])
+    links.new(instance.outputs['Instances'], realize.inputs['Geometry'])
+    links.new(realize.outputs['Geometry'], output.inputs[0])
+
+    mesh = bpy.data.meshes.new("Instances")
+    ob = bpy.data.objects.new("Instances", mesh)
+    bpy.context.scene.collection.objects.link(ob)
+    modifier = ob.modifiers.new("Nodes", 'NODES')
+    modifier.node_group = group
+
+    def evaluate(iteration):
+        # Change the instanced geometry every time, so that nothing can be reused from a
+        # previous evaluation.
+        size = 0.01 * (1.0 + 0.01 * iteration)
+        cube.inputs['Size'].default_value = (size, size, size)
+        start_time = time.time()
+        bpy.context.view_layer.update()
+        return time.time() - start_time
+
+    def measure(iterations):
+        evaluate(0)
+        times = sorted(evaluate(i + 1) for i in range(iterations))
+        return times[len(times) // 2]
+
+    iterations = args['iterations']
+    time_with_realize = measure(iterations)
+    realize.mute = True
+    time_without_realize = measure(iterations)
+
+    result = {'time': time_with_realize,
+              'time_realize': max(time_with_realize - time_without_realize, 0.0)}
+    return result
+
+
+class RealizeInstancesTest(api.Test):
+    def __init__(self, instances, iterations):
+        self.instances = instances
+        self.iterations = iterations
+
+    def name(self):
+        return f"realize_instances_{self.instances // 1000000}M"
+
+    def category(self):
+        return "geometry_nodes"
+
+    def run(self, env, device_id):
+        args = {'instances': self.instances, 'iterations': self.iterations}
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    return [RealizeInstancesTest(1000000, 5),
+            RealizeInstancesTest(10000000, 3)]